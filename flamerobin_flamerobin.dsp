@@ -448,6 +448,10 @@ SOURCE=.\src\engine\MetadataLoader.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\engine\AttachmentPool.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\metadata\MetadataTemplateCmdHandler.cpp
 # End Source File
 # Begin Source File
@@ -464,6 +468,10 @@ SOURCE=.\src\gui\MultilineEnterDialog.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\gui\NBackupFrame.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\core\Observer.cpp
 # End Source File
 # Begin Source File
@@ -488,6 +496,10 @@ SOURCE=.\src\gui\ProgressDialog.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\gui\StatementWorker.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\core\ProgressIndicator.cpp
 # End Source File
 # Begin Source File
@@ -766,6 +778,10 @@ SOURCE=.\src\gui\controls\DataGrid.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\gui\controls\DataGridCellFormat.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\gui\controls\DataGridRowBuffer.h
 # End Source File
 # Begin Source File
@@ -894,6 +910,10 @@ SOURCE=.\src\engine\MetadataLoader.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\engine\AttachmentPool.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\metadata\MetadataTemplateManager.h
 # End Source File
 # Begin Source File
@@ -906,6 +926,10 @@ SOURCE=.\src\gui\MultilineEnterDialog.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\gui\NBackupFrame.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\core\ObjectWithHandle.h
 # End Source File
 # Begin Source File
@@ -934,6 +958,10 @@ SOURCE=.\src\gui\ProgressDialog.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\gui\StatementWorker.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\core\ProgressIndicator.h
 # End Source File
 # Begin Source File
@@ -281,6 +281,10 @@ SOURCE=.\src\ibpp\dbkey.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\ibpp\decfloat.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\ibpp\events.cpp
 # End Source File
 # Begin Source File
@@ -289,10 +293,18 @@ SOURCE=.\src\ibpp\exception.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\ibpp\int128.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\ibpp\row.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\ibpp\rowbatch.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\ibpp\service.cpp
 # End Source File
 # Begin Source File
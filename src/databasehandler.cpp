@@ -33,6 +33,7 @@
 #include "core/StringUtils.h"
 #include "core/URIProcessor.h"
 #include "gui/GUIURIHandlerHelper.h"
+#include "gui/ProgressDialog.h"
 #include "metadata/server.h"
 #include "metadata/database.h"
 #include "metadata/MetadataItemURIHandlerHelper.h"
@@ -158,3 +159,34 @@ bool DatabaseInfoHandler::handleURI(URI& uri)
     return true;
 }
 
+
+class DatabaseStatisticsHandler: public URIHandler,
+    private MetadataItemURIHandlerHelper, private GUIURIHandlerHelper
+{
+public:
+    DatabaseStatisticsHandler() {}
+    bool handleURI(URI& uri);
+private:
+    // singleton; registers itself on creation.
+    static const DatabaseStatisticsHandler handlerInstance;
+};
+
+const DatabaseStatisticsHandler DatabaseStatisticsHandler::handlerInstance;
+
+bool DatabaseStatisticsHandler::handleURI(URI& uri)
+{
+    if (uri.action != "collect_statistics")
+        return false;
+
+    DatabasePtr d = extractMetadataItemPtrFromURI<Database>(uri);
+    wxWindow* w = getParentWindow(uri);
+    if (!d || !w || !d->isConnected())
+        return true;
+
+    // the database observers (the statistics page among them) are notified
+    // once new statistics have been collected
+    ProgressDialog pd(w, _("Collecting database statistics"), 1);
+    pd.doShow();
+    d->collectStatistics(&pd);
+    return true;
+}
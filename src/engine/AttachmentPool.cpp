@@ -0,0 +1,256 @@
+/*
+  Copyright (c) 2004-2016 The FlameRobin Development Team
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWindows headers
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include "engine/AttachmentPool.h"
+#include "metadata/database.h"
+
+AttachmentPool::AttachmentPool(IBPP::Database main, unsigned maxSize,
+        long idleTimeoutSeconds)
+    : mainM(main), checkedOutM(0), maxSizeM(maxSize),
+        idleTimeoutMillisM(idleTimeoutSeconds * 1000), closedM(false)
+{
+}
+
+AttachmentPool::~AttachmentPool()
+{
+    close();
+}
+
+std::vector<IBPP::Database> AttachmentPool::takeExpired(bool all)
+{
+    std::vector<IBPP::Database> expired;
+    wxLongLong now = wxGetLocalTimeMillis();
+    std::vector<IdleAttachment>::iterator it = idleM.begin();
+    while (it != idleM.end())
+    {
+        if (all || now - (*it).sinceMillis >= idleTimeoutMillisM)
+        {
+            expired.push_back((*it).database);
+            it = idleM.erase(it);
+        }
+        else
+            ++it;
+    }
+    return expired;
+}
+
+/*static*/
+void AttachmentPool::disconnect(std::vector<IBPP::Database>& attachments)
+{
+    for (std::vector<IBPP::Database>::iterator it = attachments.begin();
+        it != attachments.end(); ++it)
+    {
+        try
+        {
+            (*it)->Disconnect();
+        }
+        catch (IBPP::Exception&)
+        {
+            // the attachment is dropped anyway
+        }
+    }
+    attachments.clear();
+}
+
+IBPP::Database AttachmentPool::checkout()
+{
+    IBPP::Database attachment;
+    IBPP::Database main;
+    std::vector<IBPP::Database> expired;
+    {
+        wxCriticalSectionLocker lock(critSectM);
+        expired = takeExpired(false);
+        if (!closedM && !idleM.empty())
+        {
+            // the most recently used one, the others can expire
+            attachment = idleM.back().database;
+            idleM.pop_back();
+            ++checkedOutM;
+        }
+        else if (closedM || checkedOutM + idleM.size() >= maxSizeM)
+            attachment = mainM;
+        else
+        {
+            // reserve the slot, connecting happens outside of the lock
+            ++checkedOutM;
+            main = mainM;
+        }
+    }
+    disconnect(expired);
+    if (attachment != 0)
+        return attachment;
+
+    try
+    {
+        attachment = IBPP::DatabaseFactory(main->ServerName(),
+            main->DatabaseName(), main->Username(), main->UserPassword(),
+            main->RoleName(), main->CharSet(), "");
+        attachment->Connect();
+        return attachment;
+    }
+    catch (IBPP::Exception&)
+    {
+        // the connection limit of the server may be reached, for example,
+        // so share the main attachment instead
+        wxCriticalSectionLocker lock(critSectM);
+        --checkedOutM;
+        return mainM;
+    }
+}
+
+void AttachmentPool::checkin(IBPP::Database attachment)
+{
+    if (attachment == 0 || attachment == mainM)
+        return;
+
+    // statements cached by the user of the attachment may have been
+    // invalidated by DDL run elsewhere, the next user prepares them again
+    bool cleared = true;
+    try
+    {
+        attachment->ClearStatementCache();
+    }
+    catch (IBPP::Exception&)
+    {
+        cleared = false;
+    }
+
+    std::vector<IBPP::Database> expired;
+    {
+        wxCriticalSectionLocker lock(critSectM);
+        if (checkedOutM)
+            --checkedOutM;
+        if (closedM || !cleared || !attachment->Connected())
+            expired.push_back(attachment);
+        else
+        {
+            IdleAttachment idle;
+            idle.database = attachment;
+            idle.sinceMillis = wxGetLocalTimeMillis();
+            idleM.push_back(idle);
+        }
+        std::vector<IBPP::Database> more(takeExpired(false));
+        expired.insert(expired.end(), more.begin(), more.end());
+    }
+    disconnect(expired);
+}
+
+void AttachmentPool::clearStatementCaches()
+{
+    std::vector<IBPP::Database> idle;
+    {
+        wxCriticalSectionLocker lock(critSectM);
+        for (std::vector<IdleAttachment>::iterator it = idleM.begin();
+            it != idleM.end(); ++it)
+        {
+            idle.push_back((*it).database);
+        }
+    }
+    // an attachment checked out meanwhile is locked by IBPP while its cache
+    // is cleared, the ones checked out before are cleared on checkin()
+    for (std::vector<IBPP::Database>::iterator it = idle.begin();
+        it != idle.end(); ++it)
+    {
+        try
+        {
+            (*it)->ClearStatementCache();
+        }
+        catch (IBPP::Exception&)
+        {
+            // checkin() retries, and drops the attachment if that fails
+        }
+    }
+}
+
+void AttachmentPool::closeIdleAttachments()
+{
+    std::vector<IBPP::Database> expired;
+    {
+        wxCriticalSectionLocker lock(critSectM);
+        expired = takeExpired(false);
+    }
+    disconnect(expired);
+}
+
+void AttachmentPool::close()
+{
+    std::vector<IBPP::Database> expired;
+    {
+        wxCriticalSectionLocker lock(critSectM);
+        closedM = true;
+        expired = takeExpired(true);
+    }
+    disconnect(expired);
+}
+
+unsigned AttachmentPool::getCheckedOutCount()
+{
+    wxCriticalSectionLocker lock(critSectM);
+    return checkedOutM;
+}
+
+unsigned AttachmentPool::getIdleCount()
+{
+    wxCriticalSectionLocker lock(critSectM);
+    return idleM.size();
+}
+
+PooledAttachment::PooledAttachment(Database* database, bool lazy)
+{
+    wxASSERT(database);
+    poolM = database->getAttachmentPool();
+    mainM = database->getIBPPDatabase();
+    if (!lazy)
+        attachmentM = checkout();
+}
+
+IBPP::Database PooledAttachment::checkout()
+{
+    IBPP::Database attachment;
+    if (poolM)
+        attachment = poolM->checkout();
+    if (attachment == 0)
+        attachment = mainM;
+    return attachment;
+}
+
+void PooledAttachment::assign(IBPP::Database attachment)
+{
+    wxASSERT(attachmentM == 0);
+    attachmentM = attachment;
+}
+
+PooledAttachment::~PooledAttachment()
+{
+    if (poolM)
+        poolM->checkin(attachmentM);
+}
@@ -0,0 +1,117 @@
+/*
+  Copyright (c) 2004-2016 The FlameRobin Development Team
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef FR_ATTACHMENTPOOL_H
+#define FR_ATTACHMENTPOOL_H
+
+#include <wx/thread.h>
+
+#include <memory>
+#include <vector>
+
+#include <ibpp.h>
+
+class Database;
+
+// A small pool of secondary attachments to a database, so that SQL editors
+// and background tasks don't share the attachment of the metadata loader
+// and the property pages - a long-running query then doesn't stall them.
+// The attachments are connected on demand with the credentials of the
+// main one, returned ones are kept for reuse, and the ones idle for longer
+// than the timeout are disconnected. When the pool is exhausted the main
+// attachment is handed out instead.
+// All methods are thread-safe.
+class AttachmentPool
+{
+private:
+    struct IdleAttachment
+    {
+        IBPP::Database database;
+        wxLongLong sinceMillis;
+    };
+
+    wxCriticalSection critSectM;
+    IBPP::Database mainM;
+    std::vector<IdleAttachment> idleM;
+    unsigned checkedOutM;
+    unsigned maxSizeM;
+    long idleTimeoutMillisM;
+    bool closedM;
+
+    // removes the expired attachments from idleM (all of them if all is
+    // true) and returns them, to be disconnected after leaving the lock
+    std::vector<IBPP::Database> takeExpired(bool all);
+    static void disconnect(std::vector<IBPP::Database>& attachments);
+public:
+    // maxSize is the number of secondary attachments, 0 disables the pool
+    AttachmentPool(IBPP::Database main, unsigned maxSize,
+        long idleTimeoutSeconds);
+    ~AttachmentPool();
+
+    // returns an idle or a newly connected attachment, or the main one
+    IBPP::Database checkout();
+    // returns an attachment handed out by checkout(), its transactions
+    // should be finished; its statement cache is cleared
+    void checkin(IBPP::Database attachment);
+    // clears the statement caches of the idle attachments, needed after
+    // DDL has been committed (checked out ones are cleared on checkin())
+    void clearStatementCaches();
+    // disconnects the attachments idle for longer than the timeout
+    void closeIdleAttachments();
+    // disconnects all idle attachments, the ones checked out are
+    // disconnected when they are returned; done when the main attachment
+    // is disconnected
+    void close();
+
+    unsigned getCheckedOutCount();
+    unsigned getIdleCount();
+};
+
+typedef std::shared_ptr<AttachmentPool> AttachmentPoolPtr;
+
+// Checks out an attachment of the database's pool for the lifetime of the
+// object, the pool is kept alive until the attachment is returned to it.
+// A lazy object has no attachment until one is assigned, as connecting it
+// may take a while: checkout() can run on a worker thread, and its result
+// is handed to assign() by the thread using the object.
+class PooledAttachment
+{
+private:
+    AttachmentPoolPtr poolM;
+    IBPP::Database mainM;
+    IBPP::Database attachmentM;
+    PooledAttachment(const PooledAttachment&);
+    PooledAttachment& operator=(const PooledAttachment&);
+public:
+    PooledAttachment(Database* database, bool lazy = false);
+    ~PooledAttachment();
+
+    // returns an attachment of the pool, or the main one; thread-safe
+    IBPP::Database checkout();
+    void assign(IBPP::Database attachment);
+    bool isAssigned() const { return attachmentM != 0; }
+
+    IBPP::Database& get() { return attachmentM; }
+};
+
+#endif // FR_ATTACHMENTPOOL_H
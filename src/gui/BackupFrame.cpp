@@ -52,7 +52,7 @@ class BackupThread: public wxThread {
 public:
     BackupThread(BackupFrame* frame, wxString server, wxString username,
         wxString password, wxString dbfilename, wxString bkfilename,
-        IBPP::BRF flags);
+        IBPP::BRF flags, int workers);
 
     virtual void* Entry();
     virtual void OnExit();
@@ -64,14 +64,14 @@ private:
     wxString dbfileM;
     wxString bkfileM;
     IBPP::BRF brfM;
+    int workersM;
     void logError(wxString& msg);
     void logImportant(wxString& msg);
-    void logProgress(wxString& msg);
 };
 
 BackupThread::BackupThread(BackupFrame* frame, wxString server,
         wxString username, wxString password, wxString dbfilename,
-        wxString bkfilename, IBPP::BRF flags)
+        wxString bkfilename, IBPP::BRF flags, int workers)
     : wxThread()
 {
     frameM = frame;
@@ -82,6 +82,7 @@ BackupThread::BackupThread(BackupFrame* frame, wxString server,
     bkfileM = bkfilename;
     // always use verbose flag
     brfM = (IBPP::BRF)((int)flags | (int)IBPP::brVerbose);
+    workersM = workers;
 }
 
 void* BackupThread::Entry()
@@ -100,7 +101,8 @@ void* BackupThread::Entry()
         now = wxDateTime::Now();
         msg.Printf(_("Database backup started %s"), now.FormatTime().c_str());
         logImportant(msg);
-        svc->StartBackup(wx2std(dbfileM), wx2std(bkfileM), brfM);
+        svc->StartBackup(wx2std(dbfileM), wx2std(bkfileM), brfM, workersM);
+        std::string output;
         while (true)
         {
             if (TestDestroy())
@@ -111,17 +113,21 @@ void* BackupThread::Entry()
                 logImportant(msg);
                 break;
             }
-            const char* c = svc->WaitMsg();
-            if (c == 0)
+            // all the lines available at once, one line per call is too
+            // slow for the verbose output of big databases
+            bool running = svc->WaitOutput(output);
+            if (!output.empty() && frameM != 0)
+                frameM->threadOutputLines(output);
+            if (!running)
             {
                 now = wxDateTime::Now();
                 msg.Printf(_("Database backup finished %s"),
                     now.FormatTime().c_str());
                 logImportant(msg);
+                if (frameM != 0)
+                    frameM->threadLogPhases();
                 break;
             }
-            msg = c;
-            logProgress(msg);
         }
         svc->Disconnect();
     }
@@ -165,12 +171,6 @@ void BackupThread::logImportant(wxString& msg)
         frameM->threadOutputMsg(msg, BackupRestoreBaseFrame::important_message);
 }
 
-void BackupThread::logProgress(wxString& msg)
-{
-    if (frameM != 0)
-        frameM->threadOutputMsg(msg, BackupRestoreBaseFrame::progress_message);
-}
-
 BackupFrame::BackupFrame(wxWindow* parent, DatabasePtr db)
     : BackupRestoreBaseFrame(parent, db)
 {
@@ -213,8 +213,18 @@ void BackupFrame::createControls()
     checkbox_extern = new wxCheckBox(panel_controls, wxID_ANY,
         _("Convert external tables"));
 
+    label_workers = new wxStaticText(panel_controls, wxID_ANY,
+        _("Parallel workers:"));
+    spinctrl_workers = new wxSpinCtrl(panel_controls, wxID_ANY,
+        wxEmptyString, wxDefaultPosition, wxDefaultSize, wxSP_ARROW_KEYS,
+        0, 64, 0);
+    spinctrl_workers->SetToolTip(
+        _("0 uses the server default, Firebird 5 or later is needed for more"));
+
     checkbox_showlog = new wxCheckBox(panel_controls, ID_checkbox_showlog,
         _("Show complete log"));
+    label_progress = new wxStaticText(panel_controls, wxID_ANY,
+        wxEmptyString);
     button_start = new wxButton(panel_controls, ID_button_start,
         _("&Start Backup"));
 
@@ -243,9 +253,15 @@ void BackupFrame::layoutControls()
     sizerChecks->Add(checkbox_transport, 0, wxEXPAND);
     sizerChecks->Add(checkbox_extern, 0, wxEXPAND);
 
+    wxBoxSizer* sizerWorkers = new wxBoxSizer(wxHORIZONTAL);
+    sizerWorkers->Add(label_workers, 0, wxALIGN_CENTER_VERTICAL);
+    sizerWorkers->Add(styleguide().getControlLabelMargin(), 0);
+    sizerWorkers->Add(spinctrl_workers, 0, wxALIGN_CENTER_VERTICAL);
+
     wxBoxSizer* sizerButtons = new wxBoxSizer(wxHORIZONTAL);
     sizerButtons->Add(checkbox_showlog, 0, wxALIGN_CENTER_VERTICAL);
-    sizerButtons->Add(0, 0, 1, wxEXPAND);
+    sizerButtons->Add(styleguide().getUnrelatedControlMargin(wxHORIZONTAL), 0);
+    sizerButtons->Add(label_progress, 1, wxALIGN_CENTER_VERTICAL);
     sizerButtons->Add(button_start);
 
     wxBoxSizer* sizerPanelV = new wxBoxSizer(wxVERTICAL);
@@ -253,6 +269,8 @@ void BackupFrame::layoutControls()
     sizerPanelV->Add(sizerFilename, 0, wxEXPAND);
     sizerPanelV->Add(0, styleguide().getRelatedControlMargin(wxVERTICAL));
     sizerPanelV->Add(sizerChecks);
+    sizerPanelV->Add(0, styleguide().getRelatedControlMargin(wxVERTICAL));
+    sizerPanelV->Add(sizerWorkers);
     sizerPanelV->Add(0, styleguide().getUnrelatedControlMargin(wxVERTICAL));
     sizerPanelV->Add(sizerButtons, 0, wxEXPAND);
     sizerPanelV->Add(0, styleguide().getRelatedControlMargin(wxVERTICAL));
@@ -283,6 +301,7 @@ void BackupFrame::updateControls()
     checkbox_garbage->Enable(!running);
     checkbox_transport->Enable(!running);
     checkbox_extern->Enable(!running);
+    spinctrl_workers->Enable(!running);
     button_start->Enable(!running && !text_ctrl_filename->GetValue().empty());
 }
 
@@ -401,7 +420,7 @@ void BackupFrame::OnStartButtonClick(wxCommandEvent& WXUNUSED(event))
     std::auto_ptr<wxThread> thread(new BackupThread(this,
         server->getConnectionString(), username, password,
         database->getPath(), text_ctrl_filename->GetValue(),
-        (IBPP::BRF)flags));
+        (IBPP::BRF)flags, spinctrl_workers->GetValue()));
     startThread(thread);
     updateControls();
 }
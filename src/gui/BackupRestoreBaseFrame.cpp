@@ -49,6 +49,9 @@ BackupRestoreBaseFrame::BackupRestoreBaseFrame(wxWindow* parent,
     db->attachObserver(this, false);
 
     threadMsgTimeMillisM = 0;
+    progressObjectsM = 0;
+    progressRecordsM = 0;
+    progressStartMillisM = 0;
     verboseMsgsM = true;
 
     // create controls in constructor of descendant class (correct tab order)
@@ -58,12 +61,63 @@ BackupRestoreBaseFrame::BackupRestoreBaseFrame(wxWindow* parent,
     button_browse = 0;
     checkbox_showlog = 0;
     button_start = 0;
+    label_workers = 0;
+    spinctrl_workers = 0;
+    label_progress = 0;
     text_ctrl_log = 0;
 
     SetIcon(wxArtProvider::GetIcon(ART_Backup, wxART_FRAME_ICON));
 }
 
 //! implementation details
+// counts the objects and the records in verbose gbak output like
+//   gbak:   writing table COUNTRY
+//   gbak:writing data for table COUNTRY
+//   gbak:      14 records written
+// and the lines per phase (metadata, data, indices), the lines that don't
+// tell belong to the phase of the line before
+static void countGbakOutput(const std::string& lines, int& objects,
+    wxLongLong& records, wxString& phase, std::map<wxString, int>& phaseLines)
+{
+    std::string::size_type start = 0;
+    while (start < lines.size())
+    {
+        std::string::size_type eol = lines.find('\n', start);
+        if (eol == std::string::npos)
+            eol = lines.size();
+        if (lines.compare(start, 5, "gbak:") == 0)
+        {
+            std::string::size_type p = lines.find_first_not_of(' ',
+                start + 5);
+            bool object = p < eol && (lines.compare(p, 8, "writing ") == 0
+                || lines.compare(p, 10, "restoring ") == 0);
+            if (lines.find("index", p) < eol)
+                phase = _("indices");
+            else if (object && lines.find(" data for table ", p) < eol)
+                phase = _("data");
+            else if (object)
+                phase = _("metadata");
+
+            if (object)
+            {
+                if (lines.find(" data for table ", p) > eol)
+                    ++objects;
+            }
+            else if (p < eol && isdigit((unsigned char)lines[p]))
+            {
+                long long n = 0;
+                for (; p < eol && isdigit((unsigned char)lines[p]); ++p)
+                    n = n * 10 + (lines[p] - '0');
+                if (lines.compare(p, 9, " records ") == 0)
+                    records += n;
+            }
+        }
+        if (!phase.empty())
+            ++phaseLines[phase];
+        start = eol + 1;
+    }
+}
+
 void BackupRestoreBaseFrame::addThreadMsg(const wxString msg,
     bool& notificationNeeded)
 {
@@ -95,6 +149,16 @@ void BackupRestoreBaseFrame::clearLog()
     msgKindsM.Clear();
     msgsM.Clear();
     text_ctrl_log->ClearAll();
+
+    wxCriticalSectionLocker locker(critsectM);
+    progressObjectsM = 0;
+    progressRecordsM = 0;
+    progressStartMillisM = ::wxGetLocalTimeMillis();
+    label_progress->SetLabel(wxEmptyString);
+
+    phaseM = _("startup");
+    phaseMillisM = progressStartMillisM;
+    phaseSecondsM.clear();
 }
 
 bool BackupRestoreBaseFrame::Destroy()
@@ -112,6 +176,14 @@ void BackupRestoreBaseFrame::doReadConfigSettings(const wxString& prefix)
         verbose);
     checkbox_showlog->SetValue(verbose);
 
+    // not all descendants have it
+    if (spinctrl_workers)
+    {
+        int workers = 0;
+        config().getValue(prefix + Config::pathSeparator + "workers", workers);
+        spinctrl_workers->SetValue(workers);
+    }
+
     wxString bkfile;
     config().getValue(prefix + Config::pathSeparator + "backupfilename",
         bkfile);
@@ -124,6 +196,11 @@ void BackupRestoreBaseFrame::doWriteConfigSettings(const wxString& prefix) const
     BaseFrame::doWriteConfigSettings(prefix);
     config().setValue(prefix + Config::pathSeparator + "verboselog",
         checkbox_showlog->GetValue());
+    if (spinctrl_workers)
+    {
+        config().setValue(prefix + Config::pathSeparator + "workers",
+            spinctrl_workers->GetValue());
+    }
     config().setValue(prefix + Config::pathSeparator + "backupfilename",
         text_ctrl_filename->GetValue());
 }
@@ -198,6 +275,58 @@ void BackupRestoreBaseFrame::threadOutputMsg(const wxString msg, MsgKind kind)
     }
 }
 
+void BackupRestoreBaseFrame::threadOutputLines(const std::string& lines)
+{
+    int objects = 0;
+    wxLongLong records = 0;
+    std::map<wxString, int> phaseLines;
+    countGbakOutput(lines, objects, records, phaseM, phaseLines);
+
+    // the time since the previous output went into producing these lines
+    wxLongLong millisNow = ::wxGetLocalTimeMillis();
+    double seconds = (millisNow - phaseMillisM).ToDouble() / 1000.0;
+    phaseMillisM = millisNow;
+    int total = 0;
+    std::map<wxString, int>::const_iterator it;
+    for (it = phaseLines.begin(); it != phaseLines.end(); ++it)
+        total += it->second;
+    for (it = phaseLines.begin(); it != phaseLines.end(); ++it)
+        threadPhaseTime(it->first, seconds * it->second / total);
+
+    {
+        wxCriticalSectionLocker locker(critsectM);
+        progressObjectsM += objects;
+        progressRecordsM += records;
+    }
+    // one message for all the lines, they are only shown in the complete log
+    threadOutputMsg(wxString(lines.c_str()), progress_message);
+}
+
+void BackupRestoreBaseFrame::threadPhaseTime(const wxString& phase,
+    double seconds)
+{
+    std::vector<std::pair<wxString, double> >::iterator it;
+    for (it = phaseSecondsM.begin(); it != phaseSecondsM.end(); ++it)
+    {
+        if (it->first == phase)
+        {
+            it->second += seconds;
+            return;
+        }
+    }
+    phaseSecondsM.push_back(std::make_pair(phase, seconds));
+}
+
+void BackupRestoreBaseFrame::threadLogPhases()
+{
+    std::vector<std::pair<wxString, double> >::const_iterator it;
+    for (it = phaseSecondsM.begin(); it != phaseSecondsM.end(); ++it)
+    {
+        threadOutputMsg(wxString::Format(_("Time spent on %s: %.1f s"),
+            it->first.c_str(), it->second), important_message);
+    }
+}
+
 void BackupRestoreBaseFrame::update()
 {
     DatabasePtr db = getDatabase();
@@ -214,6 +343,19 @@ void BackupRestoreBaseFrame::updateControls()
     // completely initialized yet
 }
 
+void BackupRestoreBaseFrame::updateProgress()
+{
+    // called with critsectM locked
+    if (progressObjectsM == 0 && progressRecordsM == 0)
+        return;
+    double seconds = (::wxGetLocalTimeMillis()
+        - progressStartMillisM).ToDouble() / 1000.0;
+    double rate = (seconds > 0) ? progressRecordsM.ToDouble() / seconds : 0;
+    label_progress->SetLabel(wxString::Format(
+        _("%d objects, %s records (%.0f records/s)"), progressObjectsM,
+        progressRecordsM.ToString().c_str(), rate));
+}
+
 void BackupRestoreBaseFrame::updateMessages(size_t firstmsg, size_t lastmsg)
 {
     if (lastmsg > msgsM.GetCount())
@@ -288,6 +430,7 @@ void BackupRestoreBaseFrame::OnThreadOutput(wxCommandEvent& WXUNUSED(event))
     threadMsgsM.Clear();
 
     updateMessages(first, msgsM.GetCount());
+    updateProgress();
 }
 
 void BackupRestoreBaseFrame::OnVerboseLogChange(wxCommandEvent& WXUNUSED(event))
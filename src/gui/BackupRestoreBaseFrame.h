@@ -26,9 +26,14 @@
 #define BACKUPRESTOREBASEFRAME_H
 
 #include <wx/wx.h>
+#include <wx/spinctrl.h>
 #include <wx/thread.h>
 
+#include <map>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "core/Observer.h"
 #include "gui/BaseFrame.h"
@@ -72,6 +77,12 @@ protected:
     bool getThreadRunning() const;
 
     void threadOutputMsg(const wxString msg, MsgKind kind);
+    // verbose service output, the progress is counted on the calling thread
+    void threadOutputLines(const std::string& lines);
+    // time spent per phase, the output lines tell the phases of the
+    // server's work, the thread can add its own ones
+    void threadPhaseTime(const wxString& phase, double seconds);
+    void threadLogPhases();
     virtual void updateControls();
     BackupRestoreBaseFrame(wxWindow* parent, DatabasePtr db);
 private:
@@ -81,8 +92,17 @@ private:
     wxCriticalSection critsectM;
     wxArrayString threadMsgsM;
     wxLongLong threadMsgTimeMillisM;
+    // progress counted from the verbose output, guarded by critsectM too
+    int progressObjectsM;
+    wxLongLong progressRecordsM;
+    wxLongLong progressStartMillisM;
+    // only used by the thread
+    wxString phaseM;
+    wxLongLong phaseMillisM;
+    std::vector<std::pair<wxString, double> > phaseSecondsM;
     void addThreadMsg(const wxString msg, bool& notificationNeeded);
     void updateMessages(size_t firstmsg, size_t lastmsg);
+    void updateProgress();
 
     // observer stuff
     virtual void subjectRemoved(Subject* subject);
@@ -104,6 +124,9 @@ protected:
     wxButton* button_browse;
     wxCheckBox* checkbox_showlog;
     wxButton* button_start;
+    wxStaticText* label_workers;
+    wxSpinCtrl* spinctrl_workers;
+    wxStaticText* label_progress;
     LogTextControl* text_ctrl_log;
     void setupControls();
 private:
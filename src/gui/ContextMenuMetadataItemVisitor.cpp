@@ -89,6 +89,8 @@ void MainObjectMenuMetadataItemVisitor::visitDatabase(Database& database)
     // Tools submenu
     toolsMenu->Append(Cmds::Menu_Backup, _("&Backup database"));
     toolsMenu->Append(Cmds::Menu_Restore, _("Rest&ore database"));
+    toolsMenu->Append(Cmds::Menu_IncrementalBackup,
+        _("&Incremental backup"));
     addSeparator();
     toolsMenu->Append(Cmds::Menu_RecreateDatabase, _("Recreate empty database"));
     addSeparator();
@@ -45,6 +45,7 @@
 #include "core/ArtProvider.h"
 #include "core/FRError.h"
 #include "core/StringUtils.h"
+#include "engine/AttachmentPool.h"
 #include "gui/AdvancedMessageDialog.h"
 #include "gui/controls/DBHTreeControl.h"
 #include "gui/DataGeneratorFrame.h"
@@ -1538,9 +1539,10 @@ void DataGeneratorFrame::generateData(std::list<Table *>& order)
     pd.doShow();
     pd.initProgress(_("Inserting into tables"), order.size());
 
+    // the inserts don't hold up the metadata browsing meanwhile
+    PooledAttachment attachment(databaseM);
     // one big transaction (perhaps this should be configurable)
-    IBPP::Transaction tr =
-        IBPP::TransactionFactory(databaseM->getIBPPDatabase());
+    IBPP::Transaction tr = IBPP::TransactionFactory(attachment.get());
     tr->Start();
 
     for (std::list<Table *>::iterator it = order.begin();
@@ -1585,9 +1587,11 @@ void DataGeneratorFrame::generateData(std::list<Table *>& order)
             continue;
 
         IBPP::Statement st =
-            IBPP::StatementFactory(databaseM->getIBPPDatabase(), tr);
+            IBPP::StatementFactory(attachment.get(), tr);
         st->Prepare(wx2std(ins + params + ")"));
 
+        // the rows are sent in batches, many rows per round trip
+        const int batchSize = 1000;
         for (int i = 0; i < records; i++)
         {
             if (pd.isCanceled())
@@ -1595,8 +1599,11 @@ void DataGeneratorFrame::generateData(std::list<Table *>& order)
             pd.stepProgress(1, 2);
             for (int p = 0; p < st->Parameters(); ++p)
                 setParam(st, p+1, colSet[p], i);
-            st->Execute();
+            st->AddBatch();
+            if (st->BatchSize() >= batchSize)
+                st->ExecuteBatch();
         }
+        st->ExecuteBatch();
     }
 
     tr->Commit();
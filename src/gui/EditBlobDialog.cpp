@@ -33,6 +33,8 @@
 #include <wx/stream.h>
 #include <wx/wfstream.h>
 
+#include <memory>
+
 #include "AdvancedMessageDialog.h"
 #include "core/FRError.h"
 #include "core/StringUtils.h"
@@ -248,6 +250,7 @@ class FRInputBlobStream : public wxInputStream
         virtual size_t OnSysRead(void *buffer, size_t size);          
     private:
         IBPP::Blob blobM;
+        std::unique_ptr<IBPP::BlobStreamBuf> bufM;
         int sizeM;
 };
 
@@ -262,6 +265,7 @@ class FROutputBlobStream : public wxOutputStream
         virtual size_t OnSysWrite(const void *buffer, size_t bufsize);
     private:
         IBPP::Blob blobM;
+        std::unique_ptr<IBPP::BlobStreamBuf> bufM;
 };
 
 
@@ -1348,7 +1352,9 @@ FRInputBlobStream::FRInputBlobStream(IBPP::Blob blob)
     if (blobM != 0)
     {
         blobM->Close();
-        blobM->Open();
+        // reads ahead, the editor consumes the data while it arrives
+        bufM.reset(new IBPP::BlobStreamBuf(blobM, std::ios_base::in,
+            256 * 1024, true));
         blobM->Info(&sizeM, 0, 0);
     }
     else
@@ -1357,16 +1363,16 @@ FRInputBlobStream::FRInputBlobStream(IBPP::Blob blob)
 
 FRInputBlobStream::~FRInputBlobStream()
 {
-    if (blobM != 0)
-        blobM->Close();
 }
 
 size_t FRInputBlobStream::OnSysRead(void* buffer, size_t size)
 {
-    if ((blobM != 0) && (sizeM > 0))
-        return blobM->Read(buffer, size);
-    else
-        return 0;
+    size_t len = 0;
+    if (bufM && (sizeM > 0))
+        len = bufM->sgetn(static_cast<char*>(buffer), size);
+    if (len == 0)
+        m_lasterror = wxSTREAM_EOF;
+    return len;
 }
 
 size_t FRInputBlobStream::GetSize() const
@@ -1380,7 +1386,7 @@ FROutputBlobStream::FROutputBlobStream(IBPP::Blob blob)
     :wxOutputStream()
 {
     blobM = blob;
-    blobM->Create();
+    bufM.reset(new IBPP::BlobStreamBuf(blobM, std::ios_base::out));
 }
 
 FROutputBlobStream::~FROutputBlobStream()
@@ -1393,14 +1399,15 @@ size_t FROutputBlobStream::OnSysWrite(const void* buffer, size_t bufsize)
     if (bufsize == 0)
         return 0;
 
-    blobM->Write(buffer, bufsize);
+    // the stream buffer splits large writes into segments
+    bufM->sputn(static_cast<const char*>(buffer), bufsize);
     return bufsize;
 }
 
 bool FROutputBlobStream::Close()
 {
-    if (blobM != 0)
-        blobM->Close();
+    if (bufM)
+        bufM->Close();
     return true;
 }
 
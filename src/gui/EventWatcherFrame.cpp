@@ -48,7 +48,6 @@ class EventLogControl: public LogTextControl
 public:
     EventLogControl(wxWindow* parent, wxWindowID id = wxID_ANY);
     void logAction(const wxString& action);
-    void logEvent(const wxString& name, int count);
 };
 
 EventLogControl::EventLogControl(wxWindow* parent, wxWindowID id)
@@ -63,16 +62,10 @@ void EventLogControl::logAction(const wxString& action)
     logMsg(action + "\n");
 }
 
-void EventLogControl::logEvent(const wxString& name, int count)
-{
-    wxString now(wxDateTime::Now().Format("%H:%M:%S  "));
-    addStyledText(now, logStyleImportant);
-    logMsg(name);
-    addStyledText(wxString::Format(" (%d)\n", count), logStyleError);
-}
-
 EventWatcherFrame::EventWatcherFrame(wxWindow* parent, DatabasePtr db)
-    : BaseFrame(parent, -1, wxEmptyString), databaseM(db), eventsM(0)
+    : BaseFrame(parent, -1, wxEmptyString), databaseM(db), eventsM(0),
+        windowMillisM(config().get("EventMonitorWindow", 1000)),
+        receivedM(false)
 {
     wxASSERT(db);
     timerM.SetOwner(this, ID_timer);
@@ -106,6 +99,11 @@ void EventWatcherFrame::createControls()
         _("Received events"));
     listbox_monitored = new wxListBox(panel_controls, ID_listbox_monitored,
         wxDefaultPosition, wxDefaultSize, 0, 0, wxLB_EXTENDED);
+    listctrl_rates = new wxListCtrl(panel_controls, ID_listctrl_rates,
+        wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxLC_SINGLE_SEL);
+    listctrl_rates->InsertColumn(0, _("Event"));
+    listctrl_rates->InsertColumn(1, _("Total"), wxLIST_FORMAT_RIGHT);
+    listctrl_rates->InsertColumn(2, _("Per second"), wxLIST_FORMAT_RIGHT);
     eventlog_received = new EventLogControl(panel_controls,
         ID_log_received);
     button_add = new wxButton(panel_controls, ID_button_add, _("&Add Events"));
@@ -127,6 +125,8 @@ void EventWatcherFrame::layoutControls()
     wxBoxSizer* sizerLog = new wxBoxSizer(wxVERTICAL);
     sizerLog->Add(static_text_received);
     sizerLog->AddSpacer(styleguide().getControlLabelMargin());
+    sizerLog->Add(listctrl_rates, 2, wxEXPAND);
+    sizerLog->AddSpacer(styleguide().getRelatedControlMargin(wxVERTICAL));
     sizerLog->Add(eventlog_received, 1, wxEXPAND);
 
     wxBoxSizer* sizerTop = new wxBoxSizer(wxHORIZONTAL);
@@ -234,6 +234,7 @@ void EventWatcherFrame::defineMonitoredEvents()
         if (timerRunning)
             setTimerActive(true);
     }
+    updateRates();
 }
 
 DatabasePtr EventWatcherFrame::getDatabase() const
@@ -271,10 +272,40 @@ void EventWatcherFrame::updateMonitoringActive()
     updateControls();
 }
 
-void EventWatcherFrame::ibppEventHandler(IBPP::Events events,
+void EventWatcherFrame::updateRates()
+{
+    // the counts came in since the last update, so that is their time span
+    double seconds = windowM.Time() / 1000.0;
+    windowM.Start();
+    receivedM = false;
+
+    int count = listbox_monitored->GetCount();
+    while (listctrl_rates->GetItemCount() > count)
+        listctrl_rates->DeleteItem(count);
+    for (int i = 0; i < count; ++i)
+    {
+        wxString name(listbox_monitored->GetString(i));
+        if (i < listctrl_rates->GetItemCount())
+            listctrl_rates->SetItemText(i, name);
+        else
+            listctrl_rates->InsertItem(i, name);
+
+        EventCounts& counts = countsM[name];
+        double rate = (seconds > 0) ? counts.window / seconds : 0;
+        counts.window = 0;
+        listctrl_rates->SetItem(i, 1, wxString::Format("%d", counts.total));
+        listctrl_rates->SetItem(i, 2, wxString::Format("%.1f", rate));
+    }
+}
+
+void EventWatcherFrame::ibppEventHandler(IBPP::Events WXUNUSED(events),
     const std::string& name, int count)
 {
-    eventlog_received->logEvent(name, count);
+    // called by Dispatch(), at most once per event and window
+    EventCounts& counts = countsM[std2wxIdentifier(name, wxConvCurrent)];
+    counts.total += count;
+    counts.window += count;
+    receivedM = true;
 }
 
 //! closes window if database is removed (unregistered)
@@ -299,6 +330,7 @@ void EventWatcherFrame::doReadConfigSettings(const wxString& prefix)
     config().getValue(prefix + Config::pathSeparator + "events", events);
     listbox_monitored->Append(events);
     updateControls();
+    updateRates();
 }
 
 void EventWatcherFrame::doWriteConfigSettings(const wxString& prefix) const
@@ -413,7 +445,10 @@ void EventWatcherFrame::OnButtonRemoveClick(wxCommandEvent& WXUNUSED(event))
 void EventWatcherFrame::OnButtonStartStopClick(wxCommandEvent& WXUNUSED(event))
 {
     if (eventsM != 0)
+    {
+        eventsM->StopDelivery();
         eventsM.clear();
+    }
     else
     {
         DatabasePtr database = getDatabase();
@@ -424,6 +459,10 @@ void EventWatcherFrame::OnButtonStartStopClick(wxCommandEvent& WXUNUSED(event))
         }
         IBPP::Database db(database->getIBPPDatabase());
         eventsM = IBPP::EventsFactory(db);
+        // a thread keeps up with the notifications, the timer only picks up
+        // what it summed up, so frequent events don't flood the GUI
+        eventsM->StartDelivery(windowMillisM);
+        countsM.clear();
         defineMonitoredEvents();
     }
     updateMonitoringActive();
@@ -437,7 +476,12 @@ void EventWatcherFrame::OnListBoxSelected(wxCommandEvent& WXUNUSED(event))
 void EventWatcherFrame::OnTimer(wxTimerEvent& WXUNUSED(event))
 {
     if (eventsM != 0)
+    {
         eventsM->Dispatch();
+        // zero the rates if nothing came in for a while
+        if (receivedM || windowM.Time() >= 2 * windowMillisM)
+            updateRates();
+    }
     else // stop timer, update UI
         updateMonitoringActive();
 }
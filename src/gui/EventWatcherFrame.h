@@ -28,8 +28,10 @@
 #include <wx/wx.h>
 #include <wx/button.h>
 #include <wx/listbox.h>
+#include <wx/listctrl.h>
 #include <wx/panel.h>
 
+#include <map>
 #include <string>
 
 #include <ibpp.h>
@@ -50,10 +52,23 @@ private:
     wxTimer timerM;
     IBPP::Events eventsM;
 
+    // counts received per event, the rates are computed from them
+    struct EventCounts
+    {
+        int total;
+        int window;     // since the rates were last updated
+        EventCounts() : total(0), window(0) {}
+    };
+    std::map<wxString, EventCounts> countsM;
+    wxStopWatch windowM;
+    long windowMillisM;
+    bool receivedM;     // Dispatch() handed out counts since the last update
+
     wxPanel* panel_controls;
     wxStaticText* static_text_monitored;
     wxStaticText* static_text_received;
     wxListBox* listbox_monitored;
+    wxListCtrl* listctrl_rates;
     EventLogControl* eventlog_received;
     wxButton *button_add;
     wxButton *button_remove;
@@ -71,6 +86,7 @@ private:
     DatabasePtr getDatabase() const;
     bool setTimerActive(bool active);
     void updateMonitoringActive();
+    void updateRates();
 
     virtual void ibppEventHandler(IBPP::Events events,
         const std::string& name, int count);
@@ -92,6 +108,7 @@ private:
     enum
     {
         ID_listbox_monitored = 101,
+        ID_listctrl_rates,
         ID_log_received,
         ID_button_add,
         ID_button_remove,
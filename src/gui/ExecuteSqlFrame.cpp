@@ -33,6 +33,7 @@
 #include <wx/artprov.h>
 #include <wx/dnd.h>
 #include <wx/file.h>
+#include <wx/filename.h>
 #include <wx/fontdlg.h>
 #include <wx/stopwatch.h>
 #include <wx/tokenzr.h>
@@ -517,7 +518,8 @@ ExecuteSqlFrame::ExecuteSqlFrame(wxWindow* WXUNUSED(parent), int id,
         wxString title,
         DatabasePtr db, const wxPoint& pos, const wxSize& size, long style)
     : BaseFrame(wxTheApp->GetTopWindow(), id, title, pos, size, style),
-        Observer(), databaseM(db.get())
+        Observer(), databaseM(db.get()),
+        attachmentM(db.get(), true), statementWorkerM(this, attachmentM.get())
 {
     wxASSERT(db);
 
@@ -796,7 +798,9 @@ void ExecuteSqlFrame::set_properties()
     statusbar_1->SetStatusText("Cursor position", 2);
     statusbar_1->SetStatusText("Transaction status", 3);
 
-    grid_data->SetTable(new DataGridTable(statementM, databaseM), true);
+    DataGridTable* table = new DataGridTable(statementM, databaseM);
+    table->setStatementWorker(&statementWorkerM);
+    grid_data->SetTable(table, true);
     splitter_window_1->Initialize(styled_text_ctrl_sql);
     viewModeM = vmEditor;
 
@@ -828,6 +832,14 @@ void ExecuteSqlFrame::do_layout()
 
 bool ExecuteSqlFrame::doCanClose()
 {
+    // the running request is cancelled, the frame can be closed once it
+    // has ended
+    if (statementWorkerM.isRunning())
+    {
+        statementWorkerM.cancel();
+        return false;
+    }
+
     bool saveFile = false;
     if (filenameM.IsOk() && styled_text_ctrl_sql->GetModify())
     {
@@ -1454,7 +1466,8 @@ void ExecuteSqlFrame::OnMenuReplace(wxCommandEvent &WXUNUSED(event))
 
 void ExecuteSqlFrame::OnMenuUpdateWhenInTransaction(wxUpdateUIEvent& event)
 {
-    event.Enable(inTransactionM && !grid_data->IsCellEditControlEnabled());
+    event.Enable(inTransactionM && !grid_data->IsCellEditControlEnabled()
+        && !statementWorkerM.isRunning());
 }
 
 void ExecuteSqlFrame::OnMenuSelectView(wxCommandEvent& event)
@@ -1600,7 +1613,8 @@ void ExecuteSqlFrame::OnMenuUpdateGridCellIsBlob(wxUpdateUIEvent& event)
 {
     DataGridTable* dgt = grid_data->getDataGridTable();
     event.Enable(dgt && grid_data->GetNumberRows() &&
-        dgt->isBlobColumn(grid_data->GetGridCursorCol()));
+        dgt->isBlobColumn(grid_data->GetGridCursorCol())
+        && !statementWorkerM.isRunning());
 }
 
 void ExecuteSqlFrame::closeBlobEditor(bool saveBlobValue)
@@ -1764,14 +1778,17 @@ void ExecuteSqlFrame::OnMenuGridDeleteRow(wxCommandEvent& WXUNUSED(event))
     }
 
     // Since we are not really removing the rows (only changing the color)
-    // we can go from first to last. If we decide to revert to old code
-    // we should go from last to first.
-    for (size_t i = 0; i < rows.GetCount(); i++)
+    // they are deleted with a single batch of statements, the rows that
+    // could not be deleted stay selected
+    DataGridTable* dgt = grid_data->getDataGridTable();
+    std::vector<unsigned> toDelete(rows.begin(), rows.end());
+    if (dgt->deleteRows(toDelete))
     {
-        if (grid_data->DeleteRows(rows[i], 1))
-            grid_data->DeselectRow(rows[i]);
-        else
-            break;
+        for (size_t i = 0; i < rows.GetCount(); i++)
+        {
+            if (dgt->isRowDeleted(rows[i]))
+                grid_data->DeselectRow(rows[i]);
+        }
     }
 
     // grid_data->EndBatch();   // see comment for BeginBatch above
@@ -1835,25 +1852,31 @@ void ExecuteSqlFrame::OnMenuGridSetFieldToNULL(wxCommandEvent& WXUNUSED(event))
             AdvancedMessageDialogButtonsOk());
     }
 
-    // set fields to NULL
+    // set fields to NULL, with a batch of statements per column
+    std::map<int, std::vector<unsigned> > rowsByCol;
     for (int i = 0; i < count; i++)
     {
-        int row = cells[i].GetRow();
         int col = cells[i].GetCol();
 
         // do not set to null if field is not nullable or readonly
-        if (colsReadonly.find(col) != colsReadonly.end())
-            continue;
-
-        dgt->setValueToNull(row, col);
+        if (colsReadonly.find(col) == colsReadonly.end())
+            rowsByCol[col].push_back(cells[i].GetRow());
+    }
+    for (std::map<int, std::vector<unsigned> >::iterator it =
+        rowsByCol.begin(); it != rowsByCol.end(); ++it)
+    {
+        dgt->setValuesToNull((*it).first, (*it).second);
+    }
 
-        // if visible, update BLOB editor
-        if (editBlobDlgM && editBlobDlgM->IsShown()
-            && grid_data->GetGridCursorCol() == col
-            && grid_data->GetGridCursorRow() == row)
-        {
-            editBlobDlgM->setBlob(grid_data, dgt, &statementM, row, col, false);
-        }
+    // if visible, update BLOB editor
+    int row = grid_data->GetGridCursorRow();
+    int col = grid_data->GetGridCursorCol();
+    if (editBlobDlgM && editBlobDlgM->IsShown()
+        && rowsByCol.find(col) != rowsByCol.end()
+        && std::find(rowsByCol[col].begin(), rowsByCol[col].end(),
+            (unsigned)row) != rowsByCol[col].end())
+    {
+        editBlobDlgM->setBlob(grid_data, dgt, &statementM, row, col, false);
     }
 
     // fields that change from NOT NULL to NULL need to update the text color
@@ -1928,7 +1951,7 @@ void ExecuteSqlFrame::OnMenuUpdateGridFetchAll(wxUpdateUIEvent& event)
 {
     DataGridTable* table = grid_data->getDataGridTable();
     event.Enable(table && table->canFetchMoreRows()
-        && !table->getFetchAllRows());
+        && !table->getFetchAllRows() && !statementWorkerM.isRunning());
 }
 
 void ExecuteSqlFrame::OnMenuUpdateGridCancelFetchAll(wxUpdateUIEvent& event)
@@ -1940,6 +1963,11 @@ void ExecuteSqlFrame::OnMenuUpdateGridCancelFetchAll(wxUpdateUIEvent& event)
 
 void ExecuteSqlFrame::OnMenuUpdateGridCanSetFieldToNULL(wxUpdateUIEvent& event)
 {
+    if (statementWorkerM.isRunning())
+    {
+        event.Enable(false);
+        return;
+    }
     if (DataGridTable* dgt = grid_data->getDataGridTable())
     {
         std::vector<bool> selCols(grid_data->getColumnsWithSelectedCells());
@@ -2087,6 +2115,10 @@ void ExecuteSqlFrame::executeAllStatements(bool closeWhenDone)
 bool ExecuteSqlFrame::parseStatements(const wxString& statements,
     bool closeWhenDone, bool prepareOnly, int selectionOffset)
 {
+    // the command may come through an accelerator of a disabled menu item
+    if (statementWorkerM.isRunning())
+        return false;
+
     wxBusyCursor cr;
     MultiStatement ms(statements);
     while (true)
@@ -2155,7 +2187,7 @@ bool ExecuteSqlFrame::parseStatements(const wxString& statements,
 
 void ExecuteSqlFrame::OnMenuUpdateWhenExecutePossible(wxUpdateUIEvent& event)
 {
-    event.Enable(!closeWhenTransactionDoneM);
+    event.Enable(!closeWhenTransactionDoneM && !statementWorkerM.isRunning());
 }
 
 wxString IBPPtype2string(Database *db, IBPP::SDT t, int subtype, int size,
@@ -2185,35 +2217,28 @@ wxString IBPPtype2string(Database *db, IBPP::SDT t, int subtype, int size,
     }
 }
 
-void ExecuteSqlFrame::compareCounts(IBPP::DatabaseCounts& one,
-    IBPP::DatabaseCounts& two)
+void ExecuteSqlFrame::compareCounts(const IBPP::DatabaseCounts& delta)
 {
-    for (IBPP::DatabaseCounts::iterator it = two.begin(); it != two.end();
-        ++it)
+    for (IBPP::DatabaseCounts::const_iterator it = delta.begin();
+        it != delta.end(); ++it)
     {
         wxString s;
-        IBPP::DatabaseCounts::iterator i2 = one.find((*it).first);
-        IBPP::CountInfo c;
-        IBPP::CountInfo& r1 = (*it).second;
-        IBPP::CountInfo& r2 = c;
-        if (i2 != one.end())
-            r2 = (*i2).second;
-        if (r1.inserts > r2.inserts)
-            s += wxString::Format(_("%d inserts. "), r1.inserts - r2.inserts);
-        if (r1.updates > r2.updates)
-            s += wxString::Format(_("%d updates. "), r1.updates - r2.updates);
-        if (r1.deletes > r2.deletes)
-            s += wxString::Format(_("%d deletes. "), r1.deletes - r2.deletes);
+        const IBPP::CountInfo& r = (*it).second;
+        if (r.inserts > 0)
+            s += wxString::Format(_("%d inserts. "), r.inserts);
+        if (r.updates > 0)
+            s += wxString::Format(_("%d updates. "), r.updates);
+        if (r.deletes > 0)
+            s += wxString::Format(_("%d deletes. "), r.deletes);
         if (!s.IsEmpty())
         {
             wxString relName;
             try
             {
-                IBPP::Statement st = IBPP::StatementFactory(
-                    databaseM->getIBPPDatabase(), transactionM);
-                st->Prepare(
-                    "select rdb$relation_name "
-                    "from rdb$relations where rdb$relation_id = ?");
+                IBPP::Statement st = attachmentM.get()->
+                    CachedStatement(transactionM,
+                        "select rdb$relation_name "
+                        "from rdb$relations where rdb$relation_id = ?");
                 st->Set(1, (*it).first);
                 st->Execute();
                 if (st->Fetch())
@@ -2227,7 +2252,7 @@ void ExecuteSqlFrame::compareCounts(IBPP::DatabaseCounts& one,
             {
             }
             if (relName.IsEmpty())
-                relName.Format(_("Relation #%d"), (*it).first);
+                relName = wxString::Format(_("Relation #%d"), (*it).first);
             log(relName + ": " + s, ttSql);
         }
     }
@@ -2302,10 +2327,20 @@ bool ExecuteSqlFrame::execute(wxString sql, const wxString& terminator,
                 }
             }
 
+            if (!attachmentM.isAssigned())
+            {
+                // connecting a new attachment can take a while, so it is
+                // done with the first statement instead of on opening
+                IBPP::Database attachment;
+                statementWorkerM.run(_("Connecting to database"),
+                    [this, &attachment]()
+                    { attachment = attachmentM.checkout(); });
+                attachmentM.assign(attachment);
+            }
             if (transactionM == 0)
             {
                 transactionM = IBPP::TransactionFactory(
-                    databaseM->getIBPPDatabase(), transactionAccessModeM,
+                    attachmentM.get(), transactionAccessModeM,
                     transactionIsolationLevelM, transactionLockResolutionM);
             }
             transactionM->Start();
@@ -2314,28 +2349,36 @@ bool ExecuteSqlFrame::execute(wxString sql, const wxString& terminator,
             grid_data->EnableEditing(transactionAccessModeM == IBPP::amWrite);
         }
 
-        int fetch1 = 0, mark1 = 0, read1 = 0, write1 = 0, ins1 = 0, upd1 = 0,
-            del1 = 0, ridx1 = 0, rseq1 = 0, mem1 = 0;
-        int fetch2, mark2, read2, write2, ins2, upd2, del2, ridx2, rseq2, mem2;
-        IBPP::DatabaseCounts counts1, counts2;
+        // one round trip before and one after the statement
+        IBPP::DatabaseSnapshot stats1;
         bool doShowStats = config().get("SQLEditorShowStats", true);
         if (!prepareOnly && doShowStats)
-        {
-            databaseM->getIBPPDatabase()->
-                Statistics(&fetch1, &mark1, &read1, &write1, &mem1);
-            databaseM->getIBPPDatabase()->
-                Counts(&ins1, &upd1, &del1, &ridx1, &rseq1);
-            databaseM->getIBPPDatabase()->DetailedCounts(counts1);
-        }
+            stats1 = attachmentM.get()->Snapshot();
         grid_data->ClearGrid(); // statement object will be invalidated, so clear the grid
-        statementM = IBPP::StatementFactory(databaseM->getIBPPDatabase(), transactionM);
         log(_("Preparing statement: " + sql), ttSql);
         sae.scroll();
         {
             wxStopWatch sw;
-            statementM->Prepare(wx2std(sql, databaseM->getCharsetConverter()));
-            log(wxString::Format(_("Statement prepared (elapsed time: %s)."),
-                millisToTimeString(sw.Time()).c_str()));
+            std::string stdSql(wx2std(sql, databaseM->getCharsetConverter()));
+            // statements rerun in the same transaction are prepared only once
+            IBPP::Database& db = attachmentM.get();
+            int hits1, hits2;
+            db->StatementCacheStats(&hits1, 0);
+            statementWorkerM.run(_("Preparing statement"),
+                [this, &db, &stdSql]()
+                { statementM = db->CachedStatement(transactionM, stdSql); });
+            db->StatementCacheStats(&hits2, 0);
+            if (hits2 != hits1)
+            {
+                log(wxString::Format(
+                    _("Statement reused from the cache (elapsed time: %s)."),
+                    millisToTimeString(sw.Time()).c_str()));
+            }
+            else
+            {
+                log(wxString::Format(_("Statement prepared (elapsed time: %s)."),
+                    millisToTimeString(sw.Time()).c_str()));
+            }
         }
 
         // we don't check IBPP::Select since Firebird 2.0 has a new feature
@@ -2394,7 +2437,8 @@ bool ExecuteSqlFrame::execute(wxString sql, const wxString& terminator,
         sae.scroll();
         {
             wxStopWatch sw;
-            statementM->Execute();
+            statementWorkerM.run(_("Executing statement"),
+                [this]() { statementM->Execute(); });
             log(wxString::Format(_("Statement executed (elapsed time: %s)."),
                 millisToTimeString(sw.Time()).c_str()));
         }
@@ -2407,19 +2451,18 @@ bool ExecuteSqlFrame::execute(wxString sql, const wxString& terminator,
 
         if (doShowStats)
         {
-            databaseM->getIBPPDatabase()->Statistics(
-                &fetch2, &mark2, &read2, &write2, &mem2);
-            databaseM->getIBPPDatabase()->
-                Counts(&ins2, &upd2, &del2, &ridx2, &rseq2);
+            IBPP::DatabaseSnapshot delta =
+                attachmentM.get()->Snapshot().Diff(stats1);
             log(wxString::Format(
                 _("%d fetches, %d marks, %d reads, %d writes."),
-                fetch2-fetch1, mark2-mark1, read2-read1, write2-write1));
+                delta.fetches, delta.marks, delta.reads, delta.writes));
             log(wxString::Format(
                 _("%d inserts, %d updates, %d deletes, %d index, %d seq."),
-                ins2-ins1, upd2-upd1, del2-del1, ridx2-ridx1, rseq2-rseq1));
-            log(wxString::Format(_("Delta memory: %d bytes."), mem2-mem1));
-            databaseM->getIBPPDatabase()->DetailedCounts(counts2);
-            compareCounts(counts1, counts2);
+                delta.inserts, delta.updates, delta.deletes, delta.readIdx,
+                delta.readSeq));
+            log(wxString::Format(_("Delta memory: %d bytes."),
+                delta.currentMemory));
+            compareCounts(delta.counts);
         }
 
         if (type != IBPP::stSelect) // for other statements: show rows affected
@@ -2512,7 +2555,8 @@ void ExecuteSqlFrame::OnMenuTransactionIsolationLevel(wxCommandEvent& event)
 void ExecuteSqlFrame::OnMenuUpdateTransactionIsolationLevel(
     wxUpdateUIEvent& event)
 {
-    event.Enable(transactionM == 0 || !transactionM->Started());
+    event.Enable(!statementWorkerM.isRunning()
+        && (transactionM == 0 || !transactionM->Started()));
     if (event.GetId() == Cmds::Query_TransactionConcurrency)
         event.Check(transactionIsolationLevelM == IBPP::ilConcurrency);
     else if (event.GetId() == Cmds::Query_TransactionConsistency)
@@ -2536,7 +2580,8 @@ void ExecuteSqlFrame::OnMenuTransactionLockResolution(wxCommandEvent& event)
 void ExecuteSqlFrame::OnMenuUpdateTransactionLockResolution(
     wxUpdateUIEvent& event)
 {
-    event.Enable(transactionM == 0 || !transactionM->Started());
+    event.Enable(!statementWorkerM.isRunning()
+        && (transactionM == 0 || !transactionM->Started()));
     event.Check(transactionLockResolutionM == IBPP::lrWait);
 }
 
@@ -2551,7 +2596,8 @@ void ExecuteSqlFrame::OnMenuTransactionReadOnly(wxCommandEvent& event)
 
 void ExecuteSqlFrame::OnMenuUpdateTransactionReadOnly(wxUpdateUIEvent& event)
 {
-    event.Enable(transactionM == 0 || !transactionM->Started());
+    event.Enable(!statementWorkerM.isRunning()
+        && (transactionM == 0 || !transactionM->Started()));
     event.Check(transactionAccessModeM == IBPP::amRead);
 }
 
@@ -2568,6 +2614,8 @@ void ExecuteSqlFrame::OnMenuCommit(wxCommandEvent& WXUNUSED(event))
 
 bool ExecuteSqlFrame::commitTransaction()
 {
+    if (statementWorkerM.isRunning())
+        return false;
     if (transactionM == 0 || !transactionM->Started())    // check
     {
         inTransaction(false);
@@ -2575,6 +2623,8 @@ bool ExecuteSqlFrame::commitTransaction()
     }
 
     closeBlobEditor(true);
+    // the fetch thread must not read from the ending transaction
+    grid_data->cancelFetchAll();
 
     wxBusyCursor cr;
     ScrollAtEnd sae(styled_text_ctrl_stats);
@@ -2585,8 +2635,20 @@ bool ExecuteSqlFrame::commitTransaction()
         sae.scroll();
         {
             wxStopWatch sw;
-            statementM->Close();
-            transactionM->Commit();
+            // keep the statement prepared for the next transaction, unless
+            // it may depend on metadata changed by this one
+            bool hasDDL = false;
+            for (std::vector<SqlStatement>::const_iterator it =
+                executedStatementsM.begin(); it != executedStatementsM.end();
+                ++it)
+            {
+                if (it->isDDL())
+                    hasDDL = true;
+            }
+            if (hasDDL && statementM != 0)
+                statementM->Close();
+            statementWorkerM.run(_("Committing transaction"),
+                [this]() { transactionM->Commit(); });
             log(wxString::Format(_("Transaction committed (elapsed time: %s)."),
                 millisToTimeString(sw.Time()).c_str()));
         }
@@ -2663,6 +2725,8 @@ void ExecuteSqlFrame::OnMenuRollback(wxCommandEvent& WXUNUSED(event))
 
 bool ExecuteSqlFrame::rollbackTransaction()
 {
+    if (statementWorkerM.isRunning())
+        return false;
     if (transactionM == 0 || !transactionM->Started())    // check
     {
         executedStatementsM.clear();
@@ -2671,6 +2735,8 @@ bool ExecuteSqlFrame::rollbackTransaction()
     }
 
     closeBlobEditor(false);
+    // the fetch thread must not read from the ending transaction
+    grid_data->cancelFetchAll();
 
     ScrollAtEnd sae(styled_text_ctrl_stats);
 
@@ -2680,8 +2746,8 @@ bool ExecuteSqlFrame::rollbackTransaction()
         sae.scroll();
         {
             wxStopWatch sw;
-            statementM->Close();
-            transactionM->Rollback();
+            statementWorkerM.run(_("Rolling back transaction"),
+                [this]() { transactionM->Rollback(); });
             log(wxString::Format(_("Transaction rolled back (elapsed time: %s)."),
                 millisToTimeString(sw.Time()).c_str()));
         }
@@ -2718,7 +2784,8 @@ bool ExecuteSqlFrame::rollbackTransaction()
 void ExecuteSqlFrame::OnMenuUpdateGridInsertRow(wxUpdateUIEvent& event)
 {
     DataGridTable* tb = grid_data->getDataGridTable();
-    event.Enable(inTransactionM && tb && tb->canInsertRows());
+    event.Enable(inTransactionM && tb && tb->canInsertRows()
+        && !statementWorkerM.isRunning());
 }
 
 void ExecuteSqlFrame::OnMenuUpdateGridHasData(wxUpdateUIEvent& event)
@@ -2730,7 +2797,7 @@ void ExecuteSqlFrame::OnMenuUpdateGridHasData(wxUpdateUIEvent& event)
 void ExecuteSqlFrame::OnMenuUpdateGridDeleteRow(wxUpdateUIEvent& event)
 {
     DataGridTable *tb = grid_data->getDataGridTable();
-    if (!tb || !grid_data->GetNumberRows())
+    if (!tb || !grid_data->GetNumberRows() || statementWorkerM.isRunning())
     {
         event.Enable(false);
         return;
@@ -2775,6 +2842,13 @@ void ExecuteSqlFrame::OnGridRowCountChanged(wxCommandEvent& event)
     wxString s;
     long rowsFetched = event.GetExtraLong();
     s.Printf(_("%ld row(s) fetched"), rowsFetched);
+    DataGridTable* dgt = grid_data->getDataGridTable();
+    if (dgt && dgt->getSpilledSize())
+    {
+        s += wxString::Format(_(" (%s in memory, %s on disk)"),
+            wxFileName::GetHumanReadableSize(dgt->getResidentSize()),
+            wxFileName::GetHumanReadableSize(dgt->getSpilledSize()));
+    }
     statusbar_1->SetStatusText(s, 1);
 
     // TODO: we could make some bool flag, so that this happens only once per execute()
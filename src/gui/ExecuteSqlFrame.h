@@ -37,9 +37,11 @@
 #include "core/Observer.h"
 #include "core/StringUtils.h"
 #include "controls/DataGridTable.h"
+#include "engine/AttachmentPool.h"
 #include "gui/BaseFrame.h"
 #include "gui/EditBlobDialog.h"
 #include "gui/FindDialog.h"
+#include "gui/StatementWorker.h"
 #include "sql/SqlStatement.h"
 #include "statementHistory.h"
 
@@ -96,7 +98,7 @@ private:
     wxFileName filenameM;
     wxDateTime filenameModificationTimeM;
 
-    void compareCounts(IBPP::DatabaseCounts& one, IBPP::DatabaseCounts& two);
+    void compareCounts(const IBPP::DatabaseCounts& delta);
 
     void showProperties(wxString objectName);
 
@@ -112,8 +114,13 @@ private:
 
     bool autoCommitM;
     bool inTransactionM;
+    // a secondary attachment if available, so that long-running statements
+    // don't block the metadata browsing; checked out on the worker thread
+    // by the first statement
+    PooledAttachment attachmentM;
     IBPP::Transaction transactionM;
     IBPP::Statement statementM;
+    StatementWorker statementWorkerM;
     IBPP::TIL transactionIsolationLevelM;
     IBPP::TLR transactionLockResolutionM;
     IBPP::TAM transactionAccessModeM;
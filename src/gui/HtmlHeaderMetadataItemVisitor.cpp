@@ -48,6 +48,7 @@ void HtmlHeaderMetadataItemVisitor::visitDatabase(Database& database)
     // database triggers have been introduced in Firebird 2.1 (ODS 11.1)
     if (database.getInfo().getODSVersionIsHigherOrEqualTo(11, 1))
         addTriggers();
+    addStatistics();
     addDDL();
 }
 
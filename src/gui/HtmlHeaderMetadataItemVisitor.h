@@ -56,6 +56,7 @@ private:
     void addIndices()      { titlesM.push_back("Indices"); }
     void addDependencies() { titlesM.push_back("Dependencies"); }
     void addDDL()          { titlesM.push_back("DDL"); }
+    void addStatistics()   { titlesM.push_back("Statistics"); }
 };
 
 #endif // FR_HTMLHEADERMETADATAITEMVISITOR_H
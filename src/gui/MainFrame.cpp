@@ -56,6 +56,7 @@
 #include "gui/ExecuteSqlFrame.h"
 #include "gui/MainFrame.h"
 #include "gui/MetadataItemPropertiesFrame.h"
+#include "gui/NBackupFrame.h"
 #include "gui/PreferencesDialog.h"
 #include "gui/ProgressDialog.h"
 #include "gui/RestoreFrame.h"
@@ -390,6 +391,8 @@ BEGIN_EVENT_TABLE(MainFrame, wxFrame)
     EVT_UPDATE_UI(Cmds::Menu_Backup, MainFrame::OnMenuUpdateIfDatabaseSelected)
     EVT_MENU(Cmds::Menu_Restore, MainFrame::OnMenuRestore)
     EVT_UPDATE_UI(Cmds::Menu_Restore, MainFrame::OnMenuUpdateIfDatabaseNotConnected)
+    EVT_MENU(Cmds::Menu_IncrementalBackup, MainFrame::OnMenuIncrementalBackup)
+    EVT_UPDATE_UI(Cmds::Menu_IncrementalBackup, MainFrame::OnMenuUpdateIfDatabaseSelected)
     EVT_MENU(Cmds::Menu_Connect, MainFrame::OnMenuConnect)
     EVT_UPDATE_UI(Cmds::Menu_Connect, MainFrame::OnMenuUpdateIfDatabaseNotConnected)
     EVT_MENU(Cmds::Menu_ConnectAs, MainFrame::OnMenuConnectAs)
@@ -1084,6 +1087,22 @@ void MainFrame::OnMenuRestore(wxCommandEvent& WXUNUSED(event))
     rf->Show();
 }
 
+void MainFrame::OnMenuIncrementalBackup(wxCommandEvent& WXUNUSED(event))
+{
+    DatabasePtr db = getDatabase(treeMainM->getSelectedMetadataItem());
+    if (!checkValidDatabase(db))
+        return;
+
+    NBackupFrame* nf = NBackupFrame::findFrameFor(db);
+    if (nf)
+    {
+        nf->Raise();
+        return;
+    }
+    nf = new NBackupFrame(this, db);
+    nf->Show();
+}
+
 void MainFrame::OnMenuReconnect(wxCommandEvent& WXUNUSED(event))
 {
     DatabasePtr db = getDatabase(treeMainM->getSelectedMetadataItem());
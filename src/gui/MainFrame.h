@@ -76,6 +76,7 @@ public:
     void OnMenuInsert(wxCommandEvent& event);
     void OnMenuBrowseData(wxCommandEvent& event);
     void OnMenuRestore(wxCommandEvent& event);
+    void OnMenuIncrementalBackup(wxCommandEvent& event);
     void OnMenuShowAllGeneratorValues(wxCommandEvent& event);
     void OnMenuShowGeneratorValue(wxCommandEvent& event);
     void OnMenuSetGeneratorValue(wxCommandEvent& event);
@@ -60,7 +60,7 @@ class MetadataItemPropertiesPanel: public wxPanel, public Observer
 {
 private:
     enum { ptSummary, ptConstraints, ptDependencies, ptTriggers,
-        ptTableIndices, ptDDL, ptPrivileges } pageTypeM;
+        ptTableIndices, ptDDL, ptPrivileges, ptStatistics } pageTypeM;
 
     MetadataItem* objectM;
     bool htmlReloadRequestedM;
@@ -188,6 +188,9 @@ void MetadataItemPropertiesPanel::loadPage()
         case ptDDL:
             fileName += "DDL.html";
             break;
+        case ptStatistics:
+            fileName += objectM->getTypeName() + "statistics.html";
+            break;
     }
 
     wxBusyCursor bc;
@@ -259,6 +262,8 @@ void MetadataItemPropertiesPanel::setPage(const wxString& type)
         pageTypeM = ptDDL;
     else if (type == "privileges")
         pageTypeM = ptPrivileges;
+    else if (type == "statistics")
+        pageTypeM = ptStatistics;
     // add more page types here when needed
     else
         pageTypeM = ptSummary;
@@ -0,0 +1,685 @@
+/*
+  Copyright (c) 2004-2016 The FlameRobin Development Team
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWindows headers
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <wx/datetime.h>
+#include <wx/filename.h>
+
+#include <algorithm>
+
+#include <ibpp.h>
+
+#include "core/StringUtils.h"
+#include "config/Config.h"
+#include "gui/AdvancedMessageDialog.h"
+#include "gui/NBackupFrame.h"
+#include "gui/controls/DndTextControls.h"
+#include "gui/controls/LogTextControl.h"
+#include "gui/StyleGuide.h"
+#include "gui/UsernamePasswordDialog.h"
+#include "metadata/database.h"
+#include "metadata/server.h"
+
+// worker thread class to perform incremental backups and restores
+class NBackupThread: public wxThread {
+public:
+    // backup of the given level, or relative to guid if it isn't empty
+    NBackupThread(NBackupFrame* frame, wxString server, wxString username,
+        wxString password, wxString dbfilename, wxString bkfilename,
+        int level, wxString guid, IBPP::NBF flags);
+    // restore of the chain of backup files to dbfilename
+    NBackupThread(NBackupFrame* frame, wxString server, wxString username,
+        wxString password, wxArrayString bkfilenames, wxString dbfilename,
+        IBPP::NBF flags);
+
+    virtual void* Entry();
+    virtual void OnExit();
+private:
+    NBackupFrame* frameM;
+    bool restoreM;
+    wxString serverM;
+    wxString usernameM;
+    wxString passwordM;
+    wxString dbfileM;
+    wxArrayString bkfilesM;
+    int levelM;
+    wxString guidM;
+    IBPP::NBF nbfM;
+    void logError(wxString& msg);
+    void logImportant(wxString& msg);
+};
+
+NBackupThread::NBackupThread(NBackupFrame* frame, wxString server,
+        wxString username, wxString password, wxString dbfilename,
+        wxString bkfilename, int level, wxString guid, IBPP::NBF flags)
+    : wxThread()
+{
+    frameM = frame;
+    restoreM = false;
+    serverM = server;
+    usernameM = username;
+    passwordM = password;
+    dbfileM = dbfilename;
+    bkfilesM.Add(bkfilename);
+    levelM = level;
+    guidM = guid;
+    nbfM = flags;
+}
+
+NBackupThread::NBackupThread(NBackupFrame* frame, wxString server,
+        wxString username, wxString password, wxArrayString bkfilenames,
+        wxString dbfilename, IBPP::NBF flags)
+    : wxThread()
+{
+    frameM = frame;
+    restoreM = true;
+    serverM = server;
+    usernameM = username;
+    passwordM = password;
+    dbfileM = dbfilename;
+    bkfilesM = bkfilenames;
+    levelM = 0;
+    nbfM = flags;
+}
+
+void* NBackupThread::Entry()
+{
+    wxDateTime now;
+    wxString msg;
+    wxString what(restoreM ? _("Incremental restore")
+        : _("Incremental backup"));
+
+    try
+    {
+        msg.Printf(_("Connecting to server %s..."), serverM.c_str());
+        logImportant(msg);
+        IBPP::Service svc = IBPP::ServiceFactory(wx2std(serverM),
+            wx2std(usernameM), wx2std(passwordM));
+        svc->Connect();
+
+        now = wxDateTime::Now();
+        msg.Printf(_("%s started %s"), what.c_str(),
+            now.FormatTime().c_str());
+        logImportant(msg);
+        if (restoreM)
+        {
+            std::vector<std::string> bkfiles;
+            for (size_t i = 0; i < bkfilesM.size(); ++i)
+                bkfiles.push_back(wx2std(bkfilesM[i]));
+            svc->StartNRestore(bkfiles, wx2std(dbfileM), nbfM);
+        }
+        else if (!guidM.empty())
+        {
+            svc->StartNBackup(wx2std(dbfileM), wx2std(bkfilesM[0]),
+                wx2std(guidM), nbfM);
+        }
+        else
+        {
+            svc->StartNBackup(wx2std(dbfileM), wx2std(bkfilesM[0]),
+                levelM, nbfM);
+        }
+        std::string output;
+        while (true)
+        {
+            if (TestDestroy())
+            {
+                now = wxDateTime::Now();
+                msg.Printf(_("%s canceled %s"), what.c_str(),
+                    now.FormatTime().c_str());
+                logImportant(msg);
+                break;
+            }
+            // the service reports errors only, but waiting for the end of
+            // its output is the way to know when the server is done
+            bool running = svc->WaitOutput(output);
+            if (!output.empty() && frameM != 0)
+                frameM->threadOutputLines(output);
+            if (!running)
+            {
+                now = wxDateTime::Now();
+                msg.Printf(_("%s finished %s"), what.c_str(),
+                    now.FormatTime().c_str());
+                logImportant(msg);
+                break;
+            }
+        }
+        svc->Disconnect();
+    }
+    catch (IBPP::Exception& e)
+    {
+        now = wxDateTime::Now();
+        msg.Printf(_("%s canceled %s due to IBPP exception:\n\n"),
+            what.c_str(), now.FormatTime().c_str());
+        msg += e.what();
+        logError(msg);
+    }
+    catch (...)
+    {
+        now = wxDateTime::Now();
+        msg.Printf(_("%s canceled %s due to exception"), what.c_str(),
+            now.FormatTime().c_str());
+        logError(msg);
+    }
+    return 0;
+}
+
+void NBackupThread::OnExit()
+{
+    if (frameM != 0)
+    {
+        wxCommandEvent event(wxEVT_COMMAND_MENU_SELECTED,
+            BackupRestoreBaseFrame::ID_thread_finished);
+        wxPostEvent(frameM, event);
+    }
+}
+
+void NBackupThread::logError(wxString& msg)
+{
+    if (frameM != 0)
+        frameM->threadOutputMsg(msg, BackupRestoreBaseFrame::error_message);
+}
+
+void NBackupThread::logImportant(wxString& msg)
+{
+    if (frameM != 0)
+        frameM->threadOutputMsg(msg, BackupRestoreBaseFrame::important_message);
+}
+
+NBackupFrame::NBackupFrame(wxWindow* parent, DatabasePtr db)
+    : BackupRestoreBaseFrame(parent, db)
+{
+    setIdString(this, getFrameId(db));
+
+    wxString databaseName(db->getName_());
+    wxString serverName(db->getServer()->getName_());
+    SetTitle(wxString::Format(_("Incremental Backup \"%s:%s\""),
+        serverName.c_str(), databaseName.c_str()));
+
+    createControls();
+    layoutControls();
+    loadHistory();
+    updateControls();
+
+    text_ctrl_filename->SetFocus();
+}
+
+//! implementation details
+void NBackupFrame::createControls()
+{
+    panel_controls = new wxPanel(this, wxID_ANY, wxDefaultPosition,
+        wxDefaultSize, wxTAB_TRAVERSAL | wxCLIP_CHILDREN);
+    radio_backup = new wxRadioButton(panel_controls, ID_radio_backup,
+        _("Backup"), wxDefaultPosition, wxDefaultSize, wxRB_GROUP);
+    radio_restore = new wxRadioButton(panel_controls, ID_radio_restore,
+        _("Restore"));
+
+    label_filename = new wxStaticText(panel_controls, wxID_ANY,
+        _("Backup file:"));
+    text_ctrl_filename = new FileTextControl(panel_controls,
+        ID_text_ctrl_filename, wxEmptyString);
+    button_browse = new wxButton(panel_controls, ID_button_browse, _("..."),
+        wxDefaultPosition, wxDefaultSize, wxBU_EXACTFIT);
+
+    label_level = new wxStaticText(panel_controls, wxID_ANY,
+        _("Backup level:"));
+    spinctrl_level = new wxSpinCtrl(panel_controls, wxID_ANY,
+        wxEmptyString, wxDefaultPosition, wxDefaultSize, wxSP_ARROW_KEYS,
+        0, 9, 0);
+    spinctrl_level->SetToolTip(
+        _("Level 0 is a full copy, level N holds the pages changed since the last backup of level N-1"));
+    checkbox_guid = new wxCheckBox(panel_controls, ID_checkbox_guid,
+        _("Relative to backup:"));
+    choice_guid = new wxChoice(panel_controls, wxID_ANY);
+    checkbox_triggers = new wxCheckBox(panel_controls, wxID_ANY,
+        _("Don't run database triggers"));
+    checkbox_direct = new wxCheckBox(panel_controls, wxID_ANY,
+        _("Use direct I/O"));
+
+    label_chain = new wxStaticText(panel_controls, wxID_ANY,
+        _("Backup files to restore, level 0 first:"));
+    listbox_chain = new wxListBox(panel_controls, ID_listbox_chain,
+        wxDefaultPosition, wxDefaultSize, 0, 0, wxLB_SINGLE);
+    button_add = new wxButton(panel_controls, ID_button_add, _("&Add..."));
+    button_remove = new wxButton(panel_controls, ID_button_remove,
+        _("&Remove"));
+    button_history = new wxButton(panel_controls, ID_button_history,
+        _("From &history"));
+    button_history->SetToolTip(
+        _("Use the last chain of backups recorded in the database"));
+    label_target = new wxStaticText(panel_controls, wxID_ANY,
+        _("Restore to:"));
+    text_ctrl_target = new FileTextControl(panel_controls,
+        ID_text_ctrl_target, wxEmptyString);
+    button_browse_target = new wxButton(panel_controls,
+        ID_button_browse_target, _("..."), wxDefaultPosition, wxDefaultSize,
+        wxBU_EXACTFIT);
+    checkbox_inplace = new wxCheckBox(panel_controls, ID_checkbox_inplace,
+        _("Apply the increments to the database itself"));
+    checkbox_inplace->SetToolTip(
+        _("The database must not be in use, Firebird 4 or later is needed"));
+
+    checkbox_showlog = new wxCheckBox(panel_controls, ID_checkbox_showlog,
+        _("Show complete log"));
+    label_progress = new wxStaticText(panel_controls, wxID_ANY,
+        wxEmptyString);
+    button_start = new wxButton(panel_controls, ID_button_start,
+        _("&Start"));
+
+    text_ctrl_log = new LogTextControl(this, ID_text_ctrl_log);
+}
+
+void NBackupFrame::layoutControls()
+{
+    int wh = text_ctrl_filename->GetMinHeight();
+    button_browse->SetSize(wh, wh);
+    button_browse_target->SetSize(wh, wh);
+
+    wxBoxSizer* sizerMode = new wxBoxSizer(wxHORIZONTAL);
+    sizerMode->Add(radio_backup, 0, wxALIGN_CENTER_VERTICAL);
+    sizerMode->Add(styleguide().getUnrelatedControlMargin(wxHORIZONTAL), 0);
+    sizerMode->Add(radio_restore, 0, wxALIGN_CENTER_VERTICAL);
+
+    wxBoxSizer* sizerFilename = new wxBoxSizer(wxHORIZONTAL);
+    sizerFilename->Add(label_filename, 0, wxALIGN_CENTER_VERTICAL);
+    sizerFilename->Add(styleguide().getControlLabelMargin(), 0);
+    sizerFilename->Add(text_ctrl_filename, 1, wxALIGN_CENTER_VERTICAL);
+    sizerFilename->Add(styleguide().getBrowseButtonMargin(), 0);
+    sizerFilename->Add(button_browse, 0, wxALIGN_CENTER_VERTICAL);
+
+    wxBoxSizer* sizerLevel = new wxBoxSizer(wxHORIZONTAL);
+    sizerLevel->Add(label_level, 0, wxALIGN_CENTER_VERTICAL);
+    sizerLevel->Add(styleguide().getControlLabelMargin(), 0);
+    sizerLevel->Add(spinctrl_level, 0, wxALIGN_CENTER_VERTICAL);
+    sizerLevel->Add(styleguide().getUnrelatedControlMargin(wxHORIZONTAL), 0);
+    sizerLevel->Add(checkbox_guid, 0, wxALIGN_CENTER_VERTICAL);
+    sizerLevel->Add(styleguide().getControlLabelMargin(), 0);
+    sizerLevel->Add(choice_guid, 1, wxALIGN_CENTER_VERTICAL);
+
+    wxBoxSizer* sizerChecks = new wxBoxSizer(wxHORIZONTAL);
+    sizerChecks->Add(checkbox_triggers, 0, wxALIGN_CENTER_VERTICAL);
+    sizerChecks->Add(styleguide().getUnrelatedControlMargin(wxHORIZONTAL), 0);
+    sizerChecks->Add(checkbox_direct, 0, wxALIGN_CENTER_VERTICAL);
+
+    wxBoxSizer* sizerChainButtons = new wxBoxSizer(wxVERTICAL);
+    sizerChainButtons->Add(button_add, 0, wxEXPAND);
+    sizerChainButtons->Add(0, styleguide().getRelatedControlMargin(wxVERTICAL));
+    sizerChainButtons->Add(button_remove, 0, wxEXPAND);
+    sizerChainButtons->Add(0, styleguide().getRelatedControlMargin(wxVERTICAL));
+    sizerChainButtons->Add(button_history, 0, wxEXPAND);
+
+    wxBoxSizer* sizerChain = new wxBoxSizer(wxHORIZONTAL);
+    sizerChain->Add(listbox_chain, 1, wxEXPAND);
+    sizerChain->Add(styleguide().getBrowseButtonMargin(), 0);
+    sizerChain->Add(sizerChainButtons, 0);
+
+    wxBoxSizer* sizerTarget = new wxBoxSizer(wxHORIZONTAL);
+    sizerTarget->Add(label_target, 0, wxALIGN_CENTER_VERTICAL);
+    sizerTarget->Add(styleguide().getControlLabelMargin(), 0);
+    sizerTarget->Add(text_ctrl_target, 1, wxALIGN_CENTER_VERTICAL);
+    sizerTarget->Add(styleguide().getBrowseButtonMargin(), 0);
+    sizerTarget->Add(button_browse_target, 0, wxALIGN_CENTER_VERTICAL);
+
+    wxBoxSizer* sizerButtons = new wxBoxSizer(wxHORIZONTAL);
+    sizerButtons->Add(checkbox_showlog, 0, wxALIGN_CENTER_VERTICAL);
+    sizerButtons->Add(styleguide().getUnrelatedControlMargin(wxHORIZONTAL), 0);
+    sizerButtons->Add(label_progress, 1, wxALIGN_CENTER_VERTICAL);
+    sizerButtons->Add(button_start);
+
+    wxBoxSizer* sizerPanelV = new wxBoxSizer(wxVERTICAL);
+    sizerPanelV->Add(0, styleguide().getFrameMargin(wxTOP));
+    sizerPanelV->Add(sizerMode);
+    sizerPanelV->Add(0, styleguide().getUnrelatedControlMargin(wxVERTICAL));
+    sizerPanelV->Add(sizerFilename, 0, wxEXPAND);
+    sizerPanelV->Add(0, styleguide().getRelatedControlMargin(wxVERTICAL));
+    sizerPanelV->Add(sizerLevel, 0, wxEXPAND);
+    sizerPanelV->Add(0, styleguide().getRelatedControlMargin(wxVERTICAL));
+    sizerPanelV->Add(sizerChecks);
+    sizerPanelV->Add(0, styleguide().getUnrelatedControlMargin(wxVERTICAL));
+    sizerPanelV->Add(label_chain);
+    sizerPanelV->Add(0, styleguide().getControlLabelMargin());
+    sizerPanelV->Add(sizerChain, 0, wxEXPAND);
+    sizerPanelV->Add(0, styleguide().getRelatedControlMargin(wxVERTICAL));
+    sizerPanelV->Add(sizerTarget, 0, wxEXPAND);
+    sizerPanelV->Add(0, styleguide().getRelatedControlMargin(wxVERTICAL));
+    sizerPanelV->Add(checkbox_inplace);
+    sizerPanelV->Add(0, styleguide().getUnrelatedControlMargin(wxVERTICAL));
+    sizerPanelV->Add(sizerButtons, 0, wxEXPAND);
+    sizerPanelV->Add(0, styleguide().getRelatedControlMargin(wxVERTICAL));
+    wxBoxSizer* sizerPanelH = new wxBoxSizer(wxHORIZONTAL);
+    sizerPanelH->Add(styleguide().getFrameMargin(wxLEFT), 0);
+    sizerPanelH->Add(sizerPanelV, 1, wxEXPAND);
+    sizerPanelH->Add(styleguide().getFrameMargin(wxRIGHT), 0);
+    panel_controls->SetSizerAndFit(sizerPanelH);
+
+    wxBoxSizer* sizerMain = new wxBoxSizer(wxVERTICAL);
+    sizerMain->Add(panel_controls, 0, wxEXPAND);
+    sizerMain->Add(text_ctrl_log, 1, wxEXPAND);
+
+    // show at least 3 lines of text since it is default size too
+    sizerMain->SetItemMinSize(text_ctrl_log,
+        -1, 3 * text_ctrl_filename->GetSize().GetHeight());
+    SetSizerAndFit(sizerMain);
+}
+
+void NBackupFrame::loadHistory()
+{
+    historyM.clear();
+    choice_guid->Clear();
+
+    // the history can only be read from a connected database, the backups
+    // relative to a guid and the restore chain need it
+    DatabasePtr database = getDatabase();
+    if (!database || !database->isConnected())
+        return;
+    try
+    {
+        IBPP::Database& db = database->getIBPPDatabase();
+        IBPP::Transaction tr = IBPP::TransactionFactory(db, IBPP::amRead);
+        tr->Start();
+        IBPP::Statement st = IBPP::StatementFactory(db, tr);
+        st->Execute("select rdb$backup_level, rdb$guid, rdb$file_name,"
+            " cast(rdb$timestamp as varchar(24))"
+            " from rdb$backup_history order by rdb$backup_id");
+        int32_t level;
+        std::string guid, filename, timestamp;
+        while (st->FetchAs(level, guid, filename, timestamp))
+        {
+            HistoryEntry entry;
+            entry.level = level;
+            entry.guid = std2wxIdentifier(guid, wxConvCurrent);
+            entry.filename = wxString(filename.c_str(), *wxConvCurrent);
+            entry.timestamp = std2wxIdentifier(timestamp, wxConvCurrent);
+            historyM.push_back(entry);
+        }
+        tr->Commit();
+    }
+    catch (IBPP::Exception&)
+    {
+        // no history (old server, no rights), backups by level still work
+        historyM.clear();
+    }
+
+    for (std::vector<HistoryEntry>::const_iterator it = historyM.begin();
+        it != historyM.end(); ++it)
+    {
+        choice_guid->Append(wxString::Format(_("Level %d, %s, %s"),
+            (*it).level, (*it).timestamp.c_str(), (*it).guid.c_str()));
+    }
+    if (!historyM.empty())
+        choice_guid->SetSelection(int(historyM.size()) - 1);
+}
+
+void NBackupFrame::updateControls()
+{
+    bool running = getThreadRunning();
+    bool backup = radio_backup->GetValue();
+    bool inplace = checkbox_inplace->IsChecked();
+    bool guid = checkbox_guid->IsChecked();
+
+    radio_backup->Enable(!running);
+    radio_restore->Enable(!running);
+
+    button_browse->Enable(!running && backup);
+    text_ctrl_filename->Enable(!running && backup);
+    spinctrl_level->Enable(!running && backup && !guid);
+    checkbox_guid->Enable(!running && backup && !historyM.empty());
+    choice_guid->Enable(!running && backup && guid && !historyM.empty());
+    checkbox_triggers->Enable(!running && backup);
+    checkbox_direct->Enable(!running && backup);
+
+    listbox_chain->Enable(!running && !backup);
+    button_add->Enable(!running && !backup);
+    button_remove->Enable(!running && !backup
+        && listbox_chain->GetSelection() != wxNOT_FOUND);
+    button_history->Enable(!running && !backup && !historyM.empty());
+    text_ctrl_target->Enable(!running && !backup && !inplace);
+    button_browse_target->Enable(!running && !backup && !inplace);
+    checkbox_inplace->Enable(!running && !backup);
+
+    bool ready;
+    if (backup)
+        ready = !text_ctrl_filename->GetValue().empty();
+    else
+    {
+        ready = !listbox_chain->IsEmpty()
+            && (inplace || !text_ctrl_target->GetValue().empty());
+    }
+    button_start->Enable(!running && ready);
+}
+
+void NBackupFrame::doReadConfigSettings(const wxString& prefix)
+{
+    BackupRestoreBaseFrame::doReadConfigSettings(prefix);
+    int level = 0;
+    config().getValue(prefix + Config::pathSeparator + "level", level);
+    spinctrl_level->SetValue(level);
+    wxString target;
+    config().getValue(prefix + Config::pathSeparator + "targetfilename",
+        target);
+    if (!target.empty())
+        text_ctrl_target->SetValue(target);
+
+    wxArrayString flags;
+    config().getValue(prefix + Config::pathSeparator + "options", flags);
+    if (!flags.empty())
+    {
+        checkbox_triggers->SetValue(
+            flags.end() != std::find(flags.begin(), flags.end(), "no_triggers"));
+        checkbox_direct->SetValue(
+            flags.end() != std::find(flags.begin(), flags.end(), "direct_io"));
+    }
+    updateControls();
+}
+
+void NBackupFrame::doWriteConfigSettings(const wxString& prefix) const
+{
+    BackupRestoreBaseFrame::doWriteConfigSettings(prefix);
+    config().setValue(prefix + Config::pathSeparator + "level",
+        spinctrl_level->GetValue());
+    config().setValue(prefix + Config::pathSeparator + "targetfilename",
+        text_ctrl_target->GetValue());
+
+    wxArrayString flags;
+    if (checkbox_triggers->IsChecked())
+        flags.push_back("no_triggers");
+    if (checkbox_direct->IsChecked())
+        flags.push_back("direct_io");
+    config().setValue(prefix + Config::pathSeparator + "options", flags);
+}
+
+const wxString NBackupFrame::getName() const
+{
+    return "NBackupFrame";
+}
+
+/*static*/
+wxString NBackupFrame::getFrameId(DatabasePtr db)
+{
+    if (db)
+        return wxString("NBackupFrame/" + db->getItemPath());
+    else
+        return wxEmptyString;
+}
+
+NBackupFrame* NBackupFrame::findFrameFor(DatabasePtr db)
+{
+    BaseFrame* bf = frameFromIdString(getFrameId(db));
+    if (!bf)
+        return 0;
+    return dynamic_cast<NBackupFrame*>(bf);
+}
+
+//! event handlers
+BEGIN_EVENT_TABLE(NBackupFrame, BackupRestoreBaseFrame)
+    EVT_BUTTON(BackupRestoreBaseFrame::ID_button_browse, NBackupFrame::OnBrowseButtonClick)
+    EVT_BUTTON(BackupRestoreBaseFrame::ID_button_start, NBackupFrame::OnStartButtonClick)
+    EVT_BUTTON(NBackupFrame::ID_button_add, NBackupFrame::OnAddButtonClick)
+    EVT_BUTTON(NBackupFrame::ID_button_remove, NBackupFrame::OnRemoveButtonClick)
+    EVT_BUTTON(NBackupFrame::ID_button_history, NBackupFrame::OnHistoryButtonClick)
+    EVT_BUTTON(NBackupFrame::ID_button_browse_target, NBackupFrame::OnBrowseTargetButtonClick)
+    EVT_RADIOBUTTON(NBackupFrame::ID_radio_backup, NBackupFrame::OnSettingsChange)
+    EVT_RADIOBUTTON(NBackupFrame::ID_radio_restore, NBackupFrame::OnSettingsChange)
+    EVT_CHECKBOX(NBackupFrame::ID_checkbox_guid, NBackupFrame::OnSettingsChange)
+    EVT_CHECKBOX(NBackupFrame::ID_checkbox_inplace, NBackupFrame::OnSettingsChange)
+    EVT_LISTBOX(NBackupFrame::ID_listbox_chain, NBackupFrame::OnSettingsChange)
+    EVT_TEXT(NBackupFrame::ID_text_ctrl_target, NBackupFrame::OnSettingsChange)
+END_EVENT_TABLE()
+
+void NBackupFrame::OnBrowseButtonClick(wxCommandEvent& WXUNUSED(event))
+{
+    wxFileName origName(text_ctrl_filename->GetValue());
+    wxString filename = ::wxFileSelector(_("Select Backup File"),
+        origName.GetPath(), origName.GetFullName(), "*.nbk",
+        _("Incremental backup file (*.nbk)|*.nbk|All files (*.*)|*.*"),
+        wxFD_SAVE | wxFD_OVERWRITE_PROMPT, this);
+    if (!filename.empty())
+        text_ctrl_filename->SetValue(filename);
+}
+
+void NBackupFrame::OnBrowseTargetButtonClick(wxCommandEvent& WXUNUSED(event))
+{
+    wxFileName origName(text_ctrl_target->GetValue());
+    wxString filename = ::wxFileSelector(_("Select Database File"),
+        origName.GetPath(), origName.GetFullName(), "*.fdb",
+        _("Database file (*.fdb)|*.fdb|All files (*.*)|*.*"),
+        wxFD_SAVE | wxFD_OVERWRITE_PROMPT, this);
+    if (!filename.empty())
+        text_ctrl_target->SetValue(filename);
+}
+
+void NBackupFrame::OnAddButtonClick(wxCommandEvent& WXUNUSED(event))
+{
+    wxArrayString filenames;
+    wxFileDialog fd(this, _("Select Backup Files"), wxEmptyString,
+        wxEmptyString,
+        _("Incremental backup file (*.nbk)|*.nbk|All files (*.*)|*.*"),
+        wxFD_OPEN | wxFD_FILE_MUST_EXIST | wxFD_MULTIPLE);
+    if (fd.ShowModal() != wxID_OK)
+        return;
+    fd.GetPaths(filenames);
+    listbox_chain->Append(filenames);
+    updateControls();
+}
+
+void NBackupFrame::OnRemoveButtonClick(wxCommandEvent& WXUNUSED(event))
+{
+    int sel = listbox_chain->GetSelection();
+    if (sel != wxNOT_FOUND)
+        listbox_chain->Delete(sel);
+    updateControls();
+}
+
+void NBackupFrame::OnHistoryButtonClick(wxCommandEvent& WXUNUSED(event))
+{
+    // every backup of level N replaces the chain after level N-1, so the
+    // last entries of the history make up the chain of the newest backup
+    wxArrayString chain;
+    for (std::vector<HistoryEntry>::const_iterator it = historyM.begin();
+        it != historyM.end(); ++it)
+    {
+        size_t level = (*it).level;
+        if (chain.size() < level)
+            continue;
+        chain.resize(level);
+        chain.Add((*it).filename);
+    }
+    listbox_chain->Set(chain);
+    updateControls();
+}
+
+void NBackupFrame::OnSettingsChange(wxCommandEvent& WXUNUSED(event))
+{
+    if (IsShown())
+        updateControls();
+}
+
+void NBackupFrame::OnStartButtonClick(wxCommandEvent& WXUNUSED(event))
+{
+    verboseMsgsM = checkbox_showlog->IsChecked();
+    clearLog();
+
+    DatabasePtr database = getDatabase();
+    wxCHECK_RET(database,
+        "Cannot backup unassigned database");
+    ServerPtr server = database->getServer();
+    wxCHECK_RET(server,
+        "Cannot backup database without assigned server");
+
+    bool backup = radio_backup->GetValue();
+    bool inplace = checkbox_inplace->IsChecked();
+    if (!backup && inplace && database->isConnected())
+    {
+        showWarningDialog(this, _("The database is connected"),
+            _("The increments can only be applied to a database that is not in use. Please disconnect it first."),
+            AdvancedMessageDialogButtonsOk());
+        return;
+    }
+
+    wxString username;
+    wxString password;
+    if (!getConnectionCredentials(this, database, username, password))
+        return;
+
+    int flags = 0;
+    std::auto_ptr<wxThread> thread;
+    if (backup)
+    {
+        if (checkbox_triggers->IsChecked())
+            flags |= (int)IBPP::nbNoTriggers;
+        if (checkbox_direct->IsChecked())
+            flags |= (int)IBPP::nbDirectIO;
+        wxString guid;
+        int sel = choice_guid->GetSelection();
+        if (checkbox_guid->IsChecked() && sel != wxNOT_FOUND
+            && sel < (int)historyM.size())
+        {
+            guid = historyM[sel].guid;
+        }
+        thread.reset(new NBackupThread(this,
+            server->getConnectionString(), username, password,
+            database->getPath(), text_ctrl_filename->GetValue(),
+            spinctrl_level->GetValue(), guid, (IBPP::NBF)flags));
+    }
+    else
+    {
+        wxString target(text_ctrl_target->GetValue());
+        if (inplace)
+        {
+            flags |= (int)IBPP::nbInPlace;
+            target = database->getPath();
+        }
+        thread.reset(new NBackupThread(this,
+            server->getConnectionString(), username, password,
+            listbox_chain->GetStrings(), target, (IBPP::NBF)flags));
+    }
+    startThread(thread);
+    updateControls();
+}
@@ -0,0 +1,107 @@
+/*
+  Copyright (c) 2004-2016 The FlameRobin Development Team
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef NBACKUPFRAME_H
+#define NBACKUPFRAME_H
+
+#include <wx/wx.h>
+
+#include <vector>
+
+#include "BackupRestoreBaseFrame.h"
+
+class NBackupThread;
+
+// incremental backups (nbackup) and restores from a chain of them
+class NBackupFrame: public BackupRestoreBaseFrame {
+    friend class NBackupThread;
+private:
+    // an entry of RDB$BACKUP_HISTORY
+    struct HistoryEntry
+    {
+        int level;
+        wxString guid;
+        wxString filename;
+        wxString timestamp;
+    };
+    std::vector<HistoryEntry> historyM;
+    void loadHistory();
+
+    wxRadioButton* radio_backup;
+    wxRadioButton* radio_restore;
+    wxStaticText* label_level;
+    wxSpinCtrl* spinctrl_level;
+    wxCheckBox* checkbox_guid;
+    wxChoice* choice_guid;
+    wxCheckBox* checkbox_triggers;
+    wxCheckBox* checkbox_direct;
+    wxStaticText* label_chain;
+    wxListBox* listbox_chain;
+    wxButton* button_add;
+    wxButton* button_remove;
+    wxButton* button_history;
+    wxStaticText* label_target;
+    FileTextControl* text_ctrl_target;
+    wxButton* button_browse_target;
+    wxCheckBox* checkbox_inplace;
+    void createControls();
+    void layoutControls();
+    virtual void updateControls();
+
+    static wxString getFrameId(DatabasePtr db);
+protected:
+    virtual void doReadConfigSettings(const wxString& prefix);
+    virtual void doWriteConfigSettings(const wxString& prefix) const;
+    virtual const wxString getName() const;
+public:
+    NBackupFrame(wxWindow* parent, DatabasePtr db);
+
+    static NBackupFrame* findFrameFor(DatabasePtr db);
+private:
+    // event handling
+    enum {
+        ID_radio_backup = 201,
+        ID_radio_restore,
+        ID_checkbox_guid,
+        ID_listbox_chain,
+        ID_button_add,
+        ID_button_remove,
+        ID_button_history,
+        ID_text_ctrl_target,
+        ID_button_browse_target,
+        ID_checkbox_inplace
+    };
+
+    void OnBrowseButtonClick(wxCommandEvent& event);
+    void OnBrowseTargetButtonClick(wxCommandEvent& event);
+    void OnAddButtonClick(wxCommandEvent& event);
+    void OnRemoveButtonClick(wxCommandEvent& event);
+    void OnHistoryButtonClick(wxCommandEvent& event);
+    void OnSettingsChange(wxCommandEvent& event);
+    void OnStartButtonClick(wxCommandEvent& event);
+
+    DECLARE_EVENT_TABLE()
+};
+
+#endif // NBACKUPFRAME_H
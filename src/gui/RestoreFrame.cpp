@@ -34,6 +34,8 @@
 #include <wx/filename.h>
 
 #include <algorithm>
+#include <set>
+#include <vector>
 
 #include <ibpp.h>
 
@@ -47,13 +49,15 @@
 #include "gui/UsernamePasswordDialog.h"
 #include "metadata/database.h"
 #include "metadata/server.h"
+#include "sql/Identifier.h"
 
 // worker thread class to perform database restore
 class RestoreThread: public wxThread {
 public:
     RestoreThread(RestoreFrame* frame, wxString server, wxString username,
         wxString password, wxString bkfilename, wxString dbfilename,
-        int pagesize, IBPP::BRF flags);
+        int pagesize, IBPP::BRF flags, int workers, bool activateIndices,
+        bool keepInactiveIndices);
 
     virtual void* Entry();
     virtual void OnExit();
@@ -66,14 +70,22 @@ private:
     wxString dbfileM;
     int pagesizeM;
     IBPP::BRF brfM;
+    int workersM;
+    bool activateIndicesM;
+    bool keepInactiveIndicesM;
+    // indices inactive in the database before it is replaced, they stay so
+    // if the user asked for it
+    std::set<wxString> inactiveIndicesM;
+    void activateIndices();
+    bool readInactiveIndices();
     void logError(wxString& msg);
     void logImportant(wxString& msg);
-    void logProgress(wxString& msg);
 };
 
 RestoreThread::RestoreThread(RestoreFrame* frame, wxString server,
         wxString username, wxString password, wxString bkfilename,
-        wxString dbfilename, int pagesize, IBPP::BRF flags)
+        wxString dbfilename, int pagesize, IBPP::BRF flags, int workers,
+        bool activateIndices, bool keepInactiveIndices)
     : wxThread()
 {
     frameM = frame;
@@ -85,6 +97,9 @@ RestoreThread::RestoreThread(RestoreFrame* frame, wxString server,
     pagesizeM = pagesize;
     // always use verbose flag
     brfM = (IBPP::BRF)((int)flags | (int)IBPP::brVerbose);
+    workersM = workers;
+    activateIndicesM = activateIndices;
+    keepInactiveIndicesM = keepInactiveIndices;
 }
 
 void* RestoreThread::Entry()
@@ -100,10 +115,21 @@ void* RestoreThread::Entry()
             wx2std(usernameM), wx2std(passwordM));
         svc->Connect();
 
+        // gbak deactivates all indices, so those that should stay inactive
+        // must be known before
+        if (activateIndicesM && keepInactiveIndicesM
+            && !readInactiveIndices())
+        {
+            msg = _("The inactive indices of the database being replaced could not be read, all indices are activated after the restore.");
+            logImportant(msg);
+        }
+
         now = wxDateTime::Now();
         msg.Printf(_("Database restore started %s"), now.FormatTime().c_str());
         logImportant(msg);
-        svc->StartRestore(wx2std(bkfileM), wx2std(dbfileM), pagesizeM, brfM);
+        svc->StartRestore(wx2std(bkfileM), wx2std(dbfileM), pagesizeM, brfM,
+            workersM);
+        std::string output;
         while (true)
         {
             if (TestDestroy())
@@ -114,17 +140,34 @@ void* RestoreThread::Entry()
                 logImportant(msg);
                 break;
             }
-            const char* c = svc->WaitMsg();
-            if (c == 0)
+            // all the lines available at once, one line per call is too
+            // slow for the verbose output of big databases
+            bool running = svc->WaitOutput(output);
+            if (!output.empty() && frameM != 0)
+                frameM->threadOutputLines(output);
+            if (!running)
             {
                 now = wxDateTime::Now();
                 msg.Printf(_("Database restore finished %s"),
                     now.FormatTime().c_str());
                 logImportant(msg);
+                if (activateIndicesM)
+                {
+                    try
+                    {
+                        activateIndices();
+                    }
+                    catch (IBPP::Exception& e)
+                    {
+                        msg = _("Activating the indices failed:\n\n");
+                        msg += e.what();
+                        logError(msg);
+                    }
+                }
+                if (frameM != 0)
+                    frameM->threadLogPhases();
                 break;
             }
-            msg = c;
-            logProgress(msg);
         }
         svc->Disconnect();
     }
@@ -146,6 +189,94 @@ void* RestoreThread::Entry()
     return 0;
 }
 
+// reads the user indices inactive in the database about to be replaced,
+// false if it can't be read (it doesn't exist yet, for example)
+bool RestoreThread::readInactiveIndices()
+{
+    inactiveIndicesM.clear();
+    try
+    {
+        IBPP::Database db = IBPP::DatabaseFactory(wx2std(serverM),
+            wx2std(dbfileM), wx2std(usernameM), wx2std(passwordM));
+        db->Connect();
+        IBPP::Transaction tr = IBPP::TransactionFactory(db, IBPP::amRead);
+        tr->Start();
+        IBPP::Statement st = IBPP::StatementFactory(db, tr);
+        st->Execute(
+            "select rdb$index_name from rdb$indices"
+            " where rdb$index_inactive = 1"
+            " and coalesce(rdb$system_flag, 0) = 0");
+        std::string name;
+        while (st->FetchAs(name))
+            inactiveIndicesM.insert(std2wxIdentifier(name, wxConvCurrent));
+        tr->Commit();
+        db->Disconnect();
+    }
+    catch (IBPP::Exception&)
+    {
+        return false;
+    }
+    return true;
+}
+
+// activates the indices gbak restored inactive, so that the restore itself
+// doesn't have to wait for them, the keys go first as the foreign keys
+// need them
+void RestoreThread::activateIndices()
+{
+    wxStopWatch sw;
+    wxString msg(_("Activating indices..."));
+    logImportant(msg);
+
+    IBPP::Database db = IBPP::DatabaseFactory(wx2std(serverM),
+        wx2std(dbfileM), wx2std(usernameM), wx2std(passwordM));
+    db->Connect();
+    IBPP::Transaction tr = IBPP::TransactionFactory(db);
+    tr->Start();
+    IBPP::Statement st = IBPP::StatementFactory(db, tr);
+    st->Execute(
+        "select i.rdb$index_name from rdb$indices i"
+        " left join rdb$relation_constraints c"
+        " on c.rdb$index_name = i.rdb$index_name"
+        " where i.rdb$index_inactive = 1"
+        " and coalesce(i.rdb$system_flag, 0) = 0"
+        " order by case c.rdb$constraint_type"
+        " when 'FOREIGN KEY' then 1 else 0 end, i.rdb$index_name");
+    std::vector<wxString> indices;
+    std::string name;
+    while (st->FetchAs(name))
+    {
+        wxString index(std2wxIdentifier(name, wxConvCurrent));
+        if (inactiveIndicesM.find(index) == inactiveIndicesM.end())
+            indices.push_back(index);
+    }
+    tr->Commit();
+
+    int activated = 0;
+    for (std::vector<wxString>::const_iterator it = indices.begin();
+        it != indices.end() && !TestDestroy(); ++it)
+    {
+        wxString sql("ALTER INDEX " + Identifier(*it).getQuoted()
+            + " ACTIVE");
+        tr->Start();
+        st->ExecuteImmediate(wx2std(sql));
+        tr->Commit();
+        ++activated;
+        if (frameM != 0)
+        {
+            frameM->threadOutputMsg(*it + "\n",
+                BackupRestoreBaseFrame::progress_message);
+        }
+    }
+    db->Disconnect();
+
+    if (frameM != 0)
+        frameM->threadPhaseTime(_("index activation"), sw.Time() / 1000.0);
+    msg.Printf(_("%d of %d indices activated"), activated,
+        (int)indices.size());
+    logImportant(msg);
+}
+
 void RestoreThread::OnExit()
 {
     if (frameM != 0)
@@ -168,12 +299,6 @@ void RestoreThread::logImportant(wxString& msg)
         frameM->threadOutputMsg(msg, BackupRestoreBaseFrame::important_message);
 }
 
-void RestoreThread::logProgress(wxString& msg)
-{
-    if (frameM != 0)
-        frameM->threadOutputMsg(msg, BackupRestoreBaseFrame::progress_message);
-}
-
 RestoreFrame::RestoreFrame(wxWindow* parent, DatabasePtr db)
     : BackupRestoreBaseFrame(parent, db)
 {
@@ -209,12 +334,18 @@ void RestoreFrame::createControls()
         _("Don't restore shadow files"));
     checkbox_commit = new wxCheckBox(panel_controls, wxID_ANY,
         _("Commit per table"));
-    checkbox_deactivate = new wxCheckBox(panel_controls, wxID_ANY,
+    checkbox_deactivate = new wxCheckBox(panel_controls, ID_checkbox_deactivate,
         _("Deactivate indices"));
     checkbox_validity = new wxCheckBox(panel_controls, wxID_ANY,
         _("Ignore validity constraints"));
     checkbox_space = new wxCheckBox(panel_controls, wxID_ANY,
         _("Use all space"));
+    checkbox_activate = new wxCheckBox(panel_controls, ID_checkbox_activate,
+        _("Activate indices afterwards"));
+    checkbox_keepinactive = new wxCheckBox(panel_controls, wxID_ANY,
+        _("Except those inactive before"));
+    checkbox_keepinactive->SetToolTip(
+        _("The indices inactive in the database being replaced stay inactive"));
 
     label_pagesize = new wxStaticText(panel_controls, wxID_ANY,
         _("Page size:"));
@@ -225,8 +356,18 @@ void RestoreFrame::createControls()
         wxDefaultPosition, wxDefaultSize,
         sizeof(pagesize_choices) / sizeof(wxString), pagesize_choices);
 
+    label_workers = new wxStaticText(panel_controls, wxID_ANY,
+        _("Parallel workers:"));
+    spinctrl_workers = new wxSpinCtrl(panel_controls, wxID_ANY,
+        wxEmptyString, wxDefaultPosition, wxDefaultSize, wxSP_ARROW_KEYS,
+        0, 64, 0);
+    spinctrl_workers->SetToolTip(
+        _("0 uses the server default, Firebird 5 or later is needed for more"));
+
     checkbox_showlog = new wxCheckBox(panel_controls, ID_checkbox_showlog,
         _("Show complete log"));
+    label_progress = new wxStaticText(panel_controls, wxID_ANY,
+        wxEmptyString);
     button_start = new wxButton(panel_controls, ID_button_start,
         _("&Start Restore"));
 
@@ -241,6 +382,7 @@ void RestoreFrame::layoutControls()
     std::list<wxWindow*> controls;
     controls.push_back(label_filename);
     controls.push_back(label_pagesize);
+    controls.push_back(label_workers);
     adjustControlsMinWidth(controls);
     controls.clear();
 
@@ -251,7 +393,7 @@ void RestoreFrame::layoutControls()
     sizerFilename->Add(styleguide().getBrowseButtonMargin(), 0);
     sizerFilename->Add(button_browse, 0, wxALIGN_CENTER_VERTICAL);
 
-    wxGridSizer* sizerChecks = new wxGridSizer(3, 2,
+    wxGridSizer* sizerChecks = new wxGridSizer(5, 2,
         styleguide().getCheckboxSpacing(),
         styleguide().getUnrelatedControlMargin(wxHORIZONTAL));
     sizerChecks->Add(checkbox_replace, 0, wxEXPAND);
@@ -260,15 +402,25 @@ void RestoreFrame::layoutControls()
     sizerChecks->Add(checkbox_validity, 0, wxEXPAND);
     sizerChecks->Add(checkbox_commit, 0, wxEXPAND);
     sizerChecks->Add(checkbox_space, 0, wxEXPAND);
+    sizerChecks->Add(0, 0);
+    sizerChecks->Add(checkbox_activate, 0, wxEXPAND);
+    sizerChecks->Add(0, 0);
+    sizerChecks->Add(checkbox_keepinactive, 0, wxEXPAND);
 
     wxBoxSizer* sizerCombo = new wxBoxSizer(wxHORIZONTAL);
     sizerCombo->Add(label_pagesize, 0, wxALIGN_CENTER_VERTICAL);
     sizerCombo->Add(styleguide().getControlLabelMargin(), 0);
     sizerCombo->Add(choice_pagesize, 1, wxEXPAND);
 
+    wxBoxSizer* sizerWorkers = new wxBoxSizer(wxHORIZONTAL);
+    sizerWorkers->Add(label_workers, 0, wxALIGN_CENTER_VERTICAL);
+    sizerWorkers->Add(styleguide().getControlLabelMargin(), 0);
+    sizerWorkers->Add(spinctrl_workers, 0, wxALIGN_CENTER_VERTICAL);
+
     wxBoxSizer* sizerButtons = new wxBoxSizer(wxHORIZONTAL);
     sizerButtons->Add(checkbox_showlog, 0, wxALIGN_CENTER_VERTICAL);
-    sizerButtons->Add(0, 0, 1, wxEXPAND);
+    sizerButtons->Add(styleguide().getUnrelatedControlMargin(wxHORIZONTAL), 0);
+    sizerButtons->Add(label_progress, 1, wxALIGN_CENTER_VERTICAL);
     sizerButtons->Add(button_start);
 
     wxBoxSizer* sizerPanelV = new wxBoxSizer(wxVERTICAL);
@@ -278,6 +430,8 @@ void RestoreFrame::layoutControls()
     sizerPanelV->Add(sizerChecks);
     sizerPanelV->Add(0, styleguide().getRelatedControlMargin(wxVERTICAL));
     sizerPanelV->Add(sizerCombo);
+    sizerPanelV->Add(0, styleguide().getRelatedControlMargin(wxVERTICAL));
+    sizerPanelV->Add(sizerWorkers);
     sizerPanelV->Add(0, styleguide().getUnrelatedControlMargin(wxVERTICAL));
     sizerPanelV->Add(sizerButtons, 0, wxEXPAND);
     sizerPanelV->Add(0, styleguide().getRelatedControlMargin(wxVERTICAL));
@@ -308,7 +462,11 @@ void RestoreFrame::updateControls()
     checkbox_validity->Enable(!running);
     checkbox_commit->Enable(!running);
     checkbox_space->Enable(!running);
+    checkbox_activate->Enable(!running && checkbox_deactivate->IsChecked());
+    checkbox_keepinactive->Enable(!running && checkbox_deactivate->IsChecked()
+        && checkbox_activate->IsChecked());
     choice_pagesize->Enable(!running);
+    spinctrl_workers->Enable(!running);
     DatabasePtr db = getDatabase();
     button_start->Enable(!running && !text_ctrl_filename->GetValue().empty()
         && db && !db->isConnected());
@@ -342,6 +500,10 @@ void RestoreFrame::doReadConfigSettings(const wxString& prefix)
             flags.end() != std::find(flags.begin(), flags.end(), "commit_per_table"));
         checkbox_space->SetValue(
             flags.end() != std::find(flags.begin(), flags.end(), "use_all_space"));
+        checkbox_activate->SetValue(
+            flags.end() != std::find(flags.begin(), flags.end(), "activate_indices"));
+        checkbox_keepinactive->SetValue(
+            flags.end() != std::find(flags.begin(), flags.end(), "keep_inactive_indices"));
     }
     updateControls();
 }
@@ -365,6 +527,10 @@ void RestoreFrame::doWriteConfigSettings(const wxString& prefix) const
         flags.push_back("commit_per_table");
     if (checkbox_space->IsChecked())
         flags.push_back("use_all_space");
+    if (checkbox_activate->IsChecked())
+        flags.push_back("activate_indices");
+    if (checkbox_keepinactive->IsChecked())
+        flags.push_back("keep_inactive_indices");
     config().setValue(prefix + Config::pathSeparator + "options", flags);
 }
 
@@ -393,6 +559,8 @@ RestoreFrame* RestoreFrame::findFrameFor(DatabasePtr db)
 BEGIN_EVENT_TABLE(RestoreFrame, BackupRestoreBaseFrame)
     EVT_BUTTON(BackupRestoreBaseFrame::ID_button_browse, RestoreFrame::OnBrowseButtonClick)
     EVT_BUTTON(BackupRestoreBaseFrame::ID_button_start, RestoreFrame::OnStartButtonClick)
+    EVT_CHECKBOX(RestoreFrame::ID_checkbox_deactivate, RestoreFrame::OnDeactivateChange)
+    EVT_CHECKBOX(RestoreFrame::ID_checkbox_activate, RestoreFrame::OnDeactivateChange)
 END_EVENT_TABLE()
 
 void RestoreFrame::OnBrowseButtonClick(wxCommandEvent& WXUNUSED(event))
@@ -406,6 +574,11 @@ void RestoreFrame::OnBrowseButtonClick(wxCommandEvent& WXUNUSED(event))
         text_ctrl_filename->SetValue(filename);
 }
 
+void RestoreFrame::OnDeactivateChange(wxCommandEvent& WXUNUSED(event))
+{
+    updateControls();
+}
+
 void RestoreFrame::OnStartButtonClick(wxCommandEvent& WXUNUSED(event))
 {
     verboseMsgsM = checkbox_showlog->IsChecked();
@@ -444,7 +617,9 @@ void RestoreFrame::OnStartButtonClick(wxCommandEvent& WXUNUSED(event))
     std::auto_ptr<wxThread> thread(new RestoreThread(this,
         server->getConnectionString(), username, password,
         text_ctrl_filename->GetValue(), database->getPath(), pagesize,
-        (IBPP::BRF)flags));
+        (IBPP::BRF)flags, spinctrl_workers->GetValue(),
+        checkbox_deactivate->IsChecked() && checkbox_activate->IsChecked(),
+        checkbox_keepinactive->IsChecked()));
     startThread(thread);
     updateControls();
 }
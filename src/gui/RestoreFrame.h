@@ -40,6 +40,8 @@ private:
     wxCheckBox* checkbox_validity;
     wxCheckBox* checkbox_commit;
     wxCheckBox* checkbox_space;
+    wxCheckBox* checkbox_activate;
+    wxCheckBox* checkbox_keepinactive;
     wxStaticText* label_pagesize;
     wxChoice* choice_pagesize;
     void createControls();
@@ -57,7 +59,13 @@ public:
     static RestoreFrame* findFrameFor(DatabasePtr db);
 private:
     // event handling
+    enum {
+        ID_checkbox_deactivate = 201,
+        ID_checkbox_activate
+    };
+
     void OnBrowseButtonClick(wxCommandEvent& event);
+    void OnDeactivateChange(wxCommandEvent& event);
     void OnStartButtonClick(wxCommandEvent& event);
 
     DECLARE_EVENT_TABLE()
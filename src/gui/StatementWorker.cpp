@@ -0,0 +1,209 @@
+/*
+  Copyright (c) 2004-2016 The FlameRobin Development Team
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWindows headers
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include "gui/ProgressDialog.h"
+#include "gui/StatementWorker.h"
+
+// jobs done within that time don't process GUI events, so fetching row
+// blocks neither flickers nor re-enters the grid
+static const long quickJobMillis = 100;
+// the progress dialog is only shown for jobs running longer than that
+static const long progressDelayMillis = 500;
+
+// StatementWorkerThread runs the jobs handed to it one after the other
+class StatementWorkerThread: public wxThread
+{
+private:
+    wxSemaphore jobReadyM;
+    std::function<void ()> jobM;    // empty to end the thread
+public:
+    wxSemaphore doneM;
+    std::exception_ptr errorM;
+
+    StatementWorkerThread();
+    virtual void* Entry();
+    // doneM is posted once the job has run
+    void post(std::function<void ()> job);
+};
+
+StatementWorkerThread::StatementWorkerThread()
+    : wxThread(wxTHREAD_JOINABLE)
+{
+}
+
+void* StatementWorkerThread::Entry()
+{
+    while (true)
+    {
+        jobReadyM.Wait();
+        if (!jobM)
+            break;
+        try
+        {
+            jobM();
+        }
+        catch (...)
+        {
+            errorM = std::current_exception();
+        }
+        jobM = nullptr;
+        doneM.Post();
+    }
+    return 0;
+}
+
+void StatementWorkerThread::post(std::function<void ()> job)
+{
+    jobM = job;
+    jobReadyM.Post();
+}
+
+// StatementWorker
+StatementWorker::StatementWorker(wxWindow* parent, IBPP::Database& database)
+    : parentM(parent), databaseM(database), threadM(0), fetchedRowsM(0),
+        runningM(false)
+{
+}
+
+StatementWorker::~StatementWorker()
+{
+    if (threadM)
+    {
+        threadM->post(std::function<void ()>());
+        threadM->Wait();
+        delete threadM;
+    }
+}
+
+bool StatementWorker::isRunning() const
+{
+    return runningM;
+}
+
+void StatementWorker::setFetchedRows(unsigned rows)
+{
+    wxCriticalSectionLocker locker(progressCritSectM);
+    fetchedRowsM = rows;
+}
+
+void StatementWorker::cancel()
+{
+    // the attachment may not be connected yet
+    if (databaseM == 0)
+        return;
+    try
+    {
+        databaseM->CancelOperation();
+    }
+    catch (IBPP::Exception&)
+    {
+        // nothing left to cancel, or the client library can't do it
+    }
+}
+
+void StatementWorker::run(const wxString& title, std::function<void ()> job)
+{
+    wxASSERT(!runningM);
+    if (!threadM)
+    {
+        threadM = new StatementWorkerThread();
+        if (threadM->Create() != wxTHREAD_NO_ERROR
+            || threadM->Run() != wxTHREAD_NO_ERROR)
+        {
+            delete threadM;
+            threadM = 0;
+        }
+    }
+    if (!threadM)
+    {
+        // run it the old way rather than not at all
+        job();
+        return;
+    }
+
+    runningM = true;
+    wxStopWatch sw;
+    threadM->post(job);
+    if (threadM->doneM.WaitTimeout(quickJobMillis) == wxSEMA_TIMEOUT)
+        waitWithProgress(title, sw);
+    runningM = false;
+
+    if (threadM->errorM)
+    {
+        std::exception_ptr error;
+        std::swap(error, threadM->errorM);
+        std::rethrow_exception(error);
+    }
+}
+
+void StatementWorker::waitWithProgress(const wxString& title, wxStopWatch& sw)
+{
+    // GUI events are processed meanwhile, it is up to the owning frame to
+    // keep its commands from reaching the attachment while isRunning()
+    std::unique_ptr<ProgressDialog> progress;
+    bool canceled = false;
+    while (threadM->doneM.WaitTimeout(50) == wxSEMA_TIMEOUT)
+    {
+        if (!progress && sw.Time() >= progressDelayMillis)
+        {
+            progress.reset(new ProgressDialog(parentM, title));
+            // not doShow(), as that would disable all other windows
+            progress->Show();
+            progress->initProgressIndeterminate(wxEmptyString);
+        }
+        if (progress)
+        {
+            unsigned rows;
+            {
+                wxCriticalSectionLocker locker(progressCritSectM);
+                rows = fetchedRowsM;
+            }
+            wxString msg = wxString::Format(_("Elapsed time: %.1f s"),
+                sw.Time() / 1000.0);
+            if (rows)
+                msg += wxString::Format(_(", %u rows fetched"), rows);
+            progress->initProgressIndeterminate(msg);  // pulses the gauge
+            if (!canceled && progress->isCanceled())
+            {
+                canceled = true;
+                progress->setProgressMessage(_("Cancelling..."));
+                cancel();
+            }
+        }
+        wxYieldIfNeeded();
+    }
+}
@@ -0,0 +1,71 @@
+/*
+  Copyright (c) 2004-2016 The FlameRobin Development Team
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef FR_STATEMENTWORKER_H
+#define FR_STATEMENTWORKER_H
+
+#include <wx/wx.h>
+#include <wx/thread.h>
+
+#include <functional>
+
+#include <ibpp.h>
+
+class StatementWorkerThread;
+
+// Runs the blocking IBPP calls of a frame (prepare, execute, fetch, commit)
+// on a worker thread, so the GUI stays responsive while the server works.
+// The thread is started with the first call and lives as long as the
+// worker. Only one call runs at a time, and the calling thread doesn't
+// touch the attachment while it waits - except for cancelling the running
+// request. Other windows stay usable meanwhile, so the owning frame has to
+// disable its own commands that use the attachment while isRunning().
+class StatementWorker
+{
+private:
+    wxWindow* parentM;
+    IBPP::Database& databaseM;
+    StatementWorkerThread* threadM;
+    wxCriticalSection progressCritSectM;
+    unsigned fetchedRowsM;
+    bool runningM;
+
+    void waitWithProgress(const wxString& title, wxStopWatch& sw);
+public:
+    StatementWorker(wxWindow* parent, IBPP::Database& database);
+    ~StatementWorker();
+
+    // runs job on the worker thread and returns when it is done, the
+    // exceptions it throws are rethrown here; short jobs are simply waited
+    // for, while longer ones process GUI events, and a progress dialog
+    // shows up whose Cancel button cancels the request on the server
+    void run(const wxString& title, std::function<void ()> job);
+    bool isRunning() const;
+
+    // both are thread-safe
+    void setFetchedRows(unsigned rows);
+    void cancel();
+};
+
+#endif // FR_STATEMENTWORKER_H
@@ -845,6 +845,7 @@ BEGIN_EVENT_TABLE(DataGrid, wxGrid)
     EVT_GRID_CELL_RIGHT_CLICK(DataGrid::OnGridCellRightClick)
     EVT_GRID_LABEL_RIGHT_CLICK(DataGrid::OnGridLabelRightClick)
     EVT_GRID_EDITOR_CREATED(DataGrid::OnEditorCreated)
+    EVT_GRID_EDITOR_SHOWN(DataGrid::OnEditorShown)
     EVT_GRID_SELECT_CELL(DataGrid::OnGridCellSelected)
     EVT_GRID_RANGE_SELECT(DataGrid::OnGridRangeSelected)
     //  EVT_GRID_EDITOR_HIDDEN( DataGrid::OnEditorHidden )
@@ -889,8 +890,7 @@ void DataGrid::OnTimer(wxTimerEvent& WXUNUSED(event))
             if (IsInSelection(i, j))
             {
                 double d;
-                wxString val = table->getCellValue(i, j);
-                if (val.ToDouble(&d))
+                if (table->getCellValueAsDouble(i, j, d))
                 {
                     sum += d;
                     any = true;
@@ -938,6 +938,16 @@ void DataGrid::OnEditorCreated(wxGridEditorCreatedEvent& event)
         0, this);
 }
 
+void DataGrid::OnEditorShown(wxGridEvent& event)
+{
+    // changes would be written while the frame's worker uses the attachment
+    DataGridTable* table = getDataGridTable();
+    if (table && table->isWorkerRunning())
+        event.Veto();
+    else
+        event.Skip();
+}
+
 void DataGrid::OnEditorKeyDown(wxKeyEvent& event)
 {
     if (event.GetKeyCode() == WXK_DELETE || event.GetKeyCode() == WXK_BACK)
@@ -1008,8 +1018,12 @@ void DataGrid::OnIdle(wxIdleEvent& event)
     if (table->needsMoreRowsFetched())
     {
         table->fetch();
-        if (table->needsMoreRowsFetched())
+        // the fetch thread wakes the idle handling up for new rows itself
+        if (table->needsMoreRowsFetched()
+            && !table->isFetchingInBackground())
+        {
             event.RequestMore();
+        }
         AdjustScrollbars();
     }
 }
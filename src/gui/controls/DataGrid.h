@@ -66,6 +66,7 @@ private:
     void OnMouseWheel(wxMouseEvent& event);
     void OnThumbRelease(wxScrollWinEvent& event);
     void OnEditorCreated(wxGridEditorCreatedEvent& event);
+    void OnEditorShown(wxGridEvent& event);
     void OnEditorKeyDown(wxKeyEvent& event);
     void OnTimer(wxTimerEvent& event);
     DECLARE_EVENT_TABLE()
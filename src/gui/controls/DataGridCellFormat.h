@@ -0,0 +1,176 @@
+/*
+  Copyright (c) 2004-2016 The FlameRobin Development Team
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef FR_DATAGRIDCELLFORMAT_H
+#define FR_DATAGRIDCELLFORMAT_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+// writes value as decimal text with at least width digits backwards from
+// end, returns the start of the text
+inline char* writeDecimal(char* end, int64_t value, int width = 1)
+{
+    bool negative = value < 0;
+    uint64_t magnitude = negative ? 0 - uint64_t(value) : uint64_t(value);
+    char* p = end;
+    do
+    {
+        *--p = char('0' + magnitude % 10);
+        magnitude /= 10;
+        --width;
+    }
+    while (magnitude || width > 0);
+    if (negative)
+        *--p = '-';
+    return p;
+}
+
+// DataGridCellFormat class
+// A date, time or timestamp format of the grid compiled into a list of
+// steps, so the format string isn't interpreted for every cell.  Each step
+// is either literal text or a field with a minimum number of digits.
+// It works on UTF-8 text and doesn't need wxWidgets, the caller converts.
+class DataGridCellFormat
+{
+public:
+    enum Field { ffYear, ffYear2, ffMonth, ffDay, ffHour, ffMinute,
+        ffSecond, ffMilliSecond, ffCount, ffLiteral = ffCount };
+    struct Letter
+    {
+        char letter;
+        Field field;
+        int width;              // minimum number of digits
+    };
+    static const Letter* dateLetters();
+    static const Letter* timeLetters();
+    static const Letter* timestampLetters();
+private:
+    struct Step
+    {
+        Field field;
+        int width;
+        std::string literal;    // ffLiteral: UTF-8 encoded text
+    };
+    std::vector<Step> stepsM;
+    bool asciiM;
+public:
+    DataGridCellFormat() : asciiM(true) {}
+
+    void compile(const std::string& format, const Letter* letters);
+    // appends the text for values, indexed by Field, to result
+    void run(const int* values, std::string& result) const;
+    // no literal has non-ASCII characters
+    bool isAscii() const { return asciiM; }
+};
+
+// the letters of each format, lowercase letters use as few digits as
+// possible; 'm' is the minute in the timestamp format, the month is 'n'
+inline const DataGridCellFormat::Letter* DataGridCellFormat::dateLetters()
+{
+    static const Letter letters[] = {
+        { 'd', ffDay, 1 }, { 'D', ffDay, 2 }, { 'm', ffMonth, 1 },
+        { 'M', ffMonth, 2 }, { 'y', ffYear2, 2 }, { 'Y', ffYear, 4 },
+        { 0, ffLiteral, 0 }
+    };
+    return letters;
+}
+
+inline const DataGridCellFormat::Letter* DataGridCellFormat::timeLetters()
+{
+    static const Letter letters[] = {
+        { 'h', ffHour, 1 }, { 'H', ffHour, 2 }, { 'm', ffMinute, 1 },
+        { 'M', ffMinute, 2 }, { 's', ffSecond, 1 }, { 'S', ffSecond, 2 },
+        { 'T', ffMilliSecond, 3 }, { 0, ffLiteral, 0 }
+    };
+    return letters;
+}
+
+inline const DataGridCellFormat::Letter*
+    DataGridCellFormat::timestampLetters()
+{
+    static const Letter letters[] = {
+        { 'd', ffDay, 1 }, { 'D', ffDay, 2 }, { 'n', ffMonth, 1 },
+        { 'N', ffMonth, 2 }, { 'y', ffYear2, 2 }, { 'Y', ffYear, 4 },
+        { 'h', ffHour, 1 }, { 'H', ffHour, 2 }, { 'm', ffMinute, 1 },
+        { 'M', ffMinute, 2 }, { 's', ffSecond, 1 }, { 'S', ffSecond, 2 },
+        { 'T', ffMilliSecond, 3 }, { 0, ffLiteral, 0 }
+    };
+    return letters;
+}
+
+inline void DataGridCellFormat::compile(const std::string& format,
+    const Letter* letters)
+{
+    stepsM.clear();
+    asciiM = true;
+    for (std::string::const_iterator c = format.begin(); c != format.end();
+        ++c)
+    {
+        // the bytes of multibyte characters never match an ASCII letter
+        const Letter* l = letters;
+        while (l->letter && *c != l->letter)
+            ++l;
+        if (l->letter)
+        {
+            Step step;
+            step.field = l->field;
+            step.width = l->width;
+            stepsM.push_back(step);
+            continue;
+        }
+        // consecutive other characters are copied as one literal
+        if (stepsM.empty() || stepsM.back().field != ffLiteral)
+        {
+            Step step;
+            step.field = ffLiteral;
+            step.width = 0;
+            stepsM.push_back(step);
+        }
+        if ((unsigned char)*c > 127)
+            asciiM = false;
+        stepsM.back().literal += *c;
+    }
+}
+
+inline void DataGridCellFormat::run(const int* values,
+    std::string& result) const
+{
+    for (std::vector<Step>::const_iterator it = stepsM.begin();
+        it != stepsM.end(); ++it)
+    {
+        if ((*it).field == ffLiteral)
+        {
+            result += (*it).literal;
+            continue;
+        }
+        char buffer[24];
+        char* end = buffer + sizeof(buffer);
+        char* start = writeDecimal(end, values[(*it).field], (*it).width);
+        result.append(start, end - start);
+    }
+}
+
+#endif
@@ -30,6 +30,12 @@
     #include "wx/wx.h"
 #endif
 
+#include <wx/filename.h>
+
+#include <algorithm>
+
+#include "core/FRError.h"
+#include "core/StringUtils.h"
 #include "gui/controls/DataGridRowBuffer.h"
 
 DataGridRowBuffer::DataGridRowBuffer(unsigned fieldCount)
@@ -114,6 +120,22 @@ bool DataGridRowBuffer::getValue(unsigned offset, IBPP::DBKey& value,
     return true;
 }
 
+bool DataGridRowBuffer::getValue(unsigned offset, IBPP::Int128& value)
+{
+    if (offset + sizeof(IBPP::Int128) > dataM.size())
+        return false;
+    value = *((IBPP::Int128*)&dataM[offset]);
+    return true;
+}
+
+bool DataGridRowBuffer::getValue(unsigned offset, IBPP::DecFloat& value)
+{
+    if (offset + sizeof(IBPP::DecFloat) > dataM.size())
+        return false;
+    value = *((IBPP::DecFloat*)&dataM[offset]);
+    return true;
+}
+
 bool DataGridRowBuffer::isFieldNA(unsigned /*num*/)
 {
     return false;
@@ -210,6 +232,22 @@ void DataGridRowBuffer::setValue(unsigned offset, IBPP::DBKey value)
     invalidateIsDeletable();
 }
 
+void DataGridRowBuffer::setValue(unsigned offset, const IBPP::Int128& value)
+{
+    if (offset + sizeof(IBPP::Int128) > dataM.size())
+        dataM.resize(offset + sizeof(IBPP::Int128), 0);
+    *((IBPP::Int128*)&dataM[offset]) = value;
+    invalidateIsDeletable();
+}
+
+void DataGridRowBuffer::setValue(unsigned offset, const IBPP::DecFloat& value)
+{
+    if (offset + sizeof(IBPP::DecFloat) > dataM.size())
+        dataM.resize(offset + sizeof(IBPP::DecFloat), 0);
+    *((IBPP::DecFloat*)&dataM[offset]) = value;
+    invalidateIsDeletable();
+}
+
 bool DataGridRowBuffer::isInserted()
 {
     return false;
@@ -292,3 +330,831 @@ void InsertedGridRowBuffer::setFieldNA(unsigned num, bool isNA)
     invalidateIsDeletable();
 }
 
+// rows are spilled to the temporary file in blocks of this many rows
+static const unsigned spillBlockRows = 4096;
+// number of spilled blocks kept in memory after they were read back
+static const unsigned loadedBlockCount = 8;
+
+static void appendBits(std::vector<char>& data, const std::vector<bool>& bits,
+    unsigned first, unsigned count)
+{
+    size_t pos = data.size();
+    data.resize(pos + (count + 7) / 8, 0);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        if (bits[first + i])
+            data[pos + i / 8] |= char(1 << (i % 8));
+    }
+}
+
+static size_t readBits(const std::vector<char>& data, size_t pos,
+    std::vector<bool>& bits, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i)
+        bits[i] = (data[pos + i / 8] & (1 << (i % 8))) != 0;
+    return pos + (count + 7) / 8;
+}
+
+DataGridColumnStore::DataGridColumnStore()
+    : bufferSizeM(0), rowCountM(0), memoryLimitM(0), spilledRowsM(0),
+        spillFileM(0), spillFileSizeM(0), nextLoadedBlockM(0)
+{
+}
+
+DataGridColumnStore::~DataGridColumnStore()
+{
+    closeSpillFile();
+}
+
+void DataGridColumnStore::clear()
+{
+    fixedColumnsM.clear();
+    fixedColumnAtM.clear();
+    nullsM.clear();
+    stringsM.clear();
+    stringsLoadedM.clear();
+    blobsM.clear();
+    blobIdsM.clear();
+    blobDatabaseM = 0;
+    blobTransactionM = 0;
+    clearStrings();
+    closeSpillFile();
+    bufferSizeM = 0;
+    rowCountM = 0;
+}
+
+void DataGridColumnStore::clearStrings()
+{
+    chunksM.clear();
+    stringCacheM.clear();
+}
+
+DataGridColumnStore::CachedString& DataGridColumnStore::getCachedString(
+    unsigned row, unsigned index)
+{
+    // enough for the cells of some screens full of rows
+    const unsigned cacheSize = 4096;
+    if (stringCacheM.empty())
+        stringCacheM.resize(cacheSize);
+    return stringCacheM[(row * 31 + index) & (cacheSize - 1)];
+}
+
+void DataGridColumnStore::initialize(unsigned fieldCount,
+    unsigned stringCount, unsigned blobCount)
+{
+    nullsM.resize(fieldCount);
+    stringsM.resize(stringCount);
+    stringsLoadedM.resize(stringCount);
+    blobsM.resize(blobCount);
+}
+
+void DataGridColumnStore::addFixedColumn(unsigned offset, unsigned width)
+{
+    if (width == 0)
+        return;
+    FixedColumn fc;
+    fc.offset = offset;
+    fc.width = width;
+    fixedColumnsM.push_back(fc);
+    if (offset + width > bufferSizeM)
+        bufferSizeM = offset + width;
+    fixedColumnAtM.resize(bufferSizeM, 0);
+    for (unsigned i = offset; i < offset + width; ++i)
+        fixedColumnAtM[i] = fixedColumnsM.size() - 1;
+}
+
+uint8_t* DataGridColumnStore::getData(unsigned row, unsigned offset,
+    unsigned size)
+{
+    if (row >= rowCountM - spilledRowsM || offset >= fixedColumnAtM.size())
+        return 0;
+    FixedColumn& fc = fixedColumnsM[fixedColumnAtM[offset]];
+    if (offset + size > fc.offset + fc.width)
+        return 0;
+    return &fc.data[row * fc.width + offset - fc.offset];
+}
+
+unsigned DataGridColumnStore::addRows(unsigned count)
+{
+    unsigned first = rowCountM;
+    rowCountM += count;
+    const unsigned resident = rowCountM - spilledRowsM;
+    for (std::vector<FixedColumn>::iterator it = fixedColumnsM.begin();
+        it != fixedColumnsM.end(); ++it)
+    {
+        (*it).data.resize(resident * (*it).width, 0);
+    }
+    for (unsigned i = 0; i < nullsM.size(); ++i)
+        nullsM[i].resize(resident, true);
+    for (unsigned i = 0; i < stringsM.size(); ++i)
+    {
+        stringsM[i].resize(resident);
+        stringsLoadedM[i].resize(resident, false);
+    }
+    for (unsigned i = 0; i < blobsM.size(); ++i)
+        blobsM[i].resize(resident);
+    return first;
+}
+
+// removes the first count rows that are held in memory
+void DataGridColumnStore::eraseRows(unsigned count)
+{
+    for (std::vector<FixedColumn>::iterator it = fixedColumnsM.begin();
+        it != fixedColumnsM.end(); ++it)
+    {
+        (*it).data.erase((*it).data.begin(),
+            (*it).data.begin() + count * (*it).width);
+    }
+    for (unsigned i = 0; i < nullsM.size(); ++i)
+        nullsM[i].erase(nullsM[i].begin(), nullsM[i].begin() + count);
+    for (unsigned i = 0; i < stringsM.size(); ++i)
+    {
+        stringsM[i].erase(stringsM[i].begin(), stringsM[i].begin() + count);
+        stringsLoadedM[i].erase(stringsLoadedM[i].begin(),
+            stringsLoadedM[i].begin() + count);
+    }
+    for (unsigned i = 0; i < blobsM.size(); ++i)
+        blobsM[i].erase(blobsM[i].begin(), blobsM[i].begin() + count);
+    // the cached strings are those of other rows now
+    stringCacheM.clear();
+}
+
+void DataGridColumnStore::truncate(unsigned rowCount)
+{
+    if (rowCount >= rowCountM)
+        return;
+    // only the rows of the last fetch are removed, which aren't spilled yet
+    wxASSERT(rowCount >= spilledRowsM || rowCount == 0);
+    if (rowCount < spilledRowsM)
+    {
+        closeSpillFile();
+        rowCount = 0;
+    }
+    rowCountM = rowCount;
+    const unsigned resident = rowCountM - spilledRowsM;
+    for (std::vector<FixedColumn>::iterator it = fixedColumnsM.begin();
+        it != fixedColumnsM.end(); ++it)
+    {
+        (*it).data.resize(resident * (*it).width);
+    }
+    for (unsigned i = 0; i < nullsM.size(); ++i)
+        nullsM[i].resize(resident);
+    for (unsigned i = 0; i < stringsM.size(); ++i)
+    {
+        stringsM[i].resize(resident);
+        stringsLoadedM[i].resize(resident);
+    }
+    for (unsigned i = 0; i < blobsM.size(); ++i)
+        blobsM[i].resize(resident);
+    stringCacheM.clear();
+    if (rowCountM == 0)
+        clearStrings();
+}
+
+void DataGridColumnStore::copyRow(unsigned row, DataGridRowBuffer& buffer)
+{
+    if (row >= rowCountM)
+        return;
+    if (DataGridColumnStore* block = getSpilledBlock(row))
+        block->copyRow(row, buffer);
+    else
+    {
+        for (unsigned i = 0; i < nullsM.size()
+            && i < buffer.fieldAttrM.size(); ++i)
+        {
+            buffer.fieldAttrM[i].isNull = nullsM[i][row];
+        }
+        buffer.dataM.resize(bufferSizeM, 0);
+        for (std::vector<FixedColumn>::iterator it = fixedColumnsM.begin();
+            it != fixedColumnsM.end(); ++it)
+        {
+            std::copy((*it).data.begin() + row * (*it).width,
+                (*it).data.begin() + (row + 1) * (*it).width,
+                buffer.dataM.begin() + (*it).offset);
+        }
+        buffer.stringsM.resize(stringsM.size());
+        for (unsigned i = 0; i < stringsM.size(); ++i)
+        {
+            buffer.stringsM[i] = getString(row + spilledRowsM, i);
+            if (i < buffer.fieldAttrM.size())
+                buffer.fieldAttrM[i].isStringLoaded = stringsLoadedM[i][row];
+        }
+        buffer.blobsM.resize(blobsM.size());
+        for (unsigned i = 0; i < blobsM.size(); ++i)
+            buffer.blobsM[i] = getBlobAt(row, i);
+    }
+}
+
+void DataGridColumnStore::setMemoryLimit(size_t bytes)
+{
+    memoryLimitM = bytes;
+}
+
+size_t DataGridColumnStore::getResidentSize() const
+{
+    size_t size = 0;
+    for (std::vector<FixedColumn>::const_iterator it = fixedColumnsM.begin();
+        it != fixedColumnsM.end(); ++it)
+    {
+        size += (*it).data.capacity();
+    }
+    for (unsigned i = 0; i < nullsM.size(); ++i)
+        size += nullsM[i].capacity() / 8;
+    for (unsigned i = 0; i < stringsM.size(); ++i)
+    {
+        size += stringsM[i].capacity() * sizeof(StringRef)
+            + stringsLoadedM[i].capacity() / 8;
+    }
+    for (unsigned i = 0; i < chunksM.size(); ++i)
+        size += chunksM[i].capacity();
+    for (unsigned i = 0; i < blobsM.size(); ++i)
+        size += blobsM[i].capacity() * sizeof(IBPP::Blob);
+    for (unsigned i = 0; i < loadedBlocksM.size(); ++i)
+        size += loadedBlocksM[i].rows->getResidentSize();
+    return size;
+}
+
+size_t DataGridColumnStore::getSpilledSize() const
+{
+    return size_t(spillFileSizeM);
+}
+
+void DataGridColumnStore::checkMemoryLimit()
+{
+    if (memoryLimitM == 0)
+        return;
+    size_t size = getResidentSize();
+    if (size <= memoryLimitM)
+        return;
+
+    // spill the oldest rows in whole blocks until a quarter of the limit
+    // is free again, the newest rows always stay in memory
+    const unsigned resident = rowCountM - spilledRowsM;
+    if (resident <= spillBlockRows)
+        return;
+    double part = double(size - memoryLimitM / 4 * 3) / size;
+    unsigned count = unsigned(resident * part);
+    count = std::max(count, spillBlockRows);
+    if (count >= resident)
+        count = resident - 1;
+    count -= count % spillBlockRows;
+    if (count == 0)
+        return;
+
+    try
+    {
+        spill(count);
+    }
+    catch (FRError& e)
+    {
+        // keep all rows in memory from now on
+        memoryLimitM = 0;
+        wxLogError("%s", e.what());
+    }
+}
+
+void DataGridColumnStore::closeSpillFile()
+{
+    for (unsigned i = 0; i < loadedBlocksM.size(); ++i)
+        delete loadedBlocksM[i].rows;
+    loadedBlocksM.clear();
+    nextLoadedBlockM = 0;
+    spilledBlocksM.clear();
+    spilledRowsM = 0;
+    spillFileSizeM = 0;
+    if (spillFileM)
+    {
+        delete spillFileM;
+        spillFileM = 0;
+        wxRemoveFile(spillFileNameM);
+    }
+    spillFileNameM.clear();
+}
+
+// the blocks are in a simple binary format, only ever read back by the
+// same store: the data of the fixed columns, the NULL bitmaps, for every
+// string index the loaded bitmap, the lengths and the UTF-8 text, and for
+// every blob index the 8 byte blob ids
+void DataGridColumnStore::writeBlock(std::vector<char>& data, unsigned first,
+    unsigned count)
+{
+    for (std::vector<FixedColumn>::iterator it = fixedColumnsM.begin();
+        it != fixedColumnsM.end(); ++it)
+    {
+        data.insert(data.end(), (*it).data.begin() + first * (*it).width,
+            (*it).data.begin() + (first + count) * (*it).width);
+    }
+    for (unsigned i = 0; i < nullsM.size(); ++i)
+        appendBits(data, nullsM[i], first, count);
+    for (unsigned i = 0; i < stringsM.size(); ++i)
+    {
+        appendBits(data, stringsLoadedM[i], first, count);
+        std::vector<uint32_t> lengths(count);
+        for (unsigned r = 0; r < count; ++r)
+            lengths[r] = stringsM[i][first + r].length;
+        const char* p = (const char*)&lengths[0];
+        data.insert(data.end(), p, p + count * sizeof(uint32_t));
+        for (unsigned r = 0; r < count; ++r)
+        {
+            const StringRef& ref = stringsM[i][first + r];
+            if (ref.length)
+            {
+                const char* text = &chunksM[ref.chunk][ref.offset];
+                data.insert(data.end(), text, text + ref.length);
+            }
+        }
+    }
+    for (unsigned i = 0; i < blobsM.size(); ++i)
+    {
+        std::vector<uint64_t> ids(count, 0);
+        for (unsigned r = 0; r < count; ++r)
+        {
+            IBPP::Blob& blob = blobsM[i][first + r];
+            if (blob == 0)
+                continue;
+            if (blobDatabaseM == 0)
+            {
+                blobDatabaseM = blob->DatabasePtr();
+                blobTransactionM = blob->TransactionPtr();
+            }
+            try
+            {
+                ids[r] = blob->Id();
+            }
+            catch (IBPP::Exception&)
+            {
+                // a new blob that was never written has no data anyway
+            }
+        }
+        const char* p = (const char*)&ids[0];
+        data.insert(data.end(), p, p + count * sizeof(uint64_t));
+    }
+}
+
+void DataGridColumnStore::readBlock(const std::vector<char>& data,
+    unsigned count)
+{
+    addRows(count);
+    size_t pos = 0;
+    for (std::vector<FixedColumn>::iterator it = fixedColumnsM.begin();
+        it != fixedColumnsM.end(); ++it)
+    {
+        size_t size = count * (*it).width;
+        std::copy(data.begin() + pos, data.begin() + pos + size,
+            (*it).data.begin());
+        pos += size;
+    }
+    for (unsigned i = 0; i < nullsM.size(); ++i)
+        pos = readBits(data, pos, nullsM[i], count);
+    for (unsigned i = 0; i < stringsM.size(); ++i)
+    {
+        std::vector<bool> loaded(count);
+        pos = readBits(data, pos, loaded, count);
+        std::vector<uint32_t> lengths(count);
+        std::copy(data.begin() + pos,
+            data.begin() + pos + count * sizeof(uint32_t),
+            (char*)&lengths[0]);
+        pos += count * sizeof(uint32_t);
+        for (unsigned r = 0; r < count; ++r)
+        {
+            if (lengths[r])
+                storeString(r, i, &data[pos], lengths[r]);
+            pos += lengths[r];
+        }
+        stringsLoadedM[i] = loaded;
+    }
+    blobIdsM.resize(blobsM.size());
+    for (unsigned i = 0; i < blobsM.size(); ++i)
+    {
+        blobIdsM[i].resize(count);
+        std::copy(data.begin() + pos,
+            data.begin() + pos + count * sizeof(uint64_t),
+            (char*)&blobIdsM[i][0]);
+        pos += count * sizeof(uint64_t);
+    }
+}
+
+void DataGridColumnStore::spill(unsigned count)
+{
+    if (!spillFileM)
+    {
+        spillFileNameM = wxFileName::CreateTempFileName("frgrid");
+        if (!spillFileNameM.empty())
+            spillFileM = new wxFile(spillFileNameM, wxFile::read_write);
+        if (!spillFileM || !spillFileM->IsOpened())
+        {
+            closeSpillFile();
+            throw FRError(
+                _("Could not create a temporary file for the fetched rows."));
+        }
+    }
+
+    // nothing changes unless all blocks could be written
+    std::vector<SpilledBlock> blocks;
+    wxFileOffset offset = spillFileSizeM;
+    std::vector<char> data;
+    for (unsigned first = 0; first < count; first += spillBlockRows)
+    {
+        data.clear();
+        writeBlock(data, first, spillBlockRows);
+        if (spillFileM->Seek(offset) == wxInvalidOffset
+            || spillFileM->Write(&data[0], data.size()) != data.size())
+        {
+            throw FRError(
+                _("Could not write the fetched rows to the temporary file."));
+        }
+        SpilledBlock sb;
+        sb.offset = offset;
+        sb.size = data.size();
+        blocks.push_back(sb);
+        offset += data.size();
+    }
+    spilledBlocksM.insert(spilledBlocksM.end(), blocks.begin(), blocks.end());
+    spillFileSizeM = offset;
+
+    eraseRows(count);
+    spilledRowsM += count;
+    compactStrings();
+    for (std::vector<FixedColumn>::iterator it = fixedColumnsM.begin();
+        it != fixedColumnsM.end(); ++it)
+    {
+        (*it).data.shrink_to_fit();
+    }
+    for (unsigned i = 0; i < nullsM.size(); ++i)
+        nullsM[i].shrink_to_fit();
+    for (unsigned i = 0; i < stringsM.size(); ++i)
+    {
+        stringsM[i].shrink_to_fit();
+        stringsLoadedM[i].shrink_to_fit();
+    }
+    for (unsigned i = 0; i < blobsM.size(); ++i)
+        blobsM[i].shrink_to_fit();
+}
+
+DataGridColumnStore* DataGridColumnStore::getSpilledBlock(unsigned& row)
+{
+    if (row >= spilledRowsM)
+    {
+        row -= spilledRowsM;
+        return 0;
+    }
+    const unsigned block = row / spillBlockRows;
+    row %= spillBlockRows;
+    for (unsigned i = 0; i < loadedBlocksM.size(); ++i)
+    {
+        if (loadedBlocksM[i].block == block)
+            return loadedBlocksM[i].rows;
+    }
+
+    const SpilledBlock& sb = spilledBlocksM[block];
+    std::vector<char> data(sb.size);
+    if (spillFileM->Seek(sb.offset) == wxInvalidOffset
+        || spillFileM->Read(&data[0], sb.size) != ssize_t(sb.size))
+    {
+        throw FRError(
+            _("Could not read the fetched rows from the temporary file."));
+    }
+    DataGridColumnStore* rows = new DataGridColumnStore();
+    for (std::vector<FixedColumn>::iterator it = fixedColumnsM.begin();
+        it != fixedColumnsM.end(); ++it)
+    {
+        rows->addFixedColumn((*it).offset, (*it).width);
+    }
+    rows->initialize(nullsM.size(), stringsM.size(), blobsM.size());
+    rows->blobDatabaseM = blobDatabaseM;
+    rows->blobTransactionM = blobTransactionM;
+    rows->readBlock(data, spillBlockRows);
+
+    LoadedBlock lb;
+    lb.block = block;
+    lb.rows = rows;
+    if (loadedBlocksM.size() < loadedBlockCount)
+        loadedBlocksM.push_back(lb);
+    else
+    {
+        // replace the blocks in turn
+        delete loadedBlocksM[nextLoadedBlockM].rows;
+        loadedBlocksM[nextLoadedBlockM] = lb;
+        nextLoadedBlockM = (nextLoadedBlockM + 1) % loadedBlockCount;
+    }
+    return rows;
+}
+
+// copies the strings of the rows in memory to new chunks, dropping the
+// text of the spilled rows and of overwritten strings; the old chunks are
+// copied one after the other, and each is released once it is done, so
+// that only about one chunk more than the strings need is allocated
+void DataGridColumnStore::compactStrings()
+{
+    std::vector<std::vector<char> > chunks;
+    chunks.swap(chunksM);
+    stringCacheM.clear();
+
+    // the strings in use, as (index, row) pairs ordered by their old chunk
+    std::vector<unsigned> chunkStart(chunks.size() + 1, 0);
+    for (unsigned i = 0; i < stringsM.size(); ++i)
+    {
+        for (unsigned r = 0; r < stringsM[i].size(); ++r)
+        {
+            if (stringsM[i][r].length)
+                ++chunkStart[stringsM[i][r].chunk + 1];
+        }
+    }
+    for (unsigned c = 0; c < chunks.size(); ++c)
+        chunkStart[c + 1] += chunkStart[c];
+    std::vector<std::pair<unsigned, unsigned> > used(chunkStart.back());
+    std::vector<unsigned> next(chunkStart.begin(), chunkStart.end() - 1);
+    for (unsigned i = 0; i < stringsM.size(); ++i)
+    {
+        for (unsigned r = 0; r < stringsM[i].size(); ++r)
+        {
+            if (stringsM[i][r].length)
+                used[next[stringsM[i][r].chunk]++] = std::make_pair(i, r);
+        }
+    }
+
+    for (unsigned c = 0; c < chunks.size(); ++c)
+    {
+        for (unsigned u = chunkStart[c]; u < chunkStart[c + 1]; ++u)
+        {
+            unsigned i = used[u].first;
+            unsigned r = used[u].second;
+            StringRef ref = stringsM[i][r];
+            bool loaded = stringsLoadedM[i][r];
+            storeString(r, i, &chunks[c][ref.offset], ref.length);
+            stringsLoadedM[i][r] = loaded;
+        }
+        std::vector<char>().swap(chunks[c]);
+    }
+}
+
+void DataGridColumnStore::storeString(unsigned row, unsigned index,
+    const char* utf8, unsigned length)
+{
+    StringRef ref;
+    if (length)
+    {
+        // strings never span chunks, long ones get a chunk of their own
+        const size_t chunkSize = 1024 * 1024;
+        if (chunksM.empty()
+            || chunksM.back().size() + length > chunksM.back().capacity())
+        {
+            chunksM.push_back(std::vector<char>());
+            chunksM.back().reserve(std::max(chunkSize, size_t(length)));
+        }
+        std::vector<char>& chunk = chunksM.back();
+        ref.chunk = chunksM.size() - 1;
+        ref.offset = chunk.size();
+        ref.length = length;
+        chunk.insert(chunk.end(), utf8, utf8 + length);
+    }
+    stringsM[index][row] = ref;
+    stringsLoadedM[index][row] = true;
+
+    CachedString& cached = getCachedString(row, index);
+    if (cached.row == row && cached.index == index)
+        cached.row = unsigned(-1);
+}
+
+bool DataGridColumnStore::isFieldNull(unsigned row, unsigned num)
+{
+    if (DataGridColumnStore* block = getSpilledBlock(row))
+        return block->isFieldNull(row, num);
+    return (num < nullsM.size() && row < nullsM[num].size()
+        && nullsM[num][row]);
+}
+
+void DataGridColumnStore::setFieldNull(unsigned row, unsigned num,
+    bool isNull)
+{
+    if (DataGridColumnStore* block = getSpilledBlock(row))
+        block->setFieldNull(row, num, isNull);
+    else if (num < nullsM.size() && row < nullsM[num].size())
+        nullsM[num][row] = isNull;
+}
+
+wxString DataGridColumnStore::getString(unsigned row, unsigned index)
+{
+    if (DataGridColumnStore* block = getSpilledBlock(row))
+        return block->getString(row, index);
+    if (index >= stringsM.size() || row >= stringsM[index].size())
+        return wxEmptyString;
+    const StringRef& ref = stringsM[index][row];
+    if (ref.length == 0)
+        return wxEmptyString;
+
+    CachedString& cached = getCachedString(row, index);
+    if (cached.row != row || cached.index != index)
+    {
+        cached.row = row;
+        cached.index = index;
+        cached.value = wxString(&chunksM[ref.chunk][ref.offset], wxConvUTF8,
+            ref.length);
+    }
+    return cached.value;
+}
+
+void DataGridColumnStore::setString(unsigned row, unsigned index,
+    const wxString& value)
+{
+    if (DataGridColumnStore* block = getSpilledBlock(row))
+    {
+        block->setString(row, index, value);
+        return;
+    }
+    if (index >= stringsM.size() || row >= stringsM[index].size())
+        return;
+    std::string utf8(wx2std(value, &wxConvUTF8));
+    storeString(row, index, utf8.data(), utf8.length());
+}
+
+bool DataGridColumnStore::isStringLoaded(unsigned row, unsigned index)
+{
+    if (DataGridColumnStore* block = getSpilledBlock(row))
+        return block->isStringLoaded(row, index);
+    return (index < stringsLoadedM.size()
+        && row < stringsLoadedM[index].size() && stringsLoadedM[index][row]);
+}
+
+void DataGridColumnStore::setStringLoaded(unsigned row, unsigned index,
+    bool isLoaded)
+{
+    if (DataGridColumnStore* block = getSpilledBlock(row))
+        block->setStringLoaded(row, index, isLoaded);
+    else if (index < stringsLoadedM.size()
+        && row < stringsLoadedM[index].size())
+    {
+        stringsLoadedM[index][row] = isLoaded;
+    }
+}
+
+IBPP::Blob& DataGridColumnStore::getBlobAt(unsigned row, unsigned index)
+{
+    IBPP::Blob& blob = blobsM[index][row];
+    if (blob == 0 && index < blobIdsM.size() && blobIdsM[index][row] != 0)
+    {
+        blob = IBPP::BlobFactory(blobDatabaseM, blobTransactionM);
+        blob->SetId(blobIdsM[index][row]);
+    }
+    return blob;
+}
+
+IBPP::Blob* DataGridColumnStore::getBlob(unsigned row, unsigned index)
+{
+    if (index >= blobsM.size() || row >= rowCountM)
+        return 0;
+    if (DataGridColumnStore* block = getSpilledBlock(row))
+        return block->getBlob(row, index);
+    return &getBlobAt(row, index);
+}
+
+void DataGridColumnStore::setBlob(unsigned row, unsigned index,
+    IBPP::Blob value)
+{
+    if (index >= blobsM.size() || row >= rowCountM)
+        return;
+    if (DataGridColumnStore* block = getSpilledBlock(row))
+        block->setBlob(row, index, value);
+    else
+        blobsM[index][row] = value;
+}
+
+bool DataGridColumnStore::getValue(unsigned row, unsigned offset,
+    IBPP::DBKey& value, unsigned size)
+{
+    if (DataGridColumnStore* block = getSpilledBlock(row))
+        return block->getValue(row, offset, value, size);
+    uint8_t* data = getData(row, offset, size);
+    if (!data)
+        return false;
+    value.SetKey(data, size);
+    return true;
+}
+
+void DataGridColumnStore::setValue(unsigned row, unsigned offset,
+    IBPP::DBKey value)
+{
+    if (DataGridColumnStore* block = getSpilledBlock(row))
+        block->setValue(row, offset, value);
+    else if (uint8_t* data = getData(row, offset, value.Size()))
+        value.GetKey(data, value.Size());
+}
+
+ColumnStoreRowBuffer::ColumnStoreRowBuffer(DataGridColumnStore& store,
+        unsigned row)
+    :DataGridRowBuffer(0u), storeM(store), rowM(row)
+{
+}
+
+wxString ColumnStoreRowBuffer::getString(unsigned index)
+{
+    return storeM.getString(rowM, index);
+}
+
+IBPP::Blob* ColumnStoreRowBuffer::getBlob(unsigned index)
+{
+    return storeM.getBlob(rowM, index);
+}
+
+bool ColumnStoreRowBuffer::getValue(unsigned offset, double& value)
+{
+    return storeM.getValue(rowM, offset, value);
+}
+
+bool ColumnStoreRowBuffer::getValue(unsigned offset, float& value)
+{
+    return storeM.getValue(rowM, offset, value);
+}
+
+bool ColumnStoreRowBuffer::getValue(unsigned offset, int& value)
+{
+    return storeM.getValue(rowM, offset, value);
+}
+
+bool ColumnStoreRowBuffer::getValue(unsigned offset, int64_t& value)
+{
+    return storeM.getValue(rowM, offset, value);
+}
+
+bool ColumnStoreRowBuffer::getValue(unsigned offset, IBPP::DBKey& value,
+    unsigned size)
+{
+    return storeM.getValue(rowM, offset, value, size);
+}
+
+bool ColumnStoreRowBuffer::getValue(unsigned offset, IBPP::Int128& value)
+{
+    return storeM.getValue(rowM, offset, value);
+}
+
+bool ColumnStoreRowBuffer::getValue(unsigned offset, IBPP::DecFloat& value)
+{
+    return storeM.getValue(rowM, offset, value);
+}
+
+bool ColumnStoreRowBuffer::isFieldNull(unsigned num)
+{
+    return storeM.isFieldNull(rowM, num);
+}
+
+void ColumnStoreRowBuffer::setFieldNull(unsigned num, bool isNull)
+{
+    storeM.setFieldNull(rowM, num, isNull);
+}
+
+bool ColumnStoreRowBuffer::isStringLoaded(unsigned num)
+{
+    return storeM.isStringLoaded(rowM, num);
+}
+
+void ColumnStoreRowBuffer::setStringLoaded(unsigned num, bool isLoaded)
+{
+    storeM.setStringLoaded(rowM, num, isLoaded);
+}
+
+void ColumnStoreRowBuffer::setString(unsigned num, const wxString& value)
+{
+    storeM.setString(rowM, num, value);
+}
+
+void ColumnStoreRowBuffer::setBlob(unsigned num, IBPP::Blob value)
+{
+    storeM.setBlob(rowM, num, value);
+}
+
+void ColumnStoreRowBuffer::setValue(unsigned offset, double value)
+{
+    storeM.setValue(rowM, offset, value);
+}
+
+void ColumnStoreRowBuffer::setValue(unsigned offset, float value)
+{
+    storeM.setValue(rowM, offset, value);
+}
+
+void ColumnStoreRowBuffer::setValue(unsigned offset, int value)
+{
+    storeM.setValue(rowM, offset, value);
+}
+
+void ColumnStoreRowBuffer::setValue(unsigned offset, int64_t value)
+{
+    storeM.setValue(rowM, offset, value);
+}
+
+void ColumnStoreRowBuffer::setValue(unsigned offset, IBPP::DBKey value)
+{
+    storeM.setValue(rowM, offset, value);
+}
+
+void ColumnStoreRowBuffer::setValue(unsigned offset,
+    const IBPP::Int128& value)
+{
+    storeM.setValue(rowM, offset, value);
+}
+
+void ColumnStoreRowBuffer::setValue(unsigned offset,
+    const IBPP::DecFloat& value)
+{
+    storeM.setValue(rowM, offset, value);
+}
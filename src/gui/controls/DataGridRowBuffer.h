@@ -24,6 +24,8 @@
 #ifndef FR_DATAGRIDROWBUFFER_H
 #define FR_DATAGRIDROWBUFFER_H
 
+#include <wx/file.h>
+
 #include <ibpp.h>
 
 
@@ -39,6 +41,8 @@ struct DataGridRowBufferFieldAttr
     int isStringLoaded:1;  // accessed by stringIndexM !!
 };
 
+class DataGridColumnStore;
+
 // DataGridRowBuffer class
 class DataGridRowBuffer
 {
@@ -48,6 +52,8 @@ private:
     int isDeletedM:1;
     int isDeletableIsSetM:1;
     int isDeletableM:1;
+    // fills a buffer from a row of the column store
+    friend class DataGridColumnStore;
 protected:
     std::vector<DataGridRowBufferFieldAttr> fieldAttrM;
     std::vector<uint8_t> dataM;
@@ -60,26 +66,30 @@ public:
     DataGridRowBuffer(const DataGridRowBuffer* other);
     virtual ~DataGridRowBuffer() {}
 
-    wxString getString(unsigned index);
-    IBPP::Blob *getBlob(unsigned index);
-    bool getValue(unsigned offset, double& value);
-    bool getValue(unsigned offset, float& value);
-    bool getValue(unsigned offset, int& value);
-    bool getValue(unsigned offset, int64_t& value);
-    bool getValue(unsigned offset, IBPP::DBKey& value, unsigned size);
-    bool isFieldNull(unsigned num);
-    void setFieldNull(unsigned num, bool isNull);
+    virtual wxString getString(unsigned index);
+    virtual IBPP::Blob *getBlob(unsigned index);
+    virtual bool getValue(unsigned offset, double& value);
+    virtual bool getValue(unsigned offset, float& value);
+    virtual bool getValue(unsigned offset, int& value);
+    virtual bool getValue(unsigned offset, int64_t& value);
+    virtual bool getValue(unsigned offset, IBPP::DBKey& value, unsigned size);
+    virtual bool getValue(unsigned offset, IBPP::Int128& value);
+    virtual bool getValue(unsigned offset, IBPP::DecFloat& value);
+    virtual bool isFieldNull(unsigned num);
+    virtual void setFieldNull(unsigned num, bool isNull);
     virtual bool isFieldNA(unsigned num);
     virtual void setFieldNA(unsigned num, bool isNA);
-    bool isStringLoaded(unsigned num);
-    void setStringLoaded(unsigned num, bool isLoaded);
-    void setString(unsigned num, const wxString& value);
-    void setBlob(unsigned num, IBPP::Blob b);
-    void setValue(unsigned offset, double value);
-    void setValue(unsigned offset, float value);
-    void setValue(unsigned offset, int value);
-    void setValue(unsigned offset, int64_t value);
-    void setValue(unsigned offset, IBPP::DBKey value);
+    virtual bool isStringLoaded(unsigned num);
+    virtual void setStringLoaded(unsigned num, bool isLoaded);
+    virtual void setString(unsigned num, const wxString& value);
+    virtual void setBlob(unsigned num, IBPP::Blob b);
+    virtual void setValue(unsigned offset, double value);
+    virtual void setValue(unsigned offset, float value);
+    virtual void setValue(unsigned offset, int value);
+    virtual void setValue(unsigned offset, int64_t value);
+    virtual void setValue(unsigned offset, IBPP::DBKey value);
+    virtual void setValue(unsigned offset, const IBPP::Int128& value);
+    virtual void setValue(unsigned offset, const IBPP::DecFloat& value);
 
     virtual bool isInserted();
     bool isFieldModified(unsigned num);
@@ -105,4 +115,197 @@ public:
     virtual void setFieldNA(unsigned num, bool isNA);
 };
 
+// DataGridColumnStore class
+// Holds the rows fetched from the database column by column: fixed width
+// values in one array per column, strings and blobs in one array per index,
+// and NULL flags in bitmaps.  There are no per row allocations at all.
+// Strings are kept UTF-8 encoded in large chunks, and only converted to
+// wxString (four bytes per character on most platforms) when they are used.
+// The offsets and indices are the ones the ResultsetColumnDefs use for a
+// DataGridRowBuffer, a ColumnStoreRowBuffer gives them access to a row.
+// When a memory limit is set the oldest rows are spilled to a temporary
+// file in blocks, and read back into a few cached blocks when needed.
+class DataGridColumnStore
+{
+private:
+    struct FixedColumn
+    {
+        unsigned offset;    // of the column in a DataGridRowBuffer
+        unsigned width;
+        std::vector<uint8_t> data;
+    };
+    std::vector<FixedColumn> fixedColumnsM;
+    std::vector<unsigned> fixedColumnAtM;   // buffer offset -> fixed column
+    std::vector<std::vector<bool> > nullsM;
+
+    struct StringRef
+    {
+        unsigned chunk;
+        unsigned offset;
+        unsigned length;
+        StringRef() : chunk(0), offset(0), length(0) {}
+    };
+    std::vector<std::vector<StringRef> > stringsM;
+    std::vector<std::vector<bool> > stringsLoadedM;
+    // overwritten strings stay in their chunk until all rows are gone
+    // or the strings are compacted after spilling
+    std::vector<std::vector<char> > chunksM;
+    // the converted strings of the most recently used cells, which mostly
+    // are the visible ones, as the grid asks for them over and over again
+    struct CachedString
+    {
+        unsigned row;
+        unsigned index;
+        wxString value;
+        CachedString() : row(unsigned(-1)), index(0) {}
+    };
+    std::vector<CachedString> stringCacheM;
+    CachedString& getCachedString(unsigned row, unsigned index);
+    void clearStrings();
+    void compactStrings();
+    void storeString(unsigned row, unsigned index, const char* utf8,
+        unsigned length);
+    // of the blobs only the ids are spilled; a block read back keeps them
+    // in blobIdsM (0 for none) and creates the handles when they are used,
+    // for the attachment and transaction of the spilled ones
+    std::vector<std::vector<IBPP::Blob> > blobsM;
+    std::vector<std::vector<uint64_t> > blobIdsM;
+    IBPP::Database blobDatabaseM;
+    IBPP::Transaction blobTransactionM;
+    IBPP::Blob& getBlobAt(unsigned row, unsigned index);
+    unsigned bufferSizeM;
+    unsigned rowCountM;
+
+    // the first spilledRowsM rows are in the spill file, in blocks of
+    // spillBlockRows rows, all others are held in the arrays above
+    size_t memoryLimitM;
+    unsigned spilledRowsM;
+    wxString spillFileNameM;
+    wxFile* spillFileM;
+    wxFileOffset spillFileSizeM;
+    struct SpilledBlock
+    {
+        wxFileOffset offset;
+        size_t size;
+    };
+    std::vector<SpilledBlock> spilledBlocksM;
+    struct LoadedBlock
+    {
+        unsigned block;
+        DataGridColumnStore* rows;
+    };
+    std::vector<LoadedBlock> loadedBlocksM;
+    unsigned nextLoadedBlockM;
+
+    // for spilled rows, returns the store holding the block of the row
+    // and adjusts row to it, otherwise row is made an index into the arrays
+    DataGridColumnStore* getSpilledBlock(unsigned& row);
+    void closeSpillFile();
+    void eraseRows(unsigned count);
+    void writeBlock(std::vector<char>& data, unsigned first, unsigned count);
+    void readBlock(const std::vector<char>& data, unsigned count);
+    void spill(unsigned count);
+
+    uint8_t* getData(unsigned row, unsigned offset, unsigned size);
+
+    // not copyable
+    DataGridColumnStore(const DataGridColumnStore&);
+    DataGridColumnStore& operator=(const DataGridColumnStore&);
+public:
+    DataGridColumnStore();
+    ~DataGridColumnStore();
+
+    void clear();
+    // the fixed columns are added first, rows only after initialize()
+    void initialize(unsigned fieldCount, unsigned stringCount,
+        unsigned blobCount);
+    void addFixedColumn(unsigned offset, unsigned width);
+
+    // appends count rows with all fields NULL, returns the first new row
+    unsigned addRows(unsigned count);
+    // removes the rows from rowCount on, which must not be spilled yet
+    void truncate(unsigned rowCount);
+    unsigned getRowCount() const { return rowCountM; }
+    // fills an (empty) buffer with the values of a row
+    void copyRow(unsigned row, DataGridRowBuffer& buffer);
+
+    // 0 keeps all rows in memory
+    void setMemoryLimit(size_t bytes);
+    // spills the oldest rows if the memory limit is exceeded, to be called
+    // after complete rows have been added
+    void checkMemoryLimit();
+    size_t getResidentSize() const;
+    size_t getSpilledSize() const;
+
+    bool isFieldNull(unsigned row, unsigned num);
+    void setFieldNull(unsigned row, unsigned num, bool isNull);
+    wxString getString(unsigned row, unsigned index);
+    void setString(unsigned row, unsigned index, const wxString& value);
+    bool isStringLoaded(unsigned row, unsigned index);
+    void setStringLoaded(unsigned row, unsigned index, bool isLoaded);
+    IBPP::Blob* getBlob(unsigned row, unsigned index);
+    void setBlob(unsigned row, unsigned index, IBPP::Blob value);
+    bool getValue(unsigned row, unsigned offset, IBPP::DBKey& value,
+        unsigned size);
+    void setValue(unsigned row, unsigned offset, IBPP::DBKey value);
+
+    template<typename T>
+    bool getValue(unsigned row, unsigned offset, T& value)
+    {
+        if (DataGridColumnStore* block = getSpilledBlock(row))
+            return block->getValue(row, offset, value);
+        uint8_t* data = getData(row, offset, sizeof(T));
+        if (!data)
+            return false;
+        value = *((T*)data);
+        return true;
+    }
+
+    // changes to spilled rows only last while their block is loaded
+    template<typename T>
+    void setValue(unsigned row, unsigned offset, const T& value)
+    {
+        if (DataGridColumnStore* block = getSpilledBlock(row))
+            block->setValue(row, offset, value);
+        else if (uint8_t* data = getData(row, offset, sizeof(T)))
+            *((T*)data) = value;
+    }
+};
+
+// class to access a row of DataGridColumnStore like any other buffer,
+// it is created on the stack whenever a column definition needs one
+class ColumnStoreRowBuffer: public DataGridRowBuffer
+{
+private:
+    DataGridColumnStore& storeM;
+    unsigned rowM;
+public:
+    ColumnStoreRowBuffer(DataGridColumnStore& store, unsigned row);
+
+    unsigned getRow() const { return rowM; }
+
+    virtual wxString getString(unsigned index);
+    virtual IBPP::Blob *getBlob(unsigned index);
+    virtual bool getValue(unsigned offset, double& value);
+    virtual bool getValue(unsigned offset, float& value);
+    virtual bool getValue(unsigned offset, int& value);
+    virtual bool getValue(unsigned offset, int64_t& value);
+    virtual bool getValue(unsigned offset, IBPP::DBKey& value, unsigned size);
+    virtual bool getValue(unsigned offset, IBPP::Int128& value);
+    virtual bool getValue(unsigned offset, IBPP::DecFloat& value);
+    virtual bool isFieldNull(unsigned num);
+    virtual void setFieldNull(unsigned num, bool isNull);
+    virtual bool isStringLoaded(unsigned num);
+    virtual void setStringLoaded(unsigned num, bool isLoaded);
+    virtual void setString(unsigned num, const wxString& value);
+    virtual void setBlob(unsigned num, IBPP::Blob b);
+    virtual void setValue(unsigned offset, double value);
+    virtual void setValue(unsigned offset, float value);
+    virtual void setValue(unsigned offset, int value);
+    virtual void setValue(unsigned offset, int64_t value);
+    virtual void setValue(unsigned offset, IBPP::DBKey value);
+    virtual void setValue(unsigned offset, const IBPP::Int128& value);
+    virtual void setValue(unsigned offset, const IBPP::DecFloat& value);
+};
+
 #endif
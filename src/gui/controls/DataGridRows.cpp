@@ -36,6 +36,9 @@
 
 #include <algorithm>
 #include <bitset>
+#include <climits>
+#include <cmath>
+#include <cstdio>
 #include <string>
 
 #include "config/Config.h"
@@ -43,12 +46,21 @@
 #include "core/Observer.h"
 #include "core/ProgressIndicator.h"
 #include "core/StringUtils.h"
+#include "gui/controls/DataGridCellFormat.h"
 #include "gui/controls/DataGridRowBuffer.h"
 #include "gui/controls/DataGridRows.h"
 #include "metadata/column.h"
 #include "metadata/database.h"
 #include "metadata/table.h"
 
+static wxString formatInteger(int64_t value)
+{
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* start = writeDecimal(end, value);
+    return wxString::FromAscii(start, end - start);
+}
+
 // GridCellFormats: class to cache config data for cell formatting
 class GridCellFormats: public ConfigCache
 {
@@ -60,6 +72,15 @@ private:
     bool showBlobContentM;
     wxString timeFormatM;
     wxString timestampFormatM;
+    // the date, time and timestamp formats are compiled, so the format
+    // strings aren't interpreted for every cell
+    DataGridCellFormat dateProgramM;
+    DataGridCellFormat timeProgramM;
+    DataGridCellFormat timestampProgramM;
+    unsigned generationM;
+
+    static wxString runFormat(const DataGridCellFormat& program,
+        const int* values);
 protected:
     virtual void loadFromConfig();
 public:
@@ -67,6 +88,10 @@ public:
 
     static GridCellFormats& get();
 
+    // changes whenever the settings are reloaded, so values formatted with
+    // older settings can be told apart
+    unsigned getGeneration();
+
     template<typename T>
     wxString format(T value);
     wxString formatDate(int year, int month, int day);
@@ -85,10 +110,21 @@ public:
 };
 
 GridCellFormats::GridCellFormats()
-    : ConfigCache(config())
+    : ConfigCache(config()), generationM(0)
 {
 }
 
+wxString GridCellFormats::runFormat(const DataGridCellFormat& program,
+    const int* values)
+{
+    std::string result;
+    result.reserve(32);
+    program.run(values, result);
+    if (program.isAscii())
+        return wxString::FromAscii(result.data(), result.size());
+    return wxString::FromUTF8(result.data(), result.size());
+}
+
 GridCellFormats& GridCellFormats::get()
 {
     static GridCellFormats gcf;
@@ -105,10 +141,23 @@ void GridCellFormats::loadFromConfig()
     timeFormatM = config().get("TimeFormat", wxString("H:M:S.T"));
     timestampFormatM = config().get("TimestampFormat",
         wxString("D.N.Y, H:M:S.T"));
+    dateProgramM.compile(std::string(dateFormatM.utf8_str()),
+        DataGridCellFormat::dateLetters());
+    timeProgramM.compile(std::string(timeFormatM.utf8_str()),
+        DataGridCellFormat::timeLetters());
+    timestampProgramM.compile(std::string(timestampFormatM.utf8_str()),
+        DataGridCellFormat::timestampLetters());
 
     maxBlobKBytesM = config().get("DataGridFetchBlobAmount", 1);
     showBinaryBlobContentM = config().get("GridShowBinaryBlobs", false);
     showBlobContentM = config().get("DataGridFetchBlobs", true);
+    ++generationM;
+}
+
+unsigned GridCellFormats::getGeneration()
+{
+    ensureCacheValid();
+    return generationM;
 }
 
 template<typename T>
@@ -116,45 +165,25 @@ wxString GridCellFormats::format(T value)
 {
     ensureCacheValid();
 
+    int precision = 6;
     if (floatingPointPrecisionM >= 0 && floatingPointPrecisionM <= 18)
-        return wxString::Format("%.*f", floatingPointPrecisionM, value);
-    return wxString::Format("%f", value);
+        precision = floatingPointPrecisionM;
+    // huge values don't fit, they are rare enough to use the slow path
+    char buffer[128];
+    int len = snprintf(buffer, sizeof(buffer), "%.*f", precision,
+        double(value));
+    if (len < 0 || len >= int(sizeof(buffer)))
+        return wxString::Format("%.*f", precision, value);
+    return wxString::FromAscii(buffer, len);
 }
 
 wxString GridCellFormats::formatDate(int year, int month, int day)
 {
     ensureCacheValid();
 
-    wxString result;
-    for (wxString::const_iterator c = dateFormatM.begin();
-        c != dateFormatM.end(); c++)
-    {
-        switch (wxChar(*c))
-        {
-            case 'd':
-                result += wxString::Format("%d", day);
-                break;
-            case 'D':
-                result += wxString::Format("%02d", day);
-                break;
-            case 'm':
-                result += wxString::Format("%d", month);
-                break;
-            case 'M':
-                result += wxString::Format("%02d", month);
-                break;
-            case 'y':
-                result += wxString::Format("%02d", year % 100);
-                break;
-            case 'Y':
-                result += wxString::Format("%04d", year);
-                break;
-            default:
-                result += *c;
-                break;
-        }
-    }
-    return result;
+    int values[DataGridCellFormat::ffCount] = { year, year % 100, month,
+        day, 0, 0, 0, 0 };
+    return runFormat(dateProgramM, values);
 }
 
 bool getNumber(wxString::iterator& ci, int& toSet)
@@ -242,39 +271,9 @@ wxString GridCellFormats::formatTime(int hour, int minute, int second,
 {
     ensureCacheValid();
 
-    wxString result;
-    for (wxString::iterator c = timeFormatM.begin(); c != timeFormatM.end();
-        c++)
-    {
-        switch ((wxChar)*c)
-        {
-            case 'h':
-                result += wxString::Format("%d", hour);
-                break;
-            case 'H':
-                result += wxString::Format("%02d", hour);
-                break;
-            case 'm':
-                result += wxString::Format("%d", minute);
-                break;
-            case 'M':
-                result += wxString::Format("%02d", minute);
-                break;
-            case 's':
-                result += wxString::Format("%d", second);
-                break;
-            case 'S':
-                result += wxString::Format("%02d", second);
-                break;
-            case 'T':
-                result += wxString::Format("%03d", milliSecond);
-                break;
-            default:
-                result += *c;
-                break;
-        }
-    }
-    return result;
+    int values[DataGridCellFormat::ffCount] = { 0, 0, 0, 0, hour, minute,
+        second, milliSecond };
+    return runFormat(timeProgramM, values);
 }
 
 int GridCellFormats::maxBlobBytesToFetch()
@@ -327,57 +326,9 @@ wxString GridCellFormats::formatTimestamp(int year, int month, int day,
 {
     ensureCacheValid();
 
-    wxString result;
-    for (wxString::iterator c = timestampFormatM.begin();
-        c != timestampFormatM.end(); c++)
-    {
-        switch ((wxChar)*c)
-        {
-            case 'd':
-                result += wxString::Format("%d", day);
-                break;
-            case 'D':
-                result += wxString::Format("%02d", day);
-                break;
-            case 'n':
-                result += wxString::Format("%d", month);
-                break;
-            case 'N':
-                result += wxString::Format("%02d", month);
-                break;
-            case 'y':
-                result += wxString::Format("%02d", year % 100);
-                break;
-            case 'Y':
-                result += wxString::Format("%04d", year);
-                break;
-            case 'h':
-                result += wxString::Format("%d", hour);
-                break;
-            case 'H':
-                result += wxString::Format("%02d", hour);
-                break;
-            case 'm':
-                result += wxString::Format("%d", minute);
-                break;
-            case 'M':
-                result += wxString::Format("%02d", minute);
-                break;
-            case 's':
-                result += wxString::Format("%d", second);
-                break;
-            case 'S':
-                result += wxString::Format("%02d", second);
-                break;
-            case 'T':
-                result += wxString::Format("%03d", milliSecond);
-                break;
-            default:
-                result += *c;
-                break;
-        }
-    }
-    return result;
+    int values[DataGridCellFormat::ffCount] = { year, year % 100, month,
+        day, hour, minute, second, milliSecond };
+    return runFormat(timestampProgramM, values);
 }
 
 bool GridCellFormats::parseTimestamp(wxString::iterator& start,
@@ -491,6 +442,12 @@ wxString ResultsetColumnDef::getAsFirebirdString(DataGridRowBuffer* buffer)
     return getAsString(buffer);
 }
 
+bool ResultsetColumnDef::getAsDouble(DataGridRowBuffer* /*buffer*/,
+    double& /*value*/)
+{
+    return false;
+}
+
 wxString ResultsetColumnDef::getName()
 {
     return nameM;
@@ -563,6 +520,7 @@ public:
     IntegerColumnDef(const wxString& name, unsigned offset, bool readOnly,
         bool nullable);
     virtual wxString getAsString(DataGridRowBuffer* buffer);
+    virtual bool getAsDouble(DataGridRowBuffer* buffer, double& value);
     virtual unsigned getBufferSize();
     virtual bool isNumeric();
     virtual void setValue(DataGridRowBuffer* buffer, unsigned col,
@@ -583,7 +541,17 @@ wxString IntegerColumnDef::getAsString(DataGridRowBuffer* buffer)
     int value;
     if (!buffer->getValue(offsetM, value))
         return wxEmptyString;
-    return wxString::Format("%d", value);
+    return formatInteger(value);
+}
+
+bool IntegerColumnDef::getAsDouble(DataGridRowBuffer* buffer, double& value)
+{
+    wxASSERT(buffer);
+    int i;
+    if (!buffer->getValue(offsetM, i))
+        return false;
+    value = i;
+    return true;
 }
 
 void IntegerColumnDef::setFromString(DataGridRowBuffer* buffer,
@@ -624,6 +592,7 @@ public:
     Int64ColumnDef(const wxString& name, unsigned offset, bool readOnly,
         bool nullable);
     virtual wxString getAsString(DataGridRowBuffer* buffer);
+    virtual bool getAsDouble(DataGridRowBuffer* buffer, double& value);
     virtual unsigned getBufferSize();
     virtual bool isNumeric();
     virtual void setValue(DataGridRowBuffer* buffer, unsigned col,
@@ -644,7 +613,17 @@ wxString Int64ColumnDef::getAsString(DataGridRowBuffer* buffer)
     int64_t value;
     if (!buffer->getValue(offsetM, value))
         return wxEmptyString;
-    return wxLongLong(value).ToString();
+    return formatInteger(value);
+}
+
+bool Int64ColumnDef::getAsDouble(DataGridRowBuffer* buffer, double& value)
+{
+    wxASSERT(buffer);
+    int64_t i;
+    if (!buffer->getValue(offsetM, i))
+        return false;
+    value = double(i);
+    return true;
 }
 
 void Int64ColumnDef::setFromString(DataGridRowBuffer* buffer,
@@ -851,7 +830,7 @@ void DateColumnDef::setValue(DataGridRowBuffer* buffer, unsigned col,
 // TimeColumnDef class
 class TimeColumnDef : public ResultsetColumnDef
 {
-private:
+protected:
     unsigned offsetM;
 public:
     TimeColumnDef(const wxString& name, unsigned offset, bool readOnly,
@@ -937,7 +916,7 @@ void TimeColumnDef::setValue(DataGridRowBuffer* buffer, unsigned col,
 // TimestampColumnDef class
 class TimestampColumnDef : public ResultsetColumnDef
 {
-private:
+protected:
     unsigned offsetM;
 public:
     TimestampColumnDef(const wxString& name, unsigned offset, bool readOnly,
@@ -1051,6 +1030,180 @@ void TimestampColumnDef::setValue(DataGridRowBuffer* buffer, unsigned col,
     buffer->setValue(offsetM + sizeof(int), value.GetTime());
 }
 
+// time zones are shown as their offset from UTC, as "+hh:mm"
+wxString formatTzOffset(int offset)
+{
+    int minutes = offset < 0 ? -offset : offset;
+    return wxString::Format("%c%02d:%02d", offset < 0 ? '-' : '+',
+        minutes / 60, minutes % 60);
+}
+
+// removes a trailing "+hh:mm" or "-hh:mm" from source, returns false and
+// leaves source unchanged if there is none
+bool splitTzOffset(wxString& source, int& offset)
+{
+    size_t pos = source.find_last_of("+-");
+    if (pos == wxString::npos)
+        return false;
+    wxString hh(source.Mid(pos + 1).BeforeFirst(':'));
+    wxString mm(source.Mid(pos + 1).AfterFirst(':'));
+    long h, m;
+    if (hh.empty() || mm.length() != 2 || !hh.IsNumber() || !mm.IsNumber()
+        || !hh.ToLong(&h) || !mm.ToLong(&m) || h > 23 || m > 59)
+    {
+        return false;
+    }
+    offset = int(h * 60 + m);
+    if (source[pos] == '-')
+        offset = -offset;
+    source.Truncate(pos);
+    source.Trim(true);
+    return true;
+}
+
+// TimeTzColumnDef class
+class TimeTzColumnDef : public TimeColumnDef
+{
+public:
+    TimeTzColumnDef(const wxString& name, unsigned offset, bool readOnly,
+        bool nullable);
+    virtual wxString getAsFirebirdString(DataGridRowBuffer* buffer);
+    virtual wxString getAsString(DataGridRowBuffer* buffer);
+    virtual unsigned getBufferSize();
+    virtual void setValue(DataGridRowBuffer* buffer, unsigned col,
+        const IBPP::Statement& statement, wxMBConv* converter);
+    virtual void setFromString(DataGridRowBuffer* buffer,
+        const wxString& source);
+};
+
+TimeTzColumnDef::TimeTzColumnDef(const wxString& name, unsigned offset,
+    bool readOnly, bool nullable)
+    : TimeColumnDef(name, offset, readOnly, nullable)
+{
+}
+
+wxString TimeTzColumnDef::getAsString(DataGridRowBuffer* buffer)
+{
+    wxASSERT(buffer);
+    int tzOffset;
+    if (!buffer->getValue(offsetM + sizeof(int), tzOffset))
+        return wxEmptyString;
+    return TimeColumnDef::getAsString(buffer) + " "
+        + formatTzOffset(tzOffset);
+}
+
+wxString TimeTzColumnDef::getAsFirebirdString(DataGridRowBuffer* buffer)
+{
+    wxASSERT(buffer);
+    int tzOffset;
+    if (!buffer->getValue(offsetM + sizeof(int), tzOffset))
+        return wxEmptyString;
+    return TimeColumnDef::getAsFirebirdString(buffer) + " "
+        + formatTzOffset(tzOffset);
+}
+
+void TimeTzColumnDef::setFromString(DataGridRowBuffer* buffer,
+    const wxString& source)
+{
+    wxASSERT(buffer);
+    // keep the current offset if none is given
+    int tzOffset;
+    if (!buffer->getValue(offsetM + sizeof(int), tzOffset))
+        tzOffset = 0;
+    wxString temp(source);
+    temp.Trim(true).Trim(false);
+    splitTzOffset(temp, tzOffset);
+    TimeColumnDef::setFromString(buffer, temp);
+    buffer->setValue(offsetM + sizeof(int), tzOffset);
+}
+
+unsigned TimeTzColumnDef::getBufferSize()
+{
+    return 2 * sizeof(int);
+}
+
+void TimeTzColumnDef::setValue(DataGridRowBuffer* buffer, unsigned col,
+    const IBPP::Statement& statement, wxMBConv*)
+{
+    wxASSERT(buffer);
+    IBPP::Time value;
+    statement->Get(col, value);
+    buffer->setValue(offsetM + sizeof(int), value.GetTzOffset());
+    buffer->setValue(offsetM, value.GetTime());
+}
+
+// TimestampTzColumnDef class
+class TimestampTzColumnDef : public TimestampColumnDef
+{
+public:
+    TimestampTzColumnDef(const wxString& name, unsigned offset,
+        bool readOnly, bool nullable);
+    virtual wxString getAsFirebirdString(DataGridRowBuffer* buffer);
+    virtual wxString getAsString(DataGridRowBuffer* buffer);
+    virtual unsigned getBufferSize();
+    virtual void setValue(DataGridRowBuffer* buffer, unsigned col,
+        const IBPP::Statement& statement, wxMBConv* converter);
+    virtual void setFromString(DataGridRowBuffer* buffer,
+        const wxString& source);
+};
+
+TimestampTzColumnDef::TimestampTzColumnDef(const wxString& name,
+        unsigned offset, bool readOnly, bool nullable)
+    : TimestampColumnDef(name, offset, readOnly, nullable)
+{
+}
+
+wxString TimestampTzColumnDef::getAsString(DataGridRowBuffer* buffer)
+{
+    wxASSERT(buffer);
+    int tzOffset;
+    if (!buffer->getValue(offsetM + 2 * sizeof(int), tzOffset))
+        return wxEmptyString;
+    return TimestampColumnDef::getAsString(buffer) + " "
+        + formatTzOffset(tzOffset);
+}
+
+wxString TimestampTzColumnDef::getAsFirebirdString(DataGridRowBuffer* buffer)
+{
+    wxASSERT(buffer);
+    int tzOffset;
+    if (!buffer->getValue(offsetM + 2 * sizeof(int), tzOffset))
+        return wxEmptyString;
+    return TimestampColumnDef::getAsFirebirdString(buffer) + " "
+        + formatTzOffset(tzOffset);
+}
+
+void TimestampTzColumnDef::setFromString(DataGridRowBuffer* buffer,
+    const wxString& source)
+{
+    wxASSERT(buffer);
+    // keep the current offset if none is given
+    int tzOffset;
+    if (!buffer->getValue(offsetM + 2 * sizeof(int), tzOffset))
+        tzOffset = 0;
+    wxString temp(source);
+    temp.Trim(true).Trim(false);
+    splitTzOffset(temp, tzOffset);
+    TimestampColumnDef::setFromString(buffer, temp);
+    buffer->setValue(offsetM + 2 * sizeof(int), tzOffset);
+}
+
+unsigned TimestampTzColumnDef::getBufferSize()
+{
+    return 3 * sizeof(int);
+}
+
+void TimestampTzColumnDef::setValue(DataGridRowBuffer* buffer, unsigned col,
+    const IBPP::Statement& statement, wxMBConv*)
+{
+    wxASSERT(buffer);
+    IBPP::Timestamp value;
+    statement->Get(col, value);
+    buffer->setValue(offsetM + 2 * sizeof(int), value.GetTzOffset());
+    buffer->setValue(offsetM, value.GetDate());
+    buffer->setValue(offsetM + sizeof(int), value.GetTime());
+}
+
 // FloatColumnDef class
 class FloatColumnDef : public ResultsetColumnDef
 {
@@ -1060,6 +1213,7 @@ public:
     FloatColumnDef(const wxString& name, unsigned offset, bool readOnly,
         bool nullable);
     virtual wxString getAsString(DataGridRowBuffer* buffer);
+    virtual bool getAsDouble(DataGridRowBuffer* buffer, double& value);
     virtual unsigned getBufferSize();
     virtual bool isNumeric();
     virtual void setValue(DataGridRowBuffer* buffer, unsigned col,
@@ -1084,6 +1238,16 @@ wxString FloatColumnDef::getAsString(DataGridRowBuffer* buffer)
     return GridCellFormats::get().format<float>(value);
 }
 
+bool FloatColumnDef::getAsDouble(DataGridRowBuffer* buffer, double& value)
+{
+    wxASSERT(buffer);
+    float f;
+    if (!buffer->getValue(offsetM, f))
+        return false;
+    value = f;
+    return true;
+}
+
 void FloatColumnDef::setFromString(DataGridRowBuffer* buffer,
     const wxString& source)
 {
@@ -1123,6 +1287,7 @@ public:
     DoubleColumnDef(const wxString& name, unsigned offset, bool readOnly,
         bool nullable, short scale);
     virtual wxString getAsString(DataGridRowBuffer* buffer);
+    virtual bool getAsDouble(DataGridRowBuffer* buffer, double& value);
     virtual unsigned getBufferSize();
     virtual bool isNumeric();
     virtual void setValue(DataGridRowBuffer* buffer, unsigned col,
@@ -1150,6 +1315,12 @@ wxString DoubleColumnDef::getAsString(DataGridRowBuffer* buffer)
     return GridCellFormats::get().format<double>(value);
 }
 
+bool DoubleColumnDef::getAsDouble(DataGridRowBuffer* buffer, double& value)
+{
+    wxASSERT(buffer);
+    return buffer->getValue(offsetM, value);
+}
+
 void DoubleColumnDef::setFromString(DataGridRowBuffer* buffer,
     const wxString& source)
 {
@@ -1179,61 +1350,222 @@ void DoubleColumnDef::setValue(DataGridRowBuffer* buffer, unsigned col,
     buffer->setValue(offsetM, value);
 }
 
-class BlobColumnDef : public ResultsetColumnDef
+// Int128ColumnDef class
+class Int128ColumnDef : public ResultsetColumnDef
 {
 private:
-    unsigned indexM, stringIndexM;
-    bool textualM;
-    wxMBConv* converterM;
+    unsigned offsetM;
+    short scaleM;
 public:
-    BlobColumnDef(const wxString& name, bool readOnly, bool nullable,
-        unsigned stringIndex, unsigned blobIndex, bool textual);
-    void reset(DataGridRowBuffer* buffer);
-    virtual unsigned getIndex();
+    Int128ColumnDef(const wxString& name, unsigned offset, bool readOnly,
+        bool nullable, short scale);
     virtual wxString getAsString(DataGridRowBuffer* buffer);
+    virtual bool getAsDouble(DataGridRowBuffer* buffer, double& value);
     virtual unsigned getBufferSize();
+    virtual bool isNumeric();
     virtual void setValue(DataGridRowBuffer* buffer, unsigned col,
         const IBPP::Statement& statement, wxMBConv* converter);
     virtual void setFromString(DataGridRowBuffer* buffer,
         const wxString& source);
-    bool isTextual() { return textualM; };
 };
 
-BlobColumnDef::BlobColumnDef(const wxString& name, bool readOnly,
-        bool nullable, unsigned stringIndex, unsigned blobIndex, bool textual)
-    : ResultsetColumnDef(name, readOnly, nullable), indexM(blobIndex),
-        textualM(textual), stringIndexM(stringIndex), converterM(0)
+Int128ColumnDef::Int128ColumnDef(const wxString& name, unsigned offset,
+        bool readOnly, bool nullable, short scale)
+    : ResultsetColumnDef(name, readOnly, nullable), offsetM(offset),
+        scaleM(scale)
 {
-    //readOnlyM = true;   // TODO: uncomment this when we make BlobDialog
 }
 
-void BlobColumnDef::reset(DataGridRowBuffer* buffer)
+wxString Int128ColumnDef::getAsString(DataGridRowBuffer* buffer)
 {
-    buffer->setStringLoaded(stringIndexM, false);
+    wxASSERT(buffer);
+    IBPP::Int128 value;
+    if (!buffer->getValue(offsetM, value))
+        return wxEmptyString;
+    // exact, NUMERIC(38,x) values don't fit a double
+    return value.AsString(scaleM);
 }
 
-unsigned BlobColumnDef::getIndex()
+bool Int128ColumnDef::getAsDouble(DataGridRowBuffer* buffer, double& value)
 {
-    return indexM;
+    wxASSERT(buffer);
+    IBPP::Int128 i;
+    if (!buffer->getValue(offsetM, i))
+        return false;
+    value = i.AsDouble(scaleM);
+    return true;
 }
 
-wxString BlobColumnDef::getAsString(DataGridRowBuffer* buffer)
+void Int128ColumnDef::setFromString(DataGridRowBuffer* buffer,
+    const wxString& source)
 {
     wxASSERT(buffer);
-    if (buffer->isStringLoaded(stringIndexM))
-        return buffer->getString(stringIndexM);
-    if (!GridCellFormats::get().showBlobContent())
-        return _("[BLOB]");
-    if (!textualM && !GridCellFormats::get().showBinaryBlobContent())
-        return _("[BINARY]");
-
-    IBPP::Blob *b0 = buffer->getBlob(indexM);
-    if (!b0)
-        return "";
-    IBPP::Blob b = *b0;
+    IBPP::Int128 value;
     try
     {
-        b->Open();
+        value.SetValue(wx2std(source), scaleM);
+    }
+    catch (IBPP::Exception&)
+    {
+        throw FRError(_("Invalid 128bit numeric value"));
+    }
+    buffer->setValue(offsetM, value);
+}
+
+unsigned Int128ColumnDef::getBufferSize()
+{
+    return sizeof(IBPP::Int128);
+}
+
+bool Int128ColumnDef::isNumeric()
+{
+    return true;
+}
+
+void Int128ColumnDef::setValue(DataGridRowBuffer* buffer, unsigned col,
+    const IBPP::Statement& statement, wxMBConv*)
+{
+    wxASSERT(buffer);
+    IBPP::Int128 value;
+    statement->Get(col, value);
+    buffer->setValue(offsetM, value);
+}
+
+// DecFloatColumnDef class
+class DecFloatColumnDef : public ResultsetColumnDef
+{
+private:
+    unsigned offsetM;
+public:
+    DecFloatColumnDef(const wxString& name, unsigned offset, bool readOnly,
+        bool nullable);
+    virtual wxString getAsString(DataGridRowBuffer* buffer);
+    virtual bool getAsDouble(DataGridRowBuffer* buffer, double& value);
+    virtual unsigned getBufferSize();
+    virtual bool isNumeric();
+    virtual void setValue(DataGridRowBuffer* buffer, unsigned col,
+        const IBPP::Statement& statement, wxMBConv* converter);
+    virtual void setFromString(DataGridRowBuffer* buffer,
+        const wxString& source);
+};
+
+DecFloatColumnDef::DecFloatColumnDef(const wxString& name, unsigned offset,
+        bool readOnly, bool nullable)
+    : ResultsetColumnDef(name, readOnly, nullable), offsetM(offset)
+{
+}
+
+wxString DecFloatColumnDef::getAsString(DataGridRowBuffer* buffer)
+{
+    wxASSERT(buffer);
+    IBPP::DecFloat value;
+    if (!buffer->getValue(offsetM, value))
+        return wxEmptyString;
+    return value.AsString();
+}
+
+bool DecFloatColumnDef::getAsDouble(DataGridRowBuffer* buffer, double& value)
+{
+    wxASSERT(buffer);
+    IBPP::DecFloat d;
+    if (!buffer->getValue(offsetM, d) || d.Kind() != IBPP::dfFinite)
+        return false;
+    value = d.AsDouble();
+    return true;
+}
+
+void DecFloatColumnDef::setFromString(DataGridRowBuffer* buffer,
+    const wxString& source)
+{
+    wxASSERT(buffer);
+    IBPP::DecFloat value;
+    try
+    {
+        value.SetValue(wx2std(source));
+    }
+    catch (IBPP::Exception&)
+    {
+        throw FRError(_("Invalid decimal float value"));
+    }
+    buffer->setValue(offsetM, value);
+}
+
+unsigned DecFloatColumnDef::getBufferSize()
+{
+    return sizeof(IBPP::DecFloat);
+}
+
+bool DecFloatColumnDef::isNumeric()
+{
+    return true;
+}
+
+void DecFloatColumnDef::setValue(DataGridRowBuffer* buffer, unsigned col,
+    const IBPP::Statement& statement, wxMBConv*)
+{
+    wxASSERT(buffer);
+    IBPP::DecFloat value;
+    statement->Get(col, value);
+    buffer->setValue(offsetM, value);
+}
+
+class BlobColumnDef : public ResultsetColumnDef
+{
+private:
+    unsigned indexM, stringIndexM;
+    bool textualM;
+    wxMBConv* converterM;
+public:
+    BlobColumnDef(const wxString& name, bool readOnly, bool nullable,
+        unsigned stringIndex, unsigned blobIndex, bool textual,
+        wxMBConv* converter);
+    void reset(DataGridRowBuffer* buffer);
+    virtual unsigned getIndex();
+    virtual wxString getAsString(DataGridRowBuffer* buffer);
+    virtual unsigned getBufferSize();
+    virtual void setValue(DataGridRowBuffer* buffer, unsigned col,
+        const IBPP::Statement& statement, wxMBConv* converter);
+    virtual void setFromString(DataGridRowBuffer* buffer,
+        const wxString& source);
+    bool isTextual() { return textualM; };
+};
+
+BlobColumnDef::BlobColumnDef(const wxString& name, bool readOnly,
+        bool nullable, unsigned stringIndex, unsigned blobIndex, bool textual,
+        wxMBConv* converter)
+    : ResultsetColumnDef(name, readOnly, nullable), indexM(blobIndex),
+        textualM(textual), stringIndexM(stringIndex), converterM(converter)
+{
+    //readOnlyM = true;   // TODO: uncomment this when we make BlobDialog
+}
+
+void BlobColumnDef::reset(DataGridRowBuffer* buffer)
+{
+    buffer->setStringLoaded(stringIndexM, false);
+}
+
+unsigned BlobColumnDef::getIndex()
+{
+    return indexM;
+}
+
+wxString BlobColumnDef::getAsString(DataGridRowBuffer* buffer)
+{
+    wxASSERT(buffer);
+    if (buffer->isStringLoaded(stringIndexM))
+        return buffer->getString(stringIndexM);
+    if (!GridCellFormats::get().showBlobContent())
+        return _("[BLOB]");
+    if (!textualM && !GridCellFormats::get().showBinaryBlobContent())
+        return _("[BINARY]");
+
+    IBPP::Blob *b0 = buffer->getBlob(indexM);
+    if (!b0)
+        return "";
+    IBPP::Blob b = *b0;
+    try
+    {
+        b->Open();
     }
     catch(...)
     {
@@ -1373,25 +1705,29 @@ void StringColumnDef::setValue(DataGridRowBuffer* buffer, unsigned col,
     const IBPP::Statement& statement, wxMBConv* converter)
 {
     wxASSERT(buffer);
-    std::string value;
-    statement->Get(col, value);
     if (statement->ColumnType(col) == IBPP::sdBoolean) // Firebird v3
     {
         bool value; // UGLY, must create a specific Columm (child one ?)
         statement->Get(col, value);
         wxString val = value ? "true" : "false";
         buffer->setString(indexM, val);
+        return;
     }
-    else if (statement->ColumnSubtype(col) == 1)   // charset OCTETS
+
+    // view into the fetched row, transcoded without an intermediate copy
+    const char* data = 0;
+    int len = 0;
+    statement->GetView(col, data, len);
+    if (statement->ColumnSubtype(col) == 1)   // charset OCTETS
     {
         wxString val;
-        for (std::string::size_type p = 0; p < value.length(); p++)
-            val += wxString::Format("%02x", uint8_t(value[p]));
+        for (int p = 0; p < len; p++)
+            val += wxString::Format("%02x", uint8_t(data[p]));
         buffer->setString(indexM, val);
     }
     else
     {
-        wxString val = wxString(value.c_str(), *converter);
+        wxString val = wxString(data, *converter, len);
         size_t trimLen = val.Strip().Length();
         if (val.Length() > size_t(charSizeM))
             val.Truncate(trimLen > size_t(charSizeM) ? trimLen : charSizeM);
@@ -1422,8 +1758,13 @@ void BooleanColumnDef::setValue(DataGridRowBuffer* buffer, unsigned col,
 }
 
 // DataGridRows class
+// enough for the rows visible in the grid at once
+static const unsigned formattedValueRows = 128;
+
 DataGridRows::DataGridRows(Database* db)
-    : bufferSizeM(0), databaseM(db), readOnlyM(false)
+    : bufferSizeM(0), databaseM(db), readOnlyM(false),
+        storedRowsDeletableIsSetM(false), storedRowsDeletableM(false),
+        formatGenerationM(0)
 {
 }
 
@@ -1437,42 +1778,229 @@ ResultsetColumnDef* DataGridRows::getColumnDef(unsigned col)
     return columnDefsM[col];
 }
 
+DataGridRowBuffer* DataGridRows::getRowBuffer(ColumnStoreRowBuffer& view)
+{
+    if (overlayM.empty())
+        return &view;
+    std::map<unsigned, DataGridRowBuffer*>::iterator it =
+        overlayM.find(view.getRow());
+    if (it == overlayM.end())
+        return &view;
+    return (*it).second;
+}
+
+void DataGridRows::clearFormattedValues()
+{
+    for (unsigned col = 0; col < formattedValuesM.size(); ++col)
+    {
+        std::vector<FormattedValue>& values = formattedValuesM[col];
+        for (unsigned i = 0; i < values.size(); ++i)
+        {
+            values[i].row = UINT_MAX;
+            values[i].value.clear();
+        }
+    }
+}
+
+DataGridRowBuffer* DataGridRows::getOverlayBuffer(unsigned row)
+{
+    std::map<unsigned, DataGridRowBuffer*>::iterator it = overlayM.find(row);
+    if (it != overlayM.end())
+        return (*it).second;
+    DataGridRowBuffer* buffer = new DataGridRowBuffer(columnDefsM.size());
+    storeM.copyRow(row, *buffer);
+    overlayM[row] = buffer;
+    return buffer;
+}
+
 void DataGridRows::addRow(DataGridRowBuffer* buffer)
 {
-    if (buffersM.size() == buffersM.capacity())
-        buffersM.reserve(buffersM.capacity() + 1024);
-    buffersM.push_back(buffer);
+    // the stored row stays empty, the buffer replaces it
+    overlayM[storeM.addRows(1)] = buffer;
 }
 
 void DataGridRows::addRow(const IBPP::Statement& statement)
 {
-    DataGridRowBuffer* buffer = new DataGridRowBuffer(columnDefsM.size());
-    // if anything fails, make sure we release the memory
+    unsigned row = storeM.addRows(1);
+    ColumnStoreRowBuffer buffer(storeM, row);
+    // if anything fails, make sure we don't keep a partial row
     try
     {
-        // starts with last column -> with highest buffer offset and
-        // string array index to allocate all needed memory at once
-        unsigned col = columnDefsM.size();
-        do
+        for (unsigned col = 0; col < columnDefsM.size(); ++col)
         {
             // IBPP column counts are 1-based, not 0-based...
-            unsigned colIBPP = col--;
-            bool isNull = statement->IsNull(colIBPP);
-            buffer->setFieldNull(col, isNull);
+            bool isNull = statement->IsNull(col + 1);
+            buffer.setFieldNull(col, isNull);
             if (!isNull)
             {
-                columnDefsM[col]->setValue(buffer, colIBPP, statement,
+                columnDefsM[col]->setValue(&buffer, col + 1, statement,
                     databaseM->getCharsetConverter());
             }
         }
-        while (col > 0);
     }
     catch(...)
     {
-        delete buffer;
+        storeM.truncate(row);
+        // the row number is used again by the next row
+        clearFormattedValues();
+        throw;
+    }
+}
+
+void DataGridRows::addRows(const IBPP::RowBatch& batch)
+{
+    const unsigned rowCount = batch.Rows();
+    if (rowCount == 0)
+        return;
+    const unsigned first = storeM.addRows(rowCount);
+
+    // the column arrays of the batch don't change while it is decoded
+    const unsigned opCount = decodePlanM.size();
+    std::vector<const uint8_t*> nulls(opCount);
+    std::vector<const int64_t*> ints(opCount);
+    std::vector<const double*> doubles(opCount);
+    for (unsigned i = 0; i < opCount; ++i)
+    {
+        nulls[i] = batch.NullMask(decodePlanM[i].column);
+        ints[i] = batch.Int64s(decodePlanM[i].column);
+        doubles[i] = batch.Doubles(decodePlanM[i].column);
+    }
+
+    // the rows were added with all fields NULL, only values are set
+    unsigned row = 0;
+    // if anything fails, make sure we don't keep partial rows
+    try
+    {
+        for (; row < rowCount; ++row)
+        {
+            const unsigned r = first + row;
+            for (unsigned i = 0; i < opCount; ++i)
+            {
+                const DecodeOp& op = decodePlanM[i];
+                bool isNull = (nulls[i][row >> 3] & (1 << (row & 7))) != 0;
+                if (isNull)
+                    continue;
+                storeM.setFieldNull(r, op.field, false);
+
+                switch (op.code)
+                {
+                    case dcInteger:
+                        storeM.setValue(r, op.offset, int(ints[i][row]));
+                        break;
+                    case dcInt64:
+                        storeM.setValue(r, op.offset, int64_t(ints[i][row]));
+                        break;
+                    case dcScaledInt:
+                        storeM.setValue(r, op.offset,
+                            ints[i][row] / op.divisor);
+                        break;
+                    case dcFloat:
+                        storeM.setValue(r, op.offset, float(doubles[i][row]));
+                        break;
+                    case dcDouble:
+                        storeM.setValue(r, op.offset, doubles[i][row]);
+                        break;
+                    case dcDate:
+                    case dcTime:
+                        // same integer model as IBPP::Date and IBPP::Time
+                        storeM.setValue(r, op.offset, int(ints[i][row]));
+                        break;
+                    case dcTimestamp:
+                    {
+                        IBPP::Timestamp value;
+                        batch.Get(row, op.column, value);
+                        storeM.setValue(r, op.offset, value.GetDate());
+                        storeM.setValue(r, op.offset + sizeof(int),
+                            value.GetTime());
+                        break;
+                    }
+                    case dcTimeTz:
+                    {
+                        IBPP::Time value;
+                        batch.Get(row, op.column, value);
+                        storeM.setValue(r, op.offset + sizeof(int),
+                            value.GetTzOffset());
+                        storeM.setValue(r, op.offset, value.GetTime());
+                        break;
+                    }
+                    case dcTimestampTz:
+                    {
+                        IBPP::Timestamp value;
+                        batch.Get(row, op.column, value);
+                        storeM.setValue(r, op.offset + 2 * sizeof(int),
+                            value.GetTzOffset());
+                        storeM.setValue(r, op.offset, value.GetDate());
+                        storeM.setValue(r, op.offset + sizeof(int),
+                            value.GetTime());
+                        break;
+                    }
+                    case dcInt128:
+                    {
+                        IBPP::Int128 value;
+                        batch.Get(row, op.column, value);
+                        storeM.setValue(r, op.offset, value);
+                        break;
+                    }
+                    case dcDecFloat:
+                    {
+                        IBPP::DecFloat value;
+                        batch.Get(row, op.column, value);
+                        storeM.setValue(r, op.offset, value);
+                        break;
+                    }
+                    case dcDBKey:
+                    {
+                        IBPP::DBKey value;
+                        batch.Get(row, op.column, value);
+                        storeM.setValue(r, op.offset, value);
+                        break;
+                    }
+                    case dcBoolean:
+                        storeM.setString(r, op.offset,
+                            ints[i][row] ? "true" : "false");
+                        break;
+                    case dcString:
+                    {
+                        int len;
+                        const char* chars = batch.Chars(row, op.column, len);
+                        wxString val(chars, *op.converter, len);
+                        size_t trimLen = val.Strip().Length();
+                        if (val.Length() > op.charSize)
+                            val.Truncate(std::max(trimLen, op.charSize));
+                        storeM.setString(r, op.offset, val);
+                        break;
+                    }
+                    case dcOctets:
+                    {
+                        int len;
+                        const char* chars = batch.Chars(row, op.column, len);
+                        wxString val;
+                        for (int p = 0; p < len; p++)
+                            val += wxString::Format("%02x", uint8_t(chars[p]));
+                        storeM.setString(r, op.offset, val);
+                        break;
+                    }
+                    case dcBlob:
+                    {
+                        IBPP::Blob b;   // created by the batch
+                        batch.Get(row, op.column, b);
+                        storeM.setBlob(r, op.offset, b);
+                        break;
+                    }
+                    case dcSkip:
+                        break;
+                }
+            }
+        }
+    }
+    catch(...)
+    {
+        storeM.truncate(first + row);
+        // the row numbers are used again by the next rows
+        clearFormattedValues();
         throw;
     }
-    addRow(buffer);
+    storeM.checkMemoryLimit();
 }
 
     void freeBuffer(DataGridRowBuffer* buffer) { delete buffer; }
@@ -1481,11 +2009,14 @@ void DataGridRows::addRow(const IBPP::Statement& statement)
 
 void DataGridRows::clear()
 {
-    if (buffersM.size())
+    for (std::map<unsigned, DataGridRowBuffer*>::iterator it =
+        overlayM.begin(); it != overlayM.end(); ++it)
     {
-        for_each(buffersM.begin(), buffersM.end(), freeBuffer);
-        buffersM.clear();
+        freeBuffer((*it).second);
     }
+    overlayM.clear();
+    storeM.clear();
+    storedRowsDeletableIsSetM = false;
     if (columnDefsM.size())
     {
         for_each(columnDefsM.begin(), columnDefsM.end(), freeColumnDef);
@@ -1494,17 +2025,37 @@ void DataGridRows::clear()
     statementTablesM.clear();
     deleteFromM = statementTablesM.end();
     dbKeysM.clear();
+    decodePlanM.clear();
+    formattedValuesM.clear();
     bufferSizeM = 0;
 }
 
+void DataGridRows::setMemoryLimit(size_t bytes)
+{
+    storeM.setMemoryLimit(bytes);
+}
+
+size_t DataGridRows::getResidentSize()
+{
+    return storeM.getResidentSize();
+}
+
+size_t DataGridRows::getSpilledSize()
+{
+    return storeM.getSpilledSize();
+}
+
 bool DataGridRows::canRemoveRow(size_t row)
 {
-    if (row >= buffersM.size())
+    if (row >= storeM.getRowCount())
         return false;
     // check that it is safe to call statementM->Columns()
     if (statementM->Type() == IBPP::stUnknown)
         return false;
-    if (!buffersM[row]->isDeletableIsSet())
+    std::map<unsigned, DataGridRowBuffer*>::iterator ito = overlayM.find(row);
+    DataGridRowBuffer* buffer =
+        (ito != overlayM.end()) ? (*ito).second : 0;
+    if (buffer ? !buffer->isDeletableIsSet() : !storedRowsDeletableIsSetM)
     {
         // find table with valid constraint
         bool tableok = false;
@@ -1527,7 +2078,8 @@ bool DataGridRows::canRemoveRow(size_t row)
                         continue;
                     wxString tn(std2wxIdentifier(statementM->ColumnTable(c2),
                         databaseM->getCharsetConverter()));
-                    if (tn == (*it).first && buffersM[row]->isFieldNA(c2-1))
+                    if (tn == (*it).first && buffer
+                        && buffer->isFieldNA(c2-1))
                     {
                         tableok = false;
                         break;
@@ -1535,12 +2087,19 @@ bool DataGridRows::canRemoveRow(size_t row)
                 }
             }
         }
-        buffersM[row]->setIsDeletable(tableok);
+        if (!buffer)
+        {
+            storedRowsDeletableIsSetM = true;
+            storedRowsDeletableM = tableok;
+        }
+        else
+            buffer->setIsDeletable(tableok);
     }
-    return buffersM[row]->isDeletable();
+    return buffer ? buffer->isDeletable() : storedRowsDeletableM;
 }
 
-bool DataGridRows::removeRows(size_t from, size_t count, wxString& stm)
+bool DataGridRows::removeRows(const std::vector<unsigned>& rows,
+    wxString& stm, std::vector<IBPP::BatchError>& errors)
 {
     if (statementTablesM.begin() == statementTablesM.end())
         return false;
@@ -1569,38 +2128,30 @@ bool DataGridRows::removeRows(size_t from, size_t count, wxString& stm)
         deleteFromM = statementTablesM.find(tab);
     }
 
-    for (size_t pos = 0; pos < count; ++pos)
-    {
-        if (pos > 0)
-            stm += wxTextBuffer::GetEOL();
-        wxString s = "DELETE FROM "
-            + Identifier((*deleteFromM).first).getQuoted() + " WHERE ";
-        IBPP::Statement st = addWhere((*deleteFromM).second, s,
-            (*deleteFromM).first, buffersM[from+pos]);
-        st->Execute();
-        stm += s + ";";
-    }
+    wxString s = "DELETE FROM "
+        + Identifier((*deleteFromM).first).getQuoted() + " WHERE";
+    std::vector<bool> done(executeForRows((*deleteFromM).second, s,
+        (*deleteFromM).first, rows, stm, errors));
 
-    std::vector<DataGridRowBuffer*>::iterator i2, it = buffersM.begin();
-    from += count - 1;
-    while (from--)
-    {
-        if (++it == buffersM.end())     // should never happen
-            return false;
-    }
-    while (count--)
+    for (size_t i = 0; i < rows.size(); ++i)
     {
-        i2 = it;
-        if (it != buffersM.begin ())//Prevents it from going before the first one
-          it--;
-        (*i2)->setIsDeleted(true);
+        if (done[i])
+            getOverlayBuffer(rows[i])->setIsDeleted(true);
     }
-    return true;
+    return errors.size() < rows.size();
+}
+
+bool DataGridRows::isRowDeleted(unsigned row)
+{
+    if (row >= storeM.getRowCount())
+        return false;
+    ColumnStoreRowBuffer view(storeM, row);
+    return getRowBuffer(view)->isDeleted();
 }
 
 unsigned DataGridRows::getRowCount()
 {
-    return buffersM.size();
+    return storeM.getRowCount();
 }
 
 unsigned DataGridRows::getRowFieldCount()
@@ -1631,11 +2182,14 @@ void checkColumnsPresent(const Database* database,
                 database->getCharsetConverter()));
             if (cn == (*ci) && tn == tableName)
             {
-                found = true;
+                // values with a time zone are read as UTC offsets, their
+                // region names are lost, so they can't identify a row
+                IBPP::SDT type = statement->ColumnType(c2);
+                found = type != IBPP::sdTimeTz && type != IBPP::sdTimestampTz;
                 break;
             }
         }
-        if (!found)     // some columns missing
+        if (!found)     // some columns missing or unusable
         {
             *locator = 0;
             break;
@@ -1662,6 +2216,13 @@ void DataGridRows::getColumnInfo(Database *db, unsigned col, bool& readOnly,
         return;             // probably be done together with BLOB support
     }
 
+    if (statementM->ColumnType(col) == IBPP::sdTimeTz
+        || statementM->ColumnType(col) == IBPP::sdTimestampTz)
+    {                       // only the UTC offset is read, writing the value
+        readOnly = true;    // back would replace a region name (like
+        return;             // Europe/Prague) with the fixed offset
+    }
+
     wxString tabName(std2wxIdentifier(statementM->ColumnTable(col),
         databaseM->getCharsetConverter()));
     Table *t = dynamic_cast<Table *>(db->findRelation(Identifier(tabName)));
@@ -1750,57 +2311,98 @@ bool DataGridRows::initialize(const IBPP::Statement& statement)
 
     // Create column definitions and compute the necessary buffer size
     // and string array length when all fields contain data
+    wxMBConv* converter = databaseM->getCharsetConverter();
+    decodePlanM.reserve(colCount);
     for (unsigned col = 1; col <= colCount; ++col)
     {
         bool readOnly, nullable;
         getColumnInfo(databaseM, col, readOnly, nullable);
 
-        wxString colName(statement->ColumnAlias(col),
-            *databaseM->getCharsetConverter());
+        wxString colName(statement->ColumnAlias(col), *converter);
         if (colName.empty())
-        {
-            colName = wxString(statement->ColumnName(col),
-                *databaseM->getCharsetConverter());
-        }
+            colName = wxString(statement->ColumnName(col), *converter);
 
         IBPP::SDT type = statement->ColumnType(col);
-        if (statement->ColumnScale(col) > 0)
+        int scale = statement->ColumnScale(col);
+        bool scaledInt = scale > 0 && (type == IBPP::sdSmallint
+            || type == IBPP::sdInteger || type == IBPP::sdLargeint);
+        // INT128 based NUMERICs stay exact
+        if (scale > 0 && type != IBPP::sdInt128)
             type = IBPP::sdDouble;
 
+        DecodeOp op;
+        op.code = dcSkip;
+        op.column = col;
+        op.field = col - 1;
+        op.offset = bufferSizeM;
+        op.divisor = 1.0;
+        op.charSize = 0;
+        op.converter = converter;
+
         ResultsetColumnDef* columnDef = 0;
         if (std::string(statement->ColumnName(col)) == "DB_KEY")
+        {
             columnDef = new DBKeyColumnDef(colName, bufferSizeM, statement->ColumnSize(col));
+            op.code = dcDBKey;
+        }
         else
         {
             switch (type)
             {
                 case IBPP::sdBoolean: // Firebird v3
                     columnDef = new BooleanColumnDef(colName, stringIndex, readOnly, nullable);
+                    op.code = dcBoolean;
+                    op.offset = stringIndex;
                     ++stringIndex;
                     break;
                 case IBPP::sdDate:
                     columnDef = new DateColumnDef(colName, bufferSizeM, readOnly, nullable);
+                    op.code = dcDate;
                     break;
                 case IBPP::sdTime:
                     columnDef = new TimeColumnDef(colName, bufferSizeM, readOnly, nullable);
+                    op.code = dcTime;
                     break;
                 case IBPP::sdTimestamp:
                     columnDef = new TimestampColumnDef(colName, bufferSizeM, readOnly, nullable);
+                    op.code = dcTimestamp;
+                    break;
+                case IBPP::sdTimeTz:
+                    columnDef = new TimeTzColumnDef(colName, bufferSizeM, readOnly, nullable);
+                    op.code = dcTimeTz;
+                    break;
+                case IBPP::sdTimestampTz:
+                    columnDef = new TimestampTzColumnDef(colName, bufferSizeM, readOnly, nullable);
+                    op.code = dcTimestampTz;
                     break;
 
                 case IBPP::sdSmallint:
                 case IBPP::sdInteger:
                     columnDef = new IntegerColumnDef(colName, bufferSizeM, readOnly, nullable);
+                    op.code = dcInteger;
                     break;
                 case IBPP::sdLargeint:
                     columnDef = new Int64ColumnDef(colName, bufferSizeM, readOnly, nullable);
+                    op.code = dcInt64;
                     break;
 
                 case IBPP::sdFloat:
                     columnDef = new FloatColumnDef(colName, bufferSizeM, readOnly, nullable);
+                    op.code = dcFloat;
                     break;
                 case IBPP::sdDouble:
-                    columnDef = new DoubleColumnDef(colName, bufferSizeM, readOnly, nullable, statement->ColumnScale(col));
+                    columnDef = new DoubleColumnDef(colName, bufferSizeM, readOnly, nullable, scale);
+                    op.code = scaledInt ? dcScaledInt : dcDouble;
+                    op.divisor = pow(10.0, scale);
+                    break;
+                case IBPP::sdInt128:
+                    columnDef = new Int128ColumnDef(colName, bufferSizeM, readOnly, nullable, scale);
+                    op.code = dcInt128;
+                    break;
+                case IBPP::sdDec16:
+                case IBPP::sdDec34:
+                    columnDef = new DecFloatColumnDef(colName, bufferSizeM, readOnly, nullable);
+                    op.code = dcDecFloat;
                     break;
 
                 case IBPP::sdString:
@@ -1811,11 +2413,17 @@ bool DataGridRows::initialize(const IBPP::Statement& statement)
                     if (bpc)
                         size /= bpc;
                     columnDef = new StringColumnDef(colName, stringIndex, readOnly, nullable, size);
+                    // charset OCTETS is shown as hex string
+                    op.code = (statement->ColumnSubtype(col) == 1) ? dcOctets : dcString;
+                    op.offset = stringIndex;
+                    op.charSize = size;
                     ++stringIndex;
                     break;
                 }
                 case IBPP::sdBlob:
-                    columnDef = new BlobColumnDef(colName, readOnly, nullable, stringIndex, blobIndex, statement->ColumnSubtype(col) == 1);
+                    columnDef = new BlobColumnDef(colName, readOnly, nullable, stringIndex, blobIndex, statement->ColumnSubtype(col) == 1, converter);
+                    op.code = dcBlob;
+                    op.offset = blobIndex;
                     ++blobIndex;    // stores blob handle
                     ++stringIndex;  // stored blob data (fetched on demand)
                     break;
@@ -1826,8 +2434,29 @@ bool DataGridRows::initialize(const IBPP::Statement& statement)
             }
         }
         wxASSERT(columnDef);
+        storeM.addFixedColumn(bufferSizeM, columnDef->getBufferSize());
         bufferSizeM += columnDef->getBufferSize();
         columnDefsM.push_back(columnDef);
+        decodePlanM.push_back(op);
+    }
+    storeM.initialize(colCount, stringIndex, blobIndex);
+
+    // strings are cached by the store already, and blobs aren't formatted
+    FormattedValue empty = { UINT_MAX, wxEmptyString };
+    formattedValuesM.resize(colCount);
+    for (unsigned col = 0; col < colCount; ++col)
+    {
+        switch (decodePlanM[col].code)
+        {
+            case dcInteger: case dcInt64: case dcScaledInt: case dcFloat:
+            case dcDouble: case dcDate: case dcTime: case dcTimestamp:
+            case dcTimeTz: case dcTimestampTz: case dcInt128:
+            case dcDecFloat:
+                formattedValuesM[col].assign(formattedValueRows, empty);
+                break;
+            default:
+                break;
+        }
     }
     return true;
 }
@@ -1856,16 +2485,18 @@ bool DataGridRows::isColumnReadonly(unsigned col)
 bool DataGridRows::getFieldInfo(unsigned row, unsigned col,
     DataGridFieldInfo& info)
 {
-    if (col >= columnDefsM.size() || row >= buffersM.size())
+    if (col >= columnDefsM.size() || row >= storeM.getRowCount())
         return false;
-    info.rowInserted = buffersM[row]->isInserted();
-    info.rowDeleted = buffersM[row]->isDeleted();
+    ColumnStoreRowBuffer view(storeM, row);
+    DataGridRowBuffer* buffer = getRowBuffer(view);
+    info.rowInserted = buffer->isInserted();
+    info.rowDeleted = buffer->isDeleted();
     info.fieldReadOnly = readOnlyM || info.rowDeleted
         || isColumnReadonly(col) || isFieldReadonly(row, col);
     info.fieldModified = !info.rowDeleted
-        && buffersM[row]->isFieldModified(col);
-    info.fieldNull = buffersM[row]->isFieldNull(col);
-    info.fieldNA = buffersM[row]->isFieldNA(col);
+        && buffer->isFieldModified(col);
+    info.fieldNull = buffer->isFieldNull(col);
+    info.fieldNA = buffer->isFieldNA(col);
     info.fieldNumeric = isColumnNumeric(col);
     info.fieldBlob = isBlobColumn(col);
     return true;
@@ -1873,15 +2504,17 @@ bool DataGridRows::getFieldInfo(unsigned row, unsigned col,
 
 bool DataGridRows::isFieldReadonly(unsigned row, unsigned col)
 {
-    if (col >= columnDefsM.size() || row >= buffersM.size())
+    if (col >= columnDefsM.size() || row >= storeM.getRowCount())
         return false;
     if (columnDefsM[col]->isReadOnly())
         return true;
 
     // if row is loaded from the database and not inserted by user, we don't
     // need to check anything else
-    if (!buffersM[row]->isInserted())
+    std::map<unsigned, DataGridRowBuffer*>::iterator ito = overlayM.find(row);
+    if (ito == overlayM.end() || !(*ito).second->isInserted())
         return false;
+    DataGridRowBuffer* buffer = (*ito).second;
 
     // TODO: this needs to be cached too
 
@@ -1904,7 +2537,7 @@ bool DataGridRows::isFieldReadonly(unsigned row, unsigned col)
                 continue;
             wxString tn(std2wxIdentifier(statementM->ColumnTable(c2),
                 databaseM->getCharsetConverter()));
-            if (tn == table && buffersM[row]->isFieldNA(c2-1))
+            if (tn == table && buffer->isFieldNA(c2-1))
                 return true;
         }
     }
@@ -1913,23 +2546,56 @@ bool DataGridRows::isFieldReadonly(unsigned row, unsigned col)
 
 wxString DataGridRows::getFieldValue(unsigned row, unsigned col)
 {
-    if (row >= buffersM.size() || col >= columnDefsM.size())
+    if (row >= storeM.getRowCount() || col >= columnDefsM.size())
         return wxEmptyString;
-    return columnDefsM[col]->getAsString(buffersM[row]);
+    ColumnStoreRowBuffer view(storeM, row);
+    DataGridRowBuffer* buffer = getRowBuffer(view);
+    std::vector<FormattedValue>& values = formattedValuesM[col];
+    if (values.empty() || buffer != &view)
+        return columnDefsM[col]->getAsString(buffer);
+
+    // the format settings may have changed since the values were cached
+    unsigned generation = GridCellFormats::get().getGeneration();
+    if (generation != formatGenerationM)
+    {
+        clearFormattedValues();
+        formatGenerationM = generation;
+    }
+    FormattedValue& cached = values[row % formattedValueRows];
+    if (cached.row != row)
+    {
+        cached.value = columnDefsM[col]->getAsString(buffer);
+        cached.row = row;
+    }
+    return cached.value;
+}
+
+bool DataGridRows::getFieldValueAsDouble(unsigned row, unsigned col,
+    double& value)
+{
+    if (row >= storeM.getRowCount() || col >= columnDefsM.size())
+        return false;
+    ColumnStoreRowBuffer view(storeM, row);
+    DataGridRowBuffer* buffer = getRowBuffer(view);
+    if (buffer->isFieldNull(col) || buffer->isFieldNA(col))
+        return false;
+    return columnDefsM[col]->getAsDouble(buffer, value);
 }
 
 bool DataGridRows::isFieldNull(unsigned row, unsigned col)
 {
-    if (row >= buffersM.size())
+    if (row >= storeM.getRowCount())
         return false;
-    return buffersM[row]->isFieldNull(col);
+    ColumnStoreRowBuffer view(storeM, row);
+    return getRowBuffer(view)->isFieldNull(col);
 }
 
 bool DataGridRows::isFieldNA(unsigned row, unsigned col)
 {
-    if (row >= buffersM.size())
+    if (row >= storeM.getRowCount())
         return false;
-    return buffersM[row]->isFieldNA(col);
+    ColumnStoreRowBuffer view(storeM, row);
+    return getRowBuffer(view)->isFieldNA(col);
 }
 
 IBPP::Statement DataGridRows::addWhere(UniqueConstraint* uq, wxString& stm,
@@ -1994,6 +2660,143 @@ IBPP::Statement DataGridRows::addWhere(UniqueConstraint* uq, wxString& stm,
     return st;
 }
 
+// Executes stm, followed by a WHERE clause on the key of the table, for each
+// of the rows as a single batch. The key values are passed as strings, which
+// the server converts to the column types like the literals of addWhere().
+// The statements of the rows done are appended to log, the failed ones to
+// errors (with their grid row). Returns whether each row has been done.
+std::vector<bool> DataGridRows::executeForRows(UniqueConstraint* uq,
+    const wxString& stm, const wxString& table,
+    const std::vector<unsigned>& rows, wxString& log,
+    std::vector<IBPP::BatchError>& errors)
+{
+    wxMBConv* converter = databaseM->getCharsetConverter();
+
+    // find the key columns, RDB$DB_KEY is used alone
+    std::vector<int> keys;
+    std::vector<wxString> names;
+    bool dbkey = false;
+    for (ColumnConstraint::const_iterator ci = uq->begin(); ci !=
+        uq->end(); ++ci)
+    {
+        dbkey = (*ci) == "DB_KEY";
+        if (dbkey)
+            keys.clear();
+        for (int c2 = 1; c2 <= statementM->Columns(); ++c2)
+        {
+            wxString cn(std2wxIdentifier(statementM->ColumnName(c2),
+                converter));
+            wxString tn(std2wxIdentifier(statementM->ColumnTable(c2),
+                converter));
+            if (cn == (*ci) && tn == table)
+            {
+                keys.push_back(c2 - 1);
+                names.push_back(Identifier(cn).getQuoted());
+                break;
+            }
+        }
+        if (dbkey)
+            break;
+    }
+    DBKeyColumnDef* dbk = 0;
+    if (dbkey)
+    {
+        if (keys.empty())
+            throw FRError(_("Invalid Column"));
+        dbk = dynamic_cast<DBKeyColumnDef *>(columnDefsM[keys[0]]);
+        if (!dbk)
+            throw FRError(_("Invalid Column"));
+    }
+
+    // the key values of all rows, to size the parameters
+    std::vector<wxString> values;
+    std::vector<size_t> lengths(keys.size(), 1);
+    values.reserve(rows.size() * keys.size());
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        ColumnStoreRowBuffer view(storeM, rows[i]);
+        DataGridRowBuffer* buffer = getRowBuffer(view);
+        for (size_t k = 0; k < keys.size(); ++k)
+        {
+            if (buffer->isFieldNA(keys[k]))
+            {
+                throw FRError(dbkey ? _("N/A value in DB_KEY column.")
+                    : _("N/A value in key column."));
+            }
+            if (dbkey)
+                continue;
+            values.push_back(columnDefsM[keys[k]]->getAsFirebirdString(
+                buffer));
+            lengths[k] = std::max(lengths[k],
+                wx2std(values.back(), converter).length());
+        }
+    }
+
+    wxString charset(databaseM->getConnectionCharset());
+    if (charset.IsEmpty())
+        charset = "NONE";
+    wxString where;
+    if (dbkey)
+        where = " RDB$DB_KEY = ?";
+    for (size_t k = 0; !dbkey && k < keys.size(); ++k)
+    {
+        if (k > 0)
+            where += " AND";
+        where += " " + names[k] + wxString::Format(
+            " = CAST(? AS VARCHAR(%d) CHARACTER SET %s)",
+            (int)lengths[k], charset.c_str());
+    }
+
+    IBPP::Statement st = IBPP::StatementFactory(statementM->DatabasePtr(),
+        statementM->TransactionPtr());
+    st->Prepare(wx2std(stm + where, converter));
+    int first = st->Parameters() - (int)keys.size();
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        if (dbkey)
+        {
+            ColumnStoreRowBuffer view(storeM, rows[i]);
+            IBPP::DBKey key;
+            dbk->getDBKey(key, getRowBuffer(view));
+            st->Set(first + 1, key);
+        }
+        for (size_t k = 0; !dbkey && k < keys.size(); ++k)
+        {
+            st->Set(first + (int)k + 1,
+                wx2std(values[i * keys.size() + k], converter));
+        }
+        st->AddBatch();
+    }
+
+    size_t errorCount = errors.size();
+    st->ExecuteBatch(errors);
+    std::vector<bool> done(rows.size(), true);
+    for (size_t e = errorCount; e < errors.size(); ++e)
+    {
+        done[errors[e].row] = false;
+        errors[e].row = rows[errors[e].row];
+    }
+
+    // log the statements as addWhere() builds them
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        if (!done[i])
+            continue;
+        if (!log.IsEmpty())
+            log += wxTextBuffer::GetEOL();
+        log += stm;
+        if (dbkey)
+            log += where;
+        for (size_t k = 0; !dbkey && k < keys.size(); ++k)
+        {
+            log += (k > 0 ? " AND " : " ") + names[k] + " = '"
+                + values[i * keys.size() + k] + "'";
+        }
+        log += ";";
+    }
+    return done;
+}
+
 bool DataGridRows::isBlobColumn(unsigned col, bool* pIsTextual)
 {
     BlobColumnDef* bcd = dynamic_cast<BlobColumnDef *>(columnDefsM[col]);
@@ -2004,11 +2807,13 @@ bool DataGridRows::isBlobColumn(unsigned col, bool* pIsTextual)
 
 IBPP::Blob* DataGridRows::getBlob(unsigned row, unsigned col, bool validateBlob)
 {
-    if (row >= buffersM.size())
+    if (row >= storeM.getRowCount())
       throw FRError(_("Invalid row index."));
     if (col >= columnDefsM.size())
       throw FRError(_("Invalid col index."));
-    IBPP::Blob* b0 = buffersM[row]->getBlob(columnDefsM[col]->getIndex());
+    ColumnStoreRowBuffer view(storeM, row);
+    IBPP::Blob* b0 =
+        getRowBuffer(view)->getBlob(columnDefsM[col]->getIndex());
     if ((validateBlob) && (!b0))
         throw FRError(_("BLOB data not valid"));
     return b0;
@@ -2037,7 +2842,8 @@ DataGridRowsBlob DataGridRows::setBlobPrepare(unsigned row, unsigned col)
     DataGridRowsBlob b;
     b.row = row;
     b.col = col;
-    b.st = addWhere((*it).second, stm, tn, buffersM[row]);
+    ColumnStoreRowBuffer view(storeM, row);
+    b.st = addWhere((*it).second, stm, tn, getRowBuffer(view));
     b.blob = IBPP::BlobFactory(b.st->DatabasePtr(), b.st->TransactionPtr());
     return b;
 }
@@ -2050,13 +2856,14 @@ void DataGridRows::setBlob(DataGridRowsBlob &b)
         b.st->Execute();  // we execute before updating internal storage
     }
     
-    buffersM[b.row]->setBlob(columnDefsM[b.col]->getIndex(), b.blob);
-    buffersM[b.row]->setFieldNull(b.col, (b.blob == 0));
-    buffersM[b.row]->setFieldNA(b.col, false);
+    DataGridRowBuffer* buffer = getOverlayBuffer(b.row);
+    buffer->setBlob(columnDefsM[b.col]->getIndex(), b.blob);
+    buffer->setFieldNull(b.col, (b.blob == 0));
+    buffer->setFieldNA(b.col, false);
     BlobColumnDef *bcd = dynamic_cast<BlobColumnDef *>(columnDefsM[b.col]);
     if (!bcd)
         throw FRError(_("Not a BLOB column."));
-    bcd->reset(buffersM[b.row]);  // reset cached blob data
+    bcd->reset(buffer);  // reset cached blob data
 }
 
 void DataGridRows::exportBlobFile(const wxString& filename, unsigned row,
@@ -2068,23 +2875,24 @@ void DataGridRows::exportBlobFile(const wxString& filename, unsigned row,
     IBPP::Blob *b0 = getBlob(row,col,true);
     IBPP::Blob b = *b0;
 
-    b->Open();
+    // the next chunk is read from the server while this one is written
+    IBPP::BlobStreamBuf bs(b, std::ios_base::in, 256 * 1024, true);
     int size;
     b->Info(&size, 0, 0);
     if (pi)
         pi->initProgress(_("Saving..."), size);
     while (!pi || !pi->isCanceled())
     {
-        uint8_t buffer[32768];
-        int size = b->Read((void*)buffer, 32767);
-        if (size < 1)
+        char buffer[65536];
+        std::streamsize len = bs.sgetn(buffer, sizeof(buffer));
+        if (len < 1)
             break;
-        fl.Write(buffer, size);
+        fl.Write(buffer, len);
         if (pi)
-            pi->stepProgress(size);
+            pi->stepProgress(len);
     }
     fl.Close();
-    b->Close();
+    bs.Close();
 }
 
 void DataGridRows::importBlobFile(const wxString& filename, unsigned row,
@@ -2097,19 +2905,19 @@ void DataGridRows::importBlobFile(const wxString& filename, unsigned row,
         pi->initProgress(_("Loading..."), fl.Length()); // wxFileOffset
 
     DataGridRowsBlob b = setBlobPrepare(row,col);
-    b.blob->Create();
-    uint8_t buffer[32768];
+    IBPP::BlobStreamBuf bs(b.blob, std::ios_base::out);
+    char buffer[65536];
     while (!fl.Eof())
     {
-        size_t len = fl.Read(buffer, 32767);    // slow when not 32k
+        size_t len = fl.Read(buffer, sizeof(buffer));
         if (len < 1 || (pi && pi->isCanceled()))
             break;
-        b.blob->Write(buffer, len);
+        bs.sputn(buffer, len);
         if (pi)
             pi->stepProgress(len);
     }
     fl.Close();
-    b.blob->Close();
+    bs.Close();
     if (pi && pi->isCanceled())
         return;
 
@@ -2133,23 +2941,25 @@ wxString DataGridRows::setFieldValue(unsigned row, unsigned col,
     // to ensure atomicity, we create a temporary buffer, try to store value
     // in it and also in database. if anything fails, we revert to the values
     // from temp buffer
+    // edited rows are kept in the overlay, not in the column store
+    DataGridRowBuffer* buffer = getOverlayBuffer(row);
     DataGridRowBuffer *oldRecord;
     // we create a copy of appropriate type
     InsertedGridRowBuffer *test =
-        dynamic_cast<InsertedGridRowBuffer *>(buffersM[row]);
+        dynamic_cast<InsertedGridRowBuffer *>(buffer);
     if (test)
         oldRecord = new InsertedGridRowBuffer(test);
     else
-        oldRecord = new DataGridRowBuffer(buffersM[row]);
+        oldRecord = new DataGridRowBuffer(buffer);
     try
     {
-        buffersM[row]->setFieldNA(col, false);
+        buffer->setFieldNA(col, false);
         if (newIsNull)
-            buffersM[row]->setFieldNull(col, true);
+            buffer->setFieldNull(col, true);
         else
         {
-            columnDefsM[col]->setFromString(buffersM[row], value);
-            buffersM[row]->setFieldNull(col, false);
+            columnDefsM[col]->setFromString(buffer, value);
+            buffer->setFieldNull(col, false);
         }
 
         // run the UPDATE statement
@@ -2168,7 +2978,7 @@ wxString DataGridRows::setFieldValue(unsigned row, unsigned col,
         else
         {
             stm += " = '" +
-                columnDefsM[col]->getAsFirebirdString(buffersM[row])
+                columnDefsM[col]->getAsFirebirdString(buffer)
                 + "' WHERE ";
         }
 
@@ -2187,9 +2997,52 @@ wxString DataGridRows::setFieldValue(unsigned row, unsigned col,
     }
     catch(...)
     {
-        delete buffersM[row];       // delete the new record as it is invalid
-        buffersM[row] = oldRecord;
+        delete buffer;          // delete the new record as it is invalid
+        overlayM[row] = oldRecord;
         throw;
     }
 }
 
+
+// sets the column of the rows to NULL with a single batch of statements
+// the statements executed are returned in stm, the failed rows in errors
+void DataGridRows::setFieldsToNull(unsigned col,
+    const std::vector<unsigned>& rows, wxString& stm,
+    std::vector<IBPP::BatchError>& errors)
+{
+    if (columnDefsM[col]->isReadOnly())
+        throw FRError(_("This column is not editable."));
+    if (!columnDefsM[col]->isNullable())
+        throw FRError(_("This column does not accept NULLs."));
+
+    wxString tn(std2wxIdentifier(statementM->ColumnTable(col + 1),
+        databaseM->getCharsetConverter()));
+    wxString cn(std2wxIdentifier(statementM->ColumnName(col + 1),
+        databaseM->getCharsetConverter()));
+    std::map<wxString, UniqueConstraint *>::iterator it =
+        statementTablesM.find(tn);
+    if (it == statementTablesM.end() || (*it).second == 0)
+        throw FRError(_("This column should not be editable"));
+
+    Identifier iTn(tn, databaseM->getSqlDialect());
+    Identifier iCn(cn, databaseM->getSqlDialect());
+    wxString s = "UPDATE " + iTn.getQuoted() + " SET " + iCn.getQuoted()
+        + " = NULL WHERE";
+    std::vector<bool> done(executeForRows((*it).second, s, tn, rows, stm,
+        errors));
+
+    BlobColumnDef* bcd = dynamic_cast<BlobColumnDef *>(columnDefsM[col]);
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        if (!done[i])
+            continue;
+        DataGridRowBuffer* buffer = getOverlayBuffer(rows[i]);
+        buffer->setFieldNA(col, false);
+        buffer->setFieldNull(col, true);
+        if (bcd)
+        {
+            buffer->setBlob(columnDefsM[col]->getIndex(), IBPP::Blob());
+            bcd->reset(buffer);  // reset cached blob data
+        }
+    }
+}
@@ -30,10 +30,10 @@
 
 #include <ibpp.h>
 
+#include "gui/controls/DataGridRowBuffer.h"
 #include "metadata/constraints.h"
 
 class Database;
-class DataGridRowBuffer;
 class ProgressIndicator;
 class wxMBConv;
 
@@ -51,6 +51,8 @@ public:
 
     virtual wxString getAsFirebirdString(DataGridRowBuffer* buffer);
     virtual wxString getAsString(DataGridRowBuffer* buffer) = 0;
+    // numeric columns return their value without formatting it first
+    virtual bool getAsDouble(DataGridRowBuffer* buffer, double& value);
     virtual void setFromString(DataGridRowBuffer* buffer,
         const wxString& source) = 0;
     virtual unsigned getBufferSize() = 0;
@@ -85,26 +87,74 @@ struct DataGridRowsBlob
 class DataGridRows
 {
 private:
+    // the rows of a result set are decoded by running a plan of simple
+    // steps, one per column, built once by initialize()
+    enum DecodeOpCode { dcSkip, dcInteger, dcInt64, dcScaledInt, dcFloat,
+        dcDouble, dcDate, dcTime, dcTimestamp, dcDBKey, dcBoolean, dcString,
+        dcOctets, dcBlob, dcInt128, dcDecFloat, dcTimeTz, dcTimestampTz };
+    struct DecodeOp
+    {
+        DecodeOpCode code;
+        unsigned column;        // IBPP column number (1-based)
+        unsigned field;         // field number in DataGridRowBuffer
+        unsigned offset;        // data offset, or string or blob index
+        double divisor;         // dcScaledInt: 10 ^ scale
+        size_t charSize;        // dcString: truncation length
+        wxMBConv* converter;    // dcString
+    };
+    std::vector<DecodeOp> decodePlanM;
+
     Database* databaseM;
     const bool readOnlyM;
     IBPP::Statement statementM;
     std::vector<ResultsetColumnDef*> columnDefsM;
-    std::vector<DataGridRowBuffer*> buffersM;
+    DataGridColumnStore storeM;
+    // rows inserted, edited or deleted by the user are kept as buffers
+    // that replace the row in storeM
+    std::map<unsigned, DataGridRowBuffer*> overlayM;
+    // no field of a stored row is N/A, so all of them are deletable or not
+    bool storedRowsDeletableIsSetM;
+    bool storedRowsDeletableM;
     std::map<wxString, UniqueConstraint *> statementTablesM;
     std::map<wxString, UniqueConstraint *>::iterator deleteFromM;
     std::list<UniqueConstraint> dbKeysM;
     unsigned bufferSizeM;
 
+    // the formatted values of the stored rows shown last, per column and
+    // indexed by row modulo the cache size; empty for the columns that
+    // aren't worth caching, edited rows are formatted every time
+    struct FormattedValue
+    {
+        unsigned row;
+        wxString value;
+    };
+    std::vector<std::vector<FormattedValue> > formattedValuesM;
+    unsigned formatGenerationM;
+    void clearFormattedValues();
+
     void getColumnInfo(Database* db, unsigned col, bool& readOnly,
         bool& nullable);
     IBPP::Statement addWhere(UniqueConstraint* uq, wxString& stm,
         const wxString& table, DataGridRowBuffer *buffer);
+    std::vector<bool> executeForRows(UniqueConstraint* uq,
+        const wxString& stm, const wxString& table,
+        const std::vector<unsigned>& rows, wxString& log,
+        std::vector<IBPP::BatchError>& errors);
+    // returns the overlay buffer of the row, or the view itself
+    DataGridRowBuffer* getRowBuffer(ColumnStoreRowBuffer& view);
+    // returns the overlay buffer of the row, creates it if necessary
+    DataGridRowBuffer* getOverlayBuffer(unsigned row);
 public:
     DataGridRows(Database* db);
     ~DataGridRows();
 
     void addRow(const IBPP::Statement& statement);
+    void addRows(const IBPP::RowBatch& batch);
     void clear();
+    // past the limit (0 for none) the oldest rows are spilled to disk
+    void setMemoryLimit(size_t bytes);
+    size_t getResidentSize();
+    size_t getSpilledSize();
     unsigned getRowCount();
     unsigned getRowFieldCount();
     wxString getRowFieldName(unsigned col);
@@ -120,14 +170,20 @@ public:
     bool isFieldNA(unsigned row, unsigned col);
 
     wxString getFieldValue(unsigned row, unsigned col);
+    bool getFieldValueAsDouble(unsigned row, unsigned col, double& value);
     wxString setFieldValue(unsigned row, unsigned col,
         const wxString& value, bool setNull = false);
+    // the rows failed are returned in errors, with their row index
+    void setFieldsToNull(unsigned col, const std::vector<unsigned>& rows,
+        wxString& statement, std::vector<IBPP::BatchError>& errors);
     void importBlobFile(const wxString& filename, unsigned row, unsigned col,
         ProgressIndicator *pi);
     void exportBlobFile(const wxString& filename, unsigned row, unsigned col,
         ProgressIndicator *pi);
     bool canRemoveRow(size_t row);
-    bool removeRows(size_t from, size_t count, wxString& statement);
+    bool removeRows(const std::vector<unsigned>& rows, wxString& statement,
+        std::vector<IBPP::BatchError>& errors);
+    bool isRowDeleted(unsigned row);
 
     ResultsetColumnDef* getColumnDef(unsigned col);
     void addRow(DataGridRowBuffer* buffer);
@@ -31,8 +31,10 @@
 #endif
 
 #include <wx/grid.h>
+#include <wx/thread.h>
 
 #include <algorithm>
+#include <deque>
 #include <set>
 
 #include "config/Config.h"
@@ -42,13 +44,185 @@
 #include "gui/controls/DataGridTable.h"
 #include "gui/AdvancedMessageDialog.h"
 #include "gui/FRLayoutConfig.h"
+#include "gui/StatementWorker.h"
 #include "metadata/column.h"
 #include "metadata/database.h"
 #include "metadata/table.h"
 
+// number of rows read from the server with one Statement::FetchBatch() call
+static const unsigned fetchBlockSize = 256;
+// number of rows read with one call by the fetch thread
+static const unsigned fetchAllBlockSize = 4 * fetchBlockSize;
+// number of blocks the fetch thread may read ahead of the grid
+static const unsigned fetchAllQueueSize = 16;
+
+// DataGridFetchThread reads the remaining rows of a result set while the
+// grid stays responsive; the blocks are queued for the GUI thread, which
+// wakes up through an idle event to append them
+class DataGridFetchThread: public wxThread
+{
+private:
+    IBPP::Statement statementM;
+    IBPP::Database databaseM;
+    wxCriticalSection critSectM;
+    std::deque<IBPP::RowBatch> batchesM;
+    wxSemaphore freeSlotsM;
+    wxSemaphore doneSemM;
+    bool stopM;
+    bool doneM;
+    bool allFetchedM;
+    bool fetchingM;
+    bool canceledM;
+    wxString errorM;
+public:
+    DataGridFetchThread(IBPP::Statement& statement);
+    virtual void* Entry();
+
+    // all of these are thread-safe
+    void stop();
+    // stops the thread and cancels the block being read on the server,
+    // the rows read by it are lost
+    void cancel();
+    void waitUntilDone();
+    // moves the queued blocks to batches, returns true once the thread is
+    // done and all blocks were taken
+    bool takeBatches(std::deque<IBPP::RowBatch>& batches);
+    bool isAllFetched();
+    wxString getError();
+};
+
+DataGridFetchThread::DataGridFetchThread(IBPP::Statement& statement)
+    : wxThread(wxTHREAD_JOINABLE), statementM(statement),
+        databaseM(statement->DatabasePtr()),
+        freeSlotsM(fetchAllQueueSize, 0), stopM(false), doneM(false),
+        allFetchedM(false), fetchingM(false), canceledM(false)
+{
+}
+
+void* DataGridFetchThread::Entry()
+{
+    bool more = true;
+    while (more)
+    {
+        // wait until there is room in the queue, or stop() was called
+        freeSlotsM.Wait();
+        {
+            wxCriticalSectionLocker locker(critSectM);
+            if (stopM)
+                break;
+            fetchingM = true;
+        }
+
+        IBPP::RowBatch batch;
+        wxString error;
+        try
+        {
+            more = statementM->FetchBatch(batch, fetchAllBlockSize);
+        }
+        catch (IBPP::Exception& e)
+        {
+            error = e.what();
+            more = false;
+        }
+        catch (...)
+        {
+            // the batch may have been left with a partial row
+            batch.Clear();
+            error = _("A system error occurred!");
+            more = false;
+        }
+
+        wxCriticalSectionLocker locker(critSectM);
+        fetchingM = false;
+        // the error is the cancellation itself
+        if (canceledM)
+            break;
+        if (batch.Rows())
+            batchesM.push_back(std::move(batch));
+        if (!more)
+        {
+            allFetchedM = true;
+            errorM = error;
+        }
+        wxWakeUpIdle();
+    }
+    {
+        wxCriticalSectionLocker locker(critSectM);
+        doneM = true;
+    }
+    doneSemM.Post();
+    wxWakeUpIdle();
+    return 0;
+}
+
+void DataGridFetchThread::stop()
+{
+    wxCriticalSectionLocker locker(critSectM);
+    if (!stopM)
+    {
+        stopM = true;
+        freeSlotsM.Post();
+    }
+}
+
+void DataGridFetchThread::cancel()
+{
+    wxCriticalSectionLocker locker(critSectM);
+    if (!stopM)
+    {
+        stopM = true;
+        freeSlotsM.Post();
+    }
+    // only while a block is read, as a request sent while nothing runs
+    // would hit the next operation on the attachment
+    if (fetchingM && !canceledM)
+    {
+        canceledM = true;
+        try
+        {
+            databaseM->CancelOperation();
+        }
+        catch (IBPP::Exception&)
+        {
+            // the client library can't cancel, so the block is waited for
+        }
+    }
+}
+
+void DataGridFetchThread::waitUntilDone()
+{
+    doneSemM.Wait();
+    doneSemM.Post();
+}
+
+bool DataGridFetchThread::takeBatches(std::deque<IBPP::RowBatch>& batches)
+{
+    wxCriticalSectionLocker locker(critSectM);
+    for (size_t i = 0; i < batchesM.size(); ++i)
+        freeSlotsM.Post();
+    while (!batchesM.empty())
+    {
+        batches.push_back(std::move(batchesM.front()));
+        batchesM.pop_front();
+    }
+    return doneM;
+}
+
+bool DataGridFetchThread::isAllFetched()
+{
+    wxCriticalSectionLocker locker(critSectM);
+    return allFetchedM;
+}
+
+wxString DataGridFetchThread::getError()
+{
+    wxCriticalSectionLocker locker(critSectM);
+    return errorM;
+}
+
 DataGridTable::DataGridTable(IBPP::Statement& s, Database* db)
     : wxGridTableBase(), statementM(s), databaseM(db), nullFlagM(false),
-        rowsM(db)
+        rowsM(db), workerM(0), fetchThreadM(0)
 {
     allRowsFetchedM = false;
     fetchAllRowsM = false;
@@ -71,6 +245,16 @@ void DataGridTable::setNullFlag(bool isNull)
     nullFlagM = isNull;
 }
 
+void DataGridTable::setStatementWorker(StatementWorker* worker)
+{
+    workerM = worker;
+}
+
+bool DataGridTable::isWorkerRunning()
+{
+    return workerM && workerM->isRunning();
+}
+
 // implementation methods
 bool DataGridTable::canFetchMoreRows()
 {
@@ -80,6 +264,8 @@ bool DataGridTable::canFetchMoreRows()
 
 void DataGridTable::Clear()
 {
+    // the rows read ahead are dropped with all others
+    stopFetchThread();
     nullFlagM = false;
 
     allRowsFetchedM = true;
@@ -88,7 +274,7 @@ void DataGridTable::Clear()
     config().getValue("GridFetchAllRecords", fetchAllRowsM);
 
     unsigned oldCols = rowsM.getRowFieldCount();
-    unsigned oldRows = rowsM.getRowCount();
+    unsigned oldRows = GetNumberRows();
     rowsM.clear();
 
     if (GetView() && oldRows > 0)
@@ -121,54 +307,167 @@ void DataGridTable::fetchOne()
     }
 }
 
+bool DataGridTable::startFetchThread()
+{
+    wxASSERT(!fetchThreadM);
+    fetchThreadM = new DataGridFetchThread(statementM);
+    if (fetchThreadM->Create() != wxTHREAD_NO_ERROR
+        || fetchThreadM->Run() != wxTHREAD_NO_ERROR)
+    {
+        delete fetchThreadM;
+        fetchThreadM = 0;
+        return false;
+    }
+    return true;
+}
+
+void DataGridTable::stopFetchThread()
+{
+    if (!fetchThreadM)
+        return;
+    // the rows are dropped, so the block being read isn't waited for
+    fetchThreadM->cancel();
+    fetchThreadM->Wait();
+    delete fetchThreadM;
+    fetchThreadM = 0;
+}
+
+bool DataGridTable::isFetchingInBackground()
+{
+    return fetchThreadM != 0;
+}
+
+// appends the blocks read by the fetch thread so far, and releases the
+// thread once it is done
+void DataGridTable::appendFetchedRows()
+{
+    std::deque<IBPP::RowBatch> batches;
+    wxString error;
+    if (fetchThreadM->takeBatches(batches))
+    {
+        if (fetchThreadM->isAllFetched())
+            allRowsFetchedM = true;
+        error = fetchThreadM->getError();
+        stopFetchThread();
+    }
+
+    unsigned oldRows = GetNumberRows();
+    try
+    {
+        for (std::deque<IBPP::RowBatch>::iterator it = batches.begin();
+            it != batches.end(); ++it)
+        {
+            rowsM.addRows(*it);
+        }
+    }
+    catch (IBPP::Exception& e)
+    {
+        error = e.what();
+    }
+    catch (...)
+    {
+        error = _("A system error occurred!");
+    }
+    notifyRowsAppended(oldRows);
+    if (!error.empty())
+    {
+        ::wxMessageBox(error,
+            _("An IBPP error occurred."), wxOK|wxICON_ERROR);
+    }
+}
+
+void DataGridTable::notifyRowsAppended(unsigned oldRows)
+{
+    unsigned newRows = GetNumberRows();
+    if (newRows > oldRows && GetView())   // notify the grid
+    {
+        wxGridTableMessage msg(this, wxGRIDTABLE_NOTIFY_ROWS_APPENDED,
+            newRows - oldRows);
+        GetView()->ProcessTableMessage(msg);
+        // used in frame to update status bar
+        wxCommandEvent evt(wxEVT_FRDG_ROWCOUNT_CHANGED, GetView()->GetId());
+        evt.SetExtraLong(newRows);
+        wxPostEvent(GetView(), evt);
+    }
+}
+
 void DataGridTable::fetch()
 {
     if (!canFetchMoreRows())
         return;
+    if (fetchThreadM)
+    {
+        appendFetchedRows();
+        return;
+    }
+    // the grid may ask for more rows while the worker is busy
+    if (isWorkerRunning())
+        return;
+
+    // once the first rows are shown, all others are read by the fetch thread
+    if (fetchAllRowsM && GetNumberRows() > 0
+        && startFetchThread())
+    {
+        return;
+    }
 
     // fetch the first 100 rows no matter how long it takes
-    unsigned oldRows = rowsM.getRowCount();
+    unsigned oldRows = GetNumberRows();
     bool initial = oldRows == 0;
     // fetch more rows until maxRowToFetchM reached or 100 ms elapsed
     wxLongLong startms = ::wxGetLocalTimeMillis();
     do
     {
+        // rows are fetched in blocks, but never more than needed to reach
+        // maxRowToFetchM unless all rows are to be fetched
+        unsigned blockSize = fetchBlockSize;
+        if (!fetchAllRowsM || initial)
+        {
+            unsigned count = GetNumberRows();
+            if (count < maxRowToFetchM && maxRowToFetchM - count < blockSize)
+                blockSize = maxRowToFetchM - count;
+        }
+        // a failure before FetchBatch() mustn't append the last block again
+        batchM.Clear();
         try
         {
-            if (!statementM->Fetch())
+            if (workerM)
+            {
+                bool more = true;
+                workerM->setFetchedRows(GetNumberRows());
+                workerM->run(_("Fetching data"), [this, blockSize, &more]()
+                    { more = statementM->FetchBatch(batchM, blockSize); });
+                if (!more)
+                    allRowsFetchedM = true;
+            }
+            else if (!statementM->FetchBatch(batchM, blockSize))
                 allRowsFetchedM = true;
         }
         catch (IBPP::Exception& e)
         {
+            // the rows read before the error are still shown
             allRowsFetchedM = true;
             ::wxMessageBox(e.what(),
                 _("An IBPP error occurred."), wxOK|wxICON_ERROR);
         }
         catch (...)
         {
+            // the batch may have been left with a partial row
             allRowsFetchedM = true;
+            batchM.Clear();
             ::wxMessageBox(_("A system error occurred!"), _("Error"),
                 wxOK|wxICON_ERROR);
         }
+        rowsM.addRows(batchM);
         if (allRowsFetchedM)
             break;
-        rowsM.addRow(statementM);
 
         if (!initial && (::wxGetLocalTimeMillis() - startms > 100))
             break;
     }
-    while ((fetchAllRowsM && !initial) || rowsM.getRowCount() < maxRowToFetchM);
+    while ((fetchAllRowsM && !initial) || GetNumberRows() < maxRowToFetchM);
 
-    if (rowsM.getRowCount() > oldRows && GetView())   // notify the grid
-    {
-        wxGridTableMessage msg(this, wxGRIDTABLE_NOTIFY_ROWS_APPENDED,
-            rowsM.getRowCount() - oldRows);
-        GetView()->ProcessTableMessage(msg);
-        // used in frame to update status bar
-        wxCommandEvent evt(wxEVT_FRDG_ROWCOUNT_CHANGED, GetView()->GetId());
-        evt.SetExtraLong(rowsM.getRowCount());
-        wxPostEvent(GetView(), evt);
-    }
+    notifyRowsAppended(oldRows);
 }
 
 void DataGridTable::addRow(DataGridRowBuffer *buffer, const wxString& sql)
@@ -251,10 +550,19 @@ wxString DataGridTable::getCellValue(int row, int col)
     return rowsM.getFieldValue(row, col);
 }
 
+bool DataGridTable::getCellValueAsDouble(int row, int col, double& value)
+{
+    if (!isValidCellPos(row, col))
+        return false;
+    return rowsM.getFieldValueAsDouble(row, col, value);
+}
+
 wxString DataGridTable::getCellValueForInsert(int row, int col)
 {
     if (!isValidCellPos(row, col) || rowsM.isFieldNA(row, col))
+    {
         return wxEmptyString;
+    }
 
     if (rowsM.isFieldNull(row, col))
         return "NULL";
@@ -268,7 +576,9 @@ wxString DataGridTable::getCellValueForCSV(int row, int col,
     const wxChar& textDelimiter)
 {
     if (!isValidCellPos(row, col) || rowsM.isFieldNA(row, col))
+    {
         return wxEmptyString;
+    }
 
     const wxString sTextDelim =
         (textDelimiter != '\0') ? wxString(textDelimiter) : "";
@@ -301,6 +611,16 @@ bool DataGridTable::getFetchAllRows()
     return fetchAllRowsM;
 }
 
+size_t DataGridTable::getResidentSize()
+{
+    return rowsM.getResidentSize();
+}
+
+size_t DataGridTable::getSpilledSize()
+{
+    return rowsM.getSpilledSize();
+}
+
 int DataGridTable::GetNumberCols()
 {
     return rowsM.getRowFieldCount();
@@ -451,6 +771,10 @@ void DataGridTable::initialFetch(bool readonly)
     canInsertRowsIsSetM = false;
     canInsertRowsM = false;
     maxRowToFetchM = 100;
+    // rows are spilled to disk past the limit
+    int limit = 1024;
+    config().getValue("GridMemoryLimit", limit);
+    rowsM.setMemoryLimit(size_t(limit) * 1024 * 1024);
 
     try
     {
@@ -507,7 +831,7 @@ bool DataGridTable::isReadonlyColumn(int col)
 
 bool DataGridTable::isValidCellPos(int row, int col)
 {
-    return (row >= 0 && col >= 0 && row < (int)rowsM.getRowCount()
+    return (row >= 0 && col >= 0 && row < GetNumberRows()
         && col < (int)rowsM.getRowFieldCount());
 }
 
@@ -534,12 +858,19 @@ bool DataGridTable::needsMoreRowsFetched()
         return false;
     // true if all rows are to be fetched, or more rows should be cached
     // for more responsive grid scrolling
-    return (fetchAllRowsM || rowsM.getRowCount() < maxRowToFetchM);
+    return (fetchAllRowsM || GetNumberRows() < maxRowToFetchM);
 }
 
 void DataGridTable::setFetchAllRecords(bool fetchall)
 {
     fetchAllRowsM = fetchall;
+    // the rows read ahead so far are kept, the cursor is past them
+    if (!fetchall && fetchThreadM)
+    {
+        fetchThreadM->stop();
+        fetchThreadM->waitUntilDone();
+        appendFetchedRows();
+    }
 }
 
 IBPP::Blob* DataGridTable::getBlob(unsigned row, unsigned col, bool validateBlob)
@@ -644,24 +975,56 @@ void DataGridTable::setValueToNull(int row, int col)
 }
 
 bool DataGridTable::DeleteRows(size_t pos, size_t numRows)
+{
+    std::vector<unsigned> rows;
+    for (size_t i = 0; i < numRows; ++i)
+        rows.push_back(pos + i);
+    return deleteRows(rows);
+}
+
+// rows changed by a batch of statements are not rolled back when some of
+// them fail, so the executed statements are shown before the errors
+static void showBatchErrors(const std::vector<IBPP::BatchError>& errors)
+{
+    if (errors.empty())
+        return;
+    wxString msg(wxString::Format(
+        _("%d rows could not be saved, the first one (row %d) failed with:"),
+        (int)errors.size(), errors.front().row + 1));
+    showErrorDialog(wxGetTopLevelParent(wxGetActiveWindow()),
+        _("Database error"), msg + "\n\n" + errors.front().message.c_str(),
+        AdvancedMessageDialogButtonsOk());
+}
+
+bool DataGridTable::deleteRows(const std::vector<unsigned>& rows)
 {
     // Needs explicit exception handling (see comment for SetValue)
     try
     {
         // remove rows from internal storage
         wxString statement;
-        if (!rowsM.removeRows(pos, numRows, statement))
-            return false;
+        std::vector<IBPP::BatchError> errors;
+        bool deleted = rowsM.removeRows(rows, statement, errors);
 
         // used in frame to show executed statements
         wxGrid* grid = GetView();
-        wxCommandEvent evt2(wxEVT_FRDG_STATEMENT, grid->GetId());
-        evt2.SetString(statement);
-        wxPostEvent(grid, evt2);
+        if (!statement.IsEmpty())
+        {
+            wxCommandEvent evt2(wxEVT_FRDG_STATEMENT, grid->GetId());
+            evt2.SetString(statement);
+            wxPostEvent(grid, evt2);
+        }
 
-        if (numRows > 0)
+        if (deleted)
             grid->ForceRefresh();
-        return true;
+        showBatchErrors(errors);
+        return deleted;
+    }
+    catch (const FRError& err)
+    {
+        showErrorDialog(wxGetTopLevelParent(wxGetActiveWindow()),
+            _("Invalid data"), err.what(),
+            AdvancedMessageDialogButtonsOk());
     }
     catch (const IBPP::Exception& e)
     {
@@ -678,6 +1041,56 @@ bool DataGridTable::DeleteRows(size_t pos, size_t numRows)
     return false;
 }
 
+bool DataGridTable::isRowDeleted(int row)
+{
+    return rowsM.isRowDeleted(row);
+}
+
+void DataGridTable::setValuesToNull(int col, const std::vector<unsigned>& rows)
+{
+    // Needs explicit exception handling (see comment for SetValue)
+    try
+    {
+        wxString statement;
+        std::vector<IBPP::BatchError> errors;
+        rowsM.setFieldsToNull(col, rows, statement, errors);
+
+        if (wxGrid* grid = GetView())
+        {
+            // used in frame to show executed statements
+            if (!statement.IsEmpty())
+            {
+                wxCommandEvent evt(wxEVT_FRDG_STATEMENT, grid->GetId());
+                evt.SetString(statement);
+                wxPostEvent(grid, evt);
+            }
+
+            // used in frame to repaint cells (text color may have changed)
+            wxCommandEvent evt2(wxEVT_FRDG_INVALIDATEATTR, grid->GetId());
+            wxPostEvent(grid, evt2);
+        }
+        showBatchErrors(errors);
+    }
+    catch (const FRError& err)
+    {
+        showErrorDialog(wxGetTopLevelParent(wxGetActiveWindow()),
+            _("Invalid data"), err.what(),
+            AdvancedMessageDialogButtonsOk());
+    }
+    catch (const IBPP::Exception& e)
+    {
+        showErrorDialog(wxGetTopLevelParent(wxGetActiveWindow()),
+            _("Database error"), e.what(),
+            AdvancedMessageDialogButtonsOk());
+    }
+    catch (...)
+    {
+        showErrorDialog(wxGetTopLevelParent(wxGetActiveWindow()),
+            _("System error"), _("Unhandled exception"),
+            AdvancedMessageDialogButtonsOk());
+    }
+}
+
 DEFINE_EVENT_TYPE(wxEVT_FRDG_ROWCOUNT_CHANGED)
 DEFINE_EVENT_TYPE(wxEVT_FRDG_STATEMENT)
 DEFINE_EVENT_TYPE(wxEVT_FRDG_INVALIDATEATTR)
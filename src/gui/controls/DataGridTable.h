@@ -34,9 +34,11 @@
 class Column;
 class Database;
 class DataGridCell;
+class DataGridFetchThread;
 class ResultsetColumnDef;
 class DataGridRowBuffer;
 class ProgressIndicator;
+class StatementWorker;
 
 BEGIN_DECLARE_EVENT_TYPES()
     // this event is sent after new rows have been fetched
@@ -65,7 +67,16 @@ private:
 
     Database *databaseM;
     IBPP::Statement& statementM;
+    IBPP::RowBatch batchM;
     wxMBConv* charsetConverterM;
+    StatementWorker* workerM;
+    // reads the remaining rows ahead while all rows are to be fetched
+    DataGridFetchThread* fetchThreadM;
+
+    void appendFetchedRows();
+    void notifyRowsAppended(unsigned oldRows);
+    bool startFetchThread();
+    void stopFetchThread();
 
     int getStatementColCount();
     bool isValidCellPos(int row, int col);
@@ -78,9 +89,13 @@ public:
     void fetchOne();
     void addRow(DataGridRowBuffer *buffer, const wxString& sql);
     wxString getCellValue(int row, int col);
+    bool getCellValueAsDouble(int row, int col, double& value);
     wxString getCellValueForInsert(int row, int col);
     wxString getCellValueForCSV(int row, int col, const wxChar& textDelimiter);
     bool getFetchAllRows();
+    // memory used by the fetched rows, and size of those spilled to disk
+    size_t getResidentSize();
+    size_t getSpilledSize();
 
     // TODO: these should be replaced with a better function that covers all
     wxString getTableName();
@@ -96,11 +111,17 @@ public:
     bool isReadonlyColumn(int col);
     bool isBlobColumn(int col, bool* pIsTextual = 0);
     bool needsMoreRowsFetched();
+    // true while the fetch thread reads rows, they are appended by fetch()
+    bool isFetchingInBackground();
     void setFetchAllRecords(bool fetchall);
     bool canInsertRows();
     bool canRemoveRow(size_t row);
 
     void setNullFlag(bool isNull);
+    // rows are fetched on the worker thread of the owning frame, if set
+    void setStatementWorker(StatementWorker* worker);
+    // true while that worker runs a request, the rows can't be edited then
+    bool isWorkerRunning();
 
     // methods of wxGridTableBase
     virtual void Clear();
@@ -120,6 +141,10 @@ public:
     DataGridRowsBlob setBlobPrepare(unsigned row, unsigned col);
     void setBlob(DataGridRowsBlob &b);
     void setValueToNull(int row, int col);
+    // these save many rows with a single batch of statements
+    bool deleteRows(const std::vector<unsigned>& rows);
+    bool isRowDeleted(int row);
+    void setValuesToNull(int col, const std::vector<unsigned>& rows);
     // BLOBs can be huge, so we don't use SetValue for that
     void importBlobFile(const wxString& filename, int row, int col,
         ProgressIndicator *pi = 0);
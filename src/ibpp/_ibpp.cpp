@@ -235,6 +235,8 @@ FBCLIENT* FBCLIENT::Call()
 #define FB_ENTRYPOINT(X) \
             if ((m_##X = (proto_##X*)GetProcAddress(mHandle, "fb_"#X)) == 0) \
                 throw LogicExceptionImpl("FBCLIENT:gds()", _("Entry-point fb_"#X" not found"))
+#define FB_OPTIONAL_ENTRYPOINT(X) \
+            m_##X = (proto_##X*)GetProcAddress(mHandle, "fb_"#X)
 #endif
 #ifdef IBPP_UNIX
 #ifdef IBPP_LATE_BIND
@@ -244,9 +246,11 @@ FBCLIENT* FBCLIENT::Call()
 #define FB_ENTRYPOINT(X) \
     if ((m_##X = (proto_##X*)dlsym(mHandle,"fb_"#X)) == 0) \
         throw LogicExceptionImpl("FBCLIENT:gds()", _("Entry-point fb_"#X" not found"))
+#define FB_OPTIONAL_ENTRYPOINT(X) m_##X = (proto_##X*)dlsym(mHandle,"fb_"#X)
 #else
 #define IB_ENTRYPOINT(X) m_##X = (proto_##X*)isc_##X
 #define FB_ENTRYPOINT(X) m_##X = (proto_##X*)fb_##X
+#define FB_OPTIONAL_ENTRYPOINT(X) m_##X = (proto_##X*)fb_##X
 #endif
 #endif
 
@@ -261,6 +265,7 @@ FBCLIENT* FBCLIENT::Call()
 		IB_ENTRYPOINT(cancel_blob);
 		IB_ENTRYPOINT(get_segment);
 		IB_ENTRYPOINT(put_segment);
+		IB_ENTRYPOINT(seek_blob);
 		IB_ENTRYPOINT(blob_info);
 		IB_ENTRYPOINT(array_lookup_bounds);
 		IB_ENTRYPOINT(array_get_slice);
@@ -291,6 +296,7 @@ FBCLIENT* FBCLIENT::Call()
 		IB_ENTRYPOINT(dsql_free_statement);
 		IB_ENTRYPOINT(dsql_set_cursor_name);
 		IB_ENTRYPOINT(dsql_sql_info);
+		FB_OPTIONAL_ENTRYPOINT(cancel_operation);	// Firebird 2.5
 
 		IB_ENTRYPOINT(service_attach);
 		IB_ENTRYPOINT(service_detach);
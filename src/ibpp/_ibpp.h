@@ -48,10 +48,18 @@
 #include <windows.h>
 #endif
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <limits>
+#include <list>
+#include <map>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <sstream>
+#include <thread>
 #include <cstdarg>
 #include <cstring>
 
@@ -116,7 +124,7 @@ class EventsImpl;
 //  Native data types
 typedef enum {ivArray, ivBlob, ivDate, ivTime, ivTimestamp, ivString,
             ivInt16, ivInt32, ivInt64, ivFloat, ivDouble,
-            ivBool, ivDBKey, ivByte} IITYPE;
+            ivBool, ivDBKey, ivByte, ivInt128, ivDecFloat} IITYPE;
 
 //
 //  Those are the Interbase C API prototypes that we use
@@ -193,6 +201,12 @@ typedef ISC_STATUS  ISC_EXPORT proto_put_segment (ISC_STATUS *,
                     unsigned short,
                     char *);
 
+typedef ISC_STATUS  ISC_EXPORT proto_seek_blob (ISC_STATUS *,
+                      isc_blob_handle *,
+                      short,
+                      ISC_LONG,
+                      ISC_LONG *);
+
 typedef ISC_STATUS  ISC_EXPORT proto_blob_info (ISC_STATUS *,
                       isc_blob_handle *,
                       short,
@@ -328,6 +342,10 @@ typedef ISC_STATUS  ISC_EXPORT proto_dsql_sql_info (ISC_STATUS *,
                       short,
                       char *);
 
+typedef ISC_STATUS  ISC_EXPORT proto_cancel_operation (ISC_STATUS *,
+                      isc_db_handle *,
+                      ISC_USHORT);
+
 typedef void        ISC_EXPORT proto_decode_date (ISC_QUAD *,
                     void *);
 
@@ -418,6 +436,7 @@ struct FBCLIENT
     proto_cancel_blob*              m_cancel_blob;
     proto_get_segment*              m_get_segment;
     proto_put_segment*              m_put_segment;
+    proto_seek_blob*                m_seek_blob;
     proto_blob_info*                m_blob_info;
     proto_array_lookup_bounds*      m_array_lookup_bounds;
     proto_array_get_slice*          m_array_get_slice;
@@ -449,6 +468,7 @@ struct FBCLIENT
     proto_dsql_free_statement*      m_dsql_free_statement;
     proto_dsql_set_cursor_name*     m_dsql_set_cursor_name;
     proto_dsql_sql_info*            m_dsql_sql_info;
+    proto_cancel_operation*         m_cancel_operation; // 0 before Firebird 2.5
     //proto_decode_date*                m_decode_date;
     //proto_encode_date*                m_encode_date;
     //proto_add_user*                   m_add_user;
@@ -575,6 +595,7 @@ public:
     int GetValue(char token);
     int GetCountValue(char token);
     void GetDetailedCounts(IBPP::DatabaseCounts& counts, char token);
+    bool Truncated() { return FindToken(isc_info_truncated) != 0; }
     int GetValue(char token, char subtoken);
     bool GetBool(char token);
     int GetString(char token, std::string& data);
@@ -609,6 +630,47 @@ public:
     ~IBS();
 };
 
+//
+//  Table of the Impl objects attached to a Database or Transaction. Attach and
+//  Detach are O(1): the position of each object is indexed, and a detached
+//  object is replaced by the last one. Order of the table is not preserved.
+//
+
+template<class T>
+class Registry
+{
+    std::vector<T*> mItems;
+    std::unordered_map<T*, size_t> mIndex;
+
+public:
+    size_t size() const { return mItems.size(); }
+    bool empty() const { return mItems.empty(); }
+    T* back() const { return mItems.back(); }
+    T* operator[](size_t i) const { return mItems[i]; }
+
+    void Add(T* item)
+    {
+        if (mIndex.insert(std::make_pair(item, mItems.size())).second)
+            mItems.push_back(item);
+    }
+
+    void Remove(T* item)
+    {
+        typename std::unordered_map<T*, size_t>::iterator it = mIndex.find(item);
+        if (it == mIndex.end()) return;
+        size_t pos = it->second;
+        mIndex.erase(it);
+        if (pos != mItems.size() - 1)
+        {
+            mItems[pos] = mItems.back();
+            mIndex[mItems[pos]] = pos;
+        }
+        mItems.pop_back();
+    }
+
+    void Clear() { mItems.clear(); mIndex.clear(); }
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 //  Implementation of the "hidden" classes associated with their public
@@ -746,12 +808,16 @@ class ServiceImpl : public IBPP::IService
     //  (((((((( OBJECT INTERNALS ))))))))
 
 private:
-    int mRefCount;              // Reference counter
+    std::atomic<int> mRefCount;  // Reference counter
     isc_svc_handle mHandle;     // Firebird API Service Handle
     std::string mServerName;    // Server Name
     std::string mUserName;      // User Name
     std::string mUserPassword;  // User Password
     std::string mWaitMessage;   // Progress message returned by WaitMsg()
+    std::string mOutput;        // Incomplete line kept by WaitOutput()
+
+    void NBackup(const std::string& dbfile, const std::string& bkfile,
+        int level, const std::string& guid, IBPP::NBF flags);
 
     isc_svc_handle* GetHandlePtr() { return &mHandle; }
     void SetServerName(const char*);
@@ -790,14 +856,24 @@ public:
     void Restart(const std::string& dbfile);
     void Sweep(const std::string& dbfile);
     void Repair(const std::string& dbfile, IBPP::RPF flags);
+    void GetStatistics(const std::string& dbfile,
+        std::vector<IBPP::TableStatistics>& tables, bool system);
+    void StartStatistics(const std::string& dbfile, bool system);
 
     void StartBackup(const std::string& dbfile, const std::string& bkfile,
-        IBPP::BRF flags = IBPP::BRF(0));
+        IBPP::BRF flags = IBPP::BRF(0), int workers = 0);
     void StartRestore(const std::string& bkfile, const std::string& dbfile,
-        int pagesize, IBPP::BRF flags = IBPP::BRF(0));
+        int pagesize, IBPP::BRF flags = IBPP::BRF(0), int workers = 0);
+    void StartNBackup(const std::string& dbfile, const std::string& bkfile,
+        int level, IBPP::NBF flags = IBPP::NBF(0));
+    void StartNBackup(const std::string& dbfile, const std::string& bkfile,
+        const std::string& guid, IBPP::NBF flags = IBPP::NBF(0));
+    void StartNRestore(const std::vector<std::string>& bkfiles,
+        const std::string& dbfile, IBPP::NBF flags = IBPP::NBF(0));
 
     const char* WaitMsg();
     void Wait();
+    bool WaitOutput(std::string& output);
 
     IBPP::IService* AddRef();
     void Release();
@@ -807,7 +883,7 @@ class DatabaseImpl : public IBPP::IDatabase
 {
     //  (((((((( OBJECT INTERNALS ))))))))
 
-    int mRefCount;              // Reference counter
+    std::atomic<int> mRefCount;  // Reference counter
     isc_db_handle mHandle;      // InterBase API Session Handle
     std::string mServerName;    // Server name
     std::string mDatabaseName;  // Database name (path/file)
@@ -818,15 +894,37 @@ class DatabaseImpl : public IBPP::IDatabase
     std::string mCreateParams;  // Other parameters (creation only)
 
     int mDialect;                           // 1 if IB5, 1 or 3 if IB6/FB1
-    std::vector<TransactionImpl*> mTransactions;// Table of Transaction*
-    std::vector<StatementImpl*> mStatements;// Table of Statement*
-    std::vector<BlobImpl*> mBlobs;          // Table of Blob*
-    std::vector<ArrayImpl*> mArrays;        // Table of Array*
-    std::vector<EventsImpl*> mEvents;       // Table of Events*
+    Registry<TransactionImpl> mTransactions;// Table of Transaction*
+    Registry<StatementImpl> mStatements;    // Table of Statement*
+    Registry<BlobImpl> mBlobs;              // Table of Blob*
+    Registry<ArrayImpl> mArrays;            // Table of Array*
+    Registry<EventsImpl> mEvents;           // Table of Events*
+
+    std::recursive_mutex mMutex;            // Serializes calls on mHandle
+    std::mutex mReleaseMutex;               // Guards the waits for mMutex
+    std::condition_variable mReleased;      // Signaled once mMutex is unlocked
+    std::atomic<int> mReleaseWaiters;       // Threads waiting in WaitForLock()
+
+    // Prepared statements, keyed by transaction Id() and normalized SQL text
+    typedef std::pair<uint64_t, std::string> StatementKey;
+    typedef std::list<std::pair<StatementKey, IBPP::Statement> > StatementList;
+    StatementList mStatementCache;          // Most recently used first
+    std::map<StatementKey, StatementList::iterator> mStatementIndex;
+    int mStatementCacheSize;                // Entries kept at most
+    int mStatementCacheHits;
+    int mStatementCacheMisses;
 
 public:
     isc_db_handle* GetHandlePtr() { return &mHandle; }
     isc_db_handle GetHandle() { return mHandle; }
+    std::recursive_mutex& Mutex() { return mMutex; }
+    // Locks mMutex, waiting for its release unless cancel is set meanwhile,
+    // false if canceled; for threads which must not block on the lock
+    bool WaitForLock(const std::atomic<bool>& cancel);
+    // Wakes WaitForLock(), after mMutex was unlocked or a cancel was set
+    void NotifyLockWaiters();
+    // Adds the Databases of all Transactions, the attachment must be locked
+    void CollectTransactionDatabases(std::vector<DatabaseImpl*>& databases);
 
     void AttachTransactionImpl(TransactionImpl*);
     void DetachTransactionImpl(TransactionImpl*);
@@ -865,6 +963,7 @@ public:
     void Counts(int* Insert, int* Update, int* Delete,
         int* ReadIdx, int* ReadSeq);
     void DetailedCounts(IBPP::DatabaseCounts& counts);
+    IBPP::DatabaseSnapshot Snapshot();
     void Users(std::vector<std::string>& users);
     int Dialect() { return mDialect; }
 
@@ -874,30 +973,83 @@ public:
     void Inactivate();
     void Disconnect();
     void Drop();
+    void CancelOperation();
+
+    IBPP::Statement CachedStatement(IBPP::Transaction tr, const std::string& sql);
+    void SetStatementCacheSize(int size);
+    void ClearStatementCache();
+    void StatementCacheStats(int* Hits, int* Misses);
 
     IBPP::IDatabase* AddRef();
     void Release();
 };
 
+//  Scoped lock on the attachments an IBPP call works with. Every Impl method
+//  which hands a handle depending on an attachment to the client library
+//  holds one of these for the duration of the call. It covers everything the
+//  call, and the Impl methods it calls in turn, can reach: a Statement, Blob
+//  or Array locks its Database and all Databases of its Transaction, a
+//  Transaction all of its Databases, and a Database which may roll back or
+//  release objects of its Transactions locks their Databases as well.
+//  All of them are locked at once at the outermost call. A thread finding
+//  one of them busy there releases the others before it waits, so it never
+//  waits while holding a lock. Nested locks on attachments the thread
+//  already holds cost nothing. A nested lock which needs another attachment
+//  waits for it while holding the outer ones; it only fails if the holder
+//  is in turn waiting, directly or through others, for one of those.
+
+class AttachmentLock
+{
+public:
+    enum Scope {asAttachment, asAttachmentAndTransactions};
+
+private:
+    DatabaseImpl* mDatabase;
+    TransactionImpl* mTransaction;
+    Scope mScope;
+    std::vector<DatabaseImpl*> mLocked;     // Locked by this object
+
+    AttachmentLock(const AttachmentLock&);
+    AttachmentLock& operator=(const AttachmentLock&);
+
+    void Collect(std::vector<DatabaseImpl*>& databases);
+    void Lock();
+    void WaitNested(DatabaseImpl* db);
+    void Unlock();
+
+public:
+    AttachmentLock(DatabaseImpl* database, Scope scope = asAttachment);
+    AttachmentLock(TransactionImpl* transaction, DatabaseImpl* database = 0);
+    ~AttachmentLock();
+
+    // True if the calling thread holds the lock of the attachment
+    static bool Held(DatabaseImpl* database);
+};
+
 class TransactionImpl : public IBPP::ITransaction
 {
     //  (((((((( OBJECT INTERNALS ))))))))
 
 private:
-    int mRefCount;                  // Reference counter
+    std::atomic<int> mRefCount;  // Reference counter
     isc_tr_handle mHandle;          // Transaction InterBase
 
     std::vector<DatabaseImpl*> mDatabases;      // Table of IDatabase*
-    std::vector<StatementImpl*> mStatements;    // Table of IStatement*
-    std::vector<BlobImpl*> mBlobs;              // Table of IBlob*
-    std::vector<ArrayImpl*> mArrays;            // Table of Array*
+    std::mutex mDatabasesMutex;                 // Guards changes of mDatabases
+    Registry<StatementImpl> mStatements;        // Table of IStatement*
+    Registry<BlobImpl> mBlobs;                  // Table of IBlob*
+    Registry<ArrayImpl> mArrays;                // Table of Array*
     std::vector<TPB*> mTPBs;                    // Table of TPB
+    uint64_t mId;           // Unique, unlike the address once destroyed
 
     void Init();            // A usage exclusif des constructeurs
 
 public:
     isc_tr_handle* GetHandlePtr() { return &mHandle; }
     isc_tr_handle GetHandle() { return mHandle; }
+    uint64_t Id() { return mId; }
+    // Adds the attached Databases, safe without holding their locks
+    void CollectDatabases(std::vector<DatabaseImpl*>& databases);
 
     void AttachStatementImpl(StatementImpl*);
     void DetachStatementImpl(StatementImpl*);
@@ -941,18 +1093,31 @@ class RowImpl : public IBPP::IRow
     //  (((((((( OBJECT INTERNALS ))))))))
 
 private:
-    int mRefCount;                  // Reference counter
+    std::atomic<int> mRefCount;  // Reference counter
+
+    union Temporary                 // Storage for the converted values
+    {
+        double mNumeric;
+        float mFloat;
+        int64_t mInt64;
+        int32_t mInt32;
+        int16_t mInt16;
+        char mBool;
+    };
 
     XSQLDA* mDescrArea;             // XSQLDA descriptor itself
-    std::vector<double> mNumerics;  // Temporary storage for Numerics
-    std::vector<float> mFloats;     // Temporary storage for Floats
-    std::vector<int64_t> mInt64s;   // Temporary storage for 64 bits
-    std::vector<int32_t> mInt32s;   // Temporary storage for 32 bits
-    std::vector<int16_t> mInt16s;   // Temporary storage for 16 bits
-    std::vector<char> mBools;       // Temporary storage for Bools
-    std::vector<std::string> mStrings;  // Temporary storage for Strings
+    std::vector<int64_t> mArena;    // sqldata and sqlind of all the variables
+    std::vector<Temporary> mTemps;  // Temporary storage, one per variable
     std::vector<bool> mUpdated;     // Which columns where updated (Set()) ?
 
+    struct FieldReader              // Chosen by CheckFields() for a column
+    {
+        void (*decode)(const XSQLVAR*, void*);
+        void (*clear)(void*);       // Stores the value of a NULL
+    };
+    const IBPP::FAT* mFieldTypes;   // The types mFieldReaders are chosen for
+    std::vector<FieldReader> mFieldReaders;
+
     int mDialect;                   // Related database dialect
     DatabaseImpl* mDatabase;        // Related Database (important for Blobs, ...)
     TransactionImpl* mTransaction;  // Related Transaction (same remark)
@@ -967,6 +1132,12 @@ public:
     void AllocVariables();
     bool MissingValues();       // Returns wether one of the mMissing[] is true
     XSQLDA* Self() { return mDescrArea; }
+    void BatchLayout(IBPP::RowBatch&);  // Sets up the batch columns, no rows
+    void BatchAppend(IBPP::RowBatch&);  // Appends the current values as a row
+    void SaveValues(std::string&);      // Appends the raw values (AddBatch)
+    void LoadValues(int, const std::string&);   // Restores them at a position
+    void CheckFields(const IBPP::FAT*, int);    // Statement::FetchAs() types
+    void DecodeFields(int, void* const*, bool* const*);
 
     RowImpl& operator=(const RowImpl& copied);
     RowImpl(const RowImpl& copied);
@@ -990,6 +1161,8 @@ public:
     void Set(int, const IBPP::Date&);
     void Set(int, const IBPP::Time&);
     void Set(int, const IBPP::DBKey&);
+    void Set(int, const IBPP::Int128&);
+    void Set(int, const IBPP::DecFloat&);
     void Set(int, const IBPP::Blob&);
     void Set(int, const IBPP::Array&);
 
@@ -998,6 +1171,7 @@ public:
     bool Get(int, char*);       // c-strings, len unchecked
     bool Get(int, void*, int&); // byte buffers
     bool Get(int, std::string&);
+    bool GetView(int, const char*&, int&);
     bool Get(int, int16_t&);
     bool Get(int, int32_t&);
     bool Get(int, int64_t&);
@@ -1007,6 +1181,8 @@ public:
     bool Get(int, IBPP::Date&);
     bool Get(int, IBPP::Time&);
     bool Get(int, IBPP::DBKey&);
+    bool Get(int, IBPP::Int128&);
+    bool Get(int, IBPP::DecFloat&);
     bool Get(int, IBPP::Blob&);
     bool Get(int, IBPP::Array&);
 
@@ -1015,6 +1191,7 @@ public:
     bool Get(const std::string&, char*);    // c-strings, len unchecked
     bool Get(const std::string&, void*, int&);  // byte buffers
     bool Get(const std::string&, std::string&);
+    bool GetView(const std::string&, const char*&, int&);
     bool Get(const std::string&, int16_t&);
     bool Get(const std::string&, int32_t&);
     bool Get(const std::string&, int64_t&);
@@ -1024,6 +1201,8 @@ public:
     bool Get(const std::string&, IBPP::Date&);
     bool Get(const std::string&, IBPP::Time&);
     bool Get(const std::string&, IBPP::DBKey&);
+    bool Get(const std::string&, IBPP::Int128&);
+    bool Get(const std::string&, IBPP::DecFloat&);
     bool Get(const std::string&, IBPP::Blob&);
     bool Get(const std::string&, IBPP::Array&);
 
@@ -1054,8 +1233,9 @@ class StatementImpl : public IBPP::IStatement
 
 private:
     friend class TransactionImpl;
+    friend class DatabaseImpl;
 
-    int mRefCount;              // Reference counter
+    std::atomic<int> mRefCount;  // Reference counter
     isc_stmt_handle mHandle;    // Statement Handle
 
     DatabaseImpl* mDatabase;        // Attached database
@@ -1067,9 +1247,14 @@ private:
     bool mCursorOpened;         // dsql_set_cursor_name was called
     IBPP::STT mType;            // Type de requète
     std::string mSql;           // Last SQL statement prepared or executed
+    std::vector<std::string> mBatch;    // Parameter values queued by AddBatch()
+    std::map<int, std::pair<std::string, int> > mCharsets;  // For the blocks
 
     // Internal Methods
     void CursorFree();
+    int RunBatch(std::vector<IBPP::BatchError>*);
+    int RunBatchRow(int, std::vector<IBPP::BatchError>*);
+    int PrepareBlock(IBPP::Statement&, int rows);
 
 public:
     // Properties and Attributes Access Methods
@@ -1094,6 +1279,13 @@ public:
     inline void CursorExecute(const std::string& cursor)    { CursorExecute(cursor, std::string()); }
     bool Fetch();
     bool Fetch(IBPP::Row&);
+    bool FetchBatch(IBPP::RowBatch&, int maxrows);
+    bool FetchFields(const IBPP::FAT*, int, void* const*, bool* const*);
+    void AddBatch();
+    int BatchSize() { return (int)mBatch.size(); }
+    int ExecuteBatch() { return RunBatch(0); }
+    int ExecuteBatch(std::vector<IBPP::BatchError>& errors) { return RunBatch(&errors); }
+    void ClearBatch() { mBatch.clear(); }
     int AffectedRows();
     void Close();   // Free resources, attachments maintained
     std::string& Sql() { return mSql; }
@@ -1113,6 +1305,8 @@ public:
     void Set(int, const IBPP::Date&);
     void Set(int, const IBPP::Time&);
     void Set(int, const IBPP::DBKey&);
+    void Set(int, const IBPP::Int128&);
+    void Set(int, const IBPP::DecFloat&);
     void Set(int, const IBPP::Blob&);
     void Set(int, const IBPP::Array&);
 
@@ -1122,6 +1316,7 @@ public:
     bool Get(int, char*);               // c-strings, len unchecked
     bool Get(int, void*, int&);         // byte buffers
     bool Get(int, std::string&);
+    bool GetView(int, const char*&, int&);
     bool Get(int, int16_t*);
     bool Get(int, int16_t&);
     bool Get(int, int32_t*);
@@ -1136,6 +1331,8 @@ public:
     bool Get(int, IBPP::Date&);
     bool Get(int, IBPP::Time&);
     bool Get(int, IBPP::DBKey&);
+    bool Get(int, IBPP::Int128&);
+    bool Get(int, IBPP::DecFloat&);
     bool Get(int, IBPP::Blob&);
     bool Get(int, IBPP::Array&);
 
@@ -1145,6 +1342,7 @@ public:
     bool Get(const std::string&, char*);        // c-strings, len unchecked
     bool Get(const std::string&, void*, int&);  // byte buffers
     bool Get(const std::string&, std::string&);
+    bool GetView(const std::string&, const char*&, int&);
     bool Get(const std::string&, int16_t*);
     bool Get(const std::string&, int16_t&);
     bool Get(const std::string&, int32_t*);
@@ -1159,6 +1357,8 @@ public:
     bool Get(const std::string&, IBPP::Date&);
     bool Get(const std::string&, IBPP::Time&);
     bool Get(const std::string&, IBPP::DBKey&);
+    bool Get(const std::string&, IBPP::Int128&);
+    bool Get(const std::string&, IBPP::DecFloat&);
     bool Get(const std::string&, IBPP::Blob&);
     bool Get(const std::string&, IBPP::Array&);
 
@@ -1194,8 +1394,9 @@ class BlobImpl : public IBPP::IBlob
 
 private:
     friend class RowImpl;
+    friend class IBPP::RowBatch;
 
-    int mRefCount;
+    std::atomic<int> mRefCount;
     bool                    mIdAssigned;
     ISC_QUAD                mId;
     isc_blob_handle         mHandle;
@@ -1220,17 +1421,21 @@ public:
     //  (((((((( OBJECT INTERFACE ))))))))
 
 public:
-    void Create();
+    void Create(IBPP::BTY type);
     void Open();
     void Close();
     void Cancel();
     int Read(void*, int size);
     void Write(const void*, int size);
+    int Seek(int offset, IBPP::BSK origin);
     void Info(int* Size, int* Largest, int* Segments);
 
     void Save(const std::string& data);
     void Load(std::string& data);
 
+    uint64_t Id();
+    void SetId(uint64_t id);
+
     IBPP::Database DatabasePtr() const;
     IBPP::Transaction TransactionPtr() const;
 
@@ -1244,8 +1449,9 @@ class ArrayImpl : public IBPP::IArray
 
 private:
     friend class RowImpl;
+    friend class IBPP::RowBatch;
 
-    int                 mRefCount;      // Reference counter
+    std::atomic<int> mRefCount;  // Reference counter
     bool                mIdAssigned;
     ISC_QUAD            mId;
     bool                mDescribed;
@@ -1340,14 +1546,26 @@ class EventsImpl : public IBPP::IEvents
     Buffer mEventBuffer;
     Buffer mResultsBuffer;
 
-    int mRefCount;      // Reference counter
+    std::atomic<int> mRefCount;  // Reference counter
 
     DatabaseImpl* mDatabase;
     ISC_LONG mId;           // Firebird internal Id of these events
     bool mQueued;           // Has isc_que_events() been called?
     bool mTrapped;          // EventHandled() was called since last que_events()
 
-    void FireActions();
+    // Delivery thread, see StartDelivery()
+    std::thread mThread;
+    std::mutex mSignalMutex;
+    std::condition_variable mSignal;
+    bool mSignaled;         // EventHandler() was called, for the thread
+    std::atomic<bool> mStopping;
+    std::chrono::milliseconds mWindow;
+    std::chrono::steady_clock::time_point mDelivered;
+    std::vector<uint32_t> mCoalesced;   // Counts not dispatched yet, per event
+
+    void FireActions(bool coalesce);
+    void DeliverCoalesced(bool force);
+    void DeliveryThread();
     void Queue();
     void Cancel();
 
@@ -1369,6 +1587,8 @@ public:
     void List(std::vector<std::string>&);
     void Clear();               // Drop all events
     void Dispatch();            // Dispatch NON async events
+    void StartDelivery(int window);
+    void StopDelivery();
 
     IBPP::Database DatabasePtr() const;
 
@@ -1385,6 +1605,27 @@ void decodeTime(IBPP::Time& tm, const ISC_TIME& isc_tm);
 void encodeTimestamp(ISC_TIMESTAMP& isc_ts, const IBPP::Timestamp& ts);
 void decodeTimestamp(IBPP::Timestamp& ts, const ISC_TIMESTAMP& isc_ts);
 
+void encodeTimeTz(ISC_TIME_TZ_EX& isc_tm, const IBPP::Time& tm);
+void decodeTimeTz(IBPP::Time& tm, const ISC_TIME_TZ_EX& isc_tm);
+
+void encodeTimestampTz(ISC_TIMESTAMP_TZ_EX& isc_ts, const IBPP::Timestamp& ts);
+void decodeTimestampTz(IBPP::Timestamp& ts, const ISC_TIMESTAMP_TZ_EX& isc_ts);
+
+void encodeInt128(FB_I128& fb_i, const IBPP::Int128& i);
+void decodeInt128(IBPP::Int128& i, const FB_I128& fb_i);
+
+void encodeDecFloat(FB_DEC16& fb_df, const IBPP::DecFloat& df);
+void decodeDecFloat(IBPP::DecFloat& df, const FB_DEC16& fb_df);
+void encodeDecFloat(FB_DEC34& fb_df, const IBPP::DecFloat& df);
+void decodeDecFloat(IBPP::DecFloat& df, const FB_DEC34& fb_df);
+
+//  Unsigned 128 bits arithmetic on high and low halves, see int128.cpp
+void mulAdd128(uint64_t& high, uint64_t& low, uint32_t mul, uint32_t add);
+uint32_t divMod128(uint64_t& high, uint64_t& low, uint32_t div);
+
+//  The SQL text as the statement cache keys it, see database.cpp
+std::string NormalizedSql(const std::string& sql);
+
 struct consts   // See _ibpp.cpp for initializations of these constants
 {
     static const double dscales[19];
@@ -34,6 +34,7 @@ using namespace ibpp_internals;
 
 void ArrayImpl::Describe(const std::string& table, const std::string& column)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	//if (mIdAssigned)
 	//	throw LogicExceptionImpl("Array::Lookup", _("Array already in use."));
 	if (mDatabase == 0)
@@ -181,6 +182,7 @@ We have no idea if this is fixed or not in Interbase 6.5 though.
 
 void ArrayImpl::ReadTo(IBPP::ADT adtype, void* data, int datacount)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (! mIdAssigned)
 		throw LogicExceptionImpl("Array::ReadTo", _("Array Id not read from column."));
 	if (! mDescribed)
@@ -531,6 +533,7 @@ void ArrayImpl::ReadTo(IBPP::ADT adtype, void* data, int datacount)
 
 void ArrayImpl::WriteFrom(IBPP::ADT adtype, const void* data, int datacount)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (! mDescribed)
 		throw LogicExceptionImpl("Array::WriteFrom", _("Array description not set."));
 	if (mDatabase == 0)
@@ -912,8 +915,7 @@ void ArrayImpl::Release()
 {
 	// Release cannot throw, except in DEBUG builds on assertion
 	ASSERTION(mRefCount >= 0);
-	--mRefCount;
-	try { if (mRefCount <= 0) delete this; }
+	try { if (--mRefCount <= 0) delete this; }
 		catch (...) { }
 }
 
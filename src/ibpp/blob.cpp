@@ -26,12 +26,16 @@
 #pragma hdrstop
 #endif
 
+#include <algorithm>
+#include <functional>
+
 using namespace ibpp_internals;
 
 //	(((((((( OBJECT INTERFACE IMPLEMENTATION ))))))))
 
 void BlobImpl::Open()
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (mHandle != 0)
 		throw LogicExceptionImpl("Blob::Open", _("Blob already opened."));
 	if (mDatabase == 0)
@@ -49,8 +53,9 @@ void BlobImpl::Open()
 	mWriteMode = false;
 }
 
-void BlobImpl::Create()
+void BlobImpl::Create(IBPP::BTY type)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (mHandle != 0)
 		throw LogicExceptionImpl("Blob::Create", _("Blob already opened."));
 	if (mDatabase == 0)
@@ -58,9 +63,14 @@ void BlobImpl::Create()
 	if (mTransaction == 0)
 		throw LogicExceptionImpl("Blob::Create", _("No Transaction is attached."));
 
+	// Stream blobs need a BPB, segmented ones are the default
+	char bpb[] = {isc_bpb_version1, isc_bpb_type, 1, isc_bpb_type_stream};
+	short bpblen = (type == IBPP::btStream) ? (short)sizeof(bpb) : 0;
+
 	IBS status;
 	(*gds.Call()->m_create_blob2)(status.Self(), mDatabase->GetHandlePtr(),
-		mTransaction->GetHandlePtr(), &mHandle, &mId, 0, 0);
+		mTransaction->GetHandlePtr(), &mHandle, &mId, bpblen,
+		bpblen != 0 ? bpb : 0);
 	if (status.Errors())
 		throw SQLExceptionImpl(status, "Blob::Create",
 			_("isc_create_blob failed."));
@@ -70,6 +80,7 @@ void BlobImpl::Create()
 
 void BlobImpl::Close()
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (mHandle == 0) return;	// Not opened anyway
 
 	IBS status;
@@ -81,6 +92,7 @@ void BlobImpl::Close()
 
 void BlobImpl::Cancel()
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (mHandle == 0) return;	// Not opened anyway
 
 	if (! mWriteMode)
@@ -96,6 +108,7 @@ void BlobImpl::Cancel()
 
 int BlobImpl::Read(void* buffer, int size)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (mHandle == 0)
 		throw LogicExceptionImpl("Blob::Read", _("The Blob is not opened"));
 	if (mWriteMode)
@@ -115,6 +128,7 @@ int BlobImpl::Read(void* buffer, int size)
 
 void BlobImpl::Write(const void* buffer, int size)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (mHandle == 0)
 		throw LogicExceptionImpl("Blob::Write", _("The Blob is not opened"));
 	if (! mWriteMode)
@@ -129,8 +143,25 @@ void BlobImpl::Write(const void* buffer, int size)
 		throw SQLExceptionImpl(status, "Blob::Write", _("isc_put_segment failed."));
 }
 
+int BlobImpl::Seek(int offset, IBPP::BSK origin)
+{
+	AttachmentLock lock(mTransaction, mDatabase);
+	if (mHandle == 0)
+		throw LogicExceptionImpl("Blob::Seek", _("The Blob is not opened"));
+
+	// IBPP::BSK values match the blb_seek modes of isc_seek_blob
+	IBS status;
+	ISC_LONG position = 0;
+	(*gds.Call()->m_seek_blob)(status.Self(), &mHandle, (short)origin,
+		(ISC_LONG)offset, &position);
+	if (status.Errors())
+		throw SQLExceptionImpl(status, "Blob::Seek", _("isc_seek_blob failed."));
+	return (int)position;
+}
+
 void BlobImpl::Info(int* Size, int* Largest, int* Segments)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	char items[] = {isc_info_blob_total_length,
 					isc_info_blob_max_segment,
 					isc_info_blob_num_segments};
@@ -152,6 +183,7 @@ void BlobImpl::Info(int* Size, int* Largest, int* Segments)
 
 void BlobImpl::Save(const std::string& data)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (mHandle != 0)
 		throw LogicExceptionImpl("Blob::Save", _("Blob already opened."));
 	if (mDatabase == 0)
@@ -192,6 +224,7 @@ void BlobImpl::Save(const std::string& data)
 
 void BlobImpl::Load(std::string& data)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (mHandle != 0)
 		throw LogicExceptionImpl("Blob::Load", _("Blob already opened."));
 	if (mDatabase == 0)
@@ -208,27 +241,34 @@ void BlobImpl::Load(std::string& data)
 		throw SQLExceptionImpl(status, "Blob::Load", _("isc_open_blob2 failed."));
 	mWriteMode = false;
 
-	size_t blklen = 32*1024-1;
-	data.resize(blklen);
+	// Size the string once from the blob length, then read straight into it
+	char items[] = {isc_info_blob_total_length};
+	RB info(100);
+	status.Reset();
+	(*gds.Call()->m_blob_info)(status.Self(), &mHandle, sizeof(items), items,
+		(short)info.Size(), info.Self());
+	if (status.Errors())
+		throw SQLExceptionImpl(status, "Blob::Load", _("isc_blob_info failed."));
+	data.resize((size_t)info.GetValue(isc_info_blob_total_length));
 
-	size_t size = 0;
+	const size_t blklen = 64*1024-1;
 	size_t pos = 0;
 	for (;;)
 	{
+		if (pos == data.size())
+			data.resize(pos + blklen);	// Only to detect the end of blob
+		size_t toread = std::min(data.size() - pos, blklen);
 		status.Reset();
 		unsigned short bytesread;
 		ISC_STATUS result = (*gds.Call()->m_get_segment)(status.Self(), &mHandle,
-						&bytesread, (unsigned short)blklen,
-							const_cast<char*>(data.data()+pos));
+						&bytesread, (unsigned short)toread, &data[pos]);
 		if (result == isc_segstr_eof) break;	// End of blob
 		if (result != isc_segment && status.Errors())
 			throw SQLExceptionImpl(status, "Blob::Load", _("isc_get_segment failed."));
 
 		pos += bytesread;
-		size += bytesread;
-		data.resize(size + blklen);
 	}
-	data.resize(size);
+	data.resize(pos);
 	
 	status.Reset();
 	(*gds.Call()->m_close_blob)(status.Self(), &mHandle);
@@ -262,8 +302,7 @@ void BlobImpl::Release()
 {
 	// Release cannot throw, except in DEBUG builds on assertion
 	ASSERTION(mRefCount >= 0);
-	--mRefCount;
-	try { if (mRefCount <= 0) delete this; }
+	try { if (--mRefCount <= 0) delete this; }
 		catch (...) { }
 }
 
@@ -301,6 +340,23 @@ void BlobImpl::GetId(ISC_QUAD* quad)
 	memcpy(quad, &mId, sizeof(mId));
 }
 
+uint64_t BlobImpl::Id()
+{
+	if (! mIdAssigned)
+		throw LogicExceptionImpl("Blob::Id", _("Blob Id is not assigned."));
+
+	uint64_t id;
+	memcpy(&id, &mId, sizeof(id));
+	return id;
+}
+
+void BlobImpl::SetId(uint64_t id)
+{
+	ISC_QUAD quad;
+	memcpy(&quad, &id, sizeof(quad));
+	SetId(&quad);
+}
+
 void BlobImpl::AttachDatabaseImpl(DatabaseImpl* database)
 {
 	if (database == 0) throw LogicExceptionImpl("Blob::AttachDatabase",
@@ -362,3 +418,174 @@ BlobImpl::~BlobImpl()
 	try { if (mDatabase != 0) mDatabase->DetachBlobImpl(this); }
 		catch (...) { }
 }
+
+//	(((((((( BLOB STREAM BUFFER ))))))))
+
+int IBPP::BlobStreamBuf::Fill(std::vector<char>& buffer)
+{
+	// Blob::Read returns one segment at most, of no more than 64Kb-1
+	int filled = 0;
+	while (! mEof && filled < mSegmentSize)
+	{
+		int bytesread = mBlob->Read(&buffer[filled],
+			std::min(mSegmentSize - filled, 64*1024-1));
+		if (bytesread == 0) mEof = true;
+		filled += bytesread;
+	}
+	return filled;
+}
+
+void IBPP::BlobStreamBuf::Flush()
+{
+	char* data = pbase();
+	int len = (int)(pptr() - pbase());
+	while (len > 0)
+	{
+		int blklen = std::min(len, 64*1024-1);
+		mBlob->Write(data, blklen);
+		data += blklen;
+		len -= blklen;
+		mPos += blklen;
+	}
+	setp(&mBuffer[0], &mBuffer[0] + mBuffer.size());
+}
+
+int IBPP::BlobStreamBuf::Drain()
+{
+	// Waits for the read-ahead thread, rethrowing what it threw
+	if (! mPending.valid()) return -1;
+	return mPending.get();
+}
+
+IBPP::BlobStreamBuf::int_type IBPP::BlobStreamBuf::underflow()
+{
+	if (mWriteMode) return traits_type::eof();
+	if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+	int filled;
+	if (mPending.valid())
+	{
+		filled = mPending.get();
+		mBuffer.swap(mNext);
+	}
+	else filled = Fill(mBuffer);
+	if (filled == 0) return traits_type::eof();
+
+	mPos += filled;
+	setg(&mBuffer[0], &mBuffer[0], &mBuffer[0] + filled);
+
+	// The thread owns mBlob and mNext until the next get()
+	if (mReadAhead && ! mEof)
+		mPending = std::async(std::launch::async, &BlobStreamBuf::Fill, this,
+			std::ref(mNext));
+	return traits_type::to_int_type(*gptr());
+}
+
+IBPP::BlobStreamBuf::int_type IBPP::BlobStreamBuf::overflow(int_type c)
+{
+	if (! mWriteMode) return traits_type::eof();
+
+	Flush();
+	if (! traits_type::eq_int_type(c, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+	}
+	return traits_type::not_eof(c);
+}
+
+int IBPP::BlobStreamBuf::sync()
+{
+	if (mWriteMode) Flush();
+	return 0;
+}
+
+IBPP::BlobStreamBuf::pos_type IBPP::BlobStreamBuf::seekoff(off_type off,
+	std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	// Position queries (tellg, tellp) are answered without the server
+	if (dir == std::ios_base::cur && off == 0)
+	{
+		if (mWriteMode) return pos_type(mPos + (pptr() - pbase()));
+		return pos_type(mPos - (egptr() - gptr()));
+	}
+	if (mWriteMode || (which & std::ios_base::in) == 0)
+		return pos_type(off_type(-1));
+
+	int drained = -1;
+	try
+	{
+		drained = Drain();
+		IBPP::BSK origin = IBPP::bkBegin;
+		if (dir == std::ios_base::cur)
+			off += mPos - (egptr() - gptr());	// Blob is ahead of the reader
+		else if (dir == std::ios_base::end)
+			origin = IBPP::bkEnd;
+		mPos = mBlob->Seek((int)off, origin);
+	}
+	catch (IBPP::Exception&)
+	{
+		// Segmented Blobs can't seek: keep what was read ahead for underflow()
+		if (drained > 0)
+		{
+			std::promise<int> ready;
+			ready.set_value(drained);
+			mPending = ready.get_future();
+		}
+		return pos_type(off_type(-1));
+	}
+
+	mEof = false;
+	setg(&mBuffer[0], &mBuffer[0], &mBuffer[0]);
+	return pos_type(mPos);
+}
+
+IBPP::BlobStreamBuf::pos_type IBPP::BlobStreamBuf::seekpos(pos_type pos,
+	std::ios_base::openmode which)
+{
+	return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+void IBPP::BlobStreamBuf::Close()
+{
+	if (mWriteMode) Flush();
+	else
+	{
+		// Whatever went wrong reading ahead concerns data nobody will read
+		try { Drain(); }
+			catch (IBPP::Exception&) { }
+		setg(&mBuffer[0], &mBuffer[0], &mBuffer[0]);
+	}
+	mBlob->Close();
+}
+
+IBPP::BlobStreamBuf::BlobStreamBuf(IBPP::Blob blob, std::ios_base::openmode mode,
+	int segmentsize, bool readahead)
+	: mBlob(blob), mWriteMode((mode & std::ios_base::out) != 0),
+	mReadAhead(readahead && (mode & std::ios_base::out) == 0), mEof(false),
+	mSegmentSize(segmentsize), mPos(0)
+{
+	if (mBlob.intf() == 0)
+		throw LogicExceptionImpl("BlobStreamBuf", _("Can't stream an unbound Blob."));
+	if (mSegmentSize < 1)
+		throw LogicExceptionImpl("BlobStreamBuf", _("Invalid segment size."));
+
+	mBuffer.resize(mSegmentSize);
+	if (mWriteMode)
+	{
+		mBlob->Create();
+		setp(&mBuffer[0], &mBuffer[0] + mBuffer.size());
+	}
+	else
+	{
+		if (mReadAhead) mNext.resize(mSegmentSize);
+		mBlob->Open();
+		setg(&mBuffer[0], &mBuffer[0], &mBuffer[0]);
+	}
+}
+
+IBPP::BlobStreamBuf::~BlobStreamBuf()
+{
+	try { Close(); }
+		catch (...) { }
+}
@@ -27,6 +27,7 @@
 #endif
 
 #include <algorithm>
+#include <functional>
 
 using namespace ibpp_internals;
 
@@ -34,6 +35,7 @@ using namespace ibpp_internals;
 
 void DatabaseImpl::Create(int dialect)
 {
+    AttachmentLock lock(this);
     if (mHandle != 0)
         throw LogicExceptionImpl("Database::Create", _("Database is already connected."));
     if (mDatabaseName.empty())
@@ -66,6 +68,7 @@ void DatabaseImpl::Create(int dialect)
 
 void DatabaseImpl::Connect()
 {
+    AttachmentLock lock(this);
     if (mHandle != 0) return;   // Already connected
 
     if (mDatabaseName.empty())
@@ -140,10 +143,14 @@ void DatabaseImpl::Connect()
 
 void DatabaseImpl::Inactivate()
 {
+    AttachmentLock lock(this, AttachmentLock::asAttachmentAndTransactions);
     if (mHandle == 0) return;   // Not connected anyway
 
     IBS status;
 
+    // The cached statements would keep their handles otherwise
+    ClearStatementCache();
+
     // Rollback any started transaction...
     for (unsigned i = 0; i < mTransactions.size(); i++)
     {
@@ -178,6 +185,7 @@ void DatabaseImpl::Inactivate()
 
 void DatabaseImpl::Disconnect()
 {
+    AttachmentLock lock(this, AttachmentLock::asAttachmentAndTransactions);
     if (mHandle == 0) return;   // Not connected anyway
 
     // Put the connection to rest
@@ -196,6 +204,7 @@ void DatabaseImpl::Disconnect()
 
 void DatabaseImpl::Drop()
 {
+    AttachmentLock lock(this, AttachmentLock::asAttachmentAndTransactions);
     if (mHandle == 0)
         throw LogicExceptionImpl("Database::Drop", _("Database must be connected."));
 
@@ -210,10 +219,140 @@ void DatabaseImpl::Drop()
     mHandle = 0;
 }
 
+void DatabaseImpl::CancelOperation()
+{
+    if (mHandle == 0)
+        throw LogicExceptionImpl("Database::CancelOperation", _("Database is not connected."));
+    if (gds.Call()->m_cancel_operation == 0)
+        throw LogicExceptionImpl("Database::CancelOperation",
+            _("The client library does not support cancelling (Firebird 2.5 or later needed)."));
+
+    // Only uses the handle, so it is safe while another thread waits for the
+    // server. The running request then fails with isc_cancelled.
+    IBS status;
+    (*gds.Call()->m_cancel_operation)(status.Self(), &mHandle, fb_cancel_raise);
+    if (status.Errors())
+        throw SQLExceptionImpl(status, "Database::CancelOperation",
+            _("fb_cancel_operation failed"));
+}
+
+namespace ibpp_internals
+{
+    // Collapses whitespace runs outside of string literals and quoted
+    // identifiers to a single space, and trims both ends
+    std::string NormalizedSql(const std::string& sql)
+    {
+        std::string result;
+        result.reserve(sql.size());
+        char quote = 0;
+        bool space = false;
+        for (std::string::size_type i = 0; i < sql.size(); i++)
+        {
+            char c = sql[i];
+            if (quote == 0 && (c == ' ' || c == '\t' || c == '\r' || c == '\n'))
+            {
+                space = true;
+                continue;
+            }
+            if (space && ! result.empty()) result += ' ';
+            space = false;
+            if (quote == 0 && (c == '\'' || c == '"')) quote = c;
+            else if (c == quote) quote = 0;
+            result += c;
+        }
+        return result;
+    }
+}
+
+IBPP::Statement DatabaseImpl::CachedStatement(IBPP::Transaction tr,
+    const std::string& sql)
+{
+    // Releasing cached statements reaches into their Transactions
+    AttachmentLock lock(this, AttachmentLock::asAttachmentAndTransactions);
+    if (mHandle == 0)
+        throw LogicExceptionImpl("Database::CachedStatement", _("Database is not connected."));
+    if (tr.intf() == 0)
+        throw LogicExceptionImpl("Database::CachedStatement",
+            _("Can't use an unbound Transaction."));
+
+    TransactionImpl* trImpl = dynamic_cast<TransactionImpl*>(tr.intf());
+    StatementKey key(trImpl->Id(), NormalizedSql(sql));
+    std::map<StatementKey, StatementList::iterator>::iterator it =
+        mStatementIndex.find(key);
+    if (it != mStatementIndex.end())
+    {
+        // A Close()d statement makes the entry stale
+        IBPP::Statement st = it->second->second;
+        if (st->Type() != IBPP::stUnknown && st->TransactionPtr() == tr)
+        {
+            // The end of the transaction closes the cursors, so the failure
+            // to close one is a real error
+            try { dynamic_cast<StatementImpl*>(st.intf())->CursorFree(); }
+            catch (IBPP::Exception&)
+            {
+                mStatementCache.erase(it->second);
+                mStatementIndex.erase(it);
+                throw;
+            }
+            mStatementCache.splice(mStatementCache.begin(), mStatementCache,
+                it->second);
+            mStatementCacheHits++;
+            return st;
+        }
+        mStatementCache.erase(it->second);
+        mStatementIndex.erase(it);
+    }
+
+    mStatementCacheMisses++;
+    IBPP::Statement st = new StatementImpl(this, trImpl);
+    st->Prepare(sql);
+    if (mStatementCacheSize > 0)
+    {
+        mStatementCache.push_front(std::make_pair(key, st));
+        mStatementIndex[key] = mStatementCache.begin();
+        while ((int)mStatementCache.size() > mStatementCacheSize)
+        {
+            mStatementIndex.erase(mStatementCache.back().first);
+            mStatementCache.pop_back();
+        }
+    }
+    return st;
+}
+
+void DatabaseImpl::SetStatementCacheSize(int size)
+{
+    AttachmentLock lock(this, AttachmentLock::asAttachmentAndTransactions);
+    if (size < 0)
+        throw LogicExceptionImpl("Database::SetStatementCacheSize",
+            _("Cache size can't be negative."));
+
+    mStatementCacheSize = size;
+    while ((int)mStatementCache.size() > mStatementCacheSize)
+    {
+        mStatementIndex.erase(mStatementCache.back().first);
+        mStatementCache.pop_back();
+    }
+}
+
+void DatabaseImpl::ClearStatementCache()
+{
+    AttachmentLock lock(this, AttachmentLock::asAttachmentAndTransactions);
+    mStatementIndex.clear();
+    mStatementCache.clear();
+}
+
+void DatabaseImpl::StatementCacheStats(int* Hits, int* Misses)
+{
+    AttachmentLock lock(this);
+    if (Hits != 0) *Hits = mStatementCacheHits;
+    if (Misses != 0) *Misses = mStatementCacheMisses;
+}
+
 void DatabaseImpl::Info(int* ODSMajor, int* ODSMinor,
     int* PageSize, int* Pages, int* Buffers, int* Sweep,
     bool* Sync, bool* Reserve, bool* ReadOnly)
 {
+    AttachmentLock lock(this);
     if (mHandle == 0)
         throw LogicExceptionImpl("Database::Info", _("Database is not connected."));
 
@@ -253,6 +392,7 @@ void DatabaseImpl::Info(int* ODSMajor, int* ODSMinor,
 void DatabaseImpl::TransactionInfo(int* Oldest, int* OldestActive,
     int* OldestSnapshot, int* Next)
 {
+    AttachmentLock lock(this);
     if (mHandle == 0)
         throw LogicExceptionImpl("Database::TransactionInfo", _("Database is not connected."));
 
@@ -282,6 +422,7 @@ void DatabaseImpl::TransactionInfo(int* Oldest, int* OldestActive,
 
 void DatabaseImpl::Statistics(int* Fetches, int* Marks, int* Reads, int* Writes, int* CurrentMemory)
 {
+    AttachmentLock lock(this);
     if (mHandle == 0)
         throw LogicExceptionImpl("Database::Statistics", _("Database is not connected."));
 
@@ -310,6 +451,7 @@ void DatabaseImpl::Statistics(int* Fetches, int* Marks, int* Reads, int* Writes,
 void DatabaseImpl::Counts(int* Insert, int* Update, int* Delete,
     int* ReadIdx, int* ReadSeq)
 {
+    AttachmentLock lock(this);
     if (mHandle == 0)
         throw LogicExceptionImpl("Database::Counts", _("Database is not connected."));
 
@@ -337,6 +479,7 @@ void DatabaseImpl::Counts(int* Insert, int* Update, int* Delete,
 
 void DatabaseImpl::DetailedCounts(IBPP::DatabaseCounts& counts)
 {
+    AttachmentLock lock(this);
     if (mHandle == 0)
         throw LogicExceptionImpl("Database::DetailedCounts", _("Database is not connected."));
 
@@ -358,8 +501,65 @@ void DatabaseImpl::DetailedCounts(IBPP::DatabaseCounts& counts)
     result.GetDetailedCounts(counts, isc_info_delete_count);
 }
 
+IBPP::DatabaseSnapshot DatabaseImpl::Snapshot()
+{
+    AttachmentLock lock(this);
+    if (mHandle == 0)
+        throw LogicExceptionImpl("Database::Snapshot", _("Database is not connected."));
+
+    char items[] = {isc_info_fetches,
+                    isc_info_marks,
+                    isc_info_reads,
+                    isc_info_writes,
+                    isc_info_current_memory,
+                    isc_info_insert_count,
+                    isc_info_update_count,
+                    isc_info_delete_count,
+                    isc_info_read_idx_count,
+                    isc_info_read_seq_count,
+                    isc_info_end};
+    IBS status;
+
+    // The per relation counts may not fit the first buffer, but a single
+    // retry with the largest one will do for most databases
+    int size = 4096;
+    for (;;)
+    {
+        RB result(size);
+        status.Reset();
+        (*gds.Call()->m_database_info)(status.Self(), &mHandle, sizeof(items), items,
+            result.Size(), result.Self());
+        if (status.Errors())
+            throw SQLExceptionImpl(status, "Database::Snapshot", _("isc_database_info failed"));
+        if (result.Truncated())
+        {
+            if (size == 32767)
+                throw LogicExceptionImpl("Database::Snapshot", _("Too many counters."));
+            size = 32767;
+            continue;
+        }
+
+        IBPP::DatabaseSnapshot snapshot;
+        snapshot.fetches = result.GetValue(isc_info_fetches);
+        snapshot.marks = result.GetValue(isc_info_marks);
+        snapshot.reads = result.GetValue(isc_info_reads);
+        snapshot.writes = result.GetValue(isc_info_writes);
+        snapshot.currentMemory = result.GetValue(isc_info_current_memory);
+        snapshot.inserts = result.GetCountValue(isc_info_insert_count);
+        snapshot.updates = result.GetCountValue(isc_info_update_count);
+        snapshot.deletes = result.GetCountValue(isc_info_delete_count);
+        snapshot.readIdx = result.GetCountValue(isc_info_read_idx_count);
+        snapshot.readSeq = result.GetCountValue(isc_info_read_seq_count);
+        result.GetDetailedCounts(snapshot.counts, isc_info_insert_count);
+        result.GetDetailedCounts(snapshot.counts, isc_info_update_count);
+        result.GetDetailedCounts(snapshot.counts, isc_info_delete_count);
+        return snapshot;
+    }
+}
+
 void DatabaseImpl::Users(std::vector<std::string>& users)
 {
+    AttachmentLock lock(this);
     if (mHandle == 0)
         throw LogicExceptionImpl("Database::Users", _("Database is not connected."));
 
@@ -398,101 +598,131 @@ void DatabaseImpl::Release()
 {
     // Release cannot throw, except in DEBUG builds on assertion
     ASSERTION(mRefCount >= 0);
-    --mRefCount;
-    try { if (mRefCount <= 0) delete this; }
+    try { if (--mRefCount <= 0) delete this; }
         catch (...) { }
 }
 
 //  (((((((( OBJECT INTERNAL METHODS ))))))))
 
+void DatabaseImpl::CollectTransactionDatabases(std::vector<DatabaseImpl*>& databases)
+{
+    for (size_t i = 0; i < mTransactions.size(); i++)
+        mTransactions[i]->CollectDatabases(databases);
+}
+
 void DatabaseImpl::AttachTransactionImpl(TransactionImpl* tr)
 {
+    AttachmentLock lock(this);
     if (tr == 0)
         throw LogicExceptionImpl("Database::AttachTransaction",
                     _("Transaction object is null."));
 
-    mTransactions.push_back(tr);
+    mTransactions.Add(tr);
 }
 
 void DatabaseImpl::DetachTransactionImpl(TransactionImpl* tr)
 {
+    StatementList released;     // Destroyed once the lock is released
+    AttachmentLock lock(this);
     if (tr == 0)
         throw LogicExceptionImpl("Database::DetachTransaction",
                 _("ITransaction object is null."));
 
-    mTransactions.erase(std::find(mTransactions.begin(), mTransactions.end(), tr));
+    // The cached statements of the transaction can't be used any more
+    for (StatementList::iterator it = mStatementCache.begin();
+        it != mStatementCache.end(); )
+    {
+        StatementList::iterator next = it;
+        ++next;
+        if (it->first.first == tr->Id())
+        {
+            mStatementIndex.erase(it->first);
+            released.splice(released.end(), mStatementCache, it);
+        }
+        it = next;
+    }
+
+    mTransactions.Remove(tr);
 }
 
 void DatabaseImpl::AttachStatementImpl(StatementImpl* st)
 {
+    AttachmentLock lock(this);
     if (st == 0)
         throw LogicExceptionImpl("Database::AttachStatement",
                     _("Can't attach a null Statement object."));
 
-    mStatements.push_back(st);
+    mStatements.Add(st);
 }
 
 void DatabaseImpl::DetachStatementImpl(StatementImpl* st)
 {
+    AttachmentLock lock(this);
     if (st == 0)
         throw LogicExceptionImpl("Database::DetachStatement",
                 _("Can't detach a null Statement object."));
 
-    mStatements.erase(std::find(mStatements.begin(), mStatements.end(), st));
+    mStatements.Remove(st);
 }
 
 void DatabaseImpl::AttachBlobImpl(BlobImpl* bb)
 {
+    AttachmentLock lock(this);
     if (bb == 0)
         throw LogicExceptionImpl("Database::AttachBlob",
                     _("Can't attach a null Blob object."));
 
-    mBlobs.push_back(bb);
+    mBlobs.Add(bb);
 }
 
 void DatabaseImpl::DetachBlobImpl(BlobImpl* bb)
 {
+    AttachmentLock lock(this);
     if (bb == 0)
         throw LogicExceptionImpl("Database::DetachBlob",
                 _("Can't detach a null Blob object."));
 
-    mBlobs.erase(std::find(mBlobs.begin(), mBlobs.end(), bb));
+    mBlobs.Remove(bb);
 }
 
 void DatabaseImpl::AttachArrayImpl(ArrayImpl* ar)
 {
+    AttachmentLock lock(this);
     if (ar == 0)
         throw LogicExceptionImpl("Database::AttachArray",
                     _("Can't attach a null Array object."));
 
-    mArrays.push_back(ar);
+    mArrays.Add(ar);
 }
 
 void DatabaseImpl::DetachArrayImpl(ArrayImpl* ar)
 {
+    AttachmentLock lock(this);
     if (ar == 0)
         throw LogicExceptionImpl("Database::DetachArray",
                 _("Can't detach a null Array object."));
 
-    mArrays.erase(std::find(mArrays.begin(), mArrays.end(), ar));
+    mArrays.Remove(ar);
 }
 
 void DatabaseImpl::AttachEventsImpl(EventsImpl* ev)
 {
+    AttachmentLock lock(this);
     if (ev == 0)
         throw LogicExceptionImpl("Database::AttachEventsImpl",
                     _("Can't attach a null Events object."));
 
-    mEvents.push_back(ev);
+    mEvents.Add(ev);
 }
 
 void DatabaseImpl::DetachEventsImpl(EventsImpl* ev)
 {
+    AttachmentLock lock(this);
     if (ev == 0)
         throw LogicExceptionImpl("Database::DetachEventsImpl",
                 _("Can't detach a null Events object."));
 
-    mEvents.erase(std::find(mEvents.begin(), mEvents.end(), ev));
+    mEvents.Remove(ev);
 }
 
 DatabaseImpl::DatabaseImpl(const std::string& ServerName, const std::string& DatabaseName,
@@ -504,7 +734,8 @@ DatabaseImpl::DatabaseImpl(const std::string& ServerName, const std::string& Dat
     mServerName(ServerName), mDatabaseName(DatabaseName),
     mUserName(UserName), mUserPassword(UserPassword), mRoleName(RoleName),
     mCharSet(CharSet), mCreateParams(CreateParams),
-    mDialect(3)
+    mDialect(3), mReleaseWaiters(0), mStatementCacheSize(16),
+    mStatementCacheHits(0), mStatementCacheMisses(0)
 {
 }
 
@@ -513,3 +744,237 @@ DatabaseImpl::~DatabaseImpl()
     try { if (Connected()) Disconnect(); }
         catch(...) { }
 }
+
+bool DatabaseImpl::WaitForLock(const std::atomic<bool>& cancel)
+{
+    // Counted before trying, so that an unlock racing with the try notifies
+    std::unique_lock<std::mutex> guard(mReleaseMutex);
+    mReleaseWaiters++;
+    bool locked;
+    while (! (locked = mMutex.try_lock()) && ! cancel)
+        mReleased.wait(guard);
+    mReleaseWaiters--;
+    return locked;
+}
+
+void DatabaseImpl::NotifyLockWaiters()
+{
+    if (mReleaseWaiters == 0) return;
+    std::lock_guard<std::mutex> guard(mReleaseMutex);
+    mReleased.notify_all();
+}
+
+//  (((((((( ATTACHMENT LOCK ))))))))
+
+namespace
+{
+    // The attachments locked by the calling thread, in locking order
+    std::vector<DatabaseImpl*>& HeldAttachments()
+    {
+        static thread_local std::vector<DatabaseImpl*> held;
+        return held;
+    }
+
+    // A thread waiting for an attachment inside of another call, so while
+    // holding the ones of the outer call
+    struct NestedWaiter
+    {
+        std::thread::id thread;
+        std::vector<DatabaseImpl*> held;
+        DatabaseImpl* wanted;
+    };
+
+    std::mutex gNestedWaitersMutex;
+    std::vector<NestedWaiter> gNestedWaiters;
+
+    // True if the holders of wanted, followed from waiter to waiter, end
+    // up waiting for one of the held attachments. Only nested waiters can
+    // be part of such a cycle, the others hold nothing while they wait.
+    bool WouldDeadlock(const std::vector<DatabaseImpl*>& held, DatabaseImpl* wanted)
+    {
+        for (size_t steps = 0; steps <= gNestedWaiters.size(); steps++)
+        {
+            if (std::find(held.begin(), held.end(), wanted) != held.end())
+                return true;
+            const NestedWaiter* holder = 0;
+            for (size_t i = 0; i < gNestedWaiters.size() && holder == 0; i++)
+            {
+                const std::vector<DatabaseImpl*>& h = gNestedWaiters[i].held;
+                if (std::find(h.begin(), h.end(), wanted) != h.end())
+                    holder = &gNestedWaiters[i];
+            }
+            if (holder == 0) return false;
+            wanted = holder->wanted;
+        }
+        return false;
+    }
+}
+
+AttachmentLock::AttachmentLock(DatabaseImpl* database, Scope scope)
+    : mDatabase(database), mTransaction(0), mScope(scope)
+{
+    Lock();
+}
+
+AttachmentLock::AttachmentLock(TransactionImpl* transaction, DatabaseImpl* database)
+    : mDatabase(database), mTransaction(transaction), mScope(asAttachment)
+{
+    Lock();
+}
+
+AttachmentLock::~AttachmentLock()
+{
+    Unlock();
+}
+
+bool AttachmentLock::Held(DatabaseImpl* database)
+{
+    std::vector<DatabaseImpl*>& held = HeldAttachments();
+    return std::find(held.begin(), held.end(), database) != held.end();
+}
+
+void AttachmentLock::Collect(std::vector<DatabaseImpl*>& databases)
+{
+    if (mDatabase != 0)
+    {
+        databases.push_back(mDatabase);
+        // The Transactions can only be listed once the attachment is locked
+        if (mScope == asAttachmentAndTransactions && Held(mDatabase))
+            mDatabase->CollectTransactionDatabases(databases);
+    }
+    if (mTransaction != 0)
+        mTransaction->CollectDatabases(databases);
+
+    std::sort(databases.begin(), databases.end(), std::less<DatabaseImpl*>());
+    databases.erase(std::unique(databases.begin(), databases.end()), databases.end());
+}
+
+void AttachmentLock::Lock()
+{
+    std::vector<DatabaseImpl*>& held = HeldAttachments();
+    // Inside of another call the locks held can't be given up to wait
+    bool nested = ! held.empty();
+
+    std::vector<DatabaseImpl*> wanted;
+    Collect(wanted);
+    while (true)
+    {
+        bool busy = false;
+        for (size_t i = 0; i < wanted.size(); i++)
+        {
+            DatabaseImpl* db = wanted[i];
+            if (Held(db)) continue;
+            if (! db->Mutex().try_lock())
+            {
+                if (nested) WaitNested(db);
+                else
+                {
+                    // Back off, so that no thread waits at the outermost
+                    // call while holding locks, then start over
+                    Unlock();
+                    db->Mutex().lock();
+                    db->Mutex().unlock();
+                    db->NotifyLockWaiters();
+                    busy = true;
+                    break;
+                }
+            }
+            mLocked.push_back(db);
+            held.push_back(db);
+        }
+        if (busy) continue;
+
+        // Once locked, the objects may turn out to involve more attachments
+        std::vector<DatabaseImpl*> needed;
+        Collect(needed);
+        bool covered = true;
+        for (size_t i = 0; i < needed.size(); i++)
+            if (! Held(needed[i])) covered = false;
+        if (covered) return;
+
+        // Start over with all of them
+        if (! nested) Unlock();
+        wanted.insert(wanted.end(), needed.begin(), needed.end());
+        std::sort(wanted.begin(), wanted.end(), std::less<DatabaseImpl*>());
+        wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+    }
+}
+
+void AttachmentLock::WaitNested(DatabaseImpl* db)
+{
+    std::vector<DatabaseImpl*>& held = HeldAttachments();
+    {
+        std::lock_guard<std::mutex> guard(gNestedWaitersMutex);
+        if (WouldDeadlock(held, db))
+        {
+            Unlock();
+            throw LogicExceptionImpl("AttachmentLock",
+                _("Deadlock: the attachment is locked by a thread waiting for one held by this call."));
+        }
+        NestedWaiter waiter;
+        waiter.thread = std::this_thread::get_id();
+        waiter.held = held;
+        waiter.wanted = db;
+        gNestedWaiters.push_back(waiter);
+    }
+
+    db->Mutex().lock();
+
+    std::lock_guard<std::mutex> guard(gNestedWaitersMutex);
+    for (size_t i = 0; i < gNestedWaiters.size(); i++)
+        if (gNestedWaiters[i].thread == std::this_thread::get_id())
+        {
+            gNestedWaiters.erase(gNestedWaiters.begin() + i);
+            break;
+        }
+}
+
+void AttachmentLock::Unlock()
+{
+    std::vector<DatabaseImpl*>& held = HeldAttachments();
+    for (size_t i = mLocked.size(); i > 0; i--)
+    {
+        DatabaseImpl* db = mLocked[i-1];
+        held.erase(std::find(held.begin(), held.end(), db));
+        db->Mutex().unlock();
+        db->NotifyLockWaiters();
+    }
+    mLocked.clear();
+}
+
+//  (((((((( DATABASE SNAPSHOT ))))))))
+
+IBPP::DatabaseSnapshot IBPP::DatabaseSnapshot::Diff(
+    const IBPP::DatabaseSnapshot& before) const
+{
+    IBPP::DatabaseSnapshot delta;
+    delta.fetches = fetches - before.fetches;
+    delta.marks = marks - before.marks;
+    delta.reads = reads - before.reads;
+    delta.writes = writes - before.writes;
+    delta.currentMemory = currentMemory - before.currentMemory;
+    delta.inserts = inserts - before.inserts;
+    delta.updates = updates - before.updates;
+    delta.deletes = deletes - before.deletes;
+    delta.readIdx = readIdx - before.readIdx;
+    delta.readSeq = readSeq - before.readSeq;
+
+    // Both maps are ordered by relation id, so walk them side by side
+    IBPP::DatabaseCounts::const_iterator old = before.counts.begin();
+    for (IBPP::DatabaseCounts::const_iterator it = counts.begin();
+        it != counts.end(); ++it)
+    {
+        while (old != before.counts.end() && old->first < it->first)
+            ++old;
+        IBPP::CountInfo info = it->second;
+        if (old != before.counts.end() && old->first == it->first)
+        {
+            info.inserts -= old->second.inserts;
+            info.updates -= old->second.updates;
+            info.deletes -= old->second.deletes;
+        }
+        if (info.inserts != 0 || info.updates != 0 || info.deletes != 0)
+            delta.counts.insert(delta.counts.end(), std::make_pair(it->first, info));
+    }
+    return delta;
+}
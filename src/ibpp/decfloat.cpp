@@ -0,0 +1,399 @@
+// DecFloat class implementation
+/*
+    (C) Copyright 2000-2006 T.I.P. Group S.A. and the IBPP Team (www.ibpp.org)
+
+    The contents of this file are subject to the IBPP License (the "License");
+    you may not use this file except in compliance with the License.  You may
+    obtain a copy of the License at http://www.ibpp.org or in the 'license.txt'
+    file which must have been distributed along with this file.
+
+    This software, distributed under the License, is distributed on an "AS IS"
+    basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.  See the
+    License for the specific language governing rights and limitations
+    under the License.
+*/
+
+#ifdef _MSC_VER
+#pragma warning(disable: 4786 4996)
+#ifndef _DEBUG
+#pragma warning(disable: 4702)
+#endif
+#endif
+
+#include "_ibpp.h"
+
+#ifdef HAS_HDRSTOP
+#pragma hdrstop
+#endif
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+using namespace ibpp_internals;
+
+//	Private implementation
+
+//	DECFLOAT(16) and DECFLOAT(34) are the IEEE 754 decimal64 and decimal128
+//	formats, with the coefficient in densely packed decimal: a 10 bits declet
+//	per 3 digits, after a combination field holding the most significant digit
+//	and the two high bits of the exponent.
+
+namespace
+{
+	struct DecFormat
+	{
+		int bits;		// Size of the format
+		int ecBits;		// Exponent continuation bits
+		int declets;
+		int bias;		// Of the exponent
+		int digits;		// Precision
+	};
+
+	const DecFormat Dec16Format = {64, 8, 5, 398, 16};
+	const DecFormat Dec34Format = {128, 12, 11, 6176, 34};
+
+	unsigned getBits(uint64_t high, uint64_t low, int pos, int count)
+	{
+		uint64_t v;
+		if (pos >= 64) v = high >> (pos - 64);
+		else if (pos == 0) v = low;
+		else v = (low >> pos) | (high << (64 - pos));
+		return (unsigned)(v & ((1ULL << count) - 1));
+	}
+
+	void setBits(uint64_t& high, uint64_t& low, int pos, int count, unsigned value)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (((value >> i) & 1) == 0) continue;
+			if (pos + i >= 64) high |= 1ULL << (pos + i - 64);
+			else low |= 1ULL << (pos + i);
+		}
+	}
+
+	unsigned decodeDeclet(unsigned d)
+	{
+		unsigned p = (d >> 9) & 1, q = (d >> 8) & 1, r = (d >> 7) & 1;
+		unsigned s = (d >> 6) & 1, t = (d >> 5) & 1, u = (d >> 4) & 1;
+		unsigned w = (d >> 2) & 1, x = (d >> 1) & 1, y = d & 1;
+		unsigned pqr = (d >> 7) & 7, stu = (d >> 4) & 7;
+		unsigned d2, d1, d0;
+
+		if (((d >> 3) & 1) == 0)
+		{
+			d2 = pqr; d1 = stu; d0 = d & 7;
+		}
+		else switch ((w << 1) | x)
+		{
+			case 0 : d2 = pqr; d1 = stu; d0 = 8 + y; break;
+			case 1 : d2 = pqr; d1 = 8 + u; d0 = (s << 2) | (t << 1) | y; break;
+			case 2 : d2 = 8 + r; d1 = stu; d0 = (p << 2) | (q << 1) | y; break;
+			default :
+				switch ((s << 1) | t)
+				{
+					case 0 : d2 = 8 + r; d1 = 8 + u; d0 = (p << 2) | (q << 1) | y; break;
+					case 1 : d2 = 8 + r; d1 = (p << 2) | (q << 1) | u; d0 = 8 + y; break;
+					case 2 : d2 = pqr; d1 = 8 + u; d0 = 8 + y; break;
+					default : d2 = 8 + r; d1 = 8 + u; d0 = 8 + y; break;
+				}
+		}
+		return d2 * 100 + d1 * 10 + d0;
+	}
+
+	//	The canonical declet of each value, found by inverting decodeDeclet():
+	//	the 24 non-canonical declets come after the canonical ones
+	struct DecletTable
+	{
+		uint16_t declets[1000];
+
+		DecletTable()
+		{
+			for (int i = 0; i < 1000; i++) declets[i] = 0xFFFF;
+			for (unsigned d = 0; d < 1024; d++)
+			{
+				unsigned value = decodeDeclet(d);
+				if (declets[value] == 0xFFFF) declets[value] = (uint16_t)d;
+			}
+		}
+	};
+
+	unsigned encodeDeclet(unsigned value)
+	{
+		static const DecletTable table;
+		return table.declets[value];
+	}
+
+	void decode(IBPP::DecFloat& df, uint64_t high, uint64_t low, const DecFormat& f)
+	{
+		bool negative = getBits(high, low, f.bits - 1, 1) != 0;
+		unsigned comb = getBits(high, low, f.bits - 6, 5);
+		unsigned expCont = getBits(high, low, f.bits - 6 - f.ecBits, f.ecBits);
+
+		unsigned expHigh, msd;
+		if ((comb >> 3) != 3)
+		{
+			expHigh = comb >> 3;
+			msd = comb & 7;
+		}
+		else if (((comb >> 1) & 3) != 3)
+		{
+			expHigh = (comb >> 1) & 3;
+			msd = 8 + (comb & 1);
+		}
+		else
+		{
+			if ((comb & 1) == 0) df.SetKind(IBPP::dfInfinity, negative);
+			else if (expCont >> (f.ecBits - 1)) df.SetKind(IBPP::dfSignalingNaN, negative);
+			else df.SetKind(IBPP::dfNaN, negative);
+			return;
+		}
+
+		uint64_t coefHigh = 0, coefLow = msd;
+		for (int k = f.declets - 1; k >= 0; k--)
+			mulAdd128(coefHigh, coefLow, 1000, decodeDeclet(getBits(high, low, 10 * k, 10)));
+		df.SetValue(negative, coefHigh, coefLow,
+			(int)((expHigh << f.ecBits) | expCont) - f.bias);
+	}
+
+	void encode(uint64_t& high, uint64_t& low, const IBPP::DecFloat& df,
+		const DecFormat& f, const char* where)
+	{
+		high = low = 0;
+		if (df.IsNegative()) setBits(high, low, f.bits - 1, 1, 1);
+		const int combPos = f.bits - 6;
+		const int expPos = combPos - f.ecBits;
+		switch (df.Kind())
+		{
+			case IBPP::dfInfinity :
+				setBits(high, low, combPos, 5, 0x1E);
+				return;
+			case IBPP::dfSignalingNaN :
+				setBits(high, low, expPos + f.ecBits - 1, 1, 1);
+				// Fall through
+			case IBPP::dfNaN :
+				setBits(high, low, combPos, 5, 0x1F);
+				return;
+			default :
+				break;
+		}
+
+		// Trailing zeros beyond the precision go to the exponent
+		uint64_t coefHigh = df.CoefficientHigh(), coefLow = df.CoefficientLow();
+		int exponent = df.Exponent();
+		for (int digits = df.Digits(); digits > f.digits; digits--)
+		{
+			uint64_t h = coefHigh, l = coefLow;
+			if (divMod128(h, l, 10) != 0)
+				throw LogicExceptionImpl(where, _("Out of range numeric conversion !"));
+			coefHigh = h;
+			coefLow = l;
+			exponent++;
+		}
+		int biased = exponent + f.bias;
+		if (biased < 0 || biased >= (3 << f.ecBits))
+			throw LogicExceptionImpl(where, _("Out of range numeric conversion !"));
+
+		for (int k = 0; k < f.declets; k++)
+			setBits(high, low, 10 * k, 10, encodeDeclet(divMod128(coefHigh, coefLow, 1000)));
+		unsigned msd = (unsigned)coefLow;
+		unsigned expHigh = (unsigned)biased >> f.ecBits;
+		unsigned comb = msd < 8 ? (expHigh << 3) | msd : 0x18 | (expHigh << 1) | (msd & 1);
+		setBits(high, low, combPos, 5, comb);
+		setBits(high, low, expPos, f.ecBits, (unsigned)biased & ((1U << f.ecBits) - 1));
+	}
+}
+
+//	Public implementation
+
+void IBPP::DecFloat::Clear()
+{
+	mHigh = 0;
+	mLow = 0;
+	mExponent = 0;
+	mNegative = false;
+	mKind = IBPP::dfFinite;
+}
+
+void IBPP::DecFloat::SetValue(bool negative, uint64_t high, uint64_t low, int exponent)
+{
+	mHigh = high;
+	mLow = low;
+	mExponent = exponent;
+	mNegative = negative;
+	mKind = IBPP::dfFinite;
+}
+
+void IBPP::DecFloat::SetKind(IBPP::DFK kind, bool negative)
+{
+	Clear();
+	mKind = kind;
+	mNegative = negative;
+}
+
+void IBPP::DecFloat::SetValue(const std::string& text)
+{
+	// [+|-]digits[.digits][E[+|-]digits], Infinity, NaN or sNaN, surrounding
+	// spaces allowed
+	size_t first = text.find_first_not_of(' ');
+	size_t last = text.find_last_not_of(' ');
+	if (first == std::string::npos)
+		throw LogicExceptionImpl("DecFloat::SetValue", _("Invalid numeric value"));
+	std::string s = text.substr(first, last - first + 1);
+
+	bool negative = s[0] == '-';
+	size_t pos = (s[0] == '-' || s[0] == '+') ? 1 : 0;
+	std::string word;
+	for (size_t i = pos; i < s.size(); i++)
+		word.append(1, (char)toupper((unsigned char)s[i]));
+	if (word == "INF" || word == "INFINITY") { SetKind(IBPP::dfInfinity, negative); return; }
+	if (word == "NAN") { SetKind(IBPP::dfNaN, negative); return; }
+	if (word == "SNAN") { SetKind(IBPP::dfSignalingNaN, negative); return; }
+
+	uint64_t high = 0, low = 0;
+	int digits = 0, significant = 0, exponent = 0;
+	bool point = false;
+	for (; pos < s.size(); pos++)
+	{
+		char c = s[pos];
+		if (c == '.' && ! point)
+		{
+			point = true;
+			continue;
+		}
+		if (c < '0' || c > '9') break;
+		digits++;
+		if (point) exponent--;
+		if (significant == 0 && c == '0') continue;		// Leading zeros
+		if (++significant > 34)
+			throw LogicExceptionImpl("DecFloat::SetValue",
+				_("Out of range numeric conversion !"));
+		mulAdd128(high, low, 10, (uint32_t)(c - '0'));
+	}
+	if (digits == 0)
+		throw LogicExceptionImpl("DecFloat::SetValue", _("Invalid numeric value"));
+
+	if (pos < s.size() && (s[pos] == 'E' || s[pos] == 'e'))
+	{
+		pos++;
+		bool expNegative = pos < s.size() && s[pos] == '-';
+		if (pos < s.size() && (s[pos] == '-' || s[pos] == '+')) pos++;
+		int value = 0;
+		size_t start = pos;
+		for (; pos < s.size() && s[pos] >= '0' && s[pos] <= '9'; pos++)
+		{
+			if (value > 100000)
+				throw LogicExceptionImpl("DecFloat::SetValue",
+					_("Out of range numeric conversion !"));
+			value = value * 10 + (s[pos] - '0');
+		}
+		if (pos == start)
+			throw LogicExceptionImpl("DecFloat::SetValue", _("Invalid numeric value"));
+		exponent += expNegative ? -value : value;
+	}
+	if (pos != s.size())
+		throw LogicExceptionImpl("DecFloat::SetValue", _("Invalid numeric value"));
+
+	SetValue(negative, high, low, exponent);
+}
+
+int IBPP::DecFloat::Digits() const
+{
+	uint64_t high = mHigh, low = mLow;
+	int digits = 0;
+	do
+	{
+		divMod128(high, low, 10);
+		digits++;
+	}
+	while (high != 0 || low != 0);
+	return digits;
+}
+
+std::string IBPP::DecFloat::AsString() const
+{
+	std::string result(mNegative ? "-" : "");
+	switch (mKind)
+	{
+		case IBPP::dfInfinity : return result.append("Infinity");
+		case IBPP::dfNaN : return result.append("NaN");
+		case IBPP::dfSignalingNaN : return result.append("sNaN");
+		default : break;
+	}
+
+	std::string digits;
+	uint64_t high = mHigh, low = mLow;
+	do digits.insert(digits.begin(), (char)('0' + divMod128(high, low, 10)));
+	while (high != 0 || low != 0);
+
+	// Same rules as Firebird (the to-scientific-string of the standard):
+	// plain notation unless it needs an exponent or more than 6 leading zeros
+	const int n = (int)digits.size();
+	const int adjusted = mExponent + n - 1;
+	if (mExponent <= 0 && adjusted >= -6)
+	{
+		int before = n + mExponent;		// Digits before the decimal point
+		if (mExponent == 0) result.append(digits);
+		else if (before > 0)
+			result.append(digits, 0, before).append(1, '.').append(digits, before, std::string::npos);
+		else result.append("0.").append(-before, '0').append(digits);
+		return result;
+	}
+
+	result.append(1, digits[0]);
+	if (n > 1) result.append(1, '.').append(digits, 1, std::string::npos);
+	std::ostringstream exponent;
+	exponent << 'E' << (adjusted < 0 ? '-' : '+') << (adjusted < 0 ? -adjusted : adjusted);
+	return result.append(exponent.str());
+}
+
+double IBPP::DecFloat::AsDouble() const
+{
+	double value;
+	switch (mKind)
+	{
+		case IBPP::dfInfinity :
+			value = std::numeric_limits<double>::infinity();
+			break;
+		case IBPP::dfNaN :
+		case IBPP::dfSignalingNaN :
+			return std::numeric_limits<double>::quiet_NaN();
+		default :
+			value = ((double)mHigh * 18446744073709551616.0 + (double)mLow)
+				* pow(10.0, mExponent);
+	}
+	return mNegative ? -value : value;
+}
+
+namespace ibpp_internals
+{
+
+//	DECFLOAT(16) is a single 64 bits word, the client library stores the low
+//	64 bits of DECFLOAT(34) first, as for INT128.
+
+void encodeDecFloat(FB_DEC16& fb_df, const IBPP::DecFloat& df)
+{
+	uint64_t high, low;
+	encode(high, low, df, Dec16Format, "DecFloat[16]");
+	fb_df.fb_data[0] = low;
+}
+
+void decodeDecFloat(IBPP::DecFloat& df, const FB_DEC16& fb_df)
+{
+	decode(df, 0, fb_df.fb_data[0], Dec16Format);
+}
+
+void encodeDecFloat(FB_DEC34& fb_df, const IBPP::DecFloat& df)
+{
+	uint64_t high, low;
+	encode(high, low, df, Dec34Format, "DecFloat[34]");
+	fb_df.fb_data[0] = low;
+	fb_df.fb_data[1] = high;
+}
+
+void decodeDecFloat(IBPP::DecFloat& df, const FB_DEC34& fb_df)
+{
+	decode(df, fb_df.fb_data[1], fb_df.fb_data[0], Dec34Format);
+}
+
+}
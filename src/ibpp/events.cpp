@@ -61,6 +61,7 @@ const size_t EventsImpl::MAXEVENTNAMELEN = 127;
 
 void EventsImpl::Add(const std::string& eventname, IBPP::EventInterface* objref)
 {
+	AttachmentLock lock(mDatabase);
 	if (eventname.size() == 0)
 		throw LogicExceptionImpl("Events::Add", _("Zero length event names not permitted"));
 	if (eventname.size() > MAXEVENTNAMELEN)
@@ -100,12 +101,14 @@ void EventsImpl::Add(const std::string& eventname, IBPP::EventInterface* objref)
 
 	// 3) Alloc or grow the objref array and update the objref array (append)
 	mObjectReferences.push_back(objref);
+	mCoalesced.push_back(0);
 
 	Queue();
 }
 
 void EventsImpl::Drop(const std::string& eventname)
 {
+	AttachmentLock lock(mDatabase);
 	if (eventname.size() == 0)
 		throw LogicExceptionImpl("EventsImpl::Drop", _("Zero length event names not permitted"));
 	if (eventname.size() > MAXEVENTNAMELEN)
@@ -129,6 +132,7 @@ void EventsImpl::Drop(const std::string& eventname)
 		// 2) Event found, remove it
 		mEventBuffer.erase(eit.begin(), eit.end());
 		mResultsBuffer.erase(rit.begin(), rit.end());
+		mCoalesced.erase(mCoalesced.begin() + (oit - mObjectReferences.begin()));
 		mObjectReferences.erase(oit);
 		break;
 	}
@@ -155,23 +159,68 @@ void EventsImpl::List(std::vector<std::string>& events)
 
 void EventsImpl::Clear()
 {
+	AttachmentLock lock(mDatabase);
 	Cancel();
 	
 	mObjectReferences.clear();
+	mCoalesced.clear();
 	mEventBuffer.clear();
 	mResultsBuffer.clear();
 }
 
 void EventsImpl::Dispatch()
 {
+	AttachmentLock lock(mDatabase);
 	// If no events registered, nothing to do of course.
 	if (mEventBuffer.size() == 0) return;
 
+	// The delivery thread already requeued, only hand out what it summed up
+	if (mThread.joinable())
+	{
+		DeliverCoalesced(false);
+		return;
+	}
+
 	// Let's fire the events actions for all the events which triggered, if any, and requeue.
-	FireActions();
+	DeliverCoalesced(true);	// Left over by StopDelivery()
+	FireActions(false);
 	Queue();
 }
 
+void EventsImpl::StartDelivery(int window)
+{
+	if (mDatabase == 0) throw LogicExceptionImpl("Events::StartDelivery",
+			_("No Database is attached."));
+	if (window < 0) throw LogicExceptionImpl("Events::StartDelivery",
+			_("Negative delivery window"));
+
+	AttachmentLock lock(mDatabase);
+	mWindow = std::chrono::milliseconds(window);
+	if (mThread.joinable()) return;
+
+	mDelivered = std::chrono::steady_clock::now();
+	{
+		std::lock_guard<std::mutex> signal(mSignalMutex);
+		mStopping = false;
+		mSignaled = mTrapped;	// Trapped before the thread was there
+	}
+	mThread = std::thread(&EventsImpl::DeliveryThread, this);
+}
+
+void EventsImpl::StopDelivery()
+{
+	if (! mThread.joinable()) return;
+
+	{
+		std::lock_guard<std::mutex> signal(mSignalMutex);
+		mStopping = true;
+	}
+	mSignal.notify_one();
+	// The thread may wait for the attachment lock, which we may be holding
+	mDatabase->NotifyLockWaiters();
+	mThread.join();
+}
+
 IBPP::Database EventsImpl::DatabasePtr() const
 {
 	if (mDatabase == 0) throw LogicExceptionImpl("Events::DatabasePtr",
@@ -190,8 +239,7 @@ void EventsImpl::Release()
 {
 	// Release cannot throw, except in DEBUG builds on assertion
 	ASSERTION(mRefCount >= 0);
-	--mRefCount;
-	try { if (mRefCount <= 0) delete this; }
+	try { if (--mRefCount <= 0) delete this; }
 		catch (...) { }
 }
 
@@ -199,6 +247,7 @@ void EventsImpl::Release()
 
 void EventsImpl::Queue()
 {
+	AttachmentLock lock(mDatabase);
 	if (! mQueued)
 	{
 		if (mDatabase->GetHandle() == 0)
@@ -224,6 +273,7 @@ void EventsImpl::Queue()
 
 void EventsImpl::Cancel()
 {
+	AttachmentLock lock(mDatabase);
 	if (mQueued)
 	{
 		if (mDatabase->GetHandle() == 0) throw LogicExceptionImpl("EventsImpl::Cancel",
@@ -250,7 +300,7 @@ void EventsImpl::Cancel()
 	}
 }
 
-void EventsImpl::FireActions()
+void EventsImpl::FireActions(bool coalesce)
 {
 	if (mTrapped)
 	{
@@ -267,7 +317,9 @@ void EventsImpl::FireActions()
 				throw LogicExceptionImpl("EventsImpl::FireActions", _("Internal buffer size error"));
 			uint32_t vnew = rit.get_count();
 			uint32_t vold = eit.get_count();
-			if (vnew > vold)
+			if (vnew > vold && coalesce)
+				mCoalesced[oit - mObjectReferences.begin()] += vnew - vold;
+			else if (vnew > vold)
 			{
 				// Fire the action
 				try
@@ -289,6 +341,55 @@ void EventsImpl::FireActions()
 	}
 }
 
+void EventsImpl::DeliverCoalesced(bool force)
+{
+	if (! force && std::chrono::steady_clock::now() - mDelivered < mWindow)
+		return;
+	mDelivered = std::chrono::steady_clock::now();
+
+	typedef EventBufferIterator<Buffer::iterator> EventIterator;
+	EventIterator eit(mEventBuffer.begin()+1);
+	for (size_t i = 0; i < mCoalesced.size(); ++i, ++eit)
+	{
+		if (mCoalesced[i] == 0) continue;
+		int count = (int)mCoalesced[i];
+		mCoalesced[i] = 0;
+		mObjectReferences[i]->ibppEventHandler(this, eit.get_name(), count);
+	}
+}
+
+void EventsImpl::DeliveryThread()
+{
+	std::unique_lock<std::mutex> signal(mSignalMutex);
+	while (! mStopping)
+	{
+		if (! mSignaled)
+		{
+			mSignal.wait(signal);
+			continue;
+		}
+
+		// Whoever stops us may be holding the attachment lock meanwhile,
+		// so wait until it is released or we are stopped
+		mSignaled = false;
+		signal.unlock();
+		if (! mDatabase->WaitForLock(mStopping))
+		{
+			signal.lock();
+			continue;
+		}
+		try
+		{
+			FireActions(true);
+			Queue();
+		}
+		catch (...) { }	// Nobody to tell, the notifications just stop
+		mDatabase->Mutex().unlock();
+		mDatabase->NotifyLockWaiters();
+		signal.lock();
+	}
+}
+
 // This function must keep this prototype to stay compatible with
 // what isc_que_events() expects
 
@@ -318,6 +419,10 @@ void EventsImpl::EventHandler(const char* object, short size, const char* tmpbuf
 				rb[i] = tmpbuffer[i];
 			evi->mTrapped = true;
 			evi->mQueued = false;
+
+			std::lock_guard<std::mutex> signal(evi->mSignalMutex);
+			evi->mSignaled = true;
+			evi->mSignal.notify_one();
 		}
 		catch (...) { }
 	}
@@ -337,6 +442,7 @@ void EventsImpl::DetachDatabaseImpl()
 {
 	if (mDatabase == 0) return;
 
+	StopDelivery();
 	mDatabase->DetachEventsImpl(this);
 	mDatabase = 0;
 }
@@ -347,11 +453,16 @@ EventsImpl::EventsImpl(DatabaseImpl* database)
 	mDatabase = 0;
 	mId = 0;
 	mQueued = mTrapped = false;
+	mSignaled = mStopping = false;
+	mWindow = std::chrono::milliseconds(0);
 	AttachDatabaseImpl(database);
 }
 
 EventsImpl::~EventsImpl()
 {
+	try { StopDelivery(); }
+		catch (...) { }
+
 	try { Clear(); }
 		catch (...) { }
 	
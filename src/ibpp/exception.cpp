@@ -268,6 +268,13 @@ WrongTypeImpl::WrongTypeImpl(const std::string& context, int sqlType, IITYPE var
 		case SQL_TIMESTAMP :	info.append("TIMESTAMP"); break;
 		case SQL_TYPE_DATE :	info.append("DATE"); break;
 		case SQL_TYPE_TIME :	info.append("TIME"); break;
+		case SQL_TIME_TZ :
+		case SQL_TIME_TZ_EX :	info.append("TIME WITH TIME ZONE"); break;
+		case SQL_TIMESTAMP_TZ :
+		case SQL_TIMESTAMP_TZ_EX :	info.append("TIMESTAMP WITH TIME ZONE"); break;
+		case SQL_INT128 :		info.append("INT128"); break;
+		case SQL_DEC16 :		info.append("DECFLOAT(16)"); break;
+		case SQL_DEC34 :		info.append("DECFLOAT(34)"); break;
 		case SQL_BLOB :			info.append("BLOB"); break;
 		case SQL_ARRAY :		info.append("ARRAY"); break;
 	}
@@ -288,6 +295,8 @@ WrongTypeImpl::WrongTypeImpl(const std::string& context, int sqlType, IITYPE var
 		case ivBool :		info.append("bool"); break;
 		case ivDBKey :		info.append("DBKey"); break;
 		case ivByte :		info.append("int8_t"); break;
+		case ivInt128 :		info.append("Int128"); break;
+		case ivDecFloat :	info.append("DecFloat"); break;
 	}
 	mWhat.append(info).append("\n");
 }
@@ -195,6 +195,50 @@ typedef struct
 #define ISC_TIMESTAMP_DEFINED
 #endif	/* ISC_TIMESTAMP_DEFINED */
 
+/* Firebird v4 time zone support, the _EX variants carry the offset */
+/* of the time zone at that moment, in minutes */
+typedef struct
+{
+	ISC_TIME utc_time;
+	ISC_USHORT time_zone;
+} ISC_TIME_TZ;
+
+typedef struct
+{
+	ISC_TIME utc_time;
+	ISC_USHORT time_zone;
+	ISC_SHORT ext_offset;
+} ISC_TIME_TZ_EX;
+
+typedef struct
+{
+	ISC_TIMESTAMP utc_timestamp;
+	ISC_USHORT time_zone;
+} ISC_TIMESTAMP_TZ;
+
+typedef struct
+{
+	ISC_TIMESTAMP utc_timestamp;
+	ISC_USHORT time_zone;
+	ISC_SHORT ext_offset;
+} ISC_TIMESTAMP_TZ_EX;
+
+/*******************************************************************/
+/* Firebird v4 DECFLOAT and INT128 support                         */
+/*******************************************************************/
+
+typedef struct FB_DEC16_t {
+	ISC_UINT64 fb_data[1];
+} FB_DEC16;
+
+typedef struct FB_DEC34_t {
+	ISC_UINT64 fb_data[2];
+} FB_DEC34;
+
+typedef struct FB_I128_t {
+	ISC_UINT64 fb_data[2];
+} FB_I128;
+
 /*******************************************************************/
 /* Blob Id support                                                 */
 /*******************************************************************/
@@ -483,6 +527,13 @@ typedef struct
 #define SQL_TYPE_TIME                      560
 #define SQL_TYPE_DATE                      570
 #define SQL_INT64                          580
+#define SQL_TIMESTAMP_TZ_EX              32748
+#define SQL_TIME_TZ_EX                   32750
+#define SQL_INT128                       32752
+#define SQL_TIMESTAMP_TZ                 32754
+#define SQL_TIME_TZ                      32756
+#define SQL_DEC16                        32760
+#define SQL_DEC34                        32762
 #define SQL_BOOLEAN                      32764
 #define SQL_NULL                         32766
 
@@ -2199,6 +2250,7 @@ ISC_STATUS ISC_EXPORT fb_database_crypt_callback(ISC_STATUS*, void*);
 #define isc_spb_bkp_factor               6
 #define isc_spb_bkp_length               7
 #define isc_spb_bkp_skip_data            8
+#define isc_spb_bkp_parallel_workers     21
 #define isc_spb_bkp_ignore_checksums     0x01
 #define isc_spb_bkp_ignore_limbo         0x02
 #define isc_spb_bkp_metadata_only        0x04
@@ -2298,6 +2350,7 @@ ISC_STATUS ISC_EXPORT fb_database_crypt_callback(ISC_STATUS*, void*);
  *****************************************/
 
 #define isc_spb_res_skip_data			isc_spb_bkp_skip_data
+#define isc_spb_res_parallel_workers	isc_spb_bkp_parallel_workers
 #define isc_spb_res_buffers				9
 #define isc_spb_res_page_size			10
 #define isc_spb_res_length				11
@@ -2356,7 +2409,9 @@ ISC_STATUS ISC_EXPORT fb_database_crypt_callback(ISC_STATUS*, void*);
 #define isc_spb_nbk_level			5
 #define isc_spb_nbk_file			6
 #define isc_spb_nbk_direct			7
+#define isc_spb_nbk_guid			8
 #define isc_spb_nbk_no_triggers		0x01
+#define isc_spb_nbk_inplace			0x02
 
 /***************************************
  * Parameters for isc_action_svc_trace *
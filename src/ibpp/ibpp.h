@@ -7,6 +7,16 @@
 //
 //  Select the platform:    IBPP_WINDOWS | IBPP_LINUX | IBPP_DARWIN
 //
+//  Threads: every call which reaches the server through an attachment is
+//  serialized on a lock owned by that Database. Different objects (Statements,
+//  Blobs, Transactions...) of the same attachment may therefore be used from
+//  different threads, but a single object must not be used by two threads at
+//  the same time. Database::CancelOperation() does not take the lock, so it
+//  can interrupt a call running in another thread. Reference counts of the
+//  smart pointers are atomic. A call takes every lock it needs once, when it
+//  starts, always in the same order: a Transaction spanning several
+//  Databases locks all of them, and so do its Statements, Blobs and Arrays.
+//
 
 /*
   (C) Copyright 2000-2006 T.I.P. Group S.A. and the IBPP Team (www.ibpp.org)
@@ -64,10 +74,17 @@
 #endif
 
 #include <exception>
+#include <future>
 #include <map>
+#include <streambuf>
 #include <string>
 #include <vector>
 
+namespace ibpp_internals
+{
+    class RowImpl;  // Fills IBPP::RowBatch, see below
+}
+
 namespace IBPP
 {
     //  Typically you use this constant in a call IBPP::CheckVersion as in:
@@ -78,6 +95,9 @@ namespace IBPP
     const int MinDate = -693594;    //  1 JAN 0001
     const int MaxDate = 2958464;    // 31 DEC 9999
 
+    //  Time zone of the Time and Timestamp values which have none
+    const int TZ_NONE = -1;
+
     //  Transaction Access Modes
     enum TAM {amWrite, amRead};
 
@@ -98,12 +118,22 @@ namespace IBPP
 
     //  SQL Data Types
     enum SDT {sdArray, sdBlob, sdDate, sdTime, sdTimestamp, sdString,
-        sdSmallint, sdInteger, sdLargeint, sdFloat, sdDouble, sdBoolean};
+        sdSmallint, sdInteger, sdLargeint, sdFloat, sdDouble, sdBoolean,
+        sdTimeTz, sdTimestampTz, sdInt128, sdDec16, sdDec34};
+
+    //  DecFloat Kinds
+    enum DFK {dfFinite, dfInfinity, dfNaN, dfSignalingNaN};
 
     //  Array Data Types
     enum ADT {adDate, adTime, adTimestamp, adString,
         adBool, adInt16, adInt32, adInt64, adFloat, adDouble};
 
+    //  Blob Types (only stream blobs support Blob::Seek)
+    enum BTY {btSegmented, btStream};
+
+    //  Blob::Seek Origins
+    enum BSK {bkBegin, bkCurrent, bkEnd};
+
     // Database::Shutdown Modes
     enum DSM {dsForce, dsDenyTrans, dsDenyAttach};
 
@@ -120,6 +150,14 @@ namespace IBPP
         brPerTableCommit = 0x100000, brUseAllSpace = 0x200000
     };
 
+    // Service::StartNBackup && Service::StartNRestore Flags
+    enum NBF {
+        // Backup flags
+        nbNoTriggers = 0x1, nbDirectIO = 0x2,
+        // Restore flags
+        nbInPlace = 0x100
+    };
+
     // Service::Repair Flags
     enum RPF
     {
@@ -228,15 +266,19 @@ namespace IBPP
     };
 
     /* Class Time represent purely a Time. It is usefull in interactions
-     * with the SQL TIME type of Interbase. */
+     * with the SQL TIME type of Interbase. Values of the Firebird v4 TIME WITH
+     * TIME ZONE type hold the local time of their time zone, together with
+     * the Firebird id of that zone and its offset from UTC. */
 
     class Time
     {
     protected:
-        int mTime;  // The time, in ten-thousandths of seconds since midnight
+        int mTime;      // The time, in ten-thousandths of seconds since midnight
+        int mTimezone;  // Firebird time zone id, or TZ_NONE
+        int mTzOffset;  // Offset of that time zone from UTC, in minutes
 
     public:
-        void Clear()    { mTime = 0; }
+        void Clear()    { mTime = 0; mTimezone = TZ_NONE; mTzOffset = 0; }
         void Now();
         void SetTime(int hour, int minute, int second, int tenthousandths = 0);
         void SetTime(int tm);
@@ -247,8 +289,11 @@ namespace IBPP
         int Minutes() const;
         int Seconds() const;
         int SubSeconds() const;     // Actually tenthousandths of seconds
+        void SetTimezone(int tz, int offset);
+        int GetTimezone() const { return mTimezone; }
+        int GetTzOffset() const { return mTzOffset; }
         Time()          { Clear(); }
-        Time(int tm)    { SetTime(tm); }
+        Time(int tm)    { Clear(); SetTime(tm); }
         Time(int hour, int minute, int second, int tenthousandths = 0);
         Time(const Time&);                          // Copy Constructor
         Time& operator=(const Timestamp&);          // Timestamp Assignment operator
@@ -281,22 +326,22 @@ namespace IBPP
             { Date::SetDate(y, mo, d); Time::SetTime(h, mi, s, t); }
 
         Timestamp(const Timestamp& rv)
-            : Date(rv.mDate), Time(rv.mTime) {} // Copy Constructor
+            : Date(rv.mDate), Time(rv) {}   // Copy Constructor
 
         Timestamp(const Date& rv)
             { mDate = rv.GetDate(); mTime = 0; }
 
         Timestamp(const Time& rv)
-            { mDate = 0; mTime = rv.GetTime(); }
+            : Time(rv) { mDate = 0; }
 
         Timestamp& operator=(const Timestamp& rv)   // Timestamp Assignment operator
-            { mDate = rv.mDate; mTime = rv.mTime; return *this; }
+            { mDate = rv.mDate; Time::operator=(rv); return *this; }
 
         Timestamp& operator=(const Date& rv)        // Date Assignment operator
             { mDate = rv.GetDate(); return *this; }
 
         Timestamp& operator=(const Time& rv)        // Time Assignment operator
-            { mTime = rv.GetTime(); return *this; }
+            { Time::operator=(rv); return *this; }
 
         bool operator==(const Timestamp& rv)
             { return (mDate == rv.GetDate()) && (mTime == rv.GetTime()); }
@@ -332,6 +377,71 @@ namespace IBPP
         ~DBKey() { }
     };
 
+    /* Class Int128 stores a value of the Firebird v4 INT128 type, which also
+     * backs NUMERIC and DECIMAL columns of more than 18 digits. The value is
+     * kept unscaled, AsString() and AsDouble() apply the scale of the column
+     * (the number of digits after the decimal point), SetValue() parses such
+     * a text. */
+
+    class Int128
+    {
+    private:
+        int64_t mHigh;      // Two's complement, high 64 bits
+        uint64_t mLow;      // Low 64 bits
+
+    public:
+        void Clear()    { mHigh = 0; mLow = 0; }
+        void SetValue(int64_t high, uint64_t low) { mHigh = high; mLow = low; }
+        void SetValue(int64_t value) { mHigh = value < 0 ? -1 : 0; mLow = (uint64_t)value; }
+        void SetValue(const std::string& text, int scale = 0);
+        int64_t High() const    { return mHigh; }
+        uint64_t Low() const    { return mLow; }
+        bool IsNegative() const { return mHigh < 0; }
+        std::string AsString(int scale = 0) const;
+        double AsDouble(int scale = 0) const;
+
+        Int128()                { Clear(); }
+        Int128(int64_t value)   { SetValue(value); }
+
+        Int128& operator+=(const Int128& rv);
+        bool operator==(const Int128& rv) const
+            { return mHigh == rv.mHigh && mLow == rv.mLow; }
+        bool operator<(const Int128& rv) const
+            { return mHigh < rv.mHigh || (mHigh == rv.mHigh && mLow < rv.mLow); }
+    };
+
+    /* Class DecFloat stores a value of the Firebird v4 DECFLOAT(16) and
+     * DECFLOAT(34) types: the sign, the coefficient (an integer of up to 34
+     * digits) and the exponent, the value being coefficient * 10^exponent.
+     * It is decoded from and encoded to the binary IEEE 754 formats in IBPP,
+     * AsString() formats it as Firebird does. */
+
+    class DecFloat
+    {
+    private:
+        uint64_t mHigh;     // Coefficient, high 64 bits
+        uint64_t mLow;      // Coefficient, low 64 bits
+        int mExponent;
+        bool mNegative;
+        DFK mKind;
+
+    public:
+        void Clear();
+        void SetValue(bool negative, uint64_t high, uint64_t low, int exponent);
+        void SetValue(const std::string& text);
+        void SetKind(DFK kind, bool negative = false);
+        DFK Kind() const                    { return mKind; }
+        bool IsNegative() const             { return mNegative; }
+        uint64_t CoefficientHigh() const    { return mHigh; }
+        uint64_t CoefficientLow() const     { return mLow; }
+        int Exponent() const                { return mExponent; }
+        int Digits() const;
+        std::string AsString() const;
+        double AsDouble() const;
+
+        DecFloat()  { Clear(); }
+    };
+
     /* Class User wraps all the information about a user that the engine can manage. */
 
     class User
@@ -356,6 +466,110 @@ namespace IBPP
         ~User() { }
     };
 
+    /* Class BatchError describes a row of a statement batch which failed,
+     * see IStatement::ExecuteBatch(). */
+
+    class BatchError
+    {
+    public:
+        int row;                // Index of the row in the batch, from 0
+        int sqlcode;
+        int enginecode;
+        std::string message;
+
+        BatchError() : row(0), sqlcode(0), enginecode(0) { }
+        ~BatchError() { }
+    };
+
+    /* Classes TableStatistics and IndexStatistics hold the database statistics
+     * (what gstat reports) of a table and of its indices, see
+     * IService::GetStatistics(). fill[] counts the pages filled 0-19%,
+     * 20-39%, 40-59%, 60-79% and 80-99%. */
+
+    class IndexStatistics
+    {
+    public:
+        std::string name;
+        int depth;
+        int64_t leafbuckets;
+        int64_t nodes;
+        double avgkeylength;
+        int64_t totaldup;
+        int64_t maxdup;
+        int64_t fill[5];
+
+        IndexStatistics() : depth(0), leafbuckets(0), nodes(0),
+            avgkeylength(0), totaldup(0), maxdup(0)
+            { for (int i = 0; i < 5; i++) fill[i] = 0; }
+        ~IndexStatistics() { }
+    };
+
+    class TableStatistics
+    {
+    public:
+        std::string name;
+        int id;
+        int64_t records;
+        double avgrecordlength;
+        int64_t versions;       // Back versions, the garbage
+        int64_t maxversions;
+        int64_t fragments;
+        int64_t datapages;
+        int avgfill;            // Percent
+        int64_t fill[5];
+        std::vector<IndexStatistics> indices;
+
+        TableStatistics() : id(0), records(0), avgrecordlength(0),
+            versions(0), maxversions(0), fragments(0), datapages(0), avgfill(0)
+            { for (int i = 0; i < 5; i++) fill[i] = 0; }
+        ~TableStatistics() { }
+    };
+
+    /* Typed fetches, see IStatement::FetchAs(). FAT lists the types a column
+     * can be fetched into, FetchTarget<> maps each C++ type to its FAT.
+     * Nullable<T> receives a column which can be NULL. */
+
+    enum FAT {faString, faInt16, faInt32, faInt64, faDouble, faBool};
+
+    template<typename T> struct FetchTarget;
+
+    template<typename T> class Nullable
+    {
+    private:
+        T mValue;
+        bool mNull;
+
+        friend struct FetchTarget<Nullable<T> >;
+
+    public:
+        bool IsNull() const                 { return mNull; }
+        const T& Value() const              { return mValue; }
+        T ValueOr(const T& other) const     { return mNull ? other : mValue; }
+
+        Nullable() : mValue(), mNull(true) { }
+    };
+
+    template<typename T, FAT F> struct FetchTargetOf
+    {
+        static const FAT type = F;
+        static void* Value(T& value)        { return &value; }
+        static bool* Null(T&)               { return 0; }
+    };
+
+    template<> struct FetchTarget<std::string> : FetchTargetOf<std::string, faString> { };
+    template<> struct FetchTarget<int16_t> : FetchTargetOf<int16_t, faInt16> { };
+    template<> struct FetchTarget<int32_t> : FetchTargetOf<int32_t, faInt32> { };
+    template<> struct FetchTarget<int64_t> : FetchTargetOf<int64_t, faInt64> { };
+    template<> struct FetchTarget<double> : FetchTargetOf<double, faDouble> { };
+    template<> struct FetchTarget<bool> : FetchTargetOf<bool, faBool> { };
+
+    template<typename T> struct FetchTarget<Nullable<T> >
+    {
+        static const FAT type = FetchTarget<T>::type;
+        static void* Value(Nullable<T>& value)  { return &value.mValue; }
+        static bool* Null(Nullable<T>& value)   { return &value.mNull; }
+    };
+
     //  Interface Wrapper
     template <class T>
     class Ptr
@@ -430,17 +644,24 @@ namespace IBPP
     class IBlob
     {
     public:
-        virtual void Create() = 0;
+        virtual void Create(BTY type = btSegmented) = 0;
         virtual void Open() = 0;
         virtual void Close() = 0;
         virtual void Cancel() = 0;
         virtual int Read(void*, int size) = 0;
         virtual void Write(const void*, int size) = 0;
+        virtual int Seek(int offset, BSK origin) = 0;
         virtual void Info(int* Size, int* Largest, int* Segments) = 0;
 
         virtual void Save(const std::string& data) = 0;
         virtual void Load(std::string& data) = 0;
 
+        // The id of the blob in the database, an opaque 8 byte value. A new
+        // Blob of the same Database and Transaction can be attached to the
+        // blob again with SetId(), as if it had been fetched.
+        virtual uint64_t Id() = 0;
+        virtual void SetId(uint64_t id) = 0;
+
         virtual Database DatabasePtr() const = 0;
         virtual Transaction TransactionPtr() const = 0;
 
@@ -507,14 +728,46 @@ namespace IBPP
         virtual void Sweep(const std::string& dbfile) = 0;
         virtual void Repair(const std::string& dbfile, RPF flags) = 0;
 
+        // Runs the database statistics (isc_action_svc_db_stats) of the data
+        // and index pages including the record versions, and parses the
+        // report. The system tables are only included if asked to.
+        // StartStatistics() only starts them: the report is then read with
+        // WaitOutput(), which lets the caller give up on a long one, and
+        // parsed with IBPP::ParseStatistics().
+        virtual void GetStatistics(const std::string& dbfile,
+            std::vector<TableStatistics>& tables, bool system = false) = 0;
+        virtual void StartStatistics(const std::string& dbfile,
+            bool system = false) = 0;
+
+        // workers > 0 asks for parallel workers (Firebird 5 and later)
         virtual void StartBackup(const std::string& dbfile,
-            const std::string& bkfile, BRF flags = BRF(0)) = 0;
+            const std::string& bkfile, BRF flags = BRF(0), int workers = 0) = 0;
         virtual void StartRestore(const std::string& bkfile, const std::string& dbfile,
-            int pagesize = 0, BRF flags = BRF(0)) = 0;
+            int pagesize = 0, BRF flags = BRF(0), int workers = 0) = 0;
+
+        // Incremental backups (nbackup, Firebird 2.5 and later). A backup of
+        // level N holds the pages changed since the last one of level N-1;
+        // the guid one (Firebird 4) those changed since the backup of that
+        // RDB$BACKUP_HISTORY guid. StartNRestore() takes the chain of files,
+        // level 0 first, or with nbInPlace (Firebird 4) only the increments
+        // to apply to dbfile.
+        virtual void StartNBackup(const std::string& dbfile,
+            const std::string& bkfile, int level, NBF flags = NBF(0)) = 0;
+        virtual void StartNBackup(const std::string& dbfile,
+            const std::string& bkfile, const std::string& guid,
+            NBF flags = NBF(0)) = 0;
+        virtual void StartNRestore(const std::vector<std::string>& bkfiles,
+            const std::string& dbfile, NBF flags = NBF(0)) = 0;
 
         virtual const char* WaitMsg() = 0;  // With reporting (does not block)
         virtual void Wait() = 0;            // Without reporting (does block)
 
+        // Bulk reporting: reads all the output available (isc_info_svc_to_eof)
+        // instead of a line per call, waiting a second at most for it. The
+        // output only holds complete lines, and can be empty. Returns false
+        // once the task is finished, with the rest of the output.
+        virtual bool WaitOutput(std::string& output) = 0;
+
         virtual IService* AddRef() = 0;
         virtual void Release() = 0;
 
@@ -537,6 +790,26 @@ namespace IBPP
     };
     typedef std::map<int, CountInfo> DatabaseCounts; // int = relation ID
 
+    /* Class DatabaseSnapshot holds the counters of IDatabase::Statistics(),
+     * Counts() and DetailedCounts() all at once, as read by a single server
+     * round trip in IDatabase::Snapshot(). Diff() returns the activity between
+     * an earlier snapshot and this one; its counts only list the relations
+     * which changed. */
+
+    class DatabaseSnapshot
+    {
+    public:
+        int fetches, marks, reads, writes, currentMemory;
+        int inserts, updates, deletes, readIdx, readSeq;
+        DatabaseCounts counts;
+
+        DatabaseSnapshot Diff(const DatabaseSnapshot& before) const;
+
+        DatabaseSnapshot() : fetches(0), marks(0), reads(0), writes(0),
+            currentMemory(0), inserts(0), updates(0), deletes(0), readIdx(0),
+            readSeq(0) {}
+    };
+
     class IDatabase
     {
     public:
@@ -558,6 +831,7 @@ namespace IBPP
         virtual void Counts(int* Insert, int* Update, int* Delete,
             int* ReadIdx, int* ReadSeq) = 0;
         virtual void DetailedCounts(DatabaseCounts& counts) = 0;
+        virtual DatabaseSnapshot Snapshot() = 0;
         virtual void Users(std::vector<std::string>& users) = 0;
         virtual int Dialect() = 0;
 
@@ -567,6 +841,17 @@ namespace IBPP
         virtual void Inactivate() = 0;
         virtual void Disconnect() = 0;
         virtual void Drop() = 0;
+        // Can be called from any thread, to abort the request the attachment
+        // is running (needs a Firebird 2.5 or later client and server)
+        virtual void CancelOperation() = 0;
+
+        // Returns a Statement prepared with sql on tr, from a LRU cache keyed
+        // by transaction and SQL text (whitespace runs outside of literals
+        // don't count). Statement::Execute() of a DDL statement empties it.
+        virtual Statement CachedStatement(Transaction tr, const std::string& sql) = 0;
+        virtual void SetStatementCacheSize(int size) = 0;   // 0 disables it
+        virtual void ClearStatementCache() = 0;
+        virtual void StatementCacheStats(int* Hits, int* Misses) = 0;
 
         virtual IDatabase* AddRef() = 0;
         virtual void Release() = 0;
@@ -606,6 +891,9 @@ namespace IBPP
 
     /*
      *  Class Row can hold all the values of a row (from a SELECT for instance).
+     *  GetView() returns a pointer to the data of a CHAR or VARCHAR column and
+     *  its length in bytes, without copying it. The data is not terminated
+     *  and stays valid until the next fetch into the same row buffer.
      */
 
     class IRow
@@ -625,6 +913,8 @@ namespace IBPP
         virtual void Set(int, const Date&) = 0;
         virtual void Set(int, const Time&) = 0;
         virtual void Set(int, const DBKey&) = 0;
+        virtual void Set(int, const Int128&) = 0;
+        virtual void Set(int, const DecFloat&) = 0;
         virtual void Set(int, const Blob&) = 0;
         virtual void Set(int, const Array&) = 0;
 
@@ -632,6 +922,7 @@ namespace IBPP
         virtual bool Get(int, bool&) = 0;
         virtual bool Get(int, void*, int&) = 0; // byte buffers
         virtual bool Get(int, std::string&) = 0;
+        virtual bool GetView(int, const char*&, int&) = 0;   // no copy
         virtual bool Get(int, int16_t&) = 0;
         virtual bool Get(int, int32_t&) = 0;
         virtual bool Get(int, int64_t&) = 0;
@@ -641,6 +932,8 @@ namespace IBPP
         virtual bool Get(int, Date&) = 0;
         virtual bool Get(int, Time&) = 0;
         virtual bool Get(int, DBKey&) = 0;
+        virtual bool Get(int, Int128&) = 0;
+        virtual bool Get(int, DecFloat&) = 0;
         virtual bool Get(int, Blob&) = 0;
         virtual bool Get(int, Array&) = 0;
 
@@ -648,6 +941,7 @@ namespace IBPP
         virtual bool Get(const std::string&, bool&) = 0;
         virtual bool Get(const std::string&, void*, int&) = 0;  // byte buffers
         virtual bool Get(const std::string&, std::string&) = 0;
+        virtual bool GetView(const std::string&, const char*&, int&) = 0;
         virtual bool Get(const std::string&, int16_t&) = 0;
         virtual bool Get(const std::string&, int32_t&) = 0;
         virtual bool Get(const std::string&, int64_t&) = 0;
@@ -657,6 +951,8 @@ namespace IBPP
         virtual bool Get(const std::string&, Date&) = 0;
         virtual bool Get(const std::string&, Time&) = 0;
         virtual bool Get(const std::string&, DBKey&) = 0;
+        virtual bool Get(const std::string&, Int128&) = 0;
+        virtual bool Get(const std::string&, DecFloat&) = 0;
         virtual bool Get(const std::string&, Blob&) = 0;
         virtual bool Get(const std::string&, Array&) = 0;
 
@@ -683,12 +979,154 @@ namespace IBPP
         virtual ~IRow() {}
     };
 
+    /* Class RowBatch receives a block of rows read by IStatement::FetchBatch().
+     * The values are decoded straight from the fetch buffers and stored per
+     * column: a null bitmap and one contiguous array of values. Exact numerics
+     * are kept unscaled (Get as double to have them scaled), dates and times
+     * use the integer models of IBPP::Date and IBPP::Time, and strings are
+     * packed back to back in a single buffer per column.
+     * As everywhere else in IBPP, columns are numbered from 1. Rows are
+     * numbered from 0 to Rows()-1. All Get() methods return true when the
+     * value is SQL NULL, in which case the output argument is left untouched. */
+
+    class RowBatch
+    {
+    private:
+        friend class ibpp_internals::RowImpl;
+
+        struct Column
+        {
+            SDT mType;
+            int mSubtype;
+            int mSize;
+            int mScale;
+            std::vector<uint8_t> mNulls;    // One bit per row
+            std::vector<int64_t> mInts;     // Integers, booleans, dates, times,
+                                            // timestamps, blob and array ids
+            std::vector<double> mDoubles;   // Floats and doubles
+            std::vector<uint32_t> mOffsets; // Strings and the Firebird v4 types:
+                                            // Rows()+1 offsets into mChars
+            std::string mChars;             // Their values, the v4 types as
+                                            // their binary Firebird format
+        };
+
+        std::vector<Column> mColumns;
+        int mRows;
+        Database mDatabase;         // Used for Blob and Array access
+        Transaction mTransaction;
+
+        const Column& CheckedColumn(const char* where, int row, int col) const;
+
+    public:
+        void Clear();               // Drops the rows, keeps the layout
+        int Rows() const            { return mRows; }
+        int Columns() const         { return (int)mColumns.size(); }
+
+        SDT ColumnType(int col) const;
+        int ColumnSubtype(int col) const;
+        int ColumnSize(int col) const;
+        int ColumnScale(int col) const;
+
+        bool IsNull(int row, int col) const;
+        bool Get(int row, int col, bool&) const;
+        bool Get(int row, int col, std::string&) const;
+        bool Get(int row, int col, int16_t&) const;
+        bool Get(int row, int col, int32_t&) const;
+        bool Get(int row, int col, int64_t&) const;    // Unscaled
+        bool Get(int row, int col, float&) const;
+        bool Get(int row, int col, double&) const;     // Scaled
+        bool Get(int row, int col, Timestamp&) const;
+        bool Get(int row, int col, Date&) const;
+        bool Get(int row, int col, Time&) const;
+        bool Get(int row, int col, DBKey&) const;
+        bool Get(int row, int col, Int128&) const;
+        bool Get(int row, int col, DecFloat&) const;
+        bool Get(int row, int col, Blob&) const;
+        bool Get(int row, int col, Array&) const;
+
+        // Direct access to the column arrays, for tight loops
+        const uint8_t* NullMask(int col) const;
+        const int64_t* Int64s(int col) const;
+        const double* Doubles(int col) const;
+        const char* Chars(int row, int col, int& len) const;
+
+        RowBatch() : mRows(0) { }
+        ~RowBatch() { }
+    };
+
+    /* Class BlobStreamBuf is a std::streambuf over a Blob, so that a Blob of
+     * any size can be read or written through a std::istream / std::ostream
+     * in constant memory. The constructor opens the Blob (std::ios_base::in)
+     * or creates it (std::ios_base::out). The Blob is read or written in
+     * chunks of segmentsize bytes. With readahead, the next chunk is read by a
+     * background thread while the current one is consumed; the Blob must then
+     * not be used directly until the BlobStreamBuf is closed. Seeking is only
+     * supported when reading stream Blobs (see Blob::Create(btStream)).
+     * Errors are thrown as IBPP exceptions (which std::istream and
+     * std::ostream turn into badbit, unless their exceptions() say otherwise),
+     * except for seeks which fail as usual for a streambuf. */
+
+    class BlobStreamBuf : public std::streambuf
+    {
+    private:
+        Blob mBlob;
+        bool mWriteMode;
+        bool mReadAhead;
+        bool mEof;                  // The Blob reported its end
+        int mSegmentSize;
+        std::streamoff mPos;        // Blob offset of the end of mBuffer
+        std::vector<char> mBuffer;
+        std::vector<char> mNext;    // Filled by the read-ahead thread
+        std::future<int> mPending;
+
+        int Fill(std::vector<char>& buffer);
+        void Flush();
+        int Drain();
+
+        BlobStreamBuf(const BlobStreamBuf&);
+        BlobStreamBuf& operator=(const BlobStreamBuf&);
+
+    protected:
+        int_type underflow();
+        int_type overflow(int_type c);
+        int sync();
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+            std::ios_base::openmode which);
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which);
+
+    public:
+        void Close();               // Flushes and closes the Blob
+
+        BlobStreamBuf(Blob blob, std::ios_base::openmode mode = std::ios_base::in,
+            int segmentsize = 32*1024-1, bool readahead = false);
+        ~BlobStreamBuf();
+    };
+
     /* IStatement is the interface to the statements execution in IBPP.
      * Statement is the object class you actually use in your programming. A
      * Statement object is the work horse of IBPP. All your data manipulation
      * statements will be done through it. It is also used to access the result
-     * set of a query (when the statement is such), one row at a time and in
-     * strict forward direction. */
+     * set of a query (when the statement is such), one row at a time (or one
+     * RowBatch at a time, see FetchBatch) and in strict forward direction.
+     * FetchBatch() replaces the content of the batch with up to maxrows rows
+     * and returns false once the end of the result set has been reached (the
+     * batch then holds the last rows, if any). When it throws, the batch
+     * holds the rows read before the error. GetView() works as described
+     * for IRow, the view is invalidated by the next Fetch().
+     * FetchAs(a, b, ...) fetches the next row like Fetch() and stores its
+     * first columns into its arguments, in order. The argument types are
+     * checked against the columns once after each Prepare() (WrongType
+     * exception), the rows are then decoded without looking at the types
+     * again. A NULL column stores an empty or zero value, unless the argument
+     * is a Nullable<>. The other columns of the row stay available to Get().
+     * AddBatch() queues the current parameter values of an INSERT, UPDATE or
+     * DELETE statement, ExecuteBatch() then sends the queued rows packed into
+     * EXECUTE BLOCK statements, so that many rows cost a single round trip.
+     * Statements which can't be packed are executed row by row. When a packed
+     * block fails its rows are executed one by one: ExecuteBatch() throws the
+     * error of the first failing row (the previous rows have been executed),
+     * ExecuteBatch(errors) reports each failing row and goes on. Both return
+     * the count of rows executed without error and empty the batch. */
 
     class IStatement
     {
@@ -701,6 +1139,14 @@ namespace IBPP
         virtual void CursorExecute(const std::string& cursor, const std::string&) = 0;
         virtual bool Fetch() = 0;
         virtual bool Fetch(Row&) = 0;
+        virtual bool FetchBatch(RowBatch&, int maxrows) = 0;
+        virtual bool FetchFields(const FAT* types, int count,
+            void* const* values, bool* const* nulls) = 0;   // See FetchAs()
+        virtual void AddBatch() = 0;
+        virtual int BatchSize() = 0;
+        virtual int ExecuteBatch() = 0;
+        virtual int ExecuteBatch(std::vector<BatchError>&) = 0;
+        virtual void ClearBatch() = 0;
         virtual int AffectedRows() = 0;
         virtual void Close() = 0;
         virtual std::string& Sql() = 0;
@@ -720,6 +1166,8 @@ namespace IBPP
         virtual void Set(int, const Date& value) = 0;
         virtual void Set(int, const Time& value) = 0;
         virtual void Set(int, const DBKey& value) = 0;
+        virtual void Set(int, const Int128& value) = 0;
+        virtual void Set(int, const DecFloat& value) = 0;
         virtual void Set(int, const Blob& value) = 0;
         virtual void Set(int, const Array& value) = 0;
 
@@ -727,6 +1175,7 @@ namespace IBPP
         virtual bool Get(int, bool&) = 0;
         virtual bool Get(int, void*, int&) = 0; // byte buffers
         virtual bool Get(int, std::string&) = 0;
+        virtual bool GetView(int, const char*&, int&) = 0;   // no copy
         virtual bool Get(int, int16_t&) = 0;
         virtual bool Get(int, int32_t&) = 0;
         virtual bool Get(int, int64_t&) = 0;
@@ -736,6 +1185,8 @@ namespace IBPP
         virtual bool Get(int, Date& value) = 0;
         virtual bool Get(int, Time& value) = 0;
         virtual bool Get(int, DBKey& value) = 0;
+        virtual bool Get(int, Int128& value) = 0;
+        virtual bool Get(int, DecFloat& value) = 0;
         virtual bool Get(int, Blob& value) = 0;
         virtual bool Get(int, Array& value) = 0;
 
@@ -743,6 +1194,7 @@ namespace IBPP
         virtual bool Get(const std::string&, bool&) = 0;
         virtual bool Get(const std::string&, void*, int&) = 0;  // byte buffers
         virtual bool Get(const std::string&, std::string&) = 0;
+        virtual bool GetView(const std::string&, const char*&, int&) = 0;
         virtual bool Get(const std::string&, int16_t&) = 0;
         virtual bool Get(const std::string&, int32_t&) = 0;
         virtual bool Get(const std::string&, int64_t&) = 0;
@@ -752,6 +1204,8 @@ namespace IBPP
         virtual bool Get(const std::string&, Date& value) = 0;
         virtual bool Get(const std::string&, Time& value) = 0;
         virtual bool Get(const std::string&, DBKey& value) = 0;
+        virtual bool Get(const std::string&, Int128& value) = 0;
+        virtual bool Get(const std::string&, DecFloat& value) = 0;
         virtual bool Get(const std::string&, Blob& value) = 0;
         virtual bool Get(const std::string&, Array& value) = 0;
 
@@ -781,6 +1235,19 @@ namespace IBPP
 
         virtual ~IStatement() { }
 
+        template<typename T, typename... More>
+        bool FetchAs(T& value, More&... more)
+        {
+            // One array per list of types, its address identifies the list
+            static const FAT types[] = { FetchTarget<T>::type,
+                FetchTarget<More>::type... };
+            void* const values[] = { FetchTarget<T>::Value(value),
+                FetchTarget<More>::Value(more)... };
+            bool* const nulls[] = { FetchTarget<T>::Null(value),
+                FetchTarget<More>::Null(more)... };
+            return FetchFields(types, 1 + (int)sizeof...(More), values, nulls);
+        }
+
         // DEPRECATED METHODS (WON'T BE AVAILABLE IN VERSIONS 3.x)
         virtual bool Get(int, char*) = 0;                   // DEPRECATED
         virtual bool Get(const std::string&, char*) = 0;    // DEPRECATED
@@ -807,6 +1274,13 @@ namespace IBPP
         virtual void Clear() = 0;               // Drop all events
         virtual void Dispatch() = 0;            // Dispatch events (calls handlers)
 
+        // StartDelivery() handles the notifications on a background thread,
+        // which re-queues them at once and sums the counts per event. From
+        // then on Dispatch() calls each handler at most once per window
+        // milliseconds, with the count summed over that time.
+        virtual void StartDelivery(int window) = 0;
+        virtual void StopDelivery() = 0;
+
         virtual Database DatabasePtr() const = 0;
 
         virtual IEvents* AddRef() = 0;
@@ -894,6 +1368,13 @@ namespace IBPP
 
     void ClientLibSearchPaths(const std::string&);
 
+    /* ParseStatistics() fills tables from the text report of the database
+     * statistics, as read with IService::WaitOutput() after a call to
+     * IService::StartStatistics(). */
+
+    void ParseStatistics(const std::string& report,
+        std::vector<TableStatistics>& tables);
+
     /* Finally, here are some date and time conversion routines used by IBPP and
      * that may be helpful at the application level. They do not depend on
      * anything related to Firebird/Interbase. Just a bonus. dtoi and itod
@@ -0,0 +1,199 @@
+// Int128 class implementation
+/*
+    (C) Copyright 2000-2006 T.I.P. Group S.A. and the IBPP Team (www.ibpp.org)
+
+    The contents of this file are subject to the IBPP License (the "License");
+    you may not use this file except in compliance with the License.  You may
+    obtain a copy of the License at http://www.ibpp.org or in the 'license.txt'
+    file which must have been distributed along with this file.
+
+    This software, distributed under the License, is distributed on an "AS IS"
+    basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.  See the
+    License for the specific language governing rights and limitations
+    under the License.
+*/
+
+#ifdef _MSC_VER
+#pragma warning(disable: 4786 4996)
+#ifndef _DEBUG
+#pragma warning(disable: 4702)
+#endif
+#endif
+
+#include "_ibpp.h"
+
+#ifdef HAS_HDRSTOP
+#pragma hdrstop
+#endif
+
+#include <cmath>
+
+using namespace ibpp_internals;
+
+//	Private implementation
+
+namespace
+{
+	void negate(uint64_t& high, uint64_t& low)
+	{
+		low = ~low + 1;
+		high = ~high + (low == 0 ? 1 : 0);
+	}
+
+	// True if the magnitude fits the signed range, which goes one further
+	// for negative values
+	bool fitsSigned(uint64_t high, uint64_t low, bool negative)
+	{
+		if ((high >> 63) == 0) return true;
+		return negative && high == 0x8000000000000000ULL && low == 0;
+	}
+}
+
+//	Public implementation
+
+void IBPP::Int128::SetValue(const std::string& text, int scale)
+{
+	// [+|-]digits[.digits], surrounding spaces allowed, with at most 'scale'
+	// digits after the decimal point
+	if (scale < 0 || scale > 38)
+		throw LogicExceptionImpl("Int128::SetValue", _("Invalid scale"));
+
+	size_t pos = text.find_first_not_of(' ');
+	if (pos == std::string::npos)
+		throw LogicExceptionImpl("Int128::SetValue", _("Invalid numeric value"));
+	bool negative = text[pos] == '-';
+	if (text[pos] == '-' || text[pos] == '+') ++pos;
+
+	uint64_t high = 0, low = 0;
+	int digits = 0;
+	int decimals = -1;		// No decimal point seen yet
+	for (; pos < text.size(); ++pos)
+	{
+		char c = text[pos];
+		if (c == '.' && decimals < 0)
+		{
+			decimals = 0;
+			continue;
+		}
+		if (c < '0' || c > '9') break;
+		if (decimals == scale)
+			throw LogicExceptionImpl("Int128::SetValue",
+				_("Out of range numeric conversion !"));
+		if (decimals >= 0) ++decimals;
+		// Below this bound the product fits the 128 bits, fitsSigned()
+		// tells whether it also fits the signed range
+		if (high > 0x0CCCCCCCCCCCCCCCULL)
+			throw LogicExceptionImpl("Int128::SetValue",
+				_("Out of range numeric conversion !"));
+		mulAdd128(high, low, 10, (uint32_t)(c - '0'));
+		if (! fitsSigned(high, low, negative))
+			throw LogicExceptionImpl("Int128::SetValue",
+				_("Out of range numeric conversion !"));
+		++digits;
+	}
+	if (digits == 0 || text.find_first_not_of(' ', pos) != std::string::npos)
+		throw LogicExceptionImpl("Int128::SetValue", _("Invalid numeric value"));
+
+	for (decimals = decimals < 0 ? 0 : decimals; decimals < scale; ++decimals)
+	{
+		if (high > 0x0CCCCCCCCCCCCCCCULL)
+			throw LogicExceptionImpl("Int128::SetValue",
+				_("Out of range numeric conversion !"));
+		mulAdd128(high, low, 10, 0);
+		if (! fitsSigned(high, low, negative))
+			throw LogicExceptionImpl("Int128::SetValue",
+				_("Out of range numeric conversion !"));
+	}
+	if (negative) negate(high, low);
+	mHigh = (int64_t)high;
+	mLow = low;
+}
+
+std::string IBPP::Int128::AsString(int scale) const
+{
+	uint64_t high = (uint64_t)mHigh, low = mLow;
+	if (mHigh < 0) negate(high, low);
+
+	std::string digits;		// In reverse order
+	do digits.append(1, (char)('0' + divMod128(high, low, 10)));
+	while (high != 0 || low != 0);
+	while ((int)digits.size() <= scale) digits.append(1, '0');
+
+	std::string result;
+	if (mHigh < 0) result.append(1, '-');
+	for (int i = (int)digits.size() - 1; i >= 0; --i)
+	{
+		result.append(1, digits[i]);
+		if (i == scale && i > 0) result.append(1, '.');
+	}
+	return result;
+}
+
+double IBPP::Int128::AsDouble(int scale) const
+{
+	uint64_t high = (uint64_t)mHigh, low = mLow;
+	if (mHigh < 0) negate(high, low);
+	double value = (double)high * 18446744073709551616.0 + (double)low;
+	if (scale > 0) value /= pow(10.0, scale);
+	return mHigh < 0 ? -value : value;
+}
+
+IBPP::Int128& IBPP::Int128::operator+=(const IBPP::Int128& rv)
+{
+	uint64_t low = mLow + rv.mLow;
+	uint64_t carry = low < mLow ? 1 : 0;
+	mHigh = (int64_t)((uint64_t)mHigh + (uint64_t)rv.mHigh + carry);
+	mLow = low;
+	return *this;
+}
+
+namespace ibpp_internals
+{
+
+void mulAdd128(uint64_t& high, uint64_t& low, uint32_t mul, uint32_t add)
+{
+	// Schoolbook multiplication on 32 bits limbs, the overflow is dropped
+	uint32_t limbs[4] = {(uint32_t)low, (uint32_t)(low >> 32),
+		(uint32_t)high, (uint32_t)(high >> 32)};
+	uint64_t carry = add;
+	for (int i = 0; i < 4; i++)
+	{
+		uint64_t t = (uint64_t)limbs[i] * mul + carry;
+		limbs[i] = (uint32_t)t;
+		carry = t >> 32;
+	}
+	low = ((uint64_t)limbs[1] << 32) | limbs[0];
+	high = ((uint64_t)limbs[3] << 32) | limbs[2];
+}
+
+uint32_t divMod128(uint64_t& high, uint64_t& low, uint32_t div)
+{
+	uint32_t limbs[4] = {(uint32_t)low, (uint32_t)(low >> 32),
+		(uint32_t)high, (uint32_t)(high >> 32)};
+	uint64_t rem = 0;
+	for (int i = 3; i >= 0; i--)
+	{
+		uint64_t t = (rem << 32) | limbs[i];
+		limbs[i] = (uint32_t)(t / div);
+		rem = t % div;
+	}
+	low = ((uint64_t)limbs[1] << 32) | limbs[0];
+	high = ((uint64_t)limbs[3] << 32) | limbs[2];
+	return (uint32_t)rem;
+}
+
+//	The client library stores the low 64 bits first, as on all the (little
+//	endian) platforms Firebird v4 ships for.
+
+void encodeInt128(FB_I128& fb_i, const IBPP::Int128& i)
+{
+	fb_i.fb_data[0] = i.Low();
+	fb_i.fb_data[1] = (uint64_t)i.High();
+}
+
+void decodeInt128(IBPP::Int128& i, const FB_I128& fb_i)
+{
+	i.SetValue((int64_t)fb_i.fb_data[1], fb_i.fb_data[0]);
+}
+
+}
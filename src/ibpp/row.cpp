@@ -32,9 +32,96 @@
 
 #include <cmath>
 #include <ctime>
+#include <limits>
 
 using namespace ibpp_internals;
 
+namespace
+{
+	// Size of the sqldata buffer of a variable
+	size_t dataSize(const XSQLVAR* var)
+	{
+		switch (var->sqltype & ~1)
+		{
+			case SQL_ARRAY :
+			case SQL_BLOB :		return sizeof(ISC_QUAD);
+			case SQL_TIMESTAMP :return sizeof(ISC_TIMESTAMP);
+			case SQL_TYPE_TIME :return sizeof(ISC_TIME);
+			case SQL_TYPE_DATE :return sizeof(ISC_DATE);
+			case SQL_TIME_TZ_EX :	return sizeof(ISC_TIME_TZ_EX);
+			case SQL_TIMESTAMP_TZ_EX :	return sizeof(ISC_TIMESTAMP_TZ_EX);
+			case SQL_INT128 :	return sizeof(FB_I128);
+			case SQL_DEC16 :	return sizeof(FB_DEC16);
+			case SQL_DEC34 :	return sizeof(FB_DEC34);
+			case SQL_BOOLEAN :	return 1;	// Firebird v3
+			case SQL_TEXT :		return var->sqllen+1;
+			case SQL_VARYING :	return var->sqllen+3;
+			case SQL_SHORT :	return sizeof(int16_t);
+			case SQL_LONG :		return sizeof(int32_t);
+			case SQL_INT64 :	return sizeof(int64_t);
+			case SQL_FLOAT :	return sizeof(float);
+			case SQL_DOUBLE :	return sizeof(double);
+			default : throw LogicExceptionImpl("RowImpl::AllocVariables",
+						_("Found an unknown sqltype !"));
+		}
+	}
+
+	// Rounds a size up to the 8 bytes alignment of the arena
+	size_t arenaSlot(size_t size)
+	{
+		return (size + sizeof(int64_t) - 1) & ~(sizeof(int64_t) - 1);
+	}
+
+	// Column decoders of RowImpl::DecodeFields(), one per pair of column
+	// and value types
+
+	void decodeText(const XSQLVAR* var, void* value)
+	{
+		((std::string*)value)->assign(var->sqldata, var->sqllen);
+	}
+
+	void decodeVarying(const XSQLVAR* var, void* value)
+	{
+		((std::string*)value)->assign(var->sqldata+2, *(int16_t*)var->sqldata);
+	}
+
+	template<typename S, typename D>
+	void decodeInteger(const XSQLVAR* var, void* value)
+	{
+		S v = *(S*)var->sqldata;
+		if (sizeof(D) < sizeof(S) && (v < std::numeric_limits<D>::min()
+			|| v > std::numeric_limits<D>::max()))
+				throw LogicExceptionImpl("Statement::FetchAs",
+					_("Out of range numeric conversion !"));
+		*(D*)value = (D)v;
+	}
+
+	template<typename S>
+	void decodeNumeric(const XSQLVAR* var, void* value)
+	{
+		// NUMERIC(x,y), scale it !
+		*(double*)value = *(S*)var->sqldata / consts::dscales[-var->sqlscale];
+	}
+
+	template<typename S>
+	void decodeFloat(const XSQLVAR* var, void* value)
+	{
+		*(double*)value = *(S*)var->sqldata;
+	}
+
+	template<typename S>
+	void decodeBool(const XSQLVAR* var, void* value)
+	{
+		*(bool*)value = *(S*)var->sqldata != 0;
+	}
+
+	template<typename T>
+	void clearValue(void* value)
+	{
+		*(T*)value = T();
+	}
+}
+
 //	(((((((( OBJECT INTERFACE IMPLEMENTATION ))))))))
 
 void RowImpl::SetNull(int param)
@@ -219,6 +306,24 @@ void RowImpl::Set(int param, const IBPP::DBKey& key)
 	mUpdated[param-1] = true;
 }
 
+void RowImpl::Set(int param, const IBPP::Int128& value)
+{
+	if (mDescrArea == 0)
+		throw LogicExceptionImpl("Row::Set[Int128]", _("The row is not initialized."));
+
+	SetValue(param, ivInt128, &value);
+	mUpdated[param-1] = true;
+}
+
+void RowImpl::Set(int param, const IBPP::DecFloat& value)
+{
+	if (mDescrArea == 0)
+		throw LogicExceptionImpl("Row::Set[DecFloat]", _("The row is not initialized."));
+
+	SetValue(param, ivDecFloat, &value);
+	mUpdated[param-1] = true;
+}
+
 /*
 void RowImpl::Set(int param, const IBPP::Value& value)
 {
@@ -299,6 +404,22 @@ bool RowImpl::Get(int column, std::string& retvalue)
 	return pvalue == 0 ? true : false;
 }
 
+bool RowImpl::GetView(int column, const char*& data, int& len)
+{
+	if (mDescrArea == 0)
+		throw LogicExceptionImpl("Row::GetView", _("The row is not initialized."));
+
+	int sqllen;
+	void* pvalue = GetValue(column, ivByte, &sqllen);
+	if (pvalue != 0)
+	{
+		// points into the SQLDA, no copy is made
+		data = (const char*)pvalue;
+		len = sqllen;
+	}
+	return pvalue == 0 ? true : false;
+}
+
 bool RowImpl::Get(int column, int16_t& retvalue)
 {
 	if (mDescrArea == 0)
@@ -411,6 +532,24 @@ bool RowImpl::Get(int column, IBPP::DBKey& retkey)
 	return pvalue == 0 ? true : false;
 }
 
+bool RowImpl::Get(int column, IBPP::Int128& retvalue)
+{
+	if (mDescrArea == 0)
+		throw LogicExceptionImpl("Row::Get", _("The row is not initialized."));
+
+	void* pvalue = GetValue(column, ivInt128, (void*)&retvalue);
+	return pvalue == 0 ? true : false;
+}
+
+bool RowImpl::Get(int column, IBPP::DecFloat& retvalue)
+{
+	if (mDescrArea == 0)
+		throw LogicExceptionImpl("Row::Get", _("The row is not initialized."));
+
+	void* pvalue = GetValue(column, ivDecFloat, (void*)&retvalue);
+	return pvalue == 0 ? true : false;
+}
+
 bool RowImpl::Get(int column, IBPP::Array& retarray)
 {
 	if (mDescrArea == 0)
@@ -472,6 +611,14 @@ bool RowImpl::Get(const std::string& name, std::string& retvalue)
 	return Get(ColumnNum(name), retvalue);
 }
 
+bool RowImpl::GetView(const std::string& name, const char*& data, int& len)
+{
+	if (mDescrArea == 0)
+		throw LogicExceptionImpl("Row::GetView", _("The row is not initialized."));
+
+	return GetView(ColumnNum(name), data, len);
+}
+
 bool RowImpl::Get(const std::string& name, int16_t& retvalue)
 {
 	if (mDescrArea == 0)
@@ -552,6 +699,22 @@ bool RowImpl::Get(const std::string& name, IBPP::DBKey& retvalue)
 	return Get(ColumnNum(name), retvalue);
 }
 
+bool RowImpl::Get(const std::string& name, IBPP::Int128& retvalue)
+{
+	if (mDescrArea == 0)
+		throw LogicExceptionImpl("Row::Get", _("The row is not initialized."));
+
+	return Get(ColumnNum(name), retvalue);
+}
+
+bool RowImpl::Get(const std::string& name, IBPP::DecFloat& retvalue)
+{
+	if (mDescrArea == 0)
+		throw LogicExceptionImpl("Row::Get", _("The row is not initialized."));
+
+	return Get(ColumnNum(name), retvalue);
+}
+
 bool RowImpl::Get(const std::string& name, IBPP::Array& retarray)
 {
 	if (mDescrArea == 0)
@@ -698,6 +861,13 @@ IBPP::SDT RowImpl::ColumnType(int varnum)
 		case SQL_BLOB :      value = IBPP::sdBlob;      break;
 		case SQL_ARRAY :     value = IBPP::sdArray;     break;
 		case SQL_BOOLEAN :   value = IBPP::sdBoolean;     break;
+		case SQL_TIME_TZ :
+		case SQL_TIME_TZ_EX :		value = IBPP::sdTimeTz;      break;
+		case SQL_TIMESTAMP_TZ :
+		case SQL_TIMESTAMP_TZ_EX :	value = IBPP::sdTimestampTz; break;
+		case SQL_INT128 :    value = IBPP::sdInt128;    break;
+		case SQL_DEC16 :     value = IBPP::sdDec16;     break;
+		case SQL_DEC34 :     value = IBPP::sdDec34;     break;
 		default : throw LogicExceptionImpl("Row::ColumnType",
 						_("Found an unknown sqltype !"));
 	}
@@ -787,8 +957,7 @@ void RowImpl::Release()
 {
 	// Release cannot throw, except in DEBUG builds on assertion
 	ASSERTION(mRefCount >= 0);
-	--mRefCount;
-	try { if (mRefCount <= 0) delete this; }
+	try { if (--mRefCount <= 0) delete this; }
 		catch (...) { }
 }
 
@@ -811,7 +980,7 @@ void RowImpl::SetValue(int varnum, IITYPE ivType, const void* value, int userlen
 				std::string* svalue = (std::string*)value;
 				len = (int16_t)svalue->length();
 				if (len > var->sqllen) len = var->sqllen;
-				strncpy(var->sqldata, svalue->c_str(), len);
+				memcpy(var->sqldata, svalue->data(), len);
 				while (len < var->sqllen) var->sqldata[len++] = ' ';
 			}
 			else if (ivType == ivByte)
@@ -842,7 +1011,7 @@ void RowImpl::SetValue(int varnum, IITYPE ivType, const void* value, int userlen
 				len = (int16_t)svalue->length();
 				if (len > var->sqllen) len = var->sqllen;
 				*(int16_t*)var->sqldata = (int16_t)len;
-				strncpy(var->sqldata+2, svalue->c_str(), len);
+				memcpy(var->sqldata+2, svalue->data(), len);
 			}
 			else if (ivType == ivByte)
 			{
@@ -1015,6 +1184,66 @@ void RowImpl::SetValue(int varnum, IITYPE ivType, const void* value, int userlen
 			encodeTime(*(ISC_TIME*)var->sqldata, *(IBPP::Time*)value);
 			break;
 
+		case SQL_TIMESTAMP_TZ_EX :
+			if (ivType != ivTimestamp)
+				throw WrongTypeImpl("RowImpl::SetValue", var->sqltype, ivType,
+										_("Incompatible types."));
+			encodeTimestampTz(*(ISC_TIMESTAMP_TZ_EX*)var->sqldata, *(IBPP::Timestamp*)value);
+			break;
+
+		case SQL_TIME_TZ_EX :
+			if (ivType != ivTime)
+				throw WrongTypeImpl("RowImpl::SetValue", var->sqltype, ivType,
+										_("Incompatible types."));
+			encodeTimeTz(*(ISC_TIME_TZ_EX*)var->sqldata, *(IBPP::Time*)value);
+			break;
+
+		case SQL_INT128 :
+			if (ivType == ivInt128)
+			{
+				encodeInt128(*(FB_I128*)var->sqldata, *(IBPP::Int128*)value);
+			}
+			else if (ivType == ivInt16)
+			{
+				encodeInt128(*(FB_I128*)var->sqldata, IBPP::Int128(*(int16_t*)value));
+			}
+			else if (ivType == ivInt32)
+			{
+				encodeInt128(*(FB_I128*)var->sqldata, IBPP::Int128(*(int32_t*)value));
+			}
+			else if (ivType == ivInt64)
+			{
+				encodeInt128(*(FB_I128*)var->sqldata, IBPP::Int128(*(int64_t*)value));
+			}
+			else if (ivType == ivDouble)
+			{
+				// This SQL_INT128 is a NUMERIC(x,y), scale it ! Doubles only
+				// have 15 significant digits, so the int64_t range is enough
+				double multiplier = consts::dscales[-var->sqlscale];
+				double scaled = floor(*(double*)value * multiplier + 0.5);
+				if (scaled < -9.2e18 || scaled > 9.2e18)
+					throw LogicExceptionImpl("RowImpl::SetValue",
+						_("Out of range numeric conversion !"));
+				encodeInt128(*(FB_I128*)var->sqldata, IBPP::Int128((int64_t)scaled));
+			}
+			else throw WrongTypeImpl("RowImpl::SetValue", var->sqltype, ivType,
+										_("Incompatible types."));
+			break;
+
+		case SQL_DEC16 :
+			if (ivType != ivDecFloat)
+				throw WrongTypeImpl("RowImpl::SetValue", var->sqltype, ivType,
+										_("Incompatible types."));
+			encodeDecFloat(*(FB_DEC16*)var->sqldata, *(IBPP::DecFloat*)value);
+			break;
+
+		case SQL_DEC34 :
+			if (ivType != ivDecFloat)
+				throw WrongTypeImpl("RowImpl::SetValue", var->sqltype, ivType,
+										_("Incompatible types."));
+			encodeDecFloat(*(FB_DEC34*)var->sqldata, *(IBPP::DecFloat*)value);
+			break;
+
 		case SQL_BLOB :
 			if (ivType == ivBlob)
 			{
@@ -1105,14 +1334,14 @@ void* RowImpl::GetValue(int varnum, IITYPE ivType, void* retvalue)
 			}
 			else if (ivType == ivBool)
 			{
-				mBools[varnum-1] = 0;
+				mTemps[varnum-1].mBool = 0;
 				if (var->sqllen >= 1)
 				{
 					char c = var->sqldata[0];
 					if (c == 't' || c == 'T' || c == 'y' || c == 'Y' ||	c == '1')
-						mBools[varnum-1] = 1;
+						mTemps[varnum-1].mBool = 1;
 				}
-				value = &mBools[varnum-1];
+				value = &mTemps[varnum-1].mBool;
 			}
 			else throw WrongTypeImpl("RowImpl::GetValue", var->sqltype, ivType,
 										_("Incompatible types."));
@@ -1137,15 +1366,15 @@ void* RowImpl::GetValue(int varnum, IITYPE ivType, void* retvalue)
 			}
 			else if (ivType == ivBool)
 			{
-				mBools[varnum-1] = 0;
+				mTemps[varnum-1].mBool = 0;
 				len = *(int16_t*)var->sqldata;
 				if (len >= 1)
 				{
 					char c = var->sqldata[2];
 					if (c == 't' || c == 'T' || c == 'y' || c == 'Y' ||	c == '1')
-						mBools[varnum-1] = 1;
+						mTemps[varnum-1].mBool = 1;
 				}
-				value = &mBools[varnum-1];
+				value = &mTemps[varnum-1].mBool;
 			}
 			else throw WrongTypeImpl("RowImpl::GetValue", var->sqltype, ivType,
 										_("Incompatible types."));
@@ -1158,34 +1387,34 @@ void* RowImpl::GetValue(int varnum, IITYPE ivType, void* retvalue)
 			}
 			else if (ivType == ivBool)
 			{
-				if (*(int16_t*)var->sqldata == 0) mBools[varnum-1] = 0;
-				else mBools[varnum-1] = 1;
-				value = &mBools[varnum-1];
+				if (*(int16_t*)var->sqldata == 0) mTemps[varnum-1].mBool = 0;
+				else mTemps[varnum-1].mBool = 1;
+				value = &mTemps[varnum-1].mBool;
 			}
 			else if (ivType == ivInt32)
 			{
-				mInt32s[varnum-1] = *(int16_t*)var->sqldata;
-				value = &mInt32s[varnum-1];
+				mTemps[varnum-1].mInt32 = *(int16_t*)var->sqldata;
+				value = &mTemps[varnum-1].mInt32;
 			}
 			else if (ivType == ivInt64)
 			{
-				mInt64s[varnum-1] = *(int16_t*)var->sqldata;
-				value = &mInt64s[varnum-1];
+				mTemps[varnum-1].mInt64 = *(int16_t*)var->sqldata;
+				value = &mTemps[varnum-1].mInt64;
 			}
 			else if (ivType == ivFloat)
 			{
 				// This SQL_SHORT is a NUMERIC(x,y), scale it !
 				double divisor = consts::dscales[-var->sqlscale];
-				mFloats[varnum-1] = (float)(*(int16_t*)var->sqldata / divisor);
+				mTemps[varnum-1].mFloat = (float)(*(int16_t*)var->sqldata / divisor);
 
-				value = &mFloats[varnum-1];
+				value = &mTemps[varnum-1].mFloat;
 			}
 			else if (ivType == ivDouble)
 			{
 				// This SQL_SHORT is a NUMERIC(x,y), scale it !
 				double divisor = consts::dscales[-var->sqlscale];
-				mNumerics[varnum-1] = *(int16_t*)var->sqldata / divisor;
-				value = &mNumerics[varnum-1];
+				mTemps[varnum-1].mNumeric = *(int16_t*)var->sqldata / divisor;
+				value = &mTemps[varnum-1].mNumeric;
 			}
 			else throw WrongTypeImpl("RowImpl::GetValue", var->sqltype, ivType,
 										_("Incompatible types."));
@@ -1198,9 +1427,9 @@ void* RowImpl::GetValue(int varnum, IITYPE ivType, void* retvalue)
 			}
 			else if (ivType == ivBool)
 			{
-				if (*(int32_t*)var->sqldata == 0) mBools[varnum-1] = 0;
-				else mBools[varnum-1] = 1;
-				value = &mBools[varnum-1];
+				if (*(int32_t*)var->sqldata == 0) mTemps[varnum-1].mBool = 0;
+				else mTemps[varnum-1].mBool = 1;
+				value = &mTemps[varnum-1].mBool;
 			}
 			else if (ivType == ivInt16)
 			{
@@ -1208,27 +1437,27 @@ void* RowImpl::GetValue(int varnum, IITYPE ivType, void* retvalue)
 				if (tmp < consts::min16 || tmp > consts::max16)
 					throw LogicExceptionImpl("RowImpl::GetValue",
 						_("Out of range numeric conversion !"));
-				mInt16s[varnum-1] = (int16_t)tmp;
-				value = &mInt16s[varnum-1];
+				mTemps[varnum-1].mInt16 = (int16_t)tmp;
+				value = &mTemps[varnum-1].mInt16;
 			}
 			else if (ivType == ivInt64)
 			{
-				mInt64s[varnum-1] = *(int32_t*)var->sqldata;
-				value = &mInt64s[varnum-1];
+				mTemps[varnum-1].mInt64 = *(int32_t*)var->sqldata;
+				value = &mTemps[varnum-1].mInt64;
 			}
 			else if (ivType == ivFloat)
 			{
 				// This SQL_LONG is a NUMERIC(x,y), scale it !
 				double divisor = consts::dscales[-var->sqlscale];
-				mFloats[varnum-1] = (float)(*(int32_t*)var->sqldata / divisor);
-				value = &mFloats[varnum-1];
+				mTemps[varnum-1].mFloat = (float)(*(int32_t*)var->sqldata / divisor);
+				value = &mTemps[varnum-1].mFloat;
 			}
 			else if (ivType == ivDouble)
 			{
 				// This SQL_LONG is a NUMERIC(x,y), scale it !
 				double divisor = consts::dscales[-var->sqlscale];
-				mNumerics[varnum-1] = *(int32_t*)var->sqldata / divisor;
-				value = &mNumerics[varnum-1];
+				mTemps[varnum-1].mNumeric = *(int32_t*)var->sqldata / divisor;
+				value = &mTemps[varnum-1].mNumeric;
 			}
 			else throw WrongTypeImpl("RowImpl::GetValue", var->sqltype, ivType,
 										_("Incompatible types."));
@@ -1241,9 +1470,9 @@ void* RowImpl::GetValue(int varnum, IITYPE ivType, void* retvalue)
 			}
 			else if (ivType == ivBool)
 			{
-				if (*(int64_t*)var->sqldata == 0) mBools[varnum-1] = 0;
-				else mBools[varnum-1] = 1;
-				value = &mBools[varnum-1];
+				if (*(int64_t*)var->sqldata == 0) mTemps[varnum-1].mBool = 0;
+				else mTemps[varnum-1].mBool = 1;
+				value = &mTemps[varnum-1].mBool;
 			}
 			else if (ivType == ivInt16)
 			{
@@ -1251,8 +1480,8 @@ void* RowImpl::GetValue(int varnum, IITYPE ivType, void* retvalue)
 				if (tmp < consts::min16 || tmp > consts::max16)
 					throw LogicExceptionImpl("RowImpl::GetValue",
 						_("Out of range numeric conversion !"));
-				mInt16s[varnum-1] = (int16_t)tmp;
-				value = &mInt16s[varnum-1];
+				mTemps[varnum-1].mInt16 = (int16_t)tmp;
+				value = &mTemps[varnum-1].mInt16;
 			}
 			else if (ivType == ivInt32)
 			{
@@ -1260,22 +1489,22 @@ void* RowImpl::GetValue(int varnum, IITYPE ivType, void* retvalue)
 				if (tmp < consts::min32 || tmp > consts::max32)
 					throw LogicExceptionImpl("RowImpl::GetValue",
 						_("Out of range numeric conversion !"));
-				mInt32s[varnum-1] = (int32_t)tmp;
-				value = &mInt32s[varnum-1];
+				mTemps[varnum-1].mInt32 = (int32_t)tmp;
+				value = &mTemps[varnum-1].mInt32;
 			}
 			else if (ivType == ivFloat)
 			{
 				// This SQL_INT64 is a NUMERIC(x,y), scale it !
 				double divisor = consts::dscales[-var->sqlscale];
-				mFloats[varnum-1] = (float)(*(int64_t*)var->sqldata / divisor);
-				value = &mFloats[varnum-1];
+				mTemps[varnum-1].mFloat = (float)(*(int64_t*)var->sqldata / divisor);
+				value = &mTemps[varnum-1].mFloat;
 			}
 			else if (ivType == ivDouble)
 			{
 				// This SQL_INT64 is a NUMERIC(x,y), scale it !
 				double divisor = consts::dscales[-var->sqlscale];
-				mNumerics[varnum-1] = *(int64_t*)var->sqldata / divisor;
-				value = &mNumerics[varnum-1];
+				mTemps[varnum-1].mNumeric = *(int64_t*)var->sqldata / divisor;
+				value = &mTemps[varnum-1].mNumeric;
 			}
 			else throw WrongTypeImpl("RowImpl::GetValue", var->sqltype, ivType,
 										_("Incompatible types."));
@@ -1296,9 +1525,9 @@ void* RowImpl::GetValue(int varnum, IITYPE ivType, void* retvalue)
 			{
 				// Round to scale y of NUMERIC(x,y)
 				double multiplier = consts::dscales[-var->sqlscale];
-				mNumerics[varnum-1] =
+				mTemps[varnum-1].mNumeric =
 					floor(*(double*)var->sqldata * multiplier + 0.5) / multiplier;
-				value = &mNumerics[varnum-1];
+				value = &mTemps[varnum-1].mNumeric;
 			}
 			else value = var->sqldata;
 			break;
@@ -1327,6 +1556,60 @@ void* RowImpl::GetValue(int varnum, IITYPE ivType, void* retvalue)
 			value = retvalue;
 			break;
 
+		case SQL_TIMESTAMP_TZ_EX :
+			if (ivType != ivTimestamp)
+				throw WrongTypeImpl("RowImpl::GetValue", var->sqltype, ivType,
+										_("Incompatible types."));
+			decodeTimestampTz(*(IBPP::Timestamp*)retvalue, *(ISC_TIMESTAMP_TZ_EX*)var->sqldata);
+			value = retvalue;
+			break;
+
+		case SQL_TIME_TZ_EX :
+			if (ivType != ivTime)
+				throw WrongTypeImpl("RowImpl::GetValue", var->sqltype, ivType,
+										_("Incompatible types."));
+			decodeTimeTz(*(IBPP::Time*)retvalue, *(ISC_TIME_TZ_EX*)var->sqldata);
+			value = retvalue;
+			break;
+
+		case SQL_INT128 :
+			if (ivType == ivInt128)
+			{
+				decodeInt128(*(IBPP::Int128*)retvalue, *(FB_I128*)var->sqldata);
+				value = retvalue;
+			}
+			else if (ivType == ivDouble)
+			{
+				// This SQL_INT128 is a NUMERIC(x,y), scale it !
+				IBPP::Int128 tmp;
+				decodeInt128(tmp, *(FB_I128*)var->sqldata);
+				mTemps[varnum-1].mNumeric = tmp.AsDouble(-var->sqlscale);
+				value = &mTemps[varnum-1].mNumeric;
+			}
+			else throw WrongTypeImpl("RowImpl::GetValue", var->sqltype, ivType,
+										_("Incompatible types."));
+			break;
+
+		case SQL_DEC16 :
+		case SQL_DEC34 :
+			{
+				IBPP::DecFloat tmp;
+				IBPP::DecFloat* df = ivType == ivDecFloat ? (IBPP::DecFloat*)retvalue : &tmp;
+				if (ivType != ivDecFloat && ivType != ivDouble)
+					throw WrongTypeImpl("RowImpl::GetValue", var->sqltype, ivType,
+											_("Incompatible types."));
+				if ((var->sqltype & ~1) == SQL_DEC16)
+					decodeDecFloat(*df, *(FB_DEC16*)var->sqldata);
+				else decodeDecFloat(*df, *(FB_DEC34*)var->sqldata);
+				if (ivType == ivDouble)
+				{
+					mTemps[varnum-1].mNumeric = df->AsDouble();
+					value = &mTemps[varnum-1].mNumeric;
+				}
+				else value = retvalue;
+			}
+			break;
+
 		case SQL_BLOB :
 			if (ivType == ivBlob)
 			{
@@ -1364,48 +1647,130 @@ void* RowImpl::GetValue(int varnum, IITYPE ivType, void* retvalue)
 	return value;
 }
 
-void RowImpl::Free()
+void RowImpl::BatchLayout(IBPP::RowBatch& batch)
 {
-	if (mDescrArea != 0)
+	if (mDescrArea == 0)
+		throw LogicExceptionImpl("RowImpl::BatchLayout", _("The row is not initialized."));
+
+	batch.mColumns.resize(mDescrArea->sqld);
+	for (int i = 0; i < mDescrArea->sqld; i++)
+	{
+		IBPP::RowBatch::Column& column = batch.mColumns[i];
+		column.mType = ColumnType(i+1);
+		column.mSubtype = ColumnSubtype(i+1);
+		column.mSize = ColumnSize(i+1);
+		column.mScale = ColumnScale(i+1);
+	}
+	batch.mDatabase = mDatabase;
+	batch.mTransaction = mTransaction;
+	batch.Clear();
+}
+
+void RowImpl::BatchAppend(IBPP::RowBatch& batch)
+{
+	const int row = batch.mRows;
+	for (int i = 0; i < mDescrArea->sqld; i++)
 	{
-		for (int i = 0; i < mDescrArea->sqln; i++)
+		XSQLVAR* var = &(mDescrArea->sqlvar[i]);
+		IBPP::RowBatch::Column& column = batch.mColumns[i];
+
+		if ((row & 7) == 0) column.mNulls.push_back(0);
+		bool isnull = (var->sqltype & 1) && *(var->sqlind) != 0;
+		if (isnull) column.mNulls[row >> 3] |= (uint8_t)(1 << (row & 7));
+
+		// A SQL NULL still takes its slot, so that values stay indexed by row
+		switch (var->sqltype & ~1)
 		{
-			XSQLVAR* var = &(mDescrArea->sqlvar[i]);
-			if (var->sqldata != 0)
-			{
-				switch (var->sqltype & ~1)
+			case SQL_TEXT :
+				if (! isnull) column.mChars.append(var->sqldata, var->sqllen);
+				column.mOffsets.push_back((uint32_t)column.mChars.size());
+				break;
+			case SQL_VARYING :
+				if (! isnull) column.mChars.append(var->sqldata+2,
+					(size_t)*(int16_t*)var->sqldata);
+				column.mOffsets.push_back((uint32_t)column.mChars.size());
+				break;
+			case SQL_BOOLEAN :	// Firebird v3
+				column.mInts.push_back(isnull ? 0 : (*var->sqldata != 0 ? 1 : 0));
+				break;
+			case SQL_SHORT :
+				column.mInts.push_back(isnull ? 0 : *(int16_t*)var->sqldata);
+				break;
+			case SQL_LONG :
+				column.mInts.push_back(isnull ? 0 : *(int32_t*)var->sqldata);
+				break;
+			case SQL_INT64 :
+				column.mInts.push_back(isnull ? 0 : *(int64_t*)var->sqldata);
+				break;
+			case SQL_FLOAT :
+				column.mDoubles.push_back(isnull ? 0.0 : *(float*)var->sqldata);
+				break;
+			case SQL_DOUBLE :
+				if (! isnull && var->sqlscale < 0)
+				{
+					// Round to scale y of NUMERIC(x,y), as GetValue() does
+					double multiplier = consts::dscales[-var->sqlscale];
+					column.mDoubles.push_back(
+						floor(*(double*)var->sqldata * multiplier + 0.5) / multiplier);
+				}
+				else column.mDoubles.push_back(isnull ? 0.0 : *(double*)var->sqldata);
+				break;
+			case SQL_TIMESTAMP :
+				if (isnull) column.mInts.push_back(0);
+				else
 				{
-					case SQL_ARRAY :
-					case SQL_BLOB :		delete (ISC_QUAD*) var->sqldata; break;
-					case SQL_TIMESTAMP :delete (ISC_TIMESTAMP*) var->sqldata; break;
-					case SQL_TYPE_TIME :delete (ISC_TIME*) var->sqldata; break;
-					case SQL_TYPE_DATE :delete (ISC_DATE*) var->sqldata; break;
-					case SQL_BOOLEAN : // Firebird v3
-					case SQL_TEXT :
-					case SQL_VARYING :	delete [] var->sqldata; break;
-					case SQL_SHORT :	delete (int16_t*) var->sqldata; break;
-					case SQL_LONG :		delete (int32_t*) var->sqldata; break;
-					case SQL_INT64 :	delete (int64_t*) var->sqldata; break;
-					case SQL_FLOAT : 	delete (float*) var->sqldata; break;
-					case SQL_DOUBLE :	delete (double*) var->sqldata; break;
-					default : throw LogicExceptionImpl("RowImpl::Free",
-								_("Found an unknown sqltype !"));
+					// Date in the high 32 bits, time in the low 32 bits
+					ISC_TIMESTAMP* ts = (ISC_TIMESTAMP*)var->sqldata;
+					column.mInts.push_back(
+						(int64_t)((int)ts->timestamp_date - 15019) * 0x100000000LL
+							+ (uint32_t)ts->timestamp_time);
 				}
+				break;
+			case SQL_TYPE_DATE :
+				// Same shift between the Firebird and IBPP models as decodeDate()
+				column.mInts.push_back(isnull ? 0 : (int)*(ISC_DATE*)var->sqldata - 15019);
+				break;
+			case SQL_TYPE_TIME :
+				column.mInts.push_back(isnull ? 0 : (int)*(ISC_TIME*)var->sqldata);
+				break;
+			case SQL_TIME_TZ_EX :
+			case SQL_TIMESTAMP_TZ_EX :
+			case SQL_INT128 :
+			case SQL_DEC16 :
+			case SQL_DEC34 :
+				// Kept in their binary format, decoded by RowBatch::Get()
+				if (! isnull) column.mChars.append(var->sqldata, var->sqllen);
+				column.mOffsets.push_back((uint32_t)column.mChars.size());
+				break;
+			case SQL_ARRAY :
+			case SQL_BLOB :
+			{
+				int64_t id = 0;
+				if (! isnull) memcpy(&id, var->sqldata, sizeof(ISC_QUAD));
+				column.mInts.push_back(id);
+				break;
 			}
-			if (var->sqlind != 0) delete var->sqlind;
+			default : throw LogicExceptionImpl("RowImpl::BatchAppend",
+						_("Found an unknown sqltype !"));
 		}
+	}
+	++batch.mRows;
+}
+
+void RowImpl::Free()
+{
+	if (mDescrArea != 0)
+	{
+		// The variables themselves live in mArena
 		delete [] (char*)mDescrArea;
 		mDescrArea = 0;
 	}
 
-	mNumerics.clear();
-	mFloats.clear();
-	mInt64s.clear();
-	mInt32s.clear();
-	mInt16s.clear();
-	mBools.clear();
-	mStrings.clear();
+	mArena.clear();
+	mTemps.clear();
 	mUpdated.clear();
+	mFieldTypes = 0;
+	mFieldReaders.clear();
 
 	mDialect = 0;
 	mDatabase = 0;
@@ -1415,76 +1780,225 @@ void RowImpl::Free()
 void RowImpl::Resize(int n)
 {
 	const int size = XSQLDA_LENGTH(n);
+	int dialect = mDialect;
+	DatabaseImpl* database = mDatabase;
+	TransactionImpl* transaction = mTransaction;
 
 	Free();
     mDescrArea = (XSQLDA*) new char[size];
 
 	memset(mDescrArea, 0, size);
-	mNumerics.resize(n);
-	mFloats.resize(n);
-	mInt64s.resize(n);
-	mInt32s.resize(n);
-	mInt16s.resize(n);
-	mBools.resize(n);
-	mStrings.resize(n);
-	mUpdated.resize(n);
-	for (int i = 0; i < n; i++)
-	{
-		mNumerics[i] = 0.0;
-		mFloats[i] = 0.0;
-		mInt64s[i] = 0;
-		mInt32s[i] = 0;
-		mInt16s[i] = 0;
-		mBools[i] = 0;
-		mStrings[i].erase();
-		mUpdated[i] = false;
-	}
+	mTemps.assign(n, Temporary());
+	mUpdated.assign(n, false);
 
 	mDescrArea->version = SQLDA_VERSION1;
 	mDescrArea->sqln = (int16_t)n;
+	mDialect = dialect;
+	mDatabase = database;
+	mTransaction = transaction;
 }
 
 void RowImpl::AllocVariables()
 {
+	// All the sqldata and sqlind buffers are laid out in a single arena,
+	// each one aligned on 8 bytes. Binding a value writes straight into it
+	// and never allocates.
+	size_t arenaSize = 0;
 	int i;
 	for (i = 0; i < mDescrArea->sqld; i++)
 	{
 		XSQLVAR* var = &(mDescrArea->sqlvar[i]);
+
+		// The extended time zone formats also carry the offset of the zone,
+		// the client library converts them
+		if ((var->sqltype & ~1) == SQL_TIME_TZ)
+		{
+			var->sqltype = (short)(SQL_TIME_TZ_EX | (var->sqltype & 1));
+			var->sqllen = sizeof(ISC_TIME_TZ_EX);
+		}
+		else if ((var->sqltype & ~1) == SQL_TIMESTAMP_TZ)
+		{
+			var->sqltype = (short)(SQL_TIMESTAMP_TZ_EX | (var->sqltype & 1));
+			var->sqllen = sizeof(ISC_TIMESTAMP_TZ_EX);
+		}
+
+		arenaSize += arenaSlot(dataSize(var));
+		if (var->sqltype & 1) arenaSize += arenaSlot(sizeof(short));
+	}
+
+	mArena.assign(arenaSize / sizeof(int64_t), 0);
+	mFieldTypes = 0;	// The columns may have changed
+	char* next = mArena.empty() ? 0 : (char*)&mArena[0];
+	for (i = 0; i < mDescrArea->sqld; i++)
+	{
+		XSQLVAR* var = &(mDescrArea->sqlvar[i]);
+		var->sqldata = next;
+		next += arenaSlot(dataSize(var));
 		switch (var->sqltype & ~1)
 		{
-			case SQL_ARRAY :
-			case SQL_BLOB :		var->sqldata = (char*) new ISC_QUAD;
-								memset(var->sqldata, 0, sizeof(ISC_QUAD));
-								break;
-			case SQL_TIMESTAMP :var->sqldata = (char*) new ISC_TIMESTAMP;
-								memset(var->sqldata, 0, sizeof(ISC_TIMESTAMP));
-								break;
-			case SQL_TYPE_TIME :var->sqldata = (char*) new ISC_TIME;
-								memset(var->sqldata, 0, sizeof(ISC_TIME));
-								break;
-			case SQL_TYPE_DATE :var->sqldata = (char*) new ISC_DATE;
-								memset(var->sqldata, 0, sizeof(ISC_DATE));
+			case SQL_TEXT :		memset(var->sqldata, ' ', var->sqllen);
 								break;
-		    case SQL_BOOLEAN :  var->sqldata = new char[1]; // Firebird v3
+			case SQL_VARYING :	memset(var->sqldata+2, ' ', var->sqllen);
 								break;
-			case SQL_TEXT :		var->sqldata = new char[var->sqllen+1];
-								memset(var->sqldata, ' ', var->sqllen);
-								var->sqldata[var->sqllen] = '\0';
-								break;
-			case SQL_VARYING :	var->sqldata = new char[var->sqllen+3];
-								memset(var->sqldata, 0, 2);
-								memset(var->sqldata+2, ' ', var->sqllen);
-								var->sqldata[var->sqllen+2] = '\0';
-								break;
-			case SQL_SHORT :	var->sqldata = (char*) new int16_t(0); break;
-			case SQL_LONG :		var->sqldata = (char*) new int32_t(0); break;
-			case SQL_INT64 :	var->sqldata = (char*) new int64_t(0); break;
-			case SQL_FLOAT : 	var->sqldata = (char*) new float(0.0); break;
-			case SQL_DOUBLE :	var->sqldata = (char*) new double(0.0); break;
-			default : throw LogicExceptionImpl("RowImpl::AllocVariables",
-						_("Found an unknown sqltype !"));
 		}
-		if (var->sqltype & 1) var->sqlind = new short(-1);	// 0 indicator
+		if (var->sqltype & 1)
+		{
+			var->sqlind = (short*)next;
+			*var->sqlind = -1;	// 0 indicator
+			next += arenaSlot(sizeof(short));
+		}
+	}
+}
+
+void RowImpl::SaveValues(std::string& dest)
+{
+	// Each value is saved as its sqltype, sqllen, a null flag and the raw
+	// sqldata bytes, so that LoadValues() can check the target is the same
+	for (int i = 0; i < mDescrArea->sqld; i++)
+	{
+		XSQLVAR* var = &(mDescrArea->sqlvar[i]);
+		int16_t header[2];
+		header[0] = (int16_t)(var->sqltype & ~1);
+		header[1] = var->sqllen;
+		dest.append((const char*)header, sizeof(header));
+		if ((var->sqltype & 1) && *(var->sqlind) != 0)
+		{
+			dest.append(1, '\1');
+			continue;
+		}
+		dest.append(1, '\0');
+		int len = var->sqllen;
+		if ((var->sqltype & ~1) == SQL_VARYING)
+			len = 2 + (int)*(int16_t*)var->sqldata;
+		dest.append(var->sqldata, len);
+	}
+}
+
+void RowImpl::LoadValues(int first, const std::string& src)
+{
+	if (first < 1)
+		throw LogicExceptionImpl("RowImpl::LoadValues", _("Variable index out of range."));
+
+	const char* p = src.data();
+	const char* end = p + src.size();
+	for (int i = first-1; p < end; i++)
+	{
+		if (i >= mDescrArea->sqld)
+			throw LogicExceptionImpl("RowImpl::LoadValues", _("Variable index out of range."));
+		XSQLVAR* var = &(mDescrArea->sqlvar[i]);
+		int16_t header[2];
+		memcpy(header, p, sizeof(header));
+		p += sizeof(header);
+		if (header[0] != (var->sqltype & ~1) || header[1] != var->sqllen)
+			throw LogicExceptionImpl("RowImpl::LoadValues", _("Incompatible types."));
+		if (*p++ != 0)
+		{
+			if (! (var->sqltype & 1))
+				throw LogicExceptionImpl("RowImpl::LoadValues", _("This column can't be null."));
+			*var->sqlind = -1;
+		}
+		else
+		{
+			int len = var->sqllen;
+			if ((var->sqltype & ~1) == SQL_VARYING)
+			{
+				int16_t varlen;
+				memcpy(&varlen, p, sizeof(varlen));	// p may be unaligned
+				len = 2 + (int)varlen;
+			}
+			memcpy(var->sqldata, p, len);
+			p += len;
+			if (var->sqltype & 1) *var->sqlind = 0;
+		}
+		mUpdated[i] = true;
+	}
+}
+
+void RowImpl::CheckFields(const IBPP::FAT* types, int count)
+{
+	if (types == mFieldTypes) return;	// Already checked
+	if (count > mDescrArea->sqld)
+		throw LogicExceptionImpl("Statement::FetchAs",
+			_("More values than columns in the row."));
+
+	std::vector<FieldReader> readers(count);
+	for (int i = 0; i < count; i++)
+	{
+		const XSQLVAR* var = &(mDescrArea->sqlvar[i]);
+		const int sqltype = var->sqltype & ~1;
+		FieldReader& reader = readers[i];
+		reader.decode = 0;
+		IITYPE ivType;
+		switch (types[i])
+		{
+			case IBPP::faString :
+				ivType = ivString;
+				reader.clear = clearValue<std::string>;
+				if (sqltype == SQL_TEXT) reader.decode = decodeText;
+				else if (sqltype == SQL_VARYING) reader.decode = decodeVarying;
+				break;
+			case IBPP::faInt16 :
+				ivType = ivInt16;
+				reader.clear = clearValue<int16_t>;
+				if (var->sqlscale != 0) break;
+				if (sqltype == SQL_SHORT) reader.decode = decodeInteger<int16_t, int16_t>;
+				else if (sqltype == SQL_LONG) reader.decode = decodeInteger<int32_t, int16_t>;
+				else if (sqltype == SQL_INT64) reader.decode = decodeInteger<int64_t, int16_t>;
+				break;
+			case IBPP::faInt32 :
+				ivType = ivInt32;
+				reader.clear = clearValue<int32_t>;
+				if (var->sqlscale != 0) break;
+				if (sqltype == SQL_SHORT) reader.decode = decodeInteger<int16_t, int32_t>;
+				else if (sqltype == SQL_LONG) reader.decode = decodeInteger<int32_t, int32_t>;
+				else if (sqltype == SQL_INT64) reader.decode = decodeInteger<int64_t, int32_t>;
+				break;
+			case IBPP::faInt64 :
+				ivType = ivInt64;
+				reader.clear = clearValue<int64_t>;
+				if (var->sqlscale != 0) break;
+				if (sqltype == SQL_SHORT) reader.decode = decodeInteger<int16_t, int64_t>;
+				else if (sqltype == SQL_LONG) reader.decode = decodeInteger<int32_t, int64_t>;
+				else if (sqltype == SQL_INT64) reader.decode = decodeInteger<int64_t, int64_t>;
+				break;
+			case IBPP::faDouble :
+				ivType = ivDouble;
+				reader.clear = clearValue<double>;
+				if (sqltype == SQL_SHORT) reader.decode = decodeNumeric<int16_t>;
+				else if (sqltype == SQL_LONG) reader.decode = decodeNumeric<int32_t>;
+				else if (sqltype == SQL_INT64) reader.decode = decodeNumeric<int64_t>;
+				else if (sqltype == SQL_FLOAT) reader.decode = decodeFloat<float>;
+				else if (sqltype == SQL_DOUBLE) reader.decode = decodeFloat<double>;
+				break;
+			case IBPP::faBool :
+				ivType = ivBool;
+				reader.clear = clearValue<bool>;
+				if (sqltype == SQL_BOOLEAN) reader.decode = decodeBool<char>;
+				else if (sqltype == SQL_SHORT) reader.decode = decodeBool<int16_t>;
+				else if (sqltype == SQL_LONG) reader.decode = decodeBool<int32_t>;
+				else if (sqltype == SQL_INT64) reader.decode = decodeBool<int64_t>;
+				break;
+			default : throw LogicExceptionImpl("Statement::FetchAs",
+						_("Unknown value type."));
+		}
+		if (reader.decode == 0)
+			throw WrongTypeImpl("Statement::FetchAs", var->sqltype, ivType,
+									_("Incompatible types."));
+	}
+
+	mFieldReaders.swap(readers);
+	mFieldTypes = types;
+}
+
+void RowImpl::DecodeFields(int count, void* const* values, bool* const* nulls)
+{
+	for (int i = 0; i < count; i++)
+	{
+		const XSQLVAR* var = &(mDescrArea->sqlvar[i]);
+		bool isnull = (var->sqltype & 1) && *(var->sqlind) != 0;
+		if (nulls[i] != 0) *nulls[i] = isnull;
+		if (isnull) mFieldReaders[i].clear(values[i]);
+		else mFieldReaders[i].decode(var, values[i]);
 	}
 }
 
@@ -1506,53 +2020,23 @@ RowImpl& RowImpl::operator=(const RowImpl& copied)
     mDescrArea = (XSQLDA*) new char[size];
 	memcpy(mDescrArea, copied.mDescrArea, size);
 
-	// Copy of the columns data
-	for (int i = 0; i < mDescrArea->sqld; i++)
+	// Copy of the columns data, the arena at once. Then the pointers of the
+	// copy are moved into its own arena.
+	mArena = copied.mArena;
+	if (! mArena.empty())
 	{
-		XSQLVAR* var = &(mDescrArea->sqlvar[i]);
-		XSQLVAR* org = &(copied.mDescrArea->sqlvar[i]);
-		switch (var->sqltype & ~1)
+		const char* org = (const char*)&copied.mArena[0];
+		char* dest = (char*)&mArena[0];
+		for (int i = 0; i < mDescrArea->sqld; i++)
 		{
-			case SQL_ARRAY :
-			case SQL_BLOB :		var->sqldata = (char*) new ISC_QUAD;
-								memcpy(var->sqldata, org->sqldata, sizeof(ISC_QUAD));
-								break;
-			case SQL_TIMESTAMP :var->sqldata = (char*) new ISC_TIMESTAMP;
-								memcpy(var->sqldata, org->sqldata, sizeof(ISC_TIMESTAMP));
-								break;
-			case SQL_TYPE_TIME :var->sqldata = (char*) new ISC_TIME;
-								memcpy(var->sqldata, org->sqldata, sizeof(ISC_TIME));
-								break;
-			case SQL_TYPE_DATE :var->sqldata = (char*) new ISC_DATE;
-								memcpy(var->sqldata, org->sqldata, sizeof(ISC_DATE));
-								break;
-			case SQL_BOOLEAN :  var->sqldata = new char[1]; // Firebird v3
-								break;
-			case SQL_TEXT :		var->sqldata = new char[var->sqllen+1];
-								memcpy(var->sqldata, org->sqldata, var->sqllen+1);
-								break;
-			case SQL_VARYING :	var->sqldata = new char[var->sqllen+3];
-								memcpy(var->sqldata, org->sqldata, var->sqllen+3);
-								break;
-			case SQL_SHORT :	var->sqldata = (char*) new int16_t(*(int16_t*)org->sqldata); break;
-			case SQL_LONG :		var->sqldata = (char*) new int32_t(*(int32_t*)org->sqldata); break;
-			case SQL_INT64 :	var->sqldata = (char*) new int64_t(*(int64_t*)org->sqldata); break;
-			case SQL_FLOAT : 	var->sqldata = (char*) new float(*(float*)org->sqldata); break;
-			case SQL_DOUBLE :	var->sqldata = (char*) new double(*(double*)org->sqldata); break;
-			default : throw LogicExceptionImpl("RowImpl::Ctor",
-						_("Found an unknown sqltype !"));
+			XSQLVAR* var = &(mDescrArea->sqlvar[i]);
+			var->sqldata = dest + (var->sqldata - org);
+			if (var->sqltype & 1)
+				var->sqlind = (short*)(dest + ((char*)var->sqlind - org));
 		}
-		if (var->sqltype & 1) var->sqlind = new short(*org->sqlind);	// 0 indicator
 	}
-
-	// Pointers init, real data copy
-	mNumerics = copied.mNumerics;
-	mFloats = copied.mFloats;
-	mInt64s = copied.mInt64s;
-	mInt32s = copied.mInt32s;
-	mInt16s = copied.mInt16s;
-	mBools = copied.mBools;
-	mStrings = copied.mStrings;
+	mTemps = copied.mTemps;
+	mUpdated = copied.mUpdated;
 
 	mDialect = copied.mDialect;
 	mDatabase = copied.mDatabase;
@@ -1562,14 +2046,14 @@ RowImpl& RowImpl::operator=(const RowImpl& copied)
 }
 
 RowImpl::RowImpl(const RowImpl& copied)
-	: IBPP::IRow(), mRefCount(0), mDescrArea(0)
+	: IBPP::IRow(), mRefCount(0), mDescrArea(0), mFieldTypes(0)
 {
 	// mRefCount and mDescrArea are set to 0 before using the assignment operator
 	*this = copied;		// The assignment operator does the real copy
 }
 
 RowImpl::RowImpl(int dialect, int n, DatabaseImpl* db, TransactionImpl* tr)
-	: mRefCount(0), mDescrArea(0)
+	: mRefCount(0), mDescrArea(0), mFieldTypes(0)
 {
 	Resize(n);
 	mDialect = dialect;
@@ -0,0 +1,343 @@
+// RowBatch class implementation
+/*
+    (C) Copyright 2000-2006 T.I.P. Group S.A. and the IBPP Team (www.ibpp.org)
+
+    The contents of this file are subject to the IBPP License (the "License");
+    you may not use this file except in compliance with the License.  You may
+    obtain a copy of the License at http://www.ibpp.org or in the 'license.txt'
+    file which must have been distributed along with this file.
+
+    This software, distributed under the License, is distributed on an "AS IS"
+    basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.  See the
+    License for the specific language governing rights and limitations
+    under the License.
+*/
+
+#ifdef _MSC_VER
+#pragma warning(disable: 4786 4996)
+#ifndef _DEBUG
+#pragma warning(disable: 4702)
+#endif
+#endif
+
+#include "_ibpp.h"
+
+#ifdef HAS_HDRSTOP
+#pragma hdrstop
+#endif
+
+using namespace ibpp_internals;
+
+//	Private implementation
+
+const IBPP::RowBatch::Column& IBPP::RowBatch::CheckedColumn(const char* where,
+	int row, int col) const
+{
+	if (col < 1 || col > (int)mColumns.size())
+		throw LogicExceptionImpl(where, _("Variable index out of range."));
+	if (row < 0 || row >= mRows)
+		throw LogicExceptionImpl(where, _("Row index out of range."));
+	return mColumns[col-1];
+}
+
+//	Public implementation
+
+void IBPP::RowBatch::Clear()
+{
+	for (std::vector<Column>::iterator it = mColumns.begin();
+		it != mColumns.end(); ++it)
+	{
+		// clear() keeps the capacity, so a reused batch does not reallocate
+		it->mNulls.clear();
+		it->mInts.clear();
+		it->mDoubles.clear();
+		it->mChars.clear();
+		it->mOffsets.assign(1, 0);
+	}
+	mRows = 0;
+}
+
+IBPP::SDT IBPP::RowBatch::ColumnType(int col) const
+{
+	if (col < 1 || col > (int)mColumns.size())
+		throw LogicExceptionImpl("RowBatch::ColumnType", _("Variable index out of range."));
+	return mColumns[col-1].mType;
+}
+
+int IBPP::RowBatch::ColumnSubtype(int col) const
+{
+	if (col < 1 || col > (int)mColumns.size())
+		throw LogicExceptionImpl("RowBatch::ColumnSubtype", _("Variable index out of range."));
+	return mColumns[col-1].mSubtype;
+}
+
+int IBPP::RowBatch::ColumnSize(int col) const
+{
+	if (col < 1 || col > (int)mColumns.size())
+		throw LogicExceptionImpl("RowBatch::ColumnSize", _("Variable index out of range."));
+	return mColumns[col-1].mSize;
+}
+
+int IBPP::RowBatch::ColumnScale(int col) const
+{
+	if (col < 1 || col > (int)mColumns.size())
+		throw LogicExceptionImpl("RowBatch::ColumnScale", _("Variable index out of range."));
+	return mColumns[col-1].mScale;
+}
+
+bool IBPP::RowBatch::IsNull(int row, int col) const
+{
+	const Column& column = CheckedColumn("RowBatch::IsNull", row, col);
+	return (column.mNulls[row >> 3] & (1 << (row & 7))) != 0;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, bool& value) const
+{
+	const Column& column = CheckedColumn("RowBatch::Get[bool]", row, col);
+	if (column.mType != IBPP::sdBoolean)
+		throw LogicExceptionImpl("RowBatch::Get[bool]", _("Incompatible types."));
+	if (IsNull(row, col)) return true;
+	value = column.mInts[row] != 0;
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, std::string& value) const
+{
+	int len;
+	const char* chars = Chars(row, col, len);
+	if (chars == 0) return true;
+	value.assign(chars, (size_t)len);
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, int16_t& value) const
+{
+	int64_t tmp;
+	if (Get(row, col, tmp)) return true;
+	if (tmp < consts::min16 || tmp > consts::max16)
+		throw LogicExceptionImpl("RowBatch::Get[int16_t]",
+			_("Out of range numeric conversion !"));
+	value = (int16_t)tmp;
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, int32_t& value) const
+{
+	int64_t tmp;
+	if (Get(row, col, tmp)) return true;
+	if (tmp < consts::min32 || tmp > consts::max32)
+		throw LogicExceptionImpl("RowBatch::Get[int32_t]",
+			_("Out of range numeric conversion !"));
+	value = (int32_t)tmp;
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, int64_t& value) const
+{
+	const Column& column = CheckedColumn("RowBatch::Get[int64_t]", row, col);
+	if (column.mType != IBPP::sdSmallint && column.mType != IBPP::sdInteger
+		&& column.mType != IBPP::sdLargeint)
+			throw LogicExceptionImpl("RowBatch::Get[int64_t]", _("Incompatible types."));
+	if (IsNull(row, col)) return true;
+	value = column.mInts[row];
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, float& value) const
+{
+	double tmp;
+	if (Get(row, col, tmp)) return true;
+	value = (float)tmp;
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, double& value) const
+{
+	const Column& column = CheckedColumn("RowBatch::Get[double]", row, col);
+	if (IsNull(row, col)) return true;
+	switch (column.mType)
+	{
+		case IBPP::sdFloat :
+		case IBPP::sdDouble :
+			value = column.mDoubles[row];
+			break;
+		case IBPP::sdSmallint :
+		case IBPP::sdInteger :
+		case IBPP::sdLargeint :
+			// NUMERIC(x,y) stored unscaled, scale it !
+			value = column.mInts[row] / consts::dscales[column.mScale];
+			break;
+		case IBPP::sdInt128 :
+			{
+				IBPP::Int128 tmp;
+				Get(row, col, tmp);
+				value = tmp.AsDouble(column.mScale);
+			}
+			break;
+		case IBPP::sdDec16 :
+		case IBPP::sdDec34 :
+			{
+				IBPP::DecFloat tmp;
+				Get(row, col, tmp);
+				value = tmp.AsDouble();
+			}
+			break;
+		default : throw LogicExceptionImpl("RowBatch::Get[double]",
+					_("Incompatible types."));
+	}
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, IBPP::Timestamp& value) const
+{
+	const Column& column = CheckedColumn("RowBatch::Get[Timestamp]", row, col);
+	if (column.mType == IBPP::sdTimestampTz)
+	{
+		if (IsNull(row, col)) return true;
+		ISC_TIMESTAMP_TZ_EX tstz;
+		memcpy(&tstz, column.mChars.data() + column.mOffsets[row], sizeof(tstz));
+		decodeTimestampTz(value, tstz);
+		return false;
+	}
+	if (column.mType != IBPP::sdTimestamp)
+		throw LogicExceptionImpl("RowBatch::Get[Timestamp]", _("Incompatible types."));
+	if (IsNull(row, col)) return true;
+	value.SetTimezone(IBPP::TZ_NONE, 0);
+	int64_t packed = column.mInts[row];
+	value.SetDate((int)(packed >> 32));
+	value.SetTime((int)(uint32_t)(packed & 0xFFFFFFFF));
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, IBPP::Date& value) const
+{
+	const Column& column = CheckedColumn("RowBatch::Get[Date]", row, col);
+	if (column.mType != IBPP::sdDate)
+		throw LogicExceptionImpl("RowBatch::Get[Date]", _("Incompatible types."));
+	if (IsNull(row, col)) return true;
+	value.SetDate((int)column.mInts[row]);
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, IBPP::Time& value) const
+{
+	const Column& column = CheckedColumn("RowBatch::Get[Time]", row, col);
+	if (column.mType == IBPP::sdTimeTz)
+	{
+		if (IsNull(row, col)) return true;
+		ISC_TIME_TZ_EX ttz;
+		memcpy(&ttz, column.mChars.data() + column.mOffsets[row], sizeof(ttz));
+		decodeTimeTz(value, ttz);
+		return false;
+	}
+	if (column.mType != IBPP::sdTime)
+		throw LogicExceptionImpl("RowBatch::Get[Time]", _("Incompatible types."));
+	if (IsNull(row, col)) return true;
+	value.SetTime((int)column.mInts[row]);
+	value.SetTimezone(IBPP::TZ_NONE, 0);
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, IBPP::Int128& value) const
+{
+	const Column& column = CheckedColumn("RowBatch::Get[Int128]", row, col);
+	if (column.mType != IBPP::sdInt128)
+		throw LogicExceptionImpl("RowBatch::Get[Int128]", _("Incompatible types."));
+	if (IsNull(row, col)) return true;
+	FB_I128 i128;
+	memcpy(&i128, column.mChars.data() + column.mOffsets[row], sizeof(i128));
+	decodeInt128(value, i128);
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, IBPP::DecFloat& value) const
+{
+	const Column& column = CheckedColumn("RowBatch::Get[DecFloat]", row, col);
+	if (column.mType != IBPP::sdDec16 && column.mType != IBPP::sdDec34)
+		throw LogicExceptionImpl("RowBatch::Get[DecFloat]", _("Incompatible types."));
+	if (IsNull(row, col)) return true;
+	const char* data = column.mChars.data() + column.mOffsets[row];
+	if (column.mType == IBPP::sdDec16)
+	{
+		FB_DEC16 dec;
+		memcpy(&dec, data, sizeof(dec));
+		decodeDecFloat(value, dec);
+	}
+	else
+	{
+		FB_DEC34 dec;
+		memcpy(&dec, data, sizeof(dec));
+		decodeDecFloat(value, dec);
+	}
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, IBPP::DBKey& value) const
+{
+	int len;
+	const char* chars = Chars(row, col, len);
+	if (chars == 0) return true;
+	value.SetKey(chars, len);
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, IBPP::Blob& value) const
+{
+	const Column& column = CheckedColumn("RowBatch::Get[Blob]", row, col);
+	if (column.mType != IBPP::sdBlob)
+		throw LogicExceptionImpl("RowBatch::Get[Blob]", _("Incompatible types."));
+	if (IsNull(row, col)) return true;
+
+	if (value.intf() == 0)
+		value = IBPP::BlobFactory(mDatabase, mTransaction);
+	ISC_QUAD id;
+	memcpy(&id, &column.mInts[row], sizeof(ISC_QUAD));
+	dynamic_cast<BlobImpl*>(value.intf())->SetId(&id);
+	return false;
+}
+
+bool IBPP::RowBatch::Get(int row, int col, IBPP::Array& value) const
+{
+	const Column& column = CheckedColumn("RowBatch::Get[Array]", row, col);
+	if (column.mType != IBPP::sdArray)
+		throw LogicExceptionImpl("RowBatch::Get[Array]", _("Incompatible types."));
+	if (IsNull(row, col)) return true;
+
+	if (value.intf() == 0)
+		value = IBPP::ArrayFactory(mDatabase, mTransaction);
+	ISC_QUAD id;
+	memcpy(&id, &column.mInts[row], sizeof(ISC_QUAD));
+	dynamic_cast<ArrayImpl*>(value.intf())->SetId(&id);
+	return false;
+}
+
+const uint8_t* IBPP::RowBatch::NullMask(int col) const
+{
+	if (col < 1 || col > (int)mColumns.size())
+		throw LogicExceptionImpl("RowBatch::NullMask", _("Variable index out of range."));
+	return mColumns[col-1].mNulls.empty() ? 0 : &mColumns[col-1].mNulls[0];
+}
+
+const int64_t* IBPP::RowBatch::Int64s(int col) const
+{
+	if (col < 1 || col > (int)mColumns.size())
+		throw LogicExceptionImpl("RowBatch::Int64s", _("Variable index out of range."));
+	return mColumns[col-1].mInts.empty() ? 0 : &mColumns[col-1].mInts[0];
+}
+
+const double* IBPP::RowBatch::Doubles(int col) const
+{
+	if (col < 1 || col > (int)mColumns.size())
+		throw LogicExceptionImpl("RowBatch::Doubles", _("Variable index out of range."));
+	return mColumns[col-1].mDoubles.empty() ? 0 : &mColumns[col-1].mDoubles[0];
+}
+
+const char* IBPP::RowBatch::Chars(int row, int col, int& len) const
+{
+	const Column& column = CheckedColumn("RowBatch::Chars", row, col);
+	if (column.mType != IBPP::sdString)
+		throw LogicExceptionImpl("RowBatch::Chars", _("Incompatible types."));
+	if (IsNull(row, col)) return 0;
+	len = (int)(column.mOffsets[row+1] - column.mOffsets[row]);
+	return column.mChars.data() + column.mOffsets[row];
+}
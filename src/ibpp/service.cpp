@@ -550,8 +550,185 @@ void ServiceImpl::Repair(const std::string& dbfile, IBPP::RPF flags)
 	Wait();
 }
 
+namespace
+{
+	// Case insensitive comparison of a report label with a lowercase name
+	bool IsLabel(const std::string& label, const char* name)
+	{
+		std::string::size_type i = 0;
+		for (; i < label.size() && name[i] != 0; i++)
+			if (tolower((unsigned char)label[i]) != name[i]) return false;
+		return i == label.size() && name[i] == 0;
+	}
+}
+
+namespace IBPP
+{
+	// Parses the text report of isc_action_svc_db_stats. A table starts
+	// with an unindented "NAME (id)" line, its indices with "Index NAME (id)"
+	// lines, and the rest are "label: value" pairs separated by commas, or
+	// the " 0 - 19% = n" lines of the fill distributions.
+	void ParseStatistics(const std::string& report,
+		std::vector<IBPP::TableStatistics>& tables)
+	{
+		IBPP::TableStatistics* table = 0;
+		IBPP::IndexStatistics* index = 0;
+		bool analyzing = false;
+		bool keylength = false;
+
+		std::string::size_type pos = 0;
+		while (pos < report.size())
+		{
+			std::string::size_type eol = report.find('\n', pos);
+			if (eol == std::string::npos) eol = report.size();
+			std::string line(report, pos, eol - pos);
+			pos = eol + 1;
+
+			std::string::size_type last = line.find_last_not_of(" \t\r");
+			if (last == std::string::npos) continue;
+			line.erase(last + 1);
+			std::string::size_type first = line.find_first_not_of(" \t");
+			bool indented = first > 0;
+			line.erase(0, first);
+
+			// The header page information comes first, nothing of interest
+			if (! analyzing)
+			{
+				analyzing = line.compare(0, 18, "Analyzing database") == 0;
+				continue;
+			}
+
+			std::string::size_type paren = line.rfind(" (");
+			if (line[line.size() - 1] == ')' && paren != std::string::npos)
+			{
+				if (! indented)
+				{
+					tables.push_back(IBPP::TableStatistics());
+					table = &tables.back();
+					table->name.assign(line, 0, paren);
+					table->id = atoi(line.c_str() + paren + 2);
+					index = 0;
+					continue;
+				}
+				if (table != 0 && line.compare(0, 6, "Index ") == 0)
+				{
+					table->indices.push_back(IBPP::IndexStatistics());
+					index = &table->indices.back();
+					index->name.assign(line, 6, paren - 6);
+					keylength = false;
+					continue;
+				}
+			}
+			if (table == 0) continue;
+
+			std::string::size_type percent = line.find("% = ");
+			if (percent != std::string::npos)
+			{
+				int bucket = atoi(line.c_str()) / 20;
+				if (bucket >= 0 && bucket < 5)
+				{
+					int64_t pages = strtoll(line.c_str() + percent + 4, 0, 10);
+					if (index != 0) index->fill[bucket] = pages;
+						else table->fill[bucket] = pages;
+				}
+				continue;
+			}
+
+			std::string::size_type start = 0;
+			while (start < line.size())
+			{
+				std::string::size_type comma = line.find(',', start);
+				if (comma == std::string::npos) comma = line.size();
+				std::string::size_type colon = line.find(':', start);
+				if (colon < comma)
+				{
+					std::string label(line, start, colon - start);
+					const char* value = line.c_str() + colon + 1;
+					if (index != 0)
+					{
+						if (IsLabel(label, "depth"))
+							index->depth = atoi(value);
+						else if (IsLabel(label, "leaf buckets"))
+							index->leafbuckets = strtoll(value, 0, 10);
+						else if (IsLabel(label, "nodes"))
+							index->nodes = strtoll(value, 0, 10);
+						else if (IsLabel(label, "total dup"))
+							index->totaldup = strtoll(value, 0, 10);
+						else if (IsLabel(label, "max dup"))
+							index->maxdup = strtoll(value, 0, 10);
+						else if (IsLabel(label, "average key length"))
+						{
+							index->avgkeylength = strtod(value, 0);
+							keylength = true;
+						}
+						// Before Firebird 3 the key length was reported so
+						else if (IsLabel(label, "average data length") && ! keylength)
+							index->avgkeylength = strtod(value, 0);
+					}
+					else
+					{
+						if (IsLabel(label, "total records"))
+							table->records = strtoll(value, 0, 10);
+						else if (IsLabel(label, "average record length"))
+							table->avgrecordlength = strtod(value, 0);
+						else if (IsLabel(label, "total versions"))
+							table->versions = strtoll(value, 0, 10);
+						else if (IsLabel(label, "max versions"))
+							table->maxversions = strtoll(value, 0, 10);
+						else if (IsLabel(label, "total fragments"))
+							table->fragments = strtoll(value, 0, 10);
+						else if (IsLabel(label, "data pages"))
+							table->datapages = strtoll(value, 0, 10);
+						else if (IsLabel(label, "average fill"))
+							table->avgfill = atoi(value);
+					}
+				}
+				start = line.find_first_not_of(' ', comma + 1);
+			}
+		}
+	}
+}
+
+void ServiceImpl::GetStatistics(const std::string& dbfile,
+	std::vector<IBPP::TableStatistics>& tables, bool system)
+{
+	StartStatistics(dbfile, system);
+
+	std::string report, output;
+	while (WaitOutput(output))
+		report += output;
+	report += output;
+
+	tables.clear();
+	IBPP::ParseStatistics(report, tables);
+}
+
+void ServiceImpl::StartStatistics(const std::string& dbfile, bool system)
+{
+	if (mHandle	== 0)
+		throw LogicExceptionImpl("Service::StartStatistics", _("Service is not connected."));
+	if (dbfile.empty())
+		throw LogicExceptionImpl("Service::StartStatistics", _("Main database file must be specified."));
+
+	IBS status;
+	SPB spb;
+
+	spb.Insert(isc_action_svc_db_stats);
+	spb.InsertString(isc_spb_dbname, 2, dbfile.c_str());
+
+	unsigned int mask = isc_spb_sts_data_pages | isc_spb_sts_idx_pages
+		| isc_spb_sts_record_versions;
+	if (system) mask |= isc_spb_sts_sys_relations;
+	spb.InsertQuad(isc_spb_options, mask);
+
+	mOutput.clear();
+	(*gds.Call()->m_service_start)(status.Self(), &mHandle, 0, spb.Size(), spb.Self());
+	if (status.Errors())
+		throw SQLExceptionImpl(status, "Service::StartStatistics", _("isc_service_start failed"));
+}
+
 void ServiceImpl::StartBackup(const std::string& dbfile,
-	const std::string& bkfile, IBPP::BRF flags)
+	const std::string& bkfile, IBPP::BRF flags, int workers)
 {
 	if (mHandle	== 0)
 		throw LogicExceptionImpl("Service::Backup", _("Service is not connected."));
@@ -567,6 +744,7 @@ void ServiceImpl::StartBackup(const std::string& dbfile,
 	spb.InsertString(isc_spb_dbname, 2, dbfile.c_str());
 	spb.InsertString(isc_spb_bkp_file, 2, bkfile.c_str());
 	if (flags & IBPP::brVerbose) spb.Insert(isc_spb_verbose);
+	if (workers > 0) spb.InsertQuad(isc_spb_bkp_parallel_workers, workers);
 
 	unsigned int mask = 0;
 	if (flags & IBPP::brIgnoreChecksums)	mask |= isc_spb_bkp_ignore_checksums;
@@ -577,13 +755,14 @@ void ServiceImpl::StartBackup(const std::string& dbfile,
 	if (flags & IBPP::brConvertExtTables)	mask |= isc_spb_bkp_convert;
 	if (mask != 0) spb.InsertQuad(isc_spb_options, mask);
 
+	mOutput.clear();
 	(*gds.Call()->m_service_start)(status.Self(), &mHandle, 0, spb.Size(), spb.Self());
 	if (status.Errors())
 		throw SQLExceptionImpl(status, "Service::Backup", _("isc_service_start failed"));
 }
 
 void ServiceImpl::StartRestore(const std::string& bkfile, const std::string& dbfile,
-	int	pagesize, IBPP::BRF flags)
+	int	pagesize, IBPP::BRF flags, int workers)
 {
 	if (mHandle	== 0)
 		throw LogicExceptionImpl("Service::Restore", _("Service is not connected."));
@@ -600,6 +779,7 @@ void ServiceImpl::StartRestore(const std::string& bkfile, const std::string& dbf
 	spb.InsertString(isc_spb_dbname, 2, dbfile.c_str());
 	if (flags & IBPP::brVerbose) spb.Insert(isc_spb_verbose);
 	if (pagesize !=	0) spb.InsertQuad(isc_spb_res_page_size, pagesize);
+	if (workers > 0) spb.InsertQuad(isc_spb_res_parallel_workers, workers);
 
 	unsigned int mask;
 	if (flags & IBPP::brReplace) mask = isc_spb_res_replace;
@@ -612,11 +792,55 @@ void ServiceImpl::StartRestore(const std::string& bkfile, const std::string& dbf
 	if (flags & IBPP::brUseAllSpace)	mask |= isc_spb_res_use_all_space;
 	if (mask != 0) spb.InsertQuad(isc_spb_options, mask);
 
+	mOutput.clear();
 	(*gds.Call()->m_service_start)(status.Self(), &mHandle, 0, spb.Size(), spb.Self());
 	if (status.Errors())
 		throw SQLExceptionImpl(status, "Service::Restore", _("isc_service_start failed"));
 }
 
+void ServiceImpl::StartNBackup(const std::string& dbfile,
+	const std::string& bkfile, int level, IBPP::NBF flags)
+{
+	if (level < 0)
+		throw LogicExceptionImpl("Service::NBackup", _("Backup level can't be negative."));
+
+	NBackup(dbfile, bkfile, level, std::string(), flags);
+}
+
+void ServiceImpl::StartNBackup(const std::string& dbfile,
+	const std::string& bkfile, const std::string& guid, IBPP::NBF flags)
+{
+	if (guid.empty())
+		throw LogicExceptionImpl("Service::NBackup", _("Backup GUID must be specified."));
+
+	NBackup(dbfile, bkfile, -1, guid, flags);
+}
+
+void ServiceImpl::StartNRestore(const std::vector<std::string>& bkfiles,
+	const std::string& dbfile, IBPP::NBF flags)
+{
+	if (mHandle	== 0)
+		throw LogicExceptionImpl("Service::NRestore", _("Service is not connected."));
+	if (bkfiles.empty())
+		throw LogicExceptionImpl("Service::NRestore", _("Backup file must be specified."));
+	if (dbfile.empty())
+		throw LogicExceptionImpl("Service::NRestore", _("Main database file must be specified."));
+
+	IBS status;
+	SPB spb;
+
+	spb.Insert(isc_action_svc_nrest);
+	spb.InsertString(isc_spb_dbname, 2, dbfile.c_str());
+	for (size_t i = 0; i < bkfiles.size(); i++)
+		spb.InsertString(isc_spb_nbk_file, 2, bkfiles[i].c_str());
+	if (flags & IBPP::nbInPlace) spb.InsertQuad(isc_spb_options, isc_spb_nbk_inplace);
+
+	mOutput.clear();
+	(*gds.Call()->m_service_start)(status.Self(), &mHandle, 0, spb.Size(), spb.Self());
+	if (status.Errors())
+		throw SQLExceptionImpl(status, "Service::NRestore", _("isc_service_start failed"));
+}
+
 const char* ServiceImpl::WaitMsg()
 {
 	IBS status;
@@ -639,6 +863,71 @@ const char* ServiceImpl::WaitMsg()
 	return mWaitMessage.c_str();
 }
 
+bool ServiceImpl::WaitOutput(std::string& output)
+{
+	if (mHandle == 0)
+		throw LogicExceptionImpl("Service::WaitOutput", _("Service is not connected."));
+
+	IBS status;
+	RB result(32000);	// Buffer sizes are 16 bits signed integers
+	// The query returns after that timeout (in seconds) even without output
+	char send[] = {isc_info_svc_timeout, 4, 0, 1, 0, 0, 0};
+	char request[] = {isc_info_svc_to_eof};
+
+	(*gds.Call()->m_service_query)(status.Self(), &mHandle, 0,
+		sizeof(send), send, sizeof(request), request, result.Size(), result.Self());
+	if (status.Errors())
+		throw SQLExceptionImpl(status, "ServiceImpl::WaitOutput", _("isc_service_query failed"));
+
+	// An empty answer, neither truncated nor timed out, ends the task
+	bool running = false;
+	char* p = result.Self();
+	char* end = p + result.Size();
+	while (p < end && *p != isc_info_end)
+	{
+		switch (*p)
+		{
+			case isc_info_svc_to_eof :
+			{
+				int len = (*gds.Call()->m_vax_integer)(p + 1, 2);
+				if (p + 3 + len > end)
+					throw SQLExceptionImpl(status, "ServiceImpl::WaitOutput",
+						_("isc_service_query returned unexpected answer"));
+				mOutput.append(p + 3, len);
+				if (len > 0) running = true;
+				p += 3 + len;
+				break;
+			}
+			case isc_info_truncated :
+			case isc_info_svc_timeout :
+			case isc_info_data_not_ready :
+				running = true;
+				p++;
+				break;
+			default :
+				throw SQLExceptionImpl(status, "ServiceImpl::WaitOutput",
+					_("isc_service_query returned unexpected answer"));
+		}
+	}
+
+	if (! running)
+	{
+		output.swap(mOutput);
+		mOutput.clear();
+		return false;
+	}
+
+	std::string::size_type eol = mOutput.rfind('\n');
+	if (eol == std::string::npos)
+		output.clear();
+	else
+	{
+		output.assign(mOutput, 0, eol + 1);
+		mOutput.erase(0, eol + 1);
+	}
+	return true;
+}
+
 void ServiceImpl::Wait()
 {
 	IBS status;
@@ -683,13 +972,39 @@ void ServiceImpl::Release()
 {
 	// Release cannot throw, except in DEBUG builds on assertion
 	ASSERTION(mRefCount >= 0);
-	--mRefCount;
-	try { if (mRefCount <= 0) delete this; }
+	try { if (--mRefCount <= 0) delete this; }
 		catch (...) { }
 }
 
 //	(((((((( OBJECT INTERNAL METHODS ))))))))
 
+void ServiceImpl::NBackup(const std::string& dbfile, const std::string& bkfile,
+	int level, const std::string& guid, IBPP::NBF flags)
+{
+	if (mHandle	== 0)
+		throw LogicExceptionImpl("Service::NBackup", _("Service is not connected."));
+	if (dbfile.empty())
+		throw LogicExceptionImpl("Service::NBackup", _("Main database file must be specified."));
+	if (bkfile.empty())
+		throw LogicExceptionImpl("Service::NBackup", _("Backup file must be specified."));
+
+	IBS status;
+	SPB spb;
+
+	spb.Insert(isc_action_svc_nbak);
+	spb.InsertString(isc_spb_dbname, 2, dbfile.c_str());
+	spb.InsertString(isc_spb_nbk_file, 2, bkfile.c_str());
+	if (guid.empty()) spb.InsertQuad(isc_spb_nbk_level, level);
+		else spb.InsertString(isc_spb_nbk_guid, 2, guid.c_str());
+	if (flags & IBPP::nbDirectIO) spb.InsertString(isc_spb_nbk_direct, 2, "ON");
+	if (flags & IBPP::nbNoTriggers) spb.InsertQuad(isc_spb_options, isc_spb_nbk_no_triggers);
+
+	mOutput.clear();
+	(*gds.Call()->m_service_start)(status.Self(), &mHandle, 0, spb.Size(), spb.Self());
+	if (status.Errors())
+		throw SQLExceptionImpl(status, "Service::NBackup", _("isc_service_start failed"));
+}
+
 void ServiceImpl::SetServerName(const char* newName)
 {
 	if (newName == 0) mServerName.erase();
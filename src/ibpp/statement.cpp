@@ -32,6 +32,7 @@ using namespace ibpp_internals;
 
 void StatementImpl::Prepare(const std::string& sql)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (mDatabase == 0)
 		throw LogicExceptionImpl("Statement::Prepare", _("An IDatabase must be attached."));
 	if (mDatabase->GetHandle() == 0)
@@ -229,6 +230,7 @@ void StatementImpl::Prepare(const std::string& sql)
 
 void StatementImpl::Plan(std::string& plan)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (mHandle == 0)
 		throw LogicExceptionImpl("Statement::Plan", _("No statement has been prepared."));
 	if (mDatabase == 0)
@@ -251,6 +253,7 @@ void StatementImpl::Plan(std::string& plan)
 
 void StatementImpl::Execute(const std::string& sql)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (! sql.empty()) Prepare(sql);
 
 	if (mHandle == 0)
@@ -264,6 +267,9 @@ void StatementImpl::Execute(const std::string& sql)
 
 	CursorFree();	// Free a previous 'cursor' if any
 
+	// Cached statements may depend on the metadata about to change
+	if (mType == IBPP::stDDL) mDatabase->ClearStatementCache();
+
 	IBS status;
 	if (mType == IBPP::stSelect)
 	{
@@ -299,6 +305,7 @@ void StatementImpl::Execute(const std::string& sql)
 
 void StatementImpl::CursorExecute(const std::string& cursor, const std::string& sql)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (cursor.empty())
 		throw LogicExceptionImpl("Statement::CursorExecute", _("Cursor name can't be 0."));
 
@@ -345,6 +352,7 @@ void StatementImpl::CursorExecute(const std::string& cursor, const std::string&
 
 void StatementImpl::ExecuteImmediate(const std::string& sql)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (mDatabase == 0)
 		throw LogicExceptionImpl("Statement::ExecuteImmediate", _("An IDatabase must be attached."));
 	if (mDatabase->GetHandle() == 0)
@@ -372,6 +380,7 @@ void StatementImpl::ExecuteImmediate(const std::string& sql)
 
 int StatementImpl::AffectedRows()
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (mHandle == 0)
 		throw LogicExceptionImpl("Statement::AffectedRows", _("No statement has been prepared."));
 	if (mDatabase == 0)
@@ -406,6 +415,7 @@ int StatementImpl::AffectedRows()
 
 bool StatementImpl::Fetch()
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (! mResultSetAvailable)
 		throw LogicExceptionImpl("Statement::Fetch",
 			_("No statement has been executed or no result set available."));
@@ -436,6 +446,7 @@ bool StatementImpl::Fetch()
 
 bool StatementImpl::Fetch(IBPP::Row& row)
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (! mResultSetAvailable)
 		throw LogicExceptionImpl("Statement::Fetch(row)",
 			_("No statement has been executed or no result set available."));
@@ -467,13 +478,84 @@ bool StatementImpl::Fetch(IBPP::Row& row)
 	return true;
 }
 
+bool StatementImpl::FetchFields(const IBPP::FAT* types, int count,
+	void* const* values, bool* const* nulls)
+{
+	if (! mResultSetAvailable)
+		throw LogicExceptionImpl("Statement::FetchAs",
+			_("No statement has been executed or no result set available."));
+
+	// Checked before the fetch, a type error does not consume a row
+	mOutRow->CheckFields(types, count);
+	if (! Fetch()) return false;
+	mOutRow->DecodeFields(count, values, nulls);
+	return true;
+}
+
+bool StatementImpl::FetchBatch(IBPP::RowBatch& batch, int maxrows)
+{
+	AttachmentLock lock(mTransaction, mDatabase);
+	if (! mResultSetAvailable)
+		throw LogicExceptionImpl("Statement::FetchBatch",
+			_("No statement has been executed or no result set available."));
+	if (maxrows < 1)
+		throw LogicExceptionImpl("Statement::FetchBatch",
+			_("The batch size must be at least one row."));
+
+	mOutRow->BatchLayout(batch);
+	while (batch.Rows() < maxrows)
+	{
+		IBS status;
+		ISC_STATUS code = (*gds.Call()->m_dsql_fetch)(status.Self(), &mHandle, 1,
+						mOutRow->Self());
+		if (code == 100)	// This special code means "no more rows"
+		{
+			mResultSetAvailable = false;
+			// Oddly enough, fetching rows up to the last one seems to open
+			// an 'implicit' cursor that needs to be closed.
+			mCursorOpened = true;
+			CursorFree();	// Free the explicit or implicit cursor/result-set
+			return false;
+		}
+		if (status.Errors())
+		{
+			Close();
+			throw SQLExceptionImpl(status, "Statement::FetchBatch",
+				_("isc_dsql_fetch failed."));
+		}
+
+		// Decoded right away, the next fetch overwrites the row buffers
+		mOutRow->BatchAppend(batch);
+	}
+
+	mCursorOpened = true;
+	return true;
+}
+
+void StatementImpl::AddBatch()
+{
+	if (mHandle == 0)
+		throw LogicExceptionImpl("Statement::AddBatch", _("No statement has been prepared."));
+	if (mType == IBPP::stSelect || mType == IBPP::stSelectUpdate)
+		throw LogicExceptionImpl("Statement::AddBatch", _("Can't batch a SELECT statement."));
+	if (mInRow == 0)
+		throw LogicExceptionImpl("Statement::AddBatch", _("The statement does not take parameters."));
+	if (mInRow->MissingValues())
+		throw LogicExceptionImpl("Statement::AddBatch", _("All parameters must be specified."));
+
+	mBatch.push_back(std::string());
+	mInRow->SaveValues(mBatch.back());
+}
+
 void StatementImpl::Close()
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	// Free all statement resources.
 	// Used before preparing a new statement or from destructor.
 
 	if (mInRow != 0) { mInRow->Release(); mInRow = 0; }
 	if (mOutRow != 0) { mOutRow->Release(); mOutRow = 0; }
+	mBatch.clear();
 
 	mResultSetAvailable = false;
 	mCursorOpened = false;
@@ -650,6 +732,26 @@ void StatementImpl::Set(int param, const IBPP::DBKey& key)
 	mInRow->Set(param, key);
 }
 
+void StatementImpl::Set(int param, const IBPP::Int128& value)
+{
+	if (mHandle == 0)
+		throw LogicExceptionImpl("Statement::Set[Int128]", _("No statement has been prepared."));
+	if (mInRow == 0)
+		throw LogicExceptionImpl("Statement::Set[Int128]", _("The statement does not take parameters."));
+
+	mInRow->Set(param, value);
+}
+
+void StatementImpl::Set(int param, const IBPP::DecFloat& value)
+{
+	if (mHandle == 0)
+		throw LogicExceptionImpl("Statement::Set[DecFloat]", _("No statement has been prepared."));
+	if (mInRow == 0)
+		throw LogicExceptionImpl("Statement::Set[DecFloat]", _("The statement does not take parameters."));
+
+	mInRow->Set(param, value);
+}
+
 /*
 void StatementImpl::Set(int param, const IBPP::Value& value)
 {
@@ -712,6 +814,14 @@ bool StatementImpl::Get(int column, std::string& retvalue)
 	return mOutRow->Get(column, retvalue);
 }
 
+bool StatementImpl::GetView(int column, const char*& data, int& len)
+{
+	if (mOutRow == 0)
+		throw LogicExceptionImpl("Statement::GetView", _("The row is not initialized."));
+
+	return mOutRow->GetView(column, data, len);
+}
+
 bool StatementImpl::Get(int column, int16_t* retvalue)
 {
 	if (mOutRow == 0)
@@ -842,6 +952,22 @@ bool StatementImpl::Get(int column, IBPP::DBKey& key)
 	return mOutRow->Get(column, key);
 }
 
+bool StatementImpl::Get(int column, IBPP::Int128& value)
+{
+	if (mOutRow == 0)
+		throw LogicExceptionImpl("Statement::Get", _("The row is not initialized."));
+
+	return mOutRow->Get(column, value);
+}
+
+bool StatementImpl::Get(int column, IBPP::DecFloat& value)
+{
+	if (mOutRow == 0)
+		throw LogicExceptionImpl("Statement::Get", _("The row is not initialized."));
+
+	return mOutRow->Get(column, value);
+}
+
 bool StatementImpl::Get(int column, IBPP::Array& array)
 {
 	if (mOutRow == 0)
@@ -910,6 +1036,14 @@ bool StatementImpl::Get(const std::string& name, std::string& retvalue)
 	return mOutRow->Get(name, retvalue);
 }
 
+bool StatementImpl::GetView(const std::string& name, const char*& data, int& len)
+{
+	if (mOutRow == 0)
+		throw LogicExceptionImpl("Statement::GetView", _("The row is not initialized."));
+
+	return mOutRow->GetView(name, data, len);
+}
+
 bool StatementImpl::Get(const std::string& name, int16_t* retvalue)
 {
 	if (mOutRow == 0)
@@ -1040,6 +1174,22 @@ bool StatementImpl::Get(const std::string& name, IBPP::DBKey& retvalue)
 	return mOutRow->Get(name, retvalue);
 }
 
+bool StatementImpl::Get(const std::string& name, IBPP::Int128& retvalue)
+{
+	if (mOutRow == 0)
+		throw LogicExceptionImpl("Statement::Get", _("The row is not initialized."));
+
+	return mOutRow->Get(name, retvalue);
+}
+
+bool StatementImpl::Get(const std::string& name, IBPP::DecFloat& retvalue)
+{
+	if (mOutRow == 0)
+		throw LogicExceptionImpl("Statement::Get", _("The row is not initialized."));
+
+	return mOutRow->Get(name, retvalue);
+}
+
 bool StatementImpl::Get(const std::string& name, IBPP::Array& retarray)
 {
 	if (mOutRow == 0)
@@ -1210,8 +1360,7 @@ void StatementImpl::Release()
 {
 	// Release cannot throw, except in DEBUG builds on assertion
 	ASSERTION(mRefCount >= 0);
-	--mRefCount;
-	try { if (mRefCount <= 0) delete this; }
+	try { if (--mRefCount <= 0) delete this; }
 		catch (...) { }
 }
 
@@ -1259,6 +1408,7 @@ void StatementImpl::DetachTransactionImpl()
 
 void StatementImpl::CursorFree()
 {
+	AttachmentLock lock(mTransaction, mDatabase);
 	if (mCursorOpened)
 	{
 		mCursorOpened = false;
@@ -1273,6 +1423,276 @@ void StatementImpl::CursorFree()
 	}
 }
 
+namespace
+{
+	// Splits a DML statement around its '?' parameter markers, skipping the
+	// string literals, quoted identifiers and comments
+	void SplitParameters(const std::string& sql, std::vector<std::string>& parts)
+	{
+		std::string::size_type end = sql.find_last_not_of(" \t\r\n;");
+		std::string::size_type start = 0, i = 0;
+		parts.clear();
+		while (end != std::string::npos && i <= end)
+		{
+			char c = sql[i];
+			if (c == '\'' || c == '"')
+			{
+				std::string::size_type close = sql.find(c, i + 1);
+				i = (close == std::string::npos) ? end + 1 : close + 1;
+			}
+			else if (c == '-' && i < end && sql[i+1] == '-')
+			{
+				std::string::size_type close = sql.find('\n', i);
+				i = (close == std::string::npos) ? end + 1 : close + 1;
+			}
+			else if (c == '/' && i < end && sql[i+1] == '*')
+			{
+				std::string::size_type close = sql.find("*/", i + 2);
+				i = (close == std::string::npos) ? end + 1 : close + 2;
+			}
+			else if (c == '?')
+			{
+				parts.push_back(sql.substr(start, i - start));
+				start = ++i;
+			}
+			else
+				++i;
+		}
+		if (end != std::string::npos && start <= end)
+			parts.push_back(sql.substr(start, end + 1 - start));
+		else
+			parts.push_back(std::string());
+	}
+}
+
+int StatementImpl::PrepareBlock(IBPP::Statement& block, int rows)
+{
+	// Only plain DML can be packed into an EXECUTE BLOCK. Dialect 3 is
+	// needed to declare the BIGINT, DATE and TIME parameters.
+	if (mType != IBPP::stInsert && mType != IBPP::stUpdate && mType != IBPP::stDelete)
+		return 0;
+	if (mInRow == 0 || mDatabase->Dialect() != 3)
+		return 0;
+
+	const int params = mInRow->Columns();
+	std::vector<std::string> parts;
+	SplitParameters(mSql, parts);
+	if ((int)parts.size() != params + 1)
+		return 0;
+
+	XSQLDA* da = mInRow->Self();
+	for (int i = 0; i < params; i++)
+	{
+		short type = da->sqlvar[i].sqltype & ~1;
+		if ((type == SQL_TEXT || type == SQL_VARYING) && mCharsets.empty())
+		{
+			// The character sets are needed to declare the string parameters
+			IBPP::Statement st = new StatementImpl(mDatabase, mTransaction);
+			st->Execute("SELECT RDB$CHARACTER_SET_ID, RDB$CHARACTER_SET_NAME, "
+				"RDB$BYTES_PER_CHARACTER FROM RDB$CHARACTER_SETS");
+			while (st->Fetch())
+			{
+				int16_t id, bpc;
+				std::string name;
+				st->Get(1, id);
+				st->Get(2, name);
+				st->Get(3, bpc);
+				name.erase(name.find_last_not_of(' ') + 1);
+				mCharsets[id] = std::make_pair(name, (int)bpc);
+			}
+		}
+	}
+
+	// Declarations of the parameters of one row
+	std::vector<std::string> types;
+	int rowbytes = 0;
+	for (int i = 0; i < params; i++)
+	{
+		XSQLVAR* var = &(da->sqlvar[i]);
+		std::ostringstream type;
+		switch (var->sqltype & ~1)
+		{
+			case SQL_TEXT :
+			case SQL_VARYING :
+			{
+				std::map<int, std::pair<std::string, int> >::const_iterator cs =
+					mCharsets.find(var->sqlsubtype & 0xFF);
+				if (cs == mCharsets.end() || cs->second.second < 1
+					|| var->sqllen % cs->second.second != 0)
+						return 0;
+				type << ((var->sqltype & ~1) == SQL_TEXT ? "CHAR(" : "VARCHAR(")
+					<< var->sqllen / cs->second.second << ") CHARACTER SET "
+					<< cs->second.first;
+				break;
+			}
+			case SQL_SHORT :
+			case SQL_LONG :
+			case SQL_INT64 :
+			{
+				int precision = (var->sqltype & ~1) == SQL_SHORT ? 4
+					: (var->sqltype & ~1) == SQL_LONG ? 9 : 18;
+				if (var->sqlscale < 0)
+					type << "NUMERIC(" << precision << "," << -var->sqlscale << ")";
+				else
+					type << (precision == 4 ? "SMALLINT" : precision == 9 ? "INTEGER" : "BIGINT");
+				break;
+			}
+			case SQL_FLOAT :		type << "FLOAT"; break;
+			case SQL_DOUBLE :		type << "DOUBLE PRECISION"; break;
+			case SQL_TIMESTAMP :	type << "TIMESTAMP"; break;
+			case SQL_TYPE_DATE :	type << "DATE"; break;
+			case SQL_TYPE_TIME :	type << "TIME"; break;
+			case SQL_TIME_TZ_EX :	type << "TIME WITH TIME ZONE"; break;
+			case SQL_TIMESTAMP_TZ_EX :	type << "TIMESTAMP WITH TIME ZONE"; break;
+			case SQL_INT128 :
+				if (var->sqlscale < 0)
+					type << "NUMERIC(38," << -var->sqlscale << ")";
+				else
+					type << "INT128";
+				break;
+			case SQL_DEC16 :		type << "DECFLOAT(16)"; break;
+			case SQL_DEC34 :		type << "DECFLOAT(34)"; break;
+			case SQL_BOOLEAN :		type << "BOOLEAN"; break;
+			case SQL_BLOB :			type << "BLOB SUB_TYPE " << var->sqlsubtype; break;
+			default :				return 0;	// Arrays can't be passed
+		}
+		types.push_back(type.str());
+		rowbytes += var->sqllen + 8;	// Data, null indicator and alignment
+	}
+
+	// By default as many rows as fit the 64 KB limits of the message and of
+	// the statement text, and stay below the 255 contexts of a request
+	if (rows == 0)
+	{
+		int rowsql = 0;
+		for (int i = 0; i <= params; i++)
+			rowsql += (int)parts[i].size();
+		for (int i = 0; i < params; i++)
+			rowsql += (int)types[i].size() + 24;
+		rows = 200;
+		if (rows > 60000 / rowbytes) rows = 60000 / rowbytes;
+		if (rows > 60000 / rowsql) rows = 60000 / rowsql;
+		if (params > 0 && rows > 1000 / params) rows = 1000 / params;
+		if (rows < 2)
+			return 0;
+	}
+
+	std::ostringstream decl, body;
+	for (int r = 0; r < rows; r++)
+	{
+		body << parts[0];
+		for (int i = 0; i < params; i++)
+		{
+			decl << (r == 0 && i == 0 ? "" : ", ") << "P" << r << "_" << i
+				<< " " << types[i] << " = ?";
+			body << ":P" << r << "_" << i << parts[i+1];
+		}
+		body << "\n;\n";	// On its own line, the SQL may end with a comment
+	}
+	std::string sql = "EXECUTE BLOCK (" + decl.str() + ")\nAS BEGIN\n"
+		+ body.str() + "END";
+
+	try
+	{
+		block = new StatementImpl(mDatabase, mTransaction);
+		block->Prepare(sql);
+	}
+	catch (IBPP::Exception&)
+	{
+		// Most likely an older server or a limit of the server, the rows
+		// will be executed one by one
+		block.clear();
+		return 0;
+	}
+	return rows;
+}
+
+int StatementImpl::RunBatch(std::vector<IBPP::BatchError>* errors)
+{
+	AttachmentLock lock(mTransaction, mDatabase);
+	if (mHandle == 0)
+		throw LogicExceptionImpl("Statement::ExecuteBatch", _("No statement has been prepared."));
+
+	const int count = (int)mBatch.size();
+	int row = 0, done = 0;
+	try
+	{
+		IBPP::Statement full;
+		int fullrows = (count >= 2) ? PrepareBlock(full, 0) : 0;
+		while (fullrows > 0 && count - row >= 2)
+		{
+			IBPP::Statement block = full;
+			int rows = count - row;
+			if (rows >= fullrows)
+				rows = fullrows;
+			else if (PrepareBlock(block, rows) == 0)
+				break;
+
+			StatementImpl* impl = dynamic_cast<StatementImpl*>(block.intf());
+			try
+			{
+				for (int i = 0; i < rows; i++)
+					impl->mInRow->LoadValues(i * mInRow->Columns() + 1, mBatch[row + i]);
+			}
+			catch (IBPP::LogicException&)
+			{
+				break;	// The block parameters were not described as expected
+			}
+
+			try
+			{
+				block->Execute();
+				done += rows;
+			}
+			catch (IBPP::SQLException&)
+			{
+				// Nothing of the block has been done, execute its rows one by
+				// one to know which ones fail
+				for (int i = 0; i < rows; i++)
+					done += RunBatchRow(row + i, errors);
+			}
+			row += rows;
+		}
+
+		for ( ; row < count; row++)
+			done += RunBatchRow(row, errors);
+	}
+	catch (...)
+	{
+		mBatch.clear();
+		throw;
+	}
+
+	mBatch.clear();
+	return done;
+}
+
+int StatementImpl::RunBatchRow(int row, std::vector<IBPP::BatchError>* errors)
+{
+	mInRow->LoadValues(1, mBatch[row]);
+	if (errors == 0)
+	{
+		Execute();
+		return 1;
+	}
+
+	try
+	{
+		Execute();
+		return 1;
+	}
+	catch (IBPP::SQLException& e)
+	{
+		IBPP::BatchError error;
+		error.row = row;
+		error.sqlcode = e.SqlCode();
+		error.enginecode = e.EngineCode();
+		error.message = e.what();
+		errors->push_back(error);
+	}
+	return 0;
+}
+
 StatementImpl::StatementImpl(DatabaseImpl* database, TransactionImpl* transaction)
 	: mRefCount(0), mHandle(0), mDatabase(0), mTransaction(0),
 	mInRow(0), mOutRow(0),
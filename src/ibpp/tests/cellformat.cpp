@@ -0,0 +1,253 @@
+//  Checks and benchmark of the compiled date and time formats of the grid
+//
+//  DataGridCellFormat compiles a format like "D.N.Y, H:M:S.T" once, and
+//  runs the compiled steps for every cell. The checks compare its output
+//  with the way the format used to be interpreted for every cell, one
+//  printf conversion per letter, for fixed and pseudo-random values. The
+//  benchmark formats the timestamps of a 100 column result both ways, as
+//  scrolling through it does. It runs on std::string: the conversion to
+//  wxString and the per-column cache of formatted values of the grid are
+//  left out.
+//
+//  Not part of the FlameRobin build, the Makefile next to it compiles it:
+//
+//      make cellformat
+//      ./cellformat
+//      ./cellformat scroll [rows]
+
+/*
+  (C) Copyright 2000-2006 T.I.P. Group S.A. and the IBPP Team (www.ibpp.org)
+
+  The contents of this file are subject to the IBPP License (the "License");
+  you may not use this file except in compliance with the License.  You may
+  obtain a copy of the License at http://www.ibpp.org or in the 'license.txt'
+  file which must have been distributed along with this file.
+
+  This software, distributed under the License, is distributed on an "AS IS"
+  basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.  See the
+  License for the specific language governing rights and limitations
+  under the License.
+*/
+
+#include "gui/controls/DataGridCellFormat.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    typedef DataGridCellFormat Format;
+
+    int failures = 0;
+
+    void Expect(const std::string& what, const std::string& actual,
+        const std::string& expected)
+    {
+        if (actual != expected)
+        {
+            std::cerr << what << ": got [" << actual << "], expected ["
+                << expected << "]" << std::endl;
+            failures++;
+        }
+    }
+
+    // The format as it was interpreted for every timestamp cell
+    std::string Interpreted(const std::string& format, const int* v)
+    {
+        std::string result;
+        for (std::string::const_iterator c = format.begin();
+            c != format.end(); ++c)
+        {
+            const char* spec;
+            int value;
+            switch (*c)
+            {
+                case 'd': spec = "%d"; value = v[Format::ffDay]; break;
+                case 'D': spec = "%02d"; value = v[Format::ffDay]; break;
+                case 'n': spec = "%d"; value = v[Format::ffMonth]; break;
+                case 'N': spec = "%02d"; value = v[Format::ffMonth]; break;
+                case 'y': spec = "%02d"; value = v[Format::ffYear2]; break;
+                case 'Y': spec = "%04d"; value = v[Format::ffYear]; break;
+                case 'h': spec = "%d"; value = v[Format::ffHour]; break;
+                case 'H': spec = "%02d"; value = v[Format::ffHour]; break;
+                case 'm': spec = "%d"; value = v[Format::ffMinute]; break;
+                case 'M': spec = "%02d"; value = v[Format::ffMinute]; break;
+                case 's': spec = "%d"; value = v[Format::ffSecond]; break;
+                case 'S': spec = "%02d"; value = v[Format::ffSecond]; break;
+                case 'T':
+                    spec = "%03d";
+                    value = v[Format::ffMilliSecond];
+                    break;
+                default:
+                    result += *c;
+                    continue;
+            }
+            char buffer[16];
+            snprintf(buffer, sizeof(buffer), spec, value);
+            result += buffer;
+        }
+        return result;
+    }
+
+    std::string Compiled(const Format& format, const int* values)
+    {
+        std::string result;
+        format.run(values, result);
+        return result;
+    }
+
+    void Values(int* v, int year, int month, int day, int hour, int minute,
+        int second, int milliSecond)
+    {
+        v[Format::ffYear] = year;
+        v[Format::ffYear2] = year % 100;
+        v[Format::ffMonth] = month;
+        v[Format::ffDay] = day;
+        v[Format::ffHour] = hour;
+        v[Format::ffMinute] = minute;
+        v[Format::ffSecond] = second;
+        v[Format::ffMilliSecond] = milliSecond;
+    }
+
+    void CheckWriteDecimal()
+    {
+        char buffer[24];
+        char* end = buffer + sizeof(buffer);
+        Expect("0", std::string(writeDecimal(end, 0), end), "0");
+        Expect("7, 3 digits", std::string(writeDecimal(end, 7, 3), end),
+            "007");
+        Expect("12345, 2 digits",
+            std::string(writeDecimal(end, 12345, 2), end), "12345");
+        Expect("-42", std::string(writeDecimal(end, -42), end), "-42");
+        Expect("-5, 2 digits", std::string(writeDecimal(end, -5, 2), end),
+            "-05");
+        Expect("INT64 max",
+            std::string(writeDecimal(end, INT64_MAX), end),
+            "9223372036854775807");
+        Expect("INT64 min",
+            std::string(writeDecimal(end, INT64_MIN), end),
+            "-9223372036854775808");
+    }
+
+    void CheckFormats()
+    {
+        int v[Format::ffCount];
+        Values(v, 2026, 3, 7, 9, 5, 4, 21);
+
+        Format date, time, timestamp;
+        date.compile("D.M.Y", Format::dateLetters());
+        Expect("date", Compiled(date, v), "07.03.2026");
+        date.compile("m/d/y", Format::dateLetters());
+        Expect("short date", Compiled(date, v), "3/7/26");
+        time.compile("H:M:S.T", Format::timeLetters());
+        Expect("time", Compiled(time, v), "09:05:04.021");
+        time.compile("h.m", Format::timeLetters());
+        Expect("short time", Compiled(time, v), "9.5");
+        timestamp.compile("D.N.Y, H:M:S.T", Format::timestampLetters());
+        Expect("timestamp", Compiled(timestamp, v),
+            "07.03.2026, 09:05:04.021");
+        // in a timestamp 'm' is the minute, 'M' in a date is the month
+        timestamp.compile("n-m", Format::timestampLetters());
+        Expect("timestamp n-m", Compiled(timestamp, v), "3-5");
+        timestamp.compile("", Format::timestampLetters());
+        Expect("empty", Compiled(timestamp, v), "");
+        if (!timestamp.isAscii())
+        {
+            std::cerr << "empty: not ASCII" << std::endl;
+            failures++;
+        }
+
+        // Non-ASCII literals are kept as UTF-8, and letters are never
+        // taken from within them
+        timestamp.compile("Y\xc3\xa5r D\xe2\x80\x94M", Format::dateLetters());
+        Expect("UTF-8 literal", Compiled(timestamp, v),
+            "2026\xc3\xa5r 07\xe2\x80\x94" "03");
+        if (timestamp.isAscii())
+        {
+            std::cerr << "UTF-8 literal: taken for ASCII" << std::endl;
+            failures++;
+        }
+        Values(v, 5, 12, 31, 23, 59, 59, 999);
+        date.compile("Y-M-D y", Format::dateLetters());
+        Expect("year 5", Compiled(date, v), "0005-12-31 05");
+
+        // Any mix of letters, against the interpreted format
+        const char* formats[] = { "D.N.Y, H:M:S.T", "Y-N-D H:M:S",
+            "d/n/y h:m:s", "NN dd YYYY TTT", "[Y] {T} x", "hmsT" };
+        srand(1);
+        for (int i = 0; i < 10000; i++)
+        {
+            Values(v, 1 + rand() % 9999, 1 + rand() % 12, 1 + rand() % 31,
+                rand() % 24, rand() % 60, rand() % 60, rand() % 1000);
+            const char* f = formats[i % (sizeof(formats) / sizeof(*formats))];
+            timestamp.compile(f, Format::timestampLetters());
+            Expect(f, Compiled(timestamp, v), Interpreted(f, v));
+        }
+    }
+
+    typedef std::chrono::steady_clock Clock;
+
+    double Seconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Formats all cells of rows rows of 100 TIMESTAMP columns
+    void Scroll(unsigned rows)
+    {
+        const unsigned columns = 100;
+        const std::string f = "D.N.Y, H:M:S.T";
+        Format timestamp;
+        timestamp.compile(f, Format::timestampLetters());
+
+        for (int pass = 0; pass < 2; pass++)
+        {
+            size_t length = 0;
+            int v[Format::ffCount];
+            Clock::time_point start = Clock::now();
+            for (unsigned row = 0; row < rows; row++)
+            {
+                for (unsigned col = 0; col < columns; col++)
+                {
+                    Values(v, 2000 + col, 1 + row % 12, 1 + row % 28,
+                        row % 24, col % 60, row % 60, row % 1000);
+                    length += (pass == 0 ? Interpreted(f, v)
+                        : Compiled(timestamp, v)).size();
+                }
+            }
+            double seconds = Seconds(start);
+            std::cout << std::left << std::setw(28)
+                << (pass == 0 ? "interpreted, per letter" : "compiled")
+                << std::right << std::setw(8) << rows << " rows x "
+                << columns << " columns " << std::fixed
+                << std::setprecision(3) << std::setw(7) << seconds << " s "
+                << std::setprecision(1) << std::setw(6)
+                << seconds * 1e9 / (rows * columns) << " ns/cell"
+                << " (" << length << " chars)" << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "scroll") == 0)
+    {
+        unsigned rows = 100000;
+        if (argc > 2)
+            rows = strtoul(argv[2], 0, 10);
+        Scroll(rows);
+        return 0;
+    }
+
+    CheckWriteDecimal();
+    CheckFormats();
+
+    if (failures == 0)
+        std::cout << "All cell format checks passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
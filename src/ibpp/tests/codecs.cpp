@@ -0,0 +1,195 @@
+//  Checks of the INT128 and DECFLOAT codecs of IBPP
+//
+//  The values are converted from and to text and to and from the binary
+//  formats of the client library, without any server, and compared with
+//  known encodings. The limits of the types are checked too: the range of
+//  INT128 goes one further for negative values.
+//
+//  Not part of the FlameRobin build, the Makefile next to it compiles it
+//  together with the IBPP sources:
+//
+//      make codecs
+//      ./codecs
+
+/*
+  (C) Copyright 2000-2006 T.I.P. Group S.A. and the IBPP Team (www.ibpp.org)
+
+  The contents of this file are subject to the IBPP License (the "License");
+  you may not use this file except in compliance with the License.  You may
+  obtain a copy of the License at http://www.ibpp.org or in the 'license.txt'
+  file which must have been distributed along with this file.
+
+  This software, distributed under the License, is distributed on an "AS IS"
+  basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.  See the
+  License for the specific language governing rights and limitations
+  under the License.
+*/
+
+#include "_ibpp.h"
+
+#include <iostream>
+#include <string>
+
+namespace
+{
+    const std::string int128Max = "170141183460469231731687303715884105727";
+    const std::string int128Min = "-170141183460469231731687303715884105728";
+
+    int failures = 0;
+
+    void Fail(const std::string& what, const std::string& message)
+    {
+        std::cerr << what << ": " << message << std::endl;
+        failures++;
+    }
+
+    void Expect(const std::string& what, const std::string& actual,
+        const std::string& expected)
+    {
+        if (actual != expected)
+            Fail(what, "got " + actual + ", expected " + expected);
+    }
+
+    // Text to Int128 and back, through the binary format
+    void Int128RoundTrip(const std::string& text, int scale,
+        const std::string& expected)
+    {
+        try
+        {
+            IBPP::Int128 value;
+            value.SetValue(text, scale);
+            FB_I128 fb_i;
+            ibpp_internals::encodeInt128(fb_i, value);
+            IBPP::Int128 decoded;
+            ibpp_internals::decodeInt128(decoded, fb_i);
+            if (! (decoded == value))
+                Fail("Int128 " + text, "changed by the binary format");
+            Expect("Int128 " + text, decoded.AsString(scale), expected);
+        }
+        catch (IBPP::Exception& e)
+        {
+            Fail("Int128 " + text, e.what());
+        }
+    }
+
+    void Int128Overflow(const std::string& text, int scale)
+    {
+        try
+        {
+            IBPP::Int128 value;
+            value.SetValue(text, scale);
+            Fail("Int128 " + text, "accepted out of range");
+        }
+        catch (IBPP::Exception&)
+        {
+        }
+    }
+
+    void CheckInt128()
+    {
+        Int128RoundTrip("0", 0, "0");
+        Int128RoundTrip("-1", 0, "-1");
+        Int128RoundTrip("18446744073709551616", 0, "18446744073709551616");
+        Int128RoundTrip(int128Max, 0, int128Max);
+        Int128RoundTrip(int128Min, 0, int128Min);
+        Int128RoundTrip("-1701411834604692317316873037158841057.28", 2,
+            "-1701411834604692317316873037158841057.28");
+        Int128RoundTrip("1701411834604692317316873037158841057.27", 2,
+            "1701411834604692317316873037158841057.27");
+        Int128RoundTrip("-12.5", 2, "-12.50");
+
+        Int128Overflow("170141183460469231731687303715884105728", 0);
+        Int128Overflow("-170141183460469231731687303715884105729", 0);
+        Int128Overflow("-1701411834604692317316873037158841057.29", 2);
+
+        IBPP::Int128 min;
+        min.SetValue(int128Min);
+        if (min.High() != (int64_t)0x8000000000000000ULL || min.Low() != 0)
+            Fail("Int128 " + int128Min, "wrong two's complement");
+        IBPP::Int128 minusOne(-1);
+        FB_I128 fb_i;
+        ibpp_internals::encodeInt128(fb_i, minusOne);
+        if (fb_i.fb_data[0] != ~0ULL || fb_i.fb_data[1] != ~0ULL)
+            Fail("Int128 -1", "wrong binary format");
+    }
+
+    // Text to DecFloat and back, through both binary formats when
+    // digits allows it
+    void DecFloatRoundTrip(const std::string& text, int digits,
+        const std::string& expected)
+    {
+        try
+        {
+            IBPP::DecFloat value;
+            value.SetValue(text);
+            IBPP::DecFloat decoded;
+            if (digits <= 16)
+            {
+                FB_DEC16 fb_df;
+                ibpp_internals::encodeDecFloat(fb_df, value);
+                ibpp_internals::decodeDecFloat(decoded, fb_df);
+                Expect("DecFloat(16) " + text, decoded.AsString(), expected);
+            }
+            FB_DEC34 fb_df;
+            ibpp_internals::encodeDecFloat(fb_df, value);
+            ibpp_internals::decodeDecFloat(decoded, fb_df);
+            Expect("DecFloat(34) " + text, decoded.AsString(), expected);
+        }
+        catch (IBPP::Exception& e)
+        {
+            Fail("DecFloat " + text, e.what());
+        }
+    }
+
+    void CheckDecFloat()
+    {
+        // Known encodings of 1 and -7.50
+        IBPP::DecFloat one;
+        one.SetValue("1");
+        FB_DEC16 fb_16;
+        ibpp_internals::encodeDecFloat(fb_16, one);
+        if (fb_16.fb_data[0] != 0x2238000000000001ULL)
+            Fail("DecFloat(16) 1", "wrong binary format");
+        FB_DEC34 fb_34;
+        ibpp_internals::encodeDecFloat(fb_34, one);
+        if (fb_34.fb_data[1] != 0x2208000000000000ULL
+            || fb_34.fb_data[0] != 1)
+        {
+            Fail("DecFloat(34) 1", "wrong binary format");
+        }
+        IBPP::DecFloat value;
+        value.SetValue("-7.50");
+        ibpp_internals::encodeDecFloat(fb_16, value);
+        if (fb_16.fb_data[0] != 0xA2300000000003D0ULL)
+            Fail("DecFloat(16) -7.50", "wrong binary format");
+        ibpp_internals::decodeDecFloat(value, fb_16);
+        if (! value.IsNegative() || value.Exponent() != -2
+            || value.CoefficientLow() != 750)
+        {
+            Fail("DecFloat(16) -7.50", "decoded wrong");
+        }
+
+        DecFloatRoundTrip("0", 16, "0");
+        DecFloatRoundTrip("123.456", 16, "123.456");
+        DecFloatRoundTrip("-0.001", 16, "-0.001");
+        DecFloatRoundTrip("9999999999999999", 16, "9999999999999999");
+        DecFloatRoundTrip("1234567890123456789012345678901234", 34,
+            "1234567890123456789012345678901234");
+        DecFloatRoundTrip("-9.999999999999999999999999999999999E+6144", 34,
+            "-9.999999999999999999999999999999999E+6144");
+        DecFloatRoundTrip("1E-6176", 34, "1E-6176");
+        DecFloatRoundTrip("Infinity", 16, "Infinity");
+        DecFloatRoundTrip("-Infinity", 16, "-Infinity");
+        DecFloatRoundTrip("NaN", 16, "NaN");
+    }
+}
+
+int main()
+{
+    CheckInt128();
+    CheckDecFloat();
+
+    if (failures == 0)
+        std::cout << "All codec checks passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
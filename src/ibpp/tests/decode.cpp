@@ -0,0 +1,362 @@
+//  Benchmark of the decoding of fetched rows, as done by the data grid
+//
+//  The rows of a result set come as an IBPP::RowBatch. They were decoded
+//  one cell at a time, by a virtual call per column that checked IsNull()
+//  and read the value with the typed RowBatch::Get(). They are now decoded
+//  by a plan of steps built once per statement, run with a single switch
+//  over the raw column arrays. Both are run here on the same batch and into
+//  the same fixed size row buffers, so that only the decoding differs.
+//  The batch is filled from a row built by hand: no server is needed.
+//
+//  The conversion of the strings to wxString by the grid is left out, both
+//  ways keep them as std::string.
+//
+//  Not part of the FlameRobin build, the Makefile next to it compiles it
+//  together with the IBPP sources:
+//
+//      make decode
+//      ./decode [rows]
+
+/*
+  (C) Copyright 2000-2006 T.I.P. Group S.A. and the IBPP Team (www.ibpp.org)
+
+  The contents of this file are subject to the IBPP License (the "License");
+  you may not use this file except in compliance with the License.  You may
+  obtain a copy of the License at http://www.ibpp.org or in the 'license.txt'
+  file which must have been distributed along with this file.
+
+  This software, distributed under the License, is distributed on an "AS IS"
+  basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.  See the
+  License for the specific language governing rights and limitations
+  under the License.
+*/
+
+#include "_ibpp.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double Seconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void Report(const char* what, size_t rows, size_t cells, double seconds)
+    {
+        std::cout << std::left << std::setw(28) << what << std::right
+            << std::setw(9) << rows << " rows "
+            << std::fixed << std::setprecision(3) << std::setw(8) << seconds
+            << " s " << std::setprecision(1) << std::setw(7)
+            << seconds * 1e9 / rows << " ns/row " << std::setw(6)
+            << seconds * 1e9 / cells << " ns/cell" << std::endl;
+    }
+
+    // A typical mix: INTEGER, BIGINT, NUMERIC(18,2), DOUBLE PRECISION,
+    // DATE, TIMESTAMP, VARCHAR(30) and CHAR(10), all nullable
+    const int columns = 8;
+
+    void Describe(XSQLDA* sqlda)
+    {
+        static const short types[columns] = { SQL_LONG, SQL_INT64, SQL_INT64,
+            SQL_DOUBLE, SQL_TYPE_DATE, SQL_TIMESTAMP, SQL_VARYING, SQL_TEXT };
+        static const short lengths[columns] = { 4, 8, 8, 8, 4, 8, 30, 10 };
+        sqlda->sqld = columns;
+        for (int i = 0; i < columns; i++)
+        {
+            XSQLVAR* var = &sqlda->sqlvar[i];
+            var->sqltype = (short)(types[i] | 1);
+            var->sqllen = lengths[i];
+            var->sqlscale = (short)(i == 2 ? -2 : 0);
+        }
+    }
+
+    void Fill(ibpp_internals::RowImpl* row, IBPP::RowBatch& batch, int rows)
+    {
+        row->BatchLayout(batch);
+        for (int r = 0; r < rows; r++)
+        {
+            row->Set(1, (int32_t)r);
+            row->Set(2, (int64_t)r * 1000003);
+            row->Set(3, (int64_t)r * 7);
+            row->Set(4, r * 0.25);
+            row->Set(5, IBPP::Date(2026, 1 + r % 12, 1 + r % 28));
+            row->Set(6, IBPP::Timestamp(2026, 1 + r % 12, 1 + r % 28,
+                r % 24, r % 60, r % 60));
+            row->Set(7, std::string("customer name ") + std::to_string(r));
+            row->Set(8, std::string("ABC"));
+            // One row out of ten has a NULL in the first columns
+            if (r % 10 == 0)
+            {
+                row->SetNull(1);
+                row->SetNull(3);
+            }
+            row->BatchAppend(batch);
+        }
+    }
+
+    // The destination of both: a fixed size buffer per row with a null
+    // flag per field, strings aside
+    const unsigned rowSize = 4 + 8 + 8 + 8 + 4 + 8;
+    const unsigned offsets[columns] = { 0, 4, 12, 20, 28, 32, 0, 1 };
+
+    struct Rows
+    {
+        std::vector<char> data;
+        std::vector<bool> nulls;
+        std::vector<std::string> strings;
+
+        Rows(int rows)
+            : data(rows * rowSize), nulls(rows * columns, true),
+              strings(rows * 2)
+        {
+        }
+        template<typename T>
+        void Set(int row, unsigned offset, T value)
+        {
+            memcpy(&data[row * rowSize + offset], &value, sizeof(T));
+        }
+    };
+
+    // The per-cell way: a virtual call per column and row, typed Get()
+    class Column
+    {
+    public:
+        unsigned offset;
+        Column(unsigned o) : offset(o) {}
+        virtual ~Column() {}
+        virtual void Decode(Rows& rows, const IBPP::RowBatch& batch, int row,
+            int col) = 0;
+    };
+
+    class IntegerColumn : public Column
+    {
+    public:
+        IntegerColumn(unsigned o) : Column(o) {}
+        void Decode(Rows& rows, const IBPP::RowBatch& batch, int row, int col)
+        {
+            int value;
+            batch.Get(row, col, value);
+            rows.Set(row, offset, value);
+        }
+    };
+
+    class Int64Column : public Column
+    {
+    public:
+        Int64Column(unsigned o) : Column(o) {}
+        void Decode(Rows& rows, const IBPP::RowBatch& batch, int row, int col)
+        {
+            int64_t value;
+            batch.Get(row, col, value);
+            rows.Set(row, offset, value);
+        }
+    };
+
+    class DoubleColumn : public Column
+    {
+    public:
+        DoubleColumn(unsigned o) : Column(o) {}
+        void Decode(Rows& rows, const IBPP::RowBatch& batch, int row, int col)
+        {
+            double value;
+            batch.Get(row, col, value);
+            rows.Set(row, offset, value);
+        }
+    };
+
+    class DateColumn : public Column
+    {
+    public:
+        DateColumn(unsigned o) : Column(o) {}
+        void Decode(Rows& rows, const IBPP::RowBatch& batch, int row, int col)
+        {
+            IBPP::Date value;
+            batch.Get(row, col, value);
+            rows.Set(row, offset, value.GetDate());
+        }
+    };
+
+    class TimestampColumn : public Column
+    {
+    public:
+        TimestampColumn(unsigned o) : Column(o) {}
+        void Decode(Rows& rows, const IBPP::RowBatch& batch, int row, int col)
+        {
+            IBPP::Timestamp value;
+            batch.Get(row, col, value);
+            rows.Set(row, offset, value.GetDate());
+            rows.Set(row, offset + sizeof(int), value.GetTime());
+        }
+    };
+
+    class StringColumn : public Column
+    {
+    public:
+        StringColumn(unsigned o) : Column(o) {}
+        void Decode(Rows& rows, const IBPP::RowBatch& batch, int row, int col)
+        {
+            batch.Get(row, col, rows.strings[row * 2 + offset]);
+        }
+    };
+
+    void PerCell(const IBPP::RowBatch& batch, Rows& rows)
+    {
+        std::vector<Column*> defs;
+        defs.push_back(new IntegerColumn(offsets[0]));
+        defs.push_back(new Int64Column(offsets[1]));
+        defs.push_back(new DoubleColumn(offsets[2]));
+        defs.push_back(new DoubleColumn(offsets[3]));
+        defs.push_back(new DateColumn(offsets[4]));
+        defs.push_back(new TimestampColumn(offsets[5]));
+        defs.push_back(new StringColumn(offsets[6]));
+        defs.push_back(new StringColumn(offsets[7]));
+
+        for (int row = 0; row < batch.Rows(); row++)
+        {
+            for (int col = 0; col < columns; col++)
+            {
+                bool isNull = batch.IsNull(row, col + 1);
+                rows.nulls[row * columns + col] = isNull;
+                if (!isNull)
+                    defs[col]->Decode(rows, batch, row, col + 1);
+            }
+        }
+
+        for (size_t i = 0; i < defs.size(); i++)
+            delete defs[i];
+    }
+
+    // The plan way, as DataGridRows::addRows() does it
+    enum OpCode { opInteger, opInt64, opScaledInt, opDouble, opDate,
+        opTimestamp, opString };
+    struct Op
+    {
+        OpCode code;
+        int column;
+        unsigned offset;
+        double divisor;
+    };
+
+    void Planned(const IBPP::RowBatch& batch, Rows& rows)
+    {
+        static const OpCode codes[columns] = { opInteger, opInt64,
+            opScaledInt, opDouble, opDate, opTimestamp, opString, opString };
+        std::vector<Op> plan(columns);
+        for (int i = 0; i < columns; i++)
+        {
+            plan[i].code = codes[i];
+            plan[i].column = i + 1;
+            plan[i].offset = offsets[i];
+            plan[i].divisor = codes[i] == opScaledInt ? 100.0 : 1.0;
+        }
+
+        std::vector<const uint8_t*> nulls(columns);
+        std::vector<const int64_t*> ints(columns);
+        std::vector<const double*> doubles(columns);
+        for (int i = 0; i < columns; i++)
+        {
+            nulls[i] = batch.NullMask(plan[i].column);
+            ints[i] = batch.Int64s(plan[i].column);
+            doubles[i] = batch.Doubles(plan[i].column);
+        }
+
+        for (int row = 0; row < batch.Rows(); row++)
+        {
+            for (int i = 0; i < columns; i++)
+            {
+                const Op& op = plan[i];
+                bool isNull = (nulls[i][row >> 3] & (1 << (row & 7))) != 0;
+                rows.nulls[row * columns + i] = isNull;
+                if (isNull)
+                    continue;
+                switch (op.code)
+                {
+                    case opInteger:
+                        rows.Set(row, op.offset, int(ints[i][row]));
+                        break;
+                    case opInt64:
+                        rows.Set(row, op.offset, int64_t(ints[i][row]));
+                        break;
+                    case opScaledInt:
+                        rows.Set(row, op.offset, ints[i][row] / op.divisor);
+                        break;
+                    case opDouble:
+                        rows.Set(row, op.offset, doubles[i][row]);
+                        break;
+                    case opDate:
+                        rows.Set(row, op.offset, int(ints[i][row]));
+                        break;
+                    case opTimestamp:
+                    {
+                        IBPP::Timestamp value;
+                        batch.Get(row, op.column, value);
+                        rows.Set(row, op.offset, value.GetDate());
+                        rows.Set(row, op.offset + sizeof(int),
+                            value.GetTime());
+                        break;
+                    }
+                    case opString:
+                    {
+                        int len;
+                        const char* chars = batch.Chars(row, op.column, len);
+                        rows.strings[row * 2 + op.offset].assign(chars, len);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int count = 1000000;
+    if (argc > 1)
+        count = atoi(argv[1]);
+
+    ibpp_internals::RowImpl* row =
+        new ibpp_internals::RowImpl(3, columns, 0, 0);
+    row->AddRef();
+    Describe(row->Self());
+    row->AllocVariables();
+
+    IBPP::RowBatch batch;
+    Clock::time_point start = Clock::now();
+    Fill(row, batch, count);
+    Report("fill, BatchAppend()", count, (size_t)count * columns,
+        Seconds(start));
+
+    // Each one runs twice, the first pass also touches the memory
+    Rows perCell(count), planned(count);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        start = Clock::now();
+        PerCell(batch, perCell);
+        Report("per cell, virtual + Get()", count, (size_t)count * columns,
+            Seconds(start));
+        start = Clock::now();
+        Planned(batch, planned);
+        Report("plan, raw column arrays", count, (size_t)count * columns,
+            Seconds(start));
+    }
+
+    row->Release();
+
+    // Both must have decoded the same values
+    if (perCell.data != planned.data || perCell.nulls != planned.nulls
+        || perCell.strings != planned.strings)
+    {
+        std::cerr << "The two decodings differ" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+//  Benchmark of the memory used by the rows of the data grid
+//
+//  The fetched rows were kept as one DataGridRowBuffer per row, with its
+//  own vectors for the values, the field flags and the wxStrings. They are
+//  now kept by a DataGridColumnStore, in one array per column and the
+//  strings as UTF-8 in large chunks. This adds the same rows to either one,
+//  in fetches of 1000 like the grid, and reports the growth of the resident
+//  size of the process, read from /proc/self/status on Linux. The rows have
+//  INTEGER, BIGINT, DOUBLE PRECISION, DATE, TIMESTAMP and VARCHAR columns,
+//  one row out of ten has NULLs. Each way is run by a process of its own,
+//  so that neither reuses memory freed by the other.
+//
+//  Not part of the FlameRobin build, the Makefile next to it compiles it
+//  together with the IBPP sources and the grid row classes, and needs
+//  wxWidgets (wx-config) too:
+//
+//      make gridrows
+//      ./gridrows buffers [rows]
+//      ./gridrows store [rows]
+
+/*
+  (C) Copyright 2000-2006 T.I.P. Group S.A. and the IBPP Team (www.ibpp.org)
+
+  The contents of this file are subject to the IBPP License (the "License");
+  you may not use this file except in compliance with the License.  You may
+  obtain a copy of the License at http://www.ibpp.org or in the 'license.txt'
+  file which must have been distributed along with this file.
+
+  This software, distributed under the License, is distributed on an "AS IS"
+  basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.  See the
+  License for the specific language governing rights and limitations
+  under the License.
+*/
+
+#include "gui/controls/DataGridRowBuffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double Seconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Resident size of the process in bytes, 0 if unknown
+    size_t ResidentSize()
+    {
+        size_t kb = 0;
+        if (FILE* status = fopen("/proc/self/status", "r"))
+        {
+            char line[256];
+            while (fgets(line, sizeof(line), status))
+            {
+                if (strncmp(line, "VmRSS:", 6) == 0)
+                {
+                    kb = strtoul(line + 6, 0, 10);
+                    break;
+                }
+            }
+            fclose(status);
+        }
+        return kb * 1024;
+    }
+
+    void Report(const char* what, unsigned rows, size_t bytes,
+        double seconds)
+    {
+        std::cout << std::left << std::setw(24) << what << std::right
+            << std::setw(10) << rows << " rows " << std::fixed
+            << std::setprecision(1) << std::setw(8) << bytes / 1048576.0
+            << " MB " << std::setw(6) << double(bytes) / rows
+            << " bytes/row " << std::setprecision(2) << std::setw(7)
+            << seconds << " s" << std::endl;
+    }
+
+    // The buffer layout used by the column definitions of the grid
+    const unsigned fields = 6;
+    const unsigned intOffset = 0, int64Offset = 4, doubleOffset = 12,
+        dateOffset = 20, timestampOffset = 24;
+    const unsigned stringIndex = 0;
+    const unsigned fetchRows = 1000;
+
+    wxString Name(unsigned row)
+    {
+        return wxString::Format("customer %u", row);
+    }
+
+    // Sets the values of row to buffer, as the grid did for each new row
+    void SetRow(DataGridRowBuffer& buffer, unsigned row)
+    {
+        bool nulls = row % 10 == 0;
+        for (unsigned field = 0; field < fields; field++)
+            buffer.setFieldNull(field, nulls && field < 2);
+        if (!nulls)
+        {
+            buffer.setValue(intOffset, int(row));
+            buffer.setValue(int64Offset, int64_t(row) * 1000003);
+        }
+        buffer.setValue(doubleOffset, row * 0.25);
+        buffer.setValue(dateOffset, int(row % 40000));
+        buffer.setValue(timestampOffset, int(row % 40000));
+        buffer.setValue(timestampOffset + sizeof(int), int(row % 864000000));
+        buffer.setString(stringIndex, Name(row));
+    }
+
+    void Buffers(unsigned count)
+    {
+        std::vector<DataGridRowBuffer*> rows;
+        size_t before = ResidentSize();
+        Clock::time_point start = Clock::now();
+        for (unsigned row = 0; row < count; row++)
+        {
+            DataGridRowBuffer* buffer = new DataGridRowBuffer(fields);
+            SetRow(*buffer, row);
+            rows.push_back(buffer);
+        }
+        Report("a buffer per row", count, ResidentSize() - before,
+            Seconds(start));
+        for (unsigned row = 0; row < count; row++)
+            delete rows[row];
+    }
+
+    void Store(unsigned count)
+    {
+        DataGridColumnStore store;
+        size_t before = ResidentSize();
+        Clock::time_point start = Clock::now();
+        store.addFixedColumn(intOffset, sizeof(int));
+        store.addFixedColumn(int64Offset, sizeof(int64_t));
+        store.addFixedColumn(doubleOffset, sizeof(double));
+        store.addFixedColumn(dateOffset, sizeof(int));
+        store.addFixedColumn(timestampOffset, 2 * sizeof(int));
+        store.initialize(fields, 1, 0);
+        for (unsigned first = 0; first < count; first += fetchRows)
+        {
+            unsigned n = std::min(fetchRows, count - first);
+            store.addRows(n);
+            for (unsigned row = first; row < first + n; row++)
+            {
+                ColumnStoreRowBuffer buffer(store, row);
+                SetRow(buffer, row);
+            }
+        }
+        Report("column store", count, ResidentSize() - before,
+            Seconds(start));
+        std::cout << "  as reported by the store: " << std::setprecision(1)
+            << store.getResidentSize() / 1048576.0 << " MB" << std::endl;
+
+        // Spot check of what was stored
+        ColumnStoreRowBuffer last(store, count - 1);
+        int64_t value;
+        if (!last.getValue(int64Offset, value)
+            || value != int64_t(count - 1) * 1000003
+            || last.getString(stringIndex) != Name(count - 1))
+        {
+            std::cerr << "The store lost values" << std::endl;
+            exit(1);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || (strcmp(argv[1], "buffers") != 0
+        && strcmp(argv[1], "store") != 0))
+    {
+        std::cerr << "Usage: gridrows buffers|store [rows]" << std::endl;
+        return 2;
+    }
+    unsigned count = 10000000;
+    if (argc > 2)
+        count = strtoul(argv[2], 0, 10);
+
+    if (strcmp(argv[1], "buffers") == 0)
+        Buffers(count);
+    else
+        Store(count);
+    return 0;
+}
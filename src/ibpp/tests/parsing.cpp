@@ -0,0 +1,246 @@
+//  Checks of the text parsing done by IBPP itself
+//
+//  The SQL text normalized to key the statement cache of a Database, with
+//  whitespace only significant inside string literals and quoted
+//  identifiers, and ParseStatistics() on the reports of the Firebird 2.5
+//  and 3+ services. No server is needed.
+//
+//  Not part of the FlameRobin build, the Makefile next to it compiles it
+//  together with the IBPP sources:
+//
+//      make parsing
+//      ./parsing
+
+/*
+  (C) Copyright 2000-2006 T.I.P. Group S.A. and the IBPP Team (www.ibpp.org)
+
+  The contents of this file are subject to the IBPP License (the "License");
+  you may not use this file except in compliance with the License.  You may
+  obtain a copy of the License at http://www.ibpp.org or in the 'license.txt'
+  file which must have been distributed along with this file.
+
+  This software, distributed under the License, is distributed on an "AS IS"
+  basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.  See the
+  License for the specific language governing rights and limitations
+  under the License.
+*/
+
+#include "_ibpp.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    int failures = 0;
+
+    void Expect(const std::string& what, const std::string& actual,
+        const std::string& expected)
+    {
+        if (actual != expected)
+        {
+            std::cerr << what << ": got [" << actual << "], expected ["
+                << expected << "]" << std::endl;
+            failures++;
+        }
+    }
+
+    template<typename T>
+    void ExpectValue(const std::string& what, T actual, T expected)
+    {
+        if (actual != expected)
+        {
+            std::ostringstream values;
+            values << actual << ", expected " << expected;
+            std::cerr << what << ": got " << values.str() << std::endl;
+            failures++;
+        }
+    }
+
+    void CheckNormalizedSql()
+    {
+        using ibpp_internals::NormalizedSql;
+
+        Expect("empty", NormalizedSql(""), "");
+        Expect("blank", NormalizedSql(" \t\r\n "), "");
+        Expect("trimmed", NormalizedSql("\n  select 1 from rdb$database \n"),
+            "select 1 from rdb$database");
+        Expect("collapsed",
+            NormalizedSql("select\t*\r\n  from  t\n\nwhere id = ?"),
+            "select * from t where id = ?");
+        Expect("literal",
+            NormalizedSql("select  'a  \n b'  from t"),
+            "select 'a  \n b' from t");
+        Expect("escaped quote",
+            NormalizedSql("select 'it''s  here',  x from t"),
+            "select 'it''s  here', x from t");
+        Expect("quoted identifier",
+            NormalizedSql("select \"my  column\"   from \"my\ttable\""),
+            "select \"my  column\" from \"my\ttable\"");
+        Expect("quotes nested",
+            NormalizedSql("select '\"  '  ,  \"'  \" from t"),
+            "select '\"  ' , \"'  \" from t");
+        Expect("unterminated literal",
+            NormalizedSql("select 'a   b"),
+            "select 'a   b");
+
+        // Different texts must stay different keys
+        if (NormalizedSql("select 'a b'") == NormalizedSql("select 'a  b'"))
+        {
+            std::cerr << "literals: whitespace change not kept" << std::endl;
+            failures++;
+        }
+    }
+
+    // As written by the Firebird 3 and later services (gstat -r)
+    const char* statistics30 =
+        "Database \"/tmp/employee.fdb\"\n"
+        "Database header page information:\n"
+        "\tFlags\t\t\t0\n"
+        "\tPage size\t\t8192\n"
+        "\n"
+        "Analyzing database pages ...\n"
+        "COUNTRY (128)\n"
+        "    Primary pointer page: 180, Index root page: 181\n"
+        "    Total formats: 1, used formats: 1\n"
+        "    Average record length: 25.50, total records: 14\n"
+        "    Average version length: 12.00, total versions: 3, max versions: 2\n"
+        "    Average fragment length: 0.00, total fragments: 1, max fragments: 1\n"
+        "    Average unpacked length: 32.00, compression ratio: 1.25\n"
+        "    Pointer pages: 1, data page slots: 2\n"
+        "    Data pages: 2, average fill: 48%\n"
+        "    Primary pages: 2, secondary pages: 0, swept pages: 0\n"
+        "    Empty pages: 0, full pages: 1\n"
+        "    Fill distribution:\n"
+        "\t 0 - 19% = 1\n"
+        "\t20 - 39% = 0\n"
+        "\t40 - 59% = 0\n"
+        "\t60 - 79% = 0\n"
+        "\t80 - 99% = 1\n"
+        "\n"
+        "    Index RDB$PRIMARY1 (0)\n"
+        "\tRoot page: 186, depth: 2, leaf buckets: 3, nodes: 14\n"
+        "\tAverage node length: 10.29, total dup: 4, max dup: 2\n"
+        "\tAverage key length: 8.25, compression ratio: 1.21\n"
+        "\tAverage prefix length: 1.79, average data length: 6.50\n"
+        "\tClustering factor: 1, ratio: 0.07\n"
+        "\tFill distribution:\n"
+        "\t     0 - 19% = 0\n"
+        "\t    20 - 39% = 2\n"
+        "\t    40 - 59% = 1\n"
+        "\t    60 - 79% = 0\n"
+        "\t    80 - 99% = 0\n"
+        "\n"
+        "JOB (129)\r\n"
+        "    Average record length: 0.00, total records: 0\r\n"
+        "    Data pages: 0, average fill: 0%\r\n"
+        "\n"
+        "Gstat completion time Sun Oct 18 10:00:00 2026\n";
+
+    // As written by the Firebird 2.5 service
+    const char* statistics25 =
+        "Analyzing database pages ...\n"
+        "\n"
+        "SALES (139)\n"
+        "    Primary pointer page: 230, Index root page: 231\n"
+        "    Average record length: 68.85, total records: 33\n"
+        "    Average version length: 0.00, total versions: 0, max versions: 0\n"
+        "    Data pages: 3, data page slots: 3, average fill: 71%\n"
+        "    Fill distribution:\n"
+        "\t 0 - 19% = 0\n"
+        "\t20 - 39% = 0\n"
+        "\t40 - 59% = 1\n"
+        "\t60 - 79% = 0\n"
+        "\t80 - 99% = 2\n"
+        "\n"
+        "    Index SALESTATX (5)\n"
+        "\tDepth: 1, leaf buckets: 1, nodes: 33\n"
+        "\tAverage data length: 1.27, total dup: 27, max dup: 14\n"
+        "\tFill distribution:\n"
+        "\t     0 - 19% = 1\n"
+        "\t    20 - 39% = 0\n"
+        "\t    40 - 59% = 0\n"
+        "\t    60 - 79% = 0\n"
+        "\t    80 - 99% = 0\n";
+
+    void CheckParseStatistics()
+    {
+        std::vector<IBPP::TableStatistics> tables;
+        IBPP::ParseStatistics(statistics30, tables);
+        ExpectValue("3.0 tables", tables.size(), (size_t)2);
+        if (tables.size() == 2)
+        {
+            const IBPP::TableStatistics& t = tables[0];
+            Expect("3.0 name", t.name, "COUNTRY");
+            ExpectValue("3.0 id", t.id, 128);
+            ExpectValue("3.0 records", t.records, (int64_t)14);
+            ExpectValue("3.0 record length", t.avgrecordlength, 25.5);
+            ExpectValue("3.0 versions", t.versions, (int64_t)3);
+            ExpectValue("3.0 max versions", t.maxversions, (int64_t)2);
+            ExpectValue("3.0 fragments", t.fragments, (int64_t)1);
+            ExpectValue("3.0 data pages", t.datapages, (int64_t)2);
+            ExpectValue("3.0 fill", t.avgfill, 48);
+            ExpectValue("3.0 fill 0-19", t.fill[0], (int64_t)1);
+            ExpectValue("3.0 fill 80-99", t.fill[4], (int64_t)1);
+            ExpectValue("3.0 indices", t.indices.size(), (size_t)1);
+            if (t.indices.size() == 1)
+            {
+                const IBPP::IndexStatistics& i = t.indices[0];
+                Expect("3.0 index name", i.name, "RDB$PRIMARY1");
+                ExpectValue("3.0 depth", i.depth, 2);
+                ExpectValue("3.0 leaf buckets", i.leafbuckets, (int64_t)3);
+                ExpectValue("3.0 nodes", i.nodes, (int64_t)14);
+                ExpectValue("3.0 key length", i.avgkeylength, 8.25);
+                ExpectValue("3.0 total dup", i.totaldup, (int64_t)4);
+                ExpectValue("3.0 max dup", i.maxdup, (int64_t)2);
+                ExpectValue("3.0 index fill 20-39", i.fill[1], (int64_t)2);
+                ExpectValue("3.0 index fill 40-59", i.fill[2], (int64_t)1);
+            }
+            Expect("3.0 CRLF name", tables[1].name, "JOB");
+            ExpectValue("3.0 CRLF id", tables[1].id, 129);
+            ExpectValue("3.0 CRLF indices", tables[1].indices.size(),
+                (size_t)0);
+        }
+
+        tables.clear();
+        IBPP::ParseStatistics(statistics25, tables);
+        ExpectValue("2.5 tables", tables.size(), (size_t)1);
+        if (tables.size() == 1)
+        {
+            const IBPP::TableStatistics& t = tables[0];
+            Expect("2.5 name", t.name, "SALES");
+            ExpectValue("2.5 records", t.records, (int64_t)33);
+            ExpectValue("2.5 data pages", t.datapages, (int64_t)3);
+            ExpectValue("2.5 fill", t.avgfill, 71);
+            ExpectValue("2.5 fill 80-99", t.fill[4], (int64_t)2);
+            ExpectValue("2.5 indices", t.indices.size(), (size_t)1);
+            if (t.indices.size() == 1)
+            {
+                const IBPP::IndexStatistics& i = t.indices[0];
+                Expect("2.5 index name", i.name, "SALESTATX");
+                ExpectValue("2.5 depth", i.depth, 1);
+                ExpectValue("2.5 nodes", i.nodes, (int64_t)33);
+                ExpectValue("2.5 key length", i.avgkeylength, 1.27);
+                ExpectValue("2.5 total dup", i.totaldup, (int64_t)27);
+                ExpectValue("2.5 index fill 0-19", i.fill[0], (int64_t)1);
+            }
+        }
+
+        // Nothing before the analysis is taken for a table
+        tables.clear();
+        IBPP::ParseStatistics("EMPLOYEE (131)\n", tables);
+        ExpectValue("no analysis", tables.size(), (size_t)0);
+    }
+}
+
+int main()
+{
+    CheckNormalizedSql();
+    CheckParseStatistics();
+
+    if (failures == 0)
+        std::cout << "All parsing checks passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+//  Benchmark of the registries of the objects attached to IBPP Databases
+//  and Transactions
+//
+//  A result with a BLOB column keeps a Blob per row, each one registered
+//  with its Database and Transaction, and all of them are released together
+//  with the result. This creates and releases 1M Blob handles that way,
+//  in creation order and in reverse order, then does the same with a copy
+//  of the linear std::vector registry used before, on fewer handles since
+//  it is quadratic. The handles are never opened on a server, so neither a
+//  database nor a server is needed: only the registry work is measured.
+//
+//  Not part of the FlameRobin build, the Makefile next to it compiles it
+//  together with the IBPP sources:
+//
+//      make registry
+//      ./registry [handles]
+
+/*
+  (C) Copyright 2000-2006 T.I.P. Group S.A. and the IBPP Team (www.ibpp.org)
+
+  The contents of this file are subject to the IBPP License (the "License");
+  you may not use this file except in compliance with the License.  You may
+  obtain a copy of the License at http://www.ibpp.org or in the 'license.txt'
+  file which must have been distributed along with this file.
+
+  This software, distributed under the License, is distributed on an "AS IS"
+  basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.  See the
+  License for the specific language governing rights and limitations
+  under the License.
+*/
+
+#include "ibpp.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double Seconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void Report(const char* what, size_t count, double seconds)
+    {
+        std::cout << std::left << std::setw(40) << what << std::right
+            << std::setw(9) << count << " handles "
+            << std::fixed << std::setprecision(3) << std::setw(9) << seconds
+            << " s " << std::setprecision(0) << std::setw(6)
+            << seconds * 1e9 / count << " ns/handle" << std::endl;
+    }
+
+    void BlobHandles(IBPP::Database db, IBPP::Transaction tr, size_t count,
+        bool reverse)
+    {
+        std::vector<IBPP::Blob> blobs;
+        blobs.reserve(count);
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < count; i++)
+            blobs.push_back(IBPP::BlobFactory(db, tr));
+        Report("create", count, Seconds(start));
+
+        start = Clock::now();
+        if (reverse)
+        {
+            while (!blobs.empty())
+                blobs.pop_back();
+        }
+        else
+        {
+            for (size_t i = 0; i < count; i++)
+                blobs[i].clear();
+        }
+        Report(reverse ? "release, reverse order" : "release, creation order",
+            count, Seconds(start));
+    }
+
+    // The registry as it was: a vector searched and erased from
+    void LinearRegistry(size_t count)
+    {
+        std::vector<int> objects(count);
+        std::vector<int*> database, transaction;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < count; i++)
+        {
+            database.push_back(&objects[i]);
+            transaction.push_back(&objects[i]);
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            int* object = &objects[i];
+            transaction.erase(std::find(transaction.begin(),
+                transaction.end(), object));
+            database.erase(std::find(database.begin(), database.end(),
+                object));
+        }
+        Report("linear vector, creation order", count, Seconds(start));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t count = 1000000;
+    if (argc > 1)
+        count = strtoul(argv[1], 0, 10);
+
+    // Neither is connected, the Blobs only register with them
+    IBPP::Database db = IBPP::DatabaseFactory("", "unused.fdb", "", "");
+    IBPP::Transaction tr = IBPP::TransactionFactory(db);
+
+    BlobHandles(db, tr, count, false);
+    BlobHandles(db, tr, count, true);
+    LinearRegistry(count / 20);
+    LinearRegistry(count / 10);
+    return 0;
+}
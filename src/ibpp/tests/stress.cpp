@@ -0,0 +1,245 @@
+//  Stress test for the per-attachment locking of IBPP
+//
+//  Several threads hammer two attachments to the same database at once:
+//  some use Transactions spanning both of them (attached in opposite orders),
+//  others a single attachment, with cached and uncached Statements, Blobs and
+//  Commits. With locks taken out of order this deadlocks within seconds, so a
+//  watchdog fails the test if the threads don't finish in time.
+//
+//  Not part of the FlameRobin build, the Makefile next to it compiles it
+//  together with the IBPP sources:
+//
+//      make stress
+//      ./stress localhost:/tmp/stress.fdb SYSDBA masterkey
+//
+//  The database must exist and be writable, the test creates and drops a
+//  table of its own.
+
+/*
+  (C) Copyright 2000-2006 T.I.P. Group S.A. and the IBPP Team (www.ibpp.org)
+
+  The contents of this file are subject to the IBPP License (the "License");
+  you may not use this file except in compliance with the License.  You may
+  obtain a copy of the License at http://www.ibpp.org or in the 'license.txt'
+  file which must have been distributed along with this file.
+
+  This software, distributed under the License, is distributed on an "AS IS"
+  basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.  See the
+  License for the specific language governing rights and limitations
+  under the License.
+*/
+
+#include "ibpp.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const int threadsPerKind = 4;
+    const int iterations = 200;
+    const int timeoutSeconds = 300;
+
+    std::atomic<int> failures(0);
+    std::mutex reportMutex;
+
+    void Report(const std::string& what, const std::string& message)
+    {
+        std::lock_guard<std::mutex> guard(reportMutex);
+        std::cerr << what << ": " << message << std::endl;
+        failures++;
+    }
+
+    void InsertAndRead(IBPP::Database db, IBPP::Transaction tr, int id)
+    {
+        IBPP::Statement ins = IBPP::StatementFactory(db, tr,
+            "insert into ibpp_stress (id, note) values (?, ?)");
+        IBPP::Blob blob = IBPP::BlobFactory(db, tr);
+        blob->Save(std::string(1000, 'x'));
+        ins->Set(1, id);
+        ins->Set(2, blob);
+        ins->Execute();
+
+        IBPP::Statement sel = db->CachedStatement(tr,
+            "select id, note from ibpp_stress where id = ?");
+        sel->Set(1, id);
+        sel->Execute();
+        while (sel->Fetch())
+        {
+            IBPP::Blob note = IBPP::BlobFactory(db, tr);
+            sel->Get(2, note);
+            std::string data;
+            note->Load(data);
+            if (data.size() != 1000)
+                Report("InsertAndRead", "blob read back with a wrong size");
+        }
+    }
+
+    // Transactions on both attachments, first and second give the order
+    // in which they are attached
+    void TwoAttachments(IBPP::Database first, IBPP::Database second, int base)
+    {
+        for (int i = 0; i < iterations; i++)
+        {
+            try
+            {
+                IBPP::Transaction tr = IBPP::TransactionFactory(first);
+                tr->AttachDatabase(second);
+                tr->Start();
+                InsertAndRead(first, tr, base + 2 * i);
+                InsertAndRead(second, tr, base + 2 * i + 1);
+                if (i % 2) tr->Commit();
+                else tr->Rollback();
+            }
+            catch (IBPP::Exception& e)
+            {
+                Report("TwoAttachments", e.what());
+            }
+        }
+    }
+
+    void OneAttachment(IBPP::Database db, int base)
+    {
+        for (int i = 0; i < iterations; i++)
+        {
+            try
+            {
+                IBPP::Transaction tr = IBPP::TransactionFactory(db);
+                tr->Start();
+                InsertAndRead(db, tr, base + i);
+                IBPP::Statement st = IBPP::StatementFactory(db, tr,
+                    "select count(*) from rdb$relations");
+                st->Execute();
+                IBPP::RowBatch batch;
+                st->FetchBatch(batch, 16);
+                tr->Commit();
+                int pages;
+                db->Info(0, 0, 0, &pages, 0, 0, 0, 0, 0);
+            }
+            catch (IBPP::Exception& e)
+            {
+                Report("OneAttachment", e.what());
+            }
+        }
+    }
+
+    void Execute(IBPP::Database db, const std::string& sql)
+    {
+        IBPP::Transaction tr = IBPP::TransactionFactory(db);
+        tr->Start();
+        IBPP::Statement st = IBPP::StatementFactory(db, tr);
+        st->ExecuteImmediate(sql);
+        tr->Commit();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4)
+    {
+        std::cerr << "usage: stress server:database user password" << std::endl;
+        return 1;
+    }
+    if (! IBPP::CheckVersion(IBPP::Version))
+    {
+        std::cerr << "IBPP version mismatch" << std::endl;
+        return 1;
+    }
+
+    std::string name(argv[1]);
+    std::string server, database(name);
+    std::string::size_type colon = name.find(':');
+    if (colon != std::string::npos && colon > 1)    // Not a drive letter
+    {
+        server = name.substr(0, colon);
+        database = name.substr(colon + 1);
+    }
+
+    IBPP::Database a = IBPP::DatabaseFactory(server, database, argv[2], argv[3]);
+    IBPP::Database b = IBPP::DatabaseFactory(server, database, argv[2], argv[3]);
+    try
+    {
+        a->Connect();
+        b->Connect();
+        try { Execute(a, "drop table ibpp_stress"); }
+            catch (IBPP::Exception&) { }
+        Execute(a, "create table ibpp_stress (id integer, note blob)");
+        a->ClearStatementCache();
+    }
+    catch (IBPP::Exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::mutex doneMutex;
+    std::condition_variable doneSignal;
+    int running = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadsPerKind; t++)
+    {
+        int base = t * 10 * iterations;
+        std::vector<std::function<void ()> > jobs;
+        jobs.push_back([a, b, base]() { TwoAttachments(a, b, base); });
+        jobs.push_back([a, b, base]() { TwoAttachments(b, a, base + 2 * iterations); });
+        jobs.push_back([a, base]() { OneAttachment(a, base + 4 * iterations); });
+        jobs.push_back([b, base]() { OneAttachment(b, base + 5 * iterations); });
+        for (size_t j = 0; j < jobs.size(); j++)
+        {
+            std::function<void ()> job = jobs[j];
+            {
+                std::lock_guard<std::mutex> guard(doneMutex);
+                running++;
+            }
+            threads.push_back(std::thread([job, &doneMutex, &doneSignal, &running]()
+            {
+                job();
+                std::lock_guard<std::mutex> guard(doneMutex);
+                running--;
+                doneSignal.notify_all();
+            }));
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> guard(doneMutex);
+        if (! doneSignal.wait_for(guard, std::chrono::seconds(timeoutSeconds),
+            [&running]() { return running == 0; }))
+        {
+            std::cerr << "Threads still running after " << timeoutSeconds
+                << " seconds, the attachment locks deadlocked" << std::endl;
+            std::_Exit(2);
+        }
+    }
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    try
+    {
+        a->ClearStatementCache();
+        b->ClearStatementCache();
+        Execute(a, "drop table ibpp_stress");
+        a->Disconnect();
+        b->Disconnect();
+    }
+    catch (IBPP::Exception& e)
+    {
+        Report("Cleanup", e.what());
+    }
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " failures" << std::endl;
+        return 1;
+    }
+    std::cout << "OK" << std::endl;
+    return 0;
+}
@@ -93,25 +93,42 @@ int IBPP::Time::SubSeconds() const	// Actually tenthousandths of seconds
 	return tenthousandths;
 }
 
+void IBPP::Time::SetTimezone(int tz, int offset)
+{
+	if (tz != IBPP::TZ_NONE && (tz < 0 || tz > 0xFFFF))
+		throw LogicExceptionImpl("Time::SetTimezone", _("Invalid time zone"));
+	if (offset < -1439 || offset > 1439)
+		throw LogicExceptionImpl("Time::SetTimezone", _("Invalid time zone offset"));
+	mTimezone = tz;
+	mTzOffset = tz == IBPP::TZ_NONE ? 0 : offset;
+}
+
 IBPP::Time::Time(int hour, int minute, int second, int tenthousandths)
 {
+	Clear();
 	SetTime(hour, minute, second, tenthousandths);
 }
 
 IBPP::Time::Time(const IBPP::Time& copied)
 {
 	mTime = copied.mTime;
+	mTimezone = copied.mTimezone;
+	mTzOffset = copied.mTzOffset;
 }
 
 IBPP::Time& IBPP::Time::operator=(const IBPP::Timestamp& assigned)
 {
 	mTime = assigned.GetTime();
+	mTimezone = assigned.GetTimezone();
+	mTzOffset = assigned.GetTzOffset();
 	return *this;
 }
 
 IBPP::Time& IBPP::Time::operator=(const IBPP::Time& assigned)
 {
 	mTime = assigned.mTime;
+	mTimezone = assigned.mTimezone;
+	mTzOffset = assigned.mTzOffset;
 	return *this;
 }
 
@@ -175,6 +192,7 @@ void encodeTime(ISC_TIME& isc_tm, const IBPP::Time& tm)
 void decodeTime(IBPP::Time& tm, const ISC_TIME& isc_tm)
 {
 	tm.SetTime((int)isc_tm);
+	tm.SetTimezone(IBPP::TZ_NONE, 0);
 }
 
 void encodeTimestamp(ISC_TIMESTAMP& isc_ts, const IBPP::Timestamp& ts)
@@ -189,5 +207,65 @@ void decodeTimestamp(IBPP::Timestamp& ts, const ISC_TIMESTAMP& isc_ts)
 	decodeTime(ts, isc_ts.timestamp_time);
 }
 
+//	Firebird v4 stores the times with a time zone in UTC, IBPP keeps the local
+//	time of their zone. The extended formats come with the offset of the zone,
+//	so that region zones need no lookup on the client. Times without a zone are
+//	sent as +00:00, the Firebird id of an offset zone being 1439 + the offset.
+
+namespace
+{
+	const int64_t TicksPerDay = 864000000;	// In ten-thousandths of seconds
+	const int TicksPerMinute = 600000;
+	const int OffsetZoneBase = 1439;
+
+	void shiftTimestamp(ISC_TIMESTAMP& dst, const ISC_TIMESTAMP& src, int minutes)
+	{
+		int64_t ticks = (int64_t)src.timestamp_date * TicksPerDay
+			+ src.timestamp_time + (int64_t)minutes * TicksPerMinute;
+		int64_t days = ticks / TicksPerDay;
+		if (ticks % TicksPerDay < 0) --days;	// Round towards minus infinity
+		dst.timestamp_date = (ISC_DATE)days;
+		dst.timestamp_time = (ISC_TIME)(ticks - days * TicksPerDay);
+	}
+
+	int shiftTime(int time, int minutes)
+	{
+		int64_t ticks = (time + (int64_t)minutes * TicksPerMinute) % TicksPerDay;
+		return (int)(ticks < 0 ? ticks + TicksPerDay : ticks);
+	}
+}
+
+void encodeTimeTz(ISC_TIME_TZ_EX& isc_tm, const IBPP::Time& tm)
+{
+	bool zoned = tm.GetTimezone() != IBPP::TZ_NONE;
+	isc_tm.utc_time = (ISC_TIME)shiftTime(tm.GetTime(), -tm.GetTzOffset());
+	isc_tm.time_zone = (ISC_USHORT)(zoned ? tm.GetTimezone() : OffsetZoneBase);
+	isc_tm.ext_offset = (ISC_SHORT)tm.GetTzOffset();
+}
+
+void decodeTimeTz(IBPP::Time& tm, const ISC_TIME_TZ_EX& isc_tm)
+{
+	tm.SetTime(shiftTime((int)isc_tm.utc_time, isc_tm.ext_offset));
+	tm.SetTimezone(isc_tm.time_zone, isc_tm.ext_offset);
+}
+
+void encodeTimestampTz(ISC_TIMESTAMP_TZ_EX& isc_ts, const IBPP::Timestamp& ts)
+{
+	bool zoned = ts.GetTimezone() != IBPP::TZ_NONE;
+	ISC_TIMESTAMP local;
+	encodeTimestamp(local, ts);
+	shiftTimestamp(isc_ts.utc_timestamp, local, -ts.GetTzOffset());
+	isc_ts.time_zone = (ISC_USHORT)(zoned ? ts.GetTimezone() : OffsetZoneBase);
+	isc_ts.ext_offset = (ISC_SHORT)ts.GetTzOffset();
+}
+
+void decodeTimestampTz(IBPP::Timestamp& ts, const ISC_TIMESTAMP_TZ_EX& isc_ts)
+{
+	ISC_TIMESTAMP local;
+	shiftTimestamp(local, isc_ts.utc_timestamp, isc_ts.ext_offset);
+	decodeTimestamp(ts, local);
+	ts.SetTimezone(isc_ts.time_zone, isc_ts.ext_offset);
+}
+
 }
 
@@ -55,6 +55,7 @@ void TransactionImpl::DetachDatabase(IBPP::Database db)
 void TransactionImpl::AddReservation(IBPP::Database db,
     const std::string& table, IBPP::TTR tr)
 {
+    AttachmentLock lock(this);
     if (mHandle != 0)
         throw LogicExceptionImpl("Transaction::AddReservation",
                 _("Can't add table reservation if Transaction started."));
@@ -104,6 +105,7 @@ void TransactionImpl::AddReservation(IBPP::Database db,
 
 void TransactionImpl::Start()
 {
+    AttachmentLock lock(this);
     if (mHandle != 0) return;   // Already started anyway
 
     if (mDatabases.empty())
@@ -143,6 +145,7 @@ void TransactionImpl::Start()
 
 void TransactionImpl::Commit()
 {
+    AttachmentLock lock(this);
     if (mHandle == 0)
         throw LogicExceptionImpl("Transaction::Commit", _("Transaction is not started."));
 
@@ -162,6 +165,7 @@ void TransactionImpl::Commit()
 
 void TransactionImpl::CommitRetain()
 {
+    AttachmentLock lock(this);
     if (mHandle == 0)
         throw LogicExceptionImpl("Transaction::CommitRetain", _("Transaction is not started."));
 
@@ -174,6 +178,7 @@ void TransactionImpl::CommitRetain()
 
 void TransactionImpl::Rollback()
 {
+    AttachmentLock lock(this);
     if (mHandle == 0) return;   // Transaction not started anyway
 
     IBS status;
@@ -192,6 +197,7 @@ void TransactionImpl::Rollback()
 
 void TransactionImpl::RollbackRetain()
 {
+    AttachmentLock lock(this);
     if (mHandle == 0)
         throw LogicExceptionImpl("Transaction::RollbackRetain", _("Transaction is not started."));
 
@@ -213,8 +219,7 @@ void TransactionImpl::Release()
 {
     // Release cannot throw, except in DEBUG builds on assertion
     ASSERTION(mRefCount >= 0);
-    --mRefCount;
-    try { if (mRefCount <= 0) delete this; }
+    try { if (--mRefCount <= 0) delete this; }
         catch (...) { }
 }
 
@@ -222,71 +227,86 @@ void TransactionImpl::Release()
 
 void TransactionImpl::Init()
 {
+    static std::atomic<uint64_t> lastId(0);
+    mId = ++lastId;
     mHandle = 0;
     mDatabases.clear();
     mTPBs.clear();
-    mStatements.clear();
-    mBlobs.clear();
-    mArrays.clear();
+    mStatements.Clear();
+    mBlobs.Clear();
+    mArrays.Clear();
+}
+
+void TransactionImpl::CollectDatabases(std::vector<DatabaseImpl*>& databases)
+{
+    std::lock_guard<std::mutex> guard(mDatabasesMutex);
+    databases.insert(databases.end(), mDatabases.begin(), mDatabases.end());
 }
 
 void TransactionImpl::AttachStatementImpl(StatementImpl* st)
 {
+    AttachmentLock lock(this);
     if (st == 0)
         throw LogicExceptionImpl("Transaction::AttachStatement",
                     _("Can't attach a 0 Statement object."));
 
-    mStatements.push_back(st);
+    mStatements.Add(st);
 }
 
 void TransactionImpl::DetachStatementImpl(StatementImpl* st)
 {
+    AttachmentLock lock(this);
     if (st == 0)
         throw LogicExceptionImpl("Transaction::DetachStatement",
                 _("Can't detach a 0 Statement object."));
 
-    mStatements.erase(std::find(mStatements.begin(), mStatements.end(), st));
+    mStatements.Remove(st);
 }
 
 void TransactionImpl::AttachBlobImpl(BlobImpl* bb)
 {
+    AttachmentLock lock(this);
     if (bb == 0)
         throw LogicExceptionImpl("Transaction::AttachBlob",
                     _("Can't attach a 0 BlobImpl object."));
 
-    mBlobs.push_back(bb);
+    mBlobs.Add(bb);
 }
 
 void TransactionImpl::DetachBlobImpl(BlobImpl* bb)
 {
+    AttachmentLock lock(this);
     if (bb == 0)
         throw LogicExceptionImpl("Transaction::DetachBlob",
                 _("Can't detach a 0 BlobImpl object."));
 
-    mBlobs.erase(std::find(mBlobs.begin(), mBlobs.end(), bb));
+    mBlobs.Remove(bb);
 }
 
 void TransactionImpl::AttachArrayImpl(ArrayImpl* ar)
 {
+    AttachmentLock lock(this);
     if (ar == 0)
         throw LogicExceptionImpl("Transaction::AttachArray",
                     _("Can't attach a 0 ArrayImpl object."));
 
-    mArrays.push_back(ar);
+    mArrays.Add(ar);
 }
 
 void TransactionImpl::DetachArrayImpl(ArrayImpl* ar)
 {
+    AttachmentLock lock(this);
     if (ar == 0)
         throw LogicExceptionImpl("Transaction::DetachArray",
                 _("Can't detach a 0 ArrayImpl object."));
 
-    mArrays.erase(std::find(mArrays.begin(), mArrays.end(), ar));
+    mArrays.Remove(ar);
 }
 
 void TransactionImpl::AttachDatabaseImpl(DatabaseImpl* dbi,
     IBPP::TAM am, IBPP::TIL il, IBPP::TLR lr, IBPP::TFF flags)
 {
+    AttachmentLock lock(this, dbi);
     if (mHandle != 0)
         throw LogicExceptionImpl("Transaction::AttachDatabase",
                 _("Can't attach a Database if Transaction started."));
@@ -294,7 +314,10 @@ void TransactionImpl::AttachDatabaseImpl(DatabaseImpl* dbi,
         throw LogicExceptionImpl("Transaction::AttachDatabase",
                 _("Can't attach a null Database."));
 
-    mDatabases.push_back(dbi);
+    {
+        std::lock_guard<std::mutex> guard(mDatabasesMutex);
+        mDatabases.push_back(dbi);
+    }
 
     // Prepare a new TPB
     TPB* tpb = new TPB;
@@ -326,6 +349,7 @@ void TransactionImpl::AttachDatabaseImpl(DatabaseImpl* dbi,
 
 void TransactionImpl::DetachDatabaseImpl(DatabaseImpl* dbi)
 {
+    AttachmentLock lock(this, dbi);
     if (mHandle != 0)
         throw LogicExceptionImpl("Transaction::DetachDatabase",
                 _("Can't detach a Database if Transaction started."));
@@ -339,7 +363,10 @@ void TransactionImpl::DetachDatabaseImpl(DatabaseImpl* dbi)
     {
         size_t index = pos - mDatabases.begin();
         TPB* tpb = mTPBs[index];
-        mDatabases.erase(pos);
+        {
+            std::lock_guard<std::mutex> guard(mDatabasesMutex);
+            mDatabases.erase(pos);
+        }
         mTPBs.erase(mTPBs.begin()+index);
         delete tpb;
     }
@@ -30,6 +30,8 @@
     #include "wx/wx.h"
 #endif
 
+#include <algorithm>
+
 #include "core/ProcessableObject.h"
 #include "core/StringUtils.h"
 #include "core/TemplateProcessor.h"
@@ -51,6 +53,70 @@
 #include "metadata/view.h"
 
 
+// The database statistics aren't metadata items, these make them available
+// to {%dbstats%} and the {%foreach%} loops in it.
+class TableStatisticsItem: public ProcessableObject
+{
+public:
+    wxString name;
+    IBPP::TableStatistics stats;
+};
+
+class IndexStatisticsItem: public ProcessableObject
+{
+public:
+    wxString name;
+    wxString tableName;
+    IBPP::IndexStatistics stats;
+};
+
+class DatabaseStatisticsItem: public ProcessableObject
+{
+private:
+    static bool moreGarbage(const TableStatisticsItem& t1,
+        const TableStatisticsItem& t2)
+    {
+        if (t1.stats.versions != t2.stats.versions)
+            return t1.stats.versions > t2.stats.versions;
+        return t1.stats.fragments > t2.stats.fragments;
+    }
+    static bool deeper(const IndexStatisticsItem& i1,
+        const IndexStatisticsItem& i2)
+    {
+        if (i1.stats.depth != i2.stats.depth)
+            return i1.stats.depth > i2.stats.depth;
+        return i1.stats.nodes > i2.stats.nodes;
+    }
+public:
+    // the tables with the most garbage and the deepest indices come first
+    std::vector<TableStatisticsItem> tables;
+    std::vector<IndexStatisticsItem> indices;
+
+    DatabaseStatisticsItem(const std::vector<IBPP::TableStatistics>& stats,
+        wxMBConv* conv)
+    {
+        for (std::vector<IBPP::TableStatistics>::const_iterator it =
+            stats.begin(); it != stats.end(); ++it)
+        {
+            TableStatisticsItem table;
+            table.name = std2wxIdentifier((*it).name, conv);
+            table.stats = *it;
+            tables.push_back(table);
+            for (std::vector<IBPP::IndexStatistics>::const_iterator iit =
+                (*it).indices.begin(); iit != (*it).indices.end(); ++iit)
+            {
+                IndexStatisticsItem index;
+                index.name = std2wxIdentifier((*iit).name, conv);
+                index.tableName = table.name;
+                index.stats = *iit;
+                indices.push_back(index);
+            }
+        }
+        std::stable_sort(tables.begin(), tables.end(), moreGarbage);
+        std::stable_sort(indices.begin(), indices.end(), deeper);
+    }
+};
+
 class MetadataTemplateCmdHandler: public TemplateCmdHandler
 {
 private:
@@ -379,6 +445,40 @@ void MetadataTemplateCmdHandler::handleTemplateCmd(TemplateProcessor *tp,
                     cmdParams.from(2), (*it).get());
             }
         }
+
+        // {%foreach:tablestats:<separator>:<text>%}
+        // {%foreach:indexstats:<separator>:<text>%}
+        // Inside of {%dbstats%}, processes the specified text once for the
+        // statistics of each table (most garbage first) or of each index
+        // (deepest first).
+        else if (cmdParams[0] == "tablestats")
+        {
+            DatabaseStatisticsItem* s =
+                dynamic_cast<DatabaseStatisticsItem*>(object);
+            if (!s)
+                return;
+            bool firstItem = true;
+            for (std::vector<TableStatisticsItem>::iterator it =
+                s->tables.begin(); it != s->tables.end(); ++it)
+            {
+                Local::foreachIteration(firstItem, tp, processedText, sep,
+                    cmdParams.from(2), &(*it));
+            }
+        }
+        else if (cmdParams[0] == "indexstats")
+        {
+            DatabaseStatisticsItem* s =
+                dynamic_cast<DatabaseStatisticsItem*>(object);
+            if (!s)
+                return;
+            bool firstItem = true;
+            for (std::vector<IndexStatisticsItem>::iterator it =
+                s->indices.begin(); it != s->indices.end(); ++it)
+            {
+                Local::foreachIteration(firstItem, tp, processedText, sep,
+                    cmdParams.from(2), &(*it));
+            }
+        }
         // add more collections here.
         else
             return;
@@ -764,6 +864,94 @@ void MetadataTemplateCmdHandler::handleTemplateCmd(TemplateProcessor *tp,
             db->getConnectedUsers(users);
             processedText += wxArrayToString(users, ",");
         }
+        else if (cmdParams[0] == "statistics_time")
+        {
+            wxDateTime time = db->getStatisticsTime();
+            if (time.IsValid())
+                processedText += time.FormatISOCombined(' ');
+        }
+    }
+
+    // {%dbstats:<text>%}
+    // If the current object is a database, processes the specified text with
+    // the last collected statistics of its data and index pages as the
+    // current object. Expands to nothing if none have been collected, see
+    // {%dbinfo:statistics_time%}.
+    else if (cmdName == "dbstats" && !cmdParams.IsEmpty())
+    {
+        Database* db = dynamic_cast<Database*>(object);
+        if (!db || !db->getStatisticsTime().IsValid())
+            return;
+
+        DatabaseStatisticsItem stats(db->getStatistics(),
+            db->getCharsetConverter());
+        tp->internalProcessTemplateText(processedText, cmdParams.all(),
+            &stats);
+    }
+
+    // {%tablestatsinfo:<property>%}
+    // If the current object is the statistics of a table, expands to the
+    // requested property.
+    else if (cmdName == "tablestatsinfo" && !cmdParams.IsEmpty())
+    {
+        TableStatisticsItem* t = dynamic_cast<TableStatisticsItem*>(object);
+        if (!t)
+            return;
+
+        const IBPP::TableStatistics& s = t->stats;
+        if (cmdParams[0] == "name")
+            processedText += tp->escapeChars(t->name);
+        else if (cmdParams[0] == "records")
+            processedText << s.records;
+        else if (cmdParams[0] == "average_length")
+            processedText += wxString::Format("%0.2f", s.avgrecordlength);
+        else if (cmdParams[0] == "versions")
+            processedText << s.versions;
+        else if (cmdParams[0] == "max_versions")
+            processedText << s.maxversions;
+        else if (cmdParams[0] == "fragments")
+            processedText << s.fragments;
+        else if (cmdParams[0] == "data_pages")
+            processedText << s.datapages;
+        else if (cmdParams[0] == "average_fill")
+            processedText << s.avgfill;
+        else if (cmdParams[0] == "fill_distribution")
+        {
+            for (int i = 0; i < 5; ++i)
+            {
+                if (i)
+                    processedText += " / ";
+                processedText << s.fill[i];
+            }
+        }
+    }
+
+    // {%indexstatsinfo:<property>%}
+    // If the current object is the statistics of an index, expands to the
+    // requested property.
+    else if (cmdName == "indexstatsinfo" && !cmdParams.IsEmpty())
+    {
+        IndexStatisticsItem* i = dynamic_cast<IndexStatisticsItem*>(object);
+        if (!i)
+            return;
+
+        const IBPP::IndexStatistics& s = i->stats;
+        if (cmdParams[0] == "name")
+            processedText += tp->escapeChars(i->name);
+        else if (cmdParams[0] == "table")
+            processedText += tp->escapeChars(i->tableName);
+        else if (cmdParams[0] == "depth")
+            processedText << s.depth;
+        else if (cmdParams[0] == "nodes")
+            processedText << s.nodes;
+        else if (cmdParams[0] == "leaf_buckets")
+            processedText << s.leafbuckets;
+        else if (cmdParams[0] == "average_key_length")
+            processedText += wxString::Format("%0.2f", s.avgkeylength);
+        else if (cmdParams[0] == "total_dup")
+            processedText << s.totaldup;
+        else if (cmdParams[0] == "max_dup")
+            processedText << s.maxdup;
     }
 
     // {%privilegeinfo:<property>%}
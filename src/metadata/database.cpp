@@ -34,6 +34,7 @@
 #include <wx/fontmap.h>
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 
 #include <boost/thread.hpp>
@@ -44,6 +45,7 @@
 #include "core/FRError.h"
 #include "core/ProgressIndicator.h"
 #include "core/StringUtils.h"
+#include "engine/AttachmentPool.h"
 #include "engine/MetadataLoader.h"
 #include "MasterPassword.h"
 #include "metadata/column.h"
@@ -377,9 +379,8 @@ wxString Database::loadDomainNameForColumn(const wxString& table,
     st1->Set(1, wx2std(table, converter));
     st1->Set(2, wx2std(field, converter));
     st1->Execute();
-    st1->Fetch();
     std::string domain;
-    st1->Get(1, domain);
+    st1->FetchAs(domain);
     return std2wxIdentifier(domain, converter);
 }
 
@@ -395,10 +396,9 @@ void Database::getDatabaseTriggers(std::vector<Trigger *>& list)
         "order by rdb$trigger_sequence"
     );
     st1->Execute();
-    while (st1->Fetch())
+    std::string name;
+    while (st1->FetchAs(name))
     {
-        std::string name;
-        st1->Get(1, name);
         Trigger* t = dynamic_cast<Trigger*>(findByNameAndType(ntTrigger,
             std2wxIdentifier(name, converter)));
         if (t)
@@ -469,20 +469,29 @@ void Database::loadCollations()
         "   on c.rdb$character_set_id = k.rdb$character_set_id "
         " order by c.rdb$character_set_name, k.rdb$collation_id");
     st1->Execute();
-    while (st1->Fetch())
+    // there are hundreds of collations, read them in blocks
+    IBPP::RowBatch batch;
+    bool more;
+    do
     {
-        std::string s;
-        st1->Get(1, s);
-        wxString charset(std2wxIdentifier(s, converter));
-        st1->Get(2, s);
-        wxString collation(std2wxIdentifier(s, converter));
-        int charsetId, bytesPerChar;
-        st1->Get(3, &charsetId);
-        st1->Get(4, &bytesPerChar);
-        CharacterSet cs(charset, charsetId, bytesPerChar);
-        collationsM.insert(std::multimap<CharacterSet, wxString>::value_type(
-            cs, collation));
+        more = st1->FetchBatch(batch, 256);
+        for (int row = 0; row < batch.Rows(); ++row)
+        {
+            std::string s;
+            batch.Get(row, 1, s);
+            wxString charset(std2wxIdentifier(s, converter));
+            batch.Get(row, 2, s);
+            wxString collation(std2wxIdentifier(s, converter));
+            int charsetId, bytesPerChar;
+            batch.Get(row, 3, charsetId);
+            batch.Get(row, 4, bytesPerChar);
+            CharacterSet cs(charset, charsetId, bytesPerChar);
+            collationsM.insert(
+                std::multimap<CharacterSet, wxString>::value_type(
+                    cs, collation));
+        }
     }
+    while (more);
 }
 
 wxString Database::getTableForIndex(const wxString& indexName)
@@ -496,12 +505,9 @@ wxString Database::getTableForIndex(const wxString& indexName)
     st1->Execute();
 
     wxString tableName;
-    if (st1->Fetch())
-    {
-        std::string s;
-        st1->Get(1, s);
+    std::string s;
+    if (st1->FetchAs(s))
         tableName = std2wxIdentifier(s, getCharsetConverter());
-    }
     return tableName;
 }
 
@@ -718,6 +724,12 @@ void Database::parseCommitedSql(const SqlStatement& stm)
     if (!stm.isDDL())
         return;    // return false only on IBPP exception
 
+    // statements prepared before the change may be invalid now, on the
+    // pooled attachments too
+    databaseM->ClearStatementCache();
+    if (attachmentPoolM)
+        attachmentPoolM->clearStatementCaches();
+
     if (stm.actionIs(actGRANT))
     {
         MetadataItem *obj = stm.getObject();
@@ -911,6 +923,15 @@ void Database::create(int pagesize, int dialect)
 
 void Database::drop()
 {
+    // DROP DATABASE fails while any other attachment is connected, so the
+    // pooled ones are disconnected first; should it still fail the editors
+    // share the main attachment until the next connect
+    if (attachmentPoolM)
+    {
+        if (attachmentPoolM->getCheckedOutCount() > 0)
+            throw FRError(_("The database is still in use by other windows,\nclose them before dropping it."));
+        attachmentPoolM->close();
+    }
     databaseM->Drop();
     setDisconnected();
 }
@@ -994,6 +1015,55 @@ public:
     }
 };
 
+class BackgroundStatistics: public BackgroundTask
+{
+private:
+    IBPP::Service serviceM;
+    std::string pathM;
+    std::atomic<bool> canceledM;
+    std::vector<IBPP::TableStatistics> tablesM;
+
+    BackgroundStatistics(IBPP::Service service, const std::string& path)
+        : serviceM(service), pathM(path), canceledM(false)
+    {
+    }
+
+    virtual void doExecute()
+    {
+        serviceM->StartStatistics(pathM);
+        std::string report, output;
+        bool running = true;
+        while (running && !canceledM)
+        {
+            running = serviceM->WaitOutput(output);
+            report += output;
+        }
+        // detaching from the service manager also stops a canceled report
+        serviceM->Disconnect();
+        if (!canceledM)
+            IBPP::ParseStatistics(report, tablesM);
+    }
+public:
+    static std::shared_ptr<BackgroundStatistics> create(
+        IBPP::Service service, const std::string& path)
+    {
+        wxASSERT(service != 0);
+        return std::shared_ptr<BackgroundStatistics>(
+            new BackgroundStatistics(service, path));
+    }
+
+    void cancel()
+    {
+        canceledM = true;
+    }
+
+    // only valid once the task has finished
+    const std::vector<IBPP::TableStatistics>& getTables() const
+    {
+        return tablesM;
+    }
+};
+
 // the caller of this function should check whether the database object has the
 // password set, and if it does not, it should provide the password
 //               and if it does, just provide that password
@@ -1051,6 +1121,11 @@ void Database::connect(const wxString& password, ProgressIndicator* indicator)
         {
             connectedM = true;
 
+            DatabaseConfig dc(this, config());
+            attachmentPoolM.reset(new AttachmentPool(databaseM,
+                dc.get("AttachmentPoolSize", 2),
+                dc.get("AttachmentPoolIdleTimeout", 300)));
+
             createCharsetConverter();
 
             DatabasePtr me(shared_from_this());
@@ -1098,15 +1173,12 @@ void Database::connect(const wxString& password, ProgressIndicator* indicator)
                     "select rdb$character_set_name, current_user, current_role "
                     "from rdb$database");
                 st1->Execute();
-                if (st1->Fetch())
+                std::string charset, user, role;
+                if (st1->FetchAs(charset, user, role))
                 {
-                    std::string s;
-                    st1->Get(1, s);
-                    databaseCharsetM = std2wxIdentifier(s, getCharsetConverter());
-                    st1->Get(2, s);
-                    connectionUserM = std2wxIdentifier(s, getCharsetConverter());
-                    st1->Get(3, s);
-                    connectionRoleM = std2wxIdentifier(s, getCharsetConverter());
+                    databaseCharsetM = std2wxIdentifier(charset, getCharsetConverter());
+                    connectionUserM = std2wxIdentifier(user, getCharsetConverter());
+                    connectionRoleM = std2wxIdentifier(role, getCharsetConverter());
                     if (connectionRoleM == "NONE")
                         connectionRoleM.clear();
                 }
@@ -1221,15 +1293,12 @@ wxArrayString Database::loadIdentifiers(const wxString& loadStatement,
     st1->Execute();
 
     wxArrayString names;
-    while (st1->Fetch())
+    IBPP::Nullable<std::string> s;
+    while (st1->FetchAs(s))
     {
         checkProgressIndicatorCanceled(progressIndicator);
-        if (!st1->IsNull(1))
-        {
-            std::string s;
-            st1->Get(1, s);
-            names.push_back(std2wxIdentifier(s, converter));
-        }
+        if (!s.IsNull())
+            names.push_back(std2wxIdentifier(s.Value(), converter));
     }
     return names;
 }
@@ -1247,6 +1316,12 @@ void Database::setDisconnected()
 {
     delete metadataLoaderM;
     metadataLoaderM = 0;
+    // attachments still checked out are disconnected when they are returned
+    if (attachmentPoolM)
+    {
+        attachmentPoolM->close();
+        attachmentPoolM.reset();
+    }
     resetCredentials();     // "forget" temporary username/password
     connectedM = false;
     resetPendingLoadData();
@@ -1281,6 +1356,13 @@ MetadataLoader* Database::getMetadataLoader()
     return metadataLoaderM;
 }
 
+AttachmentPoolPtr Database::getAttachmentPool()
+{
+    if (attachmentPoolM)
+        attachmentPoolM->closeIdleAttachments();
+    return attachmentPoolM;
+}
+
 bool Database::getChildren(std::vector<MetadataItem*>& temp)
 {
     if (!connectedM)
@@ -1797,6 +1879,54 @@ void Database::getConnectedUsers(wxArrayString& users) const
     }
 }
 
+void Database::collectStatistics(ProgressIndicator* progressIndicator)
+{
+    checkConnected(_("collectStatistics"));
+
+    IBPP::Service svc;
+    ServerPtr server = getServer();
+    if (!server || !server->getService(svc, progressIndicator, false))
+        return;
+
+    std::shared_ptr<BackgroundStatistics> task(
+        BackgroundStatistics::create(svc, wx2std(getPath())));
+    svc.clear();
+    boost::thread t = startTask(task);
+    if (progressIndicator)
+    {
+        progressIndicator->initProgressIndeterminate(
+            _("Collecting database statistics..."));
+        while (!t.try_join_for(boost::chrono::milliseconds(50)))
+        {
+            progressIndicator->stepProgress();
+            if (progressIndicator->isCanceled())
+            {
+                // the task stops reading the report within a second
+                task->cancel();
+                t.detach();
+                return;
+            }
+        }
+    }
+    else
+        t.join();
+
+    task->checkForErrors();
+    statisticsM = task->getTables();
+    statisticsTimeM = wxDateTime::Now();
+    notifyObservers();
+}
+
+const std::vector<IBPP::TableStatistics>& Database::getStatistics() const
+{
+    return statisticsM;
+}
+
+wxDateTime Database::getStatisticsTime() const
+{
+    return statisticsTimeM;
+}
+
 void Database::checkConnected(const wxString& operation) const
 {
     if (!connectedM)
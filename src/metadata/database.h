@@ -24,12 +24,15 @@
 #ifndef FR_DATABASE_H
 #define FR_DATABASE_H
 
+#include <wx/datetime.h>
 #include <wx/strconv.h>
 
 #include <map>
+#include <vector>
 
 #include <ibpp.h>
 
+#include "engine/AttachmentPool.h"
 #include "metadata/MetadataClasses.h"
 #include "metadata/metadataitem.h"
 
@@ -148,6 +151,7 @@ private:
     ServerWeakPtr serverM;
     IBPP::Database databaseM;
     MetadataLoader* metadataLoaderM;
+    AttachmentPoolPtr attachmentPoolM;
 
     bool connectedM;
     wxString databaseCharsetM;
@@ -165,6 +169,9 @@ private:
 
     DatabaseInfo databaseInfoM;
 
+    std::vector<IBPP::TableStatistics> statisticsM;
+    wxDateTime statisticsTimeM;
+
     DomainsPtr userDomainsM;
     SysDomainsPtr sysDomainsM;
     ExceptionsPtr exceptionsM;
@@ -233,6 +240,9 @@ public:
     void drop();
 
     MetadataLoader* getMetadataLoader();
+    // secondary attachments for SQL editors and background tasks, only
+    // available while connected; use PooledAttachment to check them out
+    AttachmentPoolPtr getAttachmentPool();
 
     wxArrayString loadIdentifiers(const wxString& loadStatement,
         ProgressIndicator* progressIndicator = 0);
@@ -304,6 +314,13 @@ public:
     void loadInfo();
 
     void getConnectedUsers(wxArrayString& users) const;
+    // the statistics of the data and index pages, as gstat reports them.
+    // collectStatistics() runs them in a background thread (which the
+    // progress indicator can cancel) and keeps the result, the getters only
+    // return the last ones collected; the time is invalid if there are none.
+    void collectStatistics(ProgressIndicator* progressIndicator = 0);
+    const std::vector<IBPP::TableStatistics>& getStatistics() const;
+    wxDateTime getStatisticsTime() const;
 
     wxMBConv* getCharsetConverter() const;
 };
@@ -54,11 +54,11 @@ std::string Domain::getLoadStatement(bool list)
             " c.rdb$character_set_name,"    //  7
             " f.rdb$character_length,"      //  8
             " f.rdb$null_flag,"             //  9
-            " f.rdb$default_source,"        // 10
-            " l.rdb$collation_name,"        // 11
-            " f.rdb$validation_source,"     // 12
-            " f.rdb$computed_blr,"          // 13
-            " c.rdb$bytes_per_character"    // 14
+            " l.rdb$collation_name,"        // 10
+            " c.rdb$bytes_per_character,"   // 11
+            " f.rdb$computed_blr,"          // 12
+            " f.rdb$default_source,"        // 13
+            " f.rdb$validation_source"      // 14
         " from rdb$fields f"
         " left outer join rdb$character_sets c"
             " on c.rdb$character_set_id = f.rdb$character_set_id"
@@ -74,6 +74,16 @@ std::string Domain::getLoadStatement(bool list)
     return stmt;
 }
 
+/*static*/
+bool Domain::fetchLoadRow(IBPP::Statement& statement, LoadRow& row)
+{
+    // null subtype, precision, scale and bytes per char are read as 0,
+    // null charset and collation as empty, null null flag as nullable
+    return statement->FetchAs(row.name, row.datatype, row.subtype,
+        row.length, row.precision, row.scale, row.charset, row.charLength,
+        row.notNull, row.collation, row.bytesPerChar);
+}
+
 Domain::Domain(DatabasePtr database, const wxString& name)
     : MetadataItem((hasSystemPrefix(name) ? ntSysDomain : ntDomain),
         database.get(), name)
@@ -92,10 +102,11 @@ void Domain::loadProperties()
     IBPP::Statement& st1 = loader->getStatement(getLoadStatement(false));
     st1->Set(1, wx2std(getName_(), converter));
     st1->Execute();
-    if (!st1->Fetch())
+    LoadRow row;
+    if (!fetchLoadRow(st1, row))
         throw FRError(_("Domain not found: ") + getName_());
 
-    loadProperties(st1, converter);
+    loadProperties(row, st1, converter);
 }
 
 /*static*/
@@ -114,15 +125,13 @@ wxString Domain::trimDefaultValue(const wxString& value)
     return defValue;
 }
 
-void Domain::loadProperties(IBPP::Statement& statement, wxMBConv* converter)
+void Domain::loadProperties(const LoadRow& row, IBPP::Statement& statement,
+    wxMBConv* converter)
 {
     setPropertiesLoaded(false);
 
-    statement->Get(2, &datatypeM);
-    if (statement->IsNull(3))
-        subtypeM = 0;
-    else
-        statement->Get(3, &subtypeM);
+    datatypeM = row.datatype;
+    subtypeM = row.subtype;
 
     // determine the (var)char field length
     // - system tables use field_len and char_len is null
@@ -130,53 +139,26 @@ void Domain::loadProperties(IBPP::Statement& statement, wxMBConv* converter)
     // - view columns have field_len/bytes_per_char, char_len is null
     // - regular table columns and SP params have field_len/bytes_per_char
     //   they also have proper char_len, but we don't use it now
-    statement->Get(4, &lengthM);
-    int bpc = 0;   // bytes per char
-    if (!statement->IsNull(14))
-        statement->Get(14, &bpc);
-    if (bpc && (!statement->IsNull(8) || !statement->IsNull(13)))
+    lengthM = row.length;
+    int bpc = row.bytesPerChar;
+    if (bpc && (!row.charLength.IsNull() || !statement->IsNull(12)))
         lengthM /= bpc;
 
-    if (statement->IsNull(5))
-        precisionM = 0;
-    else
-        statement->Get(5, &precisionM);
-    if (statement->IsNull(6))
-        scaleM = 0;
-    else
-        statement->Get(6, &scaleM);
-    if (statement->IsNull(7))
-        charsetM = "";
-    else
-    {
-        std::string s;
-        statement->Get(7, s);
-        charsetM = std2wxIdentifier(s, converter);
-    }
-    bool notNull = false;
-    if (!statement->IsNull(9))
-    {
-        statement->Get(9, notNull);
-    }
-    nullableM = !notNull;
-    hasDefaultM = !statement->IsNull(10);
+    precisionM = row.precision;
+    scaleM = row.scale;
+    charsetM = std2wxIdentifier(row.charset, converter);
+    nullableM = !row.notNull;
+    hasDefaultM = !statement->IsNull(13);
     if (hasDefaultM)
     {
-        readBlob(statement, 10, defaultM, converter);
+        readBlob(statement, 13, defaultM, converter);
         defaultM = trimDefaultValue(defaultM);
     }
     else
         defaultM = wxEmptyString;
 
-    if (statement->IsNull(11))
-        collationM = wxEmptyString;
-    else
-    {
-        std::string s;
-        statement->Get(11, s);
-        collationM = std2wxIdentifier(s, converter);
-    }
-    readBlob(statement, 12, checkM, converter);
+    collationM = std2wxIdentifier(row.collation, converter);
+    readBlob(statement, 14, checkM, converter);
 
     setPropertiesLoaded(true);
 }
@@ -392,10 +374,11 @@ DomainPtr DomainCollectionBase::getDomain(const wxString& name)
             Domain::getLoadStatement(false));
         st1->Set(1, wx2std(name, converter));
         st1->Execute();
-        if (st1->Fetch())
+        Domain::LoadRow row;
+        if (Domain::fetchLoadRow(st1, row))
         {
             domain = insert(name);
-            domain->loadProperties(st1, converter);
+            domain->loadProperties(row, st1, converter);
         }
     }
     return domain;
@@ -424,14 +407,13 @@ void Domains::load(ProgressIndicator* progressIndicator)
 
     CollectionType domains;
     st1->Execute();
-    while (st1->Fetch())
+    Domain::LoadRow row;
+    while (Domain::fetchLoadRow(st1, row))
     {
         checkProgressIndicatorCanceled(progressIndicator);
-        if (!st1->IsNull(1))
+        if (!row.name.IsNull())
         {
-            std::string s;
-            st1->Get(1, s);
-            wxString name(std2wxIdentifier(s, converter));
+            wxString name(std2wxIdentifier(row.name.Value(), converter));
 
             DomainPtr domain = findByName(name);
             if (!domain)
@@ -440,7 +422,7 @@ void Domains::load(ProgressIndicator* progressIndicator)
                 initializeLockCount(domain, getLockCount());
             }
             domains.push_back(domain);
-            domain->loadProperties(st1, converter);
+            domain->loadProperties(row, st1, converter);
             checkProgressIndicatorCanceled(progressIndicator);
         }
     }
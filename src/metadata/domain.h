@@ -38,8 +38,22 @@ private:
     bool nullableM, hasDefaultM;
     wxString charsetM, defaultM, collationM, checkM;
 
+    // the columns of getLoadStatement() before its blobs, which
+    // loadProperties() reads from the statement
+    struct LoadRow
+    {
+        IBPP::Nullable<std::string> name;
+        int16_t datatype, subtype, length, precision, scale;
+        std::string charset;
+        IBPP::Nullable<int16_t> charLength;
+        bool notNull;
+        std::string collation;
+        int16_t bytesPerChar;
+    };
     static std::string getLoadStatement(bool list);
-    void loadProperties(IBPP::Statement& statement, wxMBConv* converter);
+    static bool fetchLoadRow(IBPP::Statement& statement, LoadRow& row);
+    void loadProperties(const LoadRow& row, IBPP::Statement& statement,
+        wxMBConv* converter);
     friend class DomainCollectionBase;
     friend class Domains;
 protected:
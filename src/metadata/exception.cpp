@@ -60,6 +60,12 @@ std::string Exception::getLoadStatement(bool list)
     return stmt;
 }
 
+/*static*/
+bool Exception::fetchLoadRow(IBPP::Statement& statement, LoadRow& row)
+{
+    return statement->FetchAs(row.name, row.message, row.number);
+}
+
 Exception::Exception(DatabasePtr database, const wxString& name)
     : MetadataItem(ntException, database.get(), name), numberM(0)
 {
@@ -89,20 +95,20 @@ void Exception::loadProperties()
     IBPP::Statement& st1 = loader->getStatement(getLoadStatement(false));
     st1->Set(1, wx2std(getName_(), converter));
     st1->Execute();
-    if (!st1->Fetch())
+    LoadRow row;
+    if (!fetchLoadRow(st1, row))
         throw FRError(_("Exception not found: ") + getName_());
 
-    loadProperties(st1, converter);
+    loadProperties(row, st1, converter);
 }
 
-void Exception::loadProperties(IBPP::Statement& statement, wxMBConv* converter)
+void Exception::loadProperties(const LoadRow& row, IBPP::Statement& statement,
+    wxMBConv* converter)
 {
     setPropertiesLoaded(false);
 
-    std::string message;
-    statement->Get(2, message);
-    messageM = wxString(message.c_str(), *converter);
-    statement->Get(3, numberM);
+    messageM = wxString(row.message.c_str(), *converter);
+    numberM = row.number;
     if (statement->IsNull(4))
         setDescriptionIsEmpty();
 
@@ -154,13 +160,12 @@ void Exceptions::load(ProgressIndicator* progressIndicator)
     CollectionType exceptions;
     st1->Execute();
     checkProgressIndicatorCanceled(progressIndicator);
-    while (st1->Fetch())
+    Exception::LoadRow row;
+    while (Exception::fetchLoadRow(st1, row))
     {
-        if (!st1->IsNull(1))
+        if (!row.name.IsNull())
         {
-            std::string s;
-            st1->Get(1, s);
-            wxString name(std2wxIdentifier(s, converter));
+            wxString name(std2wxIdentifier(row.name.Value(), converter));
 
             ExceptionPtr exception = findByName(name);
             if (!exception)
@@ -169,7 +174,7 @@ void Exceptions::load(ProgressIndicator* progressIndicator)
                 initializeLockCount(exception, getLockCount());
             }
             exceptions.push_back(exception);
-            exception->loadProperties(st1, converter);
+            exception->loadProperties(row, st1, converter);
         }
         checkProgressIndicatorCanceled(progressIndicator);
     }
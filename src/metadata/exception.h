@@ -35,8 +35,17 @@ class Exception: public MetadataItem
 private:
     wxString messageM;
     int numberM;
+    // the columns of getLoadStatement() before the description blob
+    struct LoadRow
+    {
+        IBPP::Nullable<std::string> name;
+        std::string message;
+        int32_t number;
+    };
     static std::string getLoadStatement(bool list);
-    void loadProperties(IBPP::Statement& statement, wxMBConv* converter);
+    static bool fetchLoadRow(IBPP::Statement& statement, LoadRow& row);
+    void loadProperties(const LoadRow& row, IBPP::Statement& statement,
+        wxMBConv* converter);
     friend class Exceptions;
 protected:
     virtual void loadProperties();
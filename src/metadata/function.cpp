@@ -130,29 +130,21 @@ void Function::loadProperties()
     );
     st1->Set(1, wx2std(getName_(), converter));
     st1->Execute();
-    while (st1->Fetch())
+    int16_t returnarg, mechanism, retpos, type, scale, length, subtype,
+        precision;
+    std::string libraryName, entryPoint;
+    IBPP::Nullable<std::string> charset;
+    while (st1->FetchAs(returnarg, mechanism, retpos, type, scale, length,
+        subtype, precision, libraryName, entryPoint, charset))
     {
-        short returnarg, mechanism, type, scale, length, subtype, precision,
-            retpos;
-        std::string libraryName, entryPoint, charset;
-        st1->Get(1, returnarg);
-        st1->Get(2, mechanism);
-        st1->Get(3, retpos);
-        st1->Get(4, type);
-        st1->Get(5, scale);
-        st1->Get(6, length);
-        st1->Get(7, subtype);
-        st1->Get(8, precision);
-        st1->Get(9, libraryName);
         libraryNameM = wxString(libraryName.c_str(), *converter).Strip();
-        st1->Get(10, entryPoint);
         entryPointM = wxString(entryPoint.c_str(), *converter).Strip();
         wxString datatype = Domain::dataTypeToString(type, scale,
             precision, subtype, length);
-        if (!st1->IsNull(11))
+        if (!charset.IsNull())
         {
-            st1->Get(11, charset);
-            wxString chset = wxString(charset.c_str(), *converter).Strip();
+            wxString chset = wxString(charset.Value().c_str(),
+                *converter).Strip();
             if (db->getDatabaseCharset() != chset)
             {
                 datatype += " " + SqlTokenizer::getKeyword(kwCHARACTER)
@@ -69,8 +69,7 @@ void Generator::loadProperties()
         "select gen_id(" + sqlName + ", 0) from rdb$database");
 
     st1->Execute();
-    st1->Fetch();
-    st1->Get(1, &valueM);
+    st1->FetchAs(valueM);
 
     setPropertiesLoaded(true);
     notifyObservers();
@@ -355,18 +355,17 @@ void MetadataItem::getDependencies(std::vector<Dependency>& list,
     st1->Execute();
     MetadataItem* last = 0;
     Dependency* dep = 0;
-    while (st1->Fetch())
+    int object_type;
+    std::string objname_std;
+    IBPP::Nullable<std::string> field;
+    while (st1->FetchAs(object_type, objname_std, field))
     {
-        int object_type;
-        st1->Get(1, &object_type);
         if (object_type > type_count)   // some system object, not interesting for us
             continue;
         NodeType t = dep_types[object_type];
         if (t == ntUnknown)             // ditto
             continue;
 
-        std::string objname_std;
-        st1->Get(2, objname_std);
         wxString objname(std2wxIdentifier(objname_std,
             d->getCharsetConverter()));
 
@@ -393,10 +392,9 @@ void MetadataItem::getDependencies(std::vector<Dependency>& list,
                 );
                 st2->Set(1, objname_std);
                 st2->Execute();
-                if (st2->Fetch()) // table using that trigger found
+                std::string s;
+                if (st2->FetchAs(s)) // table using that trigger found
                 {
-                    std::string s;
-                    st2->Get(1, s);
                     wxString tablecheck(std2wxIdentifier(s, d->getCharsetConverter()));
                     if (getName_() != tablecheck)    // avoid self-reference
                         current = d->findByNameAndType(ntTable, tablecheck);
@@ -412,12 +410,8 @@ void MetadataItem::getDependencies(std::vector<Dependency>& list,
             dep = &list.back();
             last = current;
         }
-        if (!st1->IsNull(3))
-        {
-            std::string s;
-            st1->Get(3, s);
-            dep->addField(std2wxIdentifier(s, d->getCharsetConverter()));
-        }
+        if (!field.IsNull())
+            dep->addField(std2wxIdentifier(field.Value(), d->getCharsetConverter()));
     }
 
     // TODO: perhaps this could be moved to Table?
@@ -454,10 +448,9 @@ void MetadataItem::getDependencies(std::vector<Dependency>& list,
         st1->Set(1, wx2std(getName_(), d->getCharsetConverter()));
         st1->Execute();
         std::vector<Dependency> tempdep;
-        while (st1->Fetch())
+        std::string s;
+        while (st1->FetchAs(s))
         {
-            std::string s;
-            st1->Get(1, s);
             Trigger t(d->shared_from_this(),
                 std2wxIdentifier(s, d->getCharsetConverter()));
             t.getDependencies(tempdep, true);
@@ -502,13 +495,11 @@ void MetadataItem::getDependencies(std::vector<Dependency>& list,
         st1->Execute();
         wxString lasttable;
         Dependency* dep = 0;
-        while (st1->Fetch())
+        std::string relation, column;
+        while (st1->FetchAs(relation, column))
         {
-            std::string s;
-            st1->Get(1, s);
-            wxString table_name(std2wxIdentifier(s, d->getCharsetConverter()));
-            st1->Get(2, s);
-            wxString field_name(std2wxIdentifier(s, d->getCharsetConverter()));
+            wxString table_name(std2wxIdentifier(relation, d->getCharsetConverter()));
+            wxString field_name(std2wxIdentifier(column, d->getCharsetConverter()));
 
             if (table_name != lasttable)    // new
             {
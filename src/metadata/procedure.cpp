@@ -76,9 +76,9 @@ void Procedure::loadChildren()
         "rdb$parameter_type, "
     );
     if (db->getInfo().getODSVersionIsHigherOrEqualTo(11, 1))
-        sql += "rdb$default_source, rdb$null_flag, rdb$parameter_mechanism, ";
+        sql += "rdb$null_flag, rdb$parameter_mechanism, rdb$default_source, ";
     else
-        sql += "null, null, -1, ";
+        sql += "cast(null as smallint), cast(-1 as smallint), null, ";
 
     sql +=  "rdb$description from rdb$procedure_parameters "
             "where rdb$procedure_name = ? "
@@ -89,28 +89,24 @@ void Procedure::loadChildren()
     st1->Execute();
 
     ParameterPtrs parameters;
-    while (st1->Fetch())
+    std::string name, fieldSource, s;
+    int16_t partype;
+    // null flag null = nullable, null mechanism = -1
+    bool notNull;
+    IBPP::Nullable<int16_t> mech;
+    while (st1->FetchAs(name, fieldSource, partype, notNull, mech))
     {
-        std::string s;
-        st1->Get(1, s);
-        wxString param_name(std2wxIdentifier(s, converter));
-        st1->Get(2, s);
-        wxString source(std2wxIdentifier(s, converter));
-
-        short partype, mechanism = -1;
-        st1->Get(3, &partype);
-        bool hasDefault = !st1->IsNull(4);
+        wxString param_name(std2wxIdentifier(name, converter));
+        wxString source(std2wxIdentifier(fieldSource, converter));
+
+        short mechanism = mech.ValueOr(-1);
+        bool hasDefault = !st1->IsNull(6);
         wxString defaultSrc;
         if (hasDefault)
         {
-            st1->Get(4, s);
+            st1->Get(6, s);
             defaultSrc = std2wxIdentifier(s, converter);
         }
-        bool notNull = false;
-        if (!st1->IsNull(5))
-            st1->Get(5, &notNull);
-        if (!st1->IsNull(6))
-            st1->Get(6, mechanism);
         bool hasDescription = !st1->IsNull(7);
 
         ParameterPtr par = findParameter(param_name);
@@ -204,9 +200,8 @@ wxString Procedure::getOwner()
         "select rdb$owner_name from rdb$procedures where rdb$procedure_name = ?");
     st1->Set(1, wx2std(getName_(), db->getCharsetConverter()));
     st1->Execute();
-    st1->Fetch();
     std::string name;
-    st1->Get(1, name);
+    st1->FetchAs(name);
     return std2wxIdentifier(name, db->getCharsetConverter());
 }
 
@@ -443,17 +438,12 @@ std::vector<Privilege>* Procedure::getPrivileges()
     std::string lastuser;
     int lasttype = -1;
     Privilege *pr = 0;
-    while (st1->Fetch())
+    std::string user, grantor, privilege, field;
+    // null grant option = no grant option
+    int usertype, grantoption;
+    while (st1->FetchAs(user, usertype, grantor, privilege, grantoption,
+        field))
     {
-        std::string user, grantor, privilege, field;
-        int usertype, grantoption = 0;
-        st1->Get(1, user);
-        st1->Get(2, usertype);
-        st1->Get(3, grantor);
-        st1->Get(4, privilege);
-        if (!st1->IsNull(5))
-            st1->Get(5, grantoption);
-        st1->Get(6, field);
         if (!pr || user != lastuser || usertype != lasttype)
         {
             Privilege p(this, std2wxIdentifier(user, converter),
@@ -113,21 +113,16 @@ void Relation::loadProperties()
     IBPP::Statement& st1 = loader->getStatement(sql);
     st1->Set(1, wx2std(getName_(), converter));
     st1->Execute();
-    if (st1->Fetch())
+    std::string name;
+    IBPP::Nullable<std::string> file;
+    if (st1->FetchAs(name, relationTypeM, file))
     {
-        std::string name;
-        st1->Get(1, name);
         ownerM = std2wxIdentifier(name, converter);
-        st1->Get(2, relationTypeM);
 
         wxString value;
         // for tables: path to external file
-        if (!st1->IsNull(3))
-        {
-            std::string s;
-            st1->Get(3, s);
-            setExternalFilePath(wxString(s.c_str(), *converter));
-        }
+        if (!file.IsNull())
+            setExternalFilePath(wxString(file.Value().c_str(), *converter));
         else
             setExternalFilePath(wxEmptyString);
 
@@ -199,18 +194,12 @@ void Relation::loadChildren()
     st1->Execute();
 
     ColumnPtrs columns;
-    while (st1->Fetch())
+    std::string name, fieldSource, coll;
+    bool notNull;
+    while (st1->FetchAs(name, notNull, fieldSource, coll))
     {
-        std::string s, coll;
-        st1->Get(1, s);
-        wxString fname(std2wxIdentifier(s, converter));
-        bool notNull = false;
-        if (!st1->IsNull(2))
-            st1->Get(2, &notNull);
-        st1->Get(3, s);
-        wxString source(std2wxIdentifier(s, converter));
-        if (!st1->IsNull(4))
-            st1->Get(4, coll);
+        wxString fname(std2wxIdentifier(name, converter));
+        wxString source(std2wxIdentifier(fieldSource, converter));
         wxString collation(std2wxIdentifier(coll, converter));
         wxString computedSrc, defaultSrc;
         readBlob(st1, 5, computedSrc, converter);
@@ -291,13 +280,11 @@ void Relation::getDependentChecks(std::vector<CheckConstraint>& checks)
 
     st1->Set(1, wx2std(getName_(), converter));
     st1->Execute();
-    while (st1->Fetch())
+    std::string constraint, relation;
+    while (st1->FetchAs(constraint, relation))
     {
-        std::string s;
-        st1->Get(1, s);
-        wxString cname(std2wxIdentifier(s, converter));
-        st1->Get(2, s);
-        wxString table(std2wxIdentifier(s, converter));
+        wxString cname(std2wxIdentifier(constraint, converter));
+        wxString table(std2wxIdentifier(relation, converter));
 
         wxString source;
         readBlob(st1, 3, source, converter);
@@ -588,17 +575,12 @@ std::vector<Privilege>* Relation::getPrivileges()
     std::string lastuser;
     int lasttype = -1;
     Privilege *pr = 0;
-    while (st1->Fetch())
+    std::string user, grantor, privilege, field;
+    // null grant option = no grant option
+    int usertype, grantoption;
+    while (st1->FetchAs(user, usertype, grantor, privilege, grantoption,
+        field))
     {
-        std::string user, grantor, privilege, field;
-        int usertype, grantoption = 0;
-        st1->Get(1, user);
-        st1->Get(2, usertype);
-        st1->Get(3, grantor);
-        st1->Get(4, privilege);
-        if (!st1->IsNull(5))
-            st1->Get(5, grantoption);
-        st1->Get(6, field);
         if (!pr || user != lastuser || usertype != lasttype)
         {
             Privilege p(this, wxString(user.c_str(), *converter).Strip(), usertype);
@@ -630,10 +612,9 @@ void Relation::getTriggers(std::vector<Trigger *>& list,
     );
     st1->Set(1, wx2std(getName_(), converter));
     st1->Execute();
-    while (st1->Fetch())
+    std::string name;
+    while (st1->FetchAs(name))
     {
-        std::string name;
-        st1->Get(1, name);
         Trigger* t = dynamic_cast<Trigger*>(db->findByNameAndType(ntTrigger,
             std2wxIdentifier(name, converter)));
         if (t && t->getFiringTime() == time)
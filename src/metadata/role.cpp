@@ -71,16 +71,11 @@ std::vector<Privilege>* Role::getPrivileges()
     std::string lastuser;
     int lasttype = -1;
     Privilege *pr = 0;
-    while (st1->Fetch())
+    std::string user, grantor, privilege;
+    // null grant option = no grant option
+    int usertype, grantoption;
+    while (st1->FetchAs(user, usertype, grantor, privilege, grantoption))
     {
-        std::string user, grantor, privilege;
-        int usertype, grantoption = 0;
-        st1->Get(1, user);
-        st1->Get(2, usertype);
-        st1->Get(3, grantor);
-        st1->Get(4, privilege);
-        if (!st1->IsNull(5))
-            st1->Get(5, grantoption);
         if (!pr || user != lastuser || usertype != lasttype)
         {
             Privilege p(this, wxString(user).Strip(), usertype);
@@ -105,9 +100,8 @@ wxString Role::getOwner()
         "select rdb$owner_name from rdb$roles where rdb$role_name = ?");
     st1->Set(1, wx2std(getName_(), db->getCharsetConverter()));
     st1->Execute();
-    st1->Fetch();
     std::string name;
-    st1->Get(1, name);
+    st1->FetchAs(name);
     return wxString(name).Trim();
 }
 
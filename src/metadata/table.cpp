@@ -114,7 +114,7 @@ void Table::loadCheckConstraints()
     SubjectLocker lock(this);
 
     IBPP::Statement& st1 = loader->getStatement(
-        "select r.rdb$constraint_name, t.rdb$trigger_source, d.rdb$field_name "
+        "select r.rdb$constraint_name, d.rdb$field_name, t.rdb$trigger_source "
         " from rdb$relation_constraints r "
         " join rdb$check_constraints c on r.rdb$constraint_name=c.rdb$constraint_name and r.rdb$constraint_type = 'CHECK'"
         " join rdb$triggers t on c.rdb$trigger_name=t.rdb$trigger_name and t.rdb$trigger_type = 1 "
@@ -128,15 +128,15 @@ void Table::loadCheckConstraints()
     st1->Set(1, wx2std(getName_(), conv));
     st1->Execute();
     CheckConstraint *cc = 0;
-    while (st1->Fetch())
+    std::string name;
+    IBPP::Nullable<std::string> field;
+    while (st1->FetchAs(name, field))
     {
-        std::string s;
-        st1->Get(1, s);
-        wxString cname(std2wxIdentifier(s, conv));
+        wxString cname(std2wxIdentifier(name, conv));
         if (!cc || cname != cc->getName_()) // new constraint
         {
             wxString source;
-            readBlob(st1, 2, source, conv);
+            readBlob(st1, 3, source, conv);
 
             CheckConstraint c;
             c.setParent(this);
@@ -146,10 +146,9 @@ void Table::loadCheckConstraints()
             cc = &checkConstraintsM.back();
         }
 
-        if (!st1->IsNull(3))
+        if (!field.IsNull())
         {
-            st1->Get(3, s);
-            wxString fname(std2wxIdentifier(s, conv));
+            wxString fname(std2wxIdentifier(field.Value(), conv));
             cc->columnsM.push_back(fname);
         }
     }
@@ -182,15 +181,12 @@ void Table::loadPrimaryKey()
 
     st1->Set(1, wx2std(getName_(), conv));
     st1->Execute();
-    while (st1->Fetch())
+    std::string name, field, index;
+    while (st1->FetchAs(name, field, index))
     {
-        std::string s;
-        st1->Get(1, s);
-        wxString cname(std2wxIdentifier(s, conv));
-        st1->Get(2, s);
-        wxString fname(std2wxIdentifier(s, conv));
-        st1->Get(3, s);
-        wxString ixname(std2wxIdentifier(s, conv));
+        wxString cname(std2wxIdentifier(name, conv));
+        wxString fname(std2wxIdentifier(field, conv));
+        wxString ixname(std2wxIdentifier(index, conv));
 
         primaryKeyM.setName_(cname);
         primaryKeyM.columnsM.push_back(fname);
@@ -227,15 +223,12 @@ void Table::loadUniqueConstraints()
     st1->Set(1, wx2std(getName_(), conv));
     st1->Execute();
     UniqueConstraint *cc = 0;
-    while (st1->Fetch())
+    std::string name, field, index;
+    while (st1->FetchAs(name, field, index))
     {
-        std::string s;
-        st1->Get(1, s);
-        wxString cname(std2wxIdentifier(s, conv));
-        st1->Get(2, s);
-        wxString fname(std2wxIdentifier(s, conv));
-        st1->Get(3, s);
-        wxString ixname(std2wxIdentifier(s, conv));
+        wxString cname(std2wxIdentifier(name, conv));
+        wxString fname(std2wxIdentifier(field, conv));
+        wxString ixname(std2wxIdentifier(index, conv));
 
         if (cc && cc->getName_() == cname)
             cc->columnsM.push_back(fname);
@@ -322,21 +315,14 @@ void Table::loadForeignKeys()
     st1->Set(1, wx2std(getName_(), conv));
     st1->Execute();
     ForeignKey *fkp = 0;
-    while (st1->Fetch())
+    std::string name, field, update, del, ref_constraint, index;
+    while (st1->FetchAs(name, field, update, del, ref_constraint, index))
     {
-        std::string s;
-        st1->Get(1, s);
-        wxString cname(std2wxIdentifier(s, conv));
-        st1->Get(2, s);
-        wxString fname(std2wxIdentifier(s, conv));
-        st1->Get(3, s);
-        wxString update_rule(std2wxIdentifier(s, conv));
-        st1->Get(4, s);
-        wxString delete_rule(std2wxIdentifier(s, conv));
-        std::string ref_constraint;
-        st1->Get(5, ref_constraint);
-        st1->Get(6, s);
-        wxString ixname(std2wxIdentifier(s, conv));
+        wxString cname(std2wxIdentifier(name, conv));
+        wxString fname(std2wxIdentifier(field, conv));
+        wxString update_rule(std2wxIdentifier(update, conv));
+        wxString delete_rule(std2wxIdentifier(del, conv));
+        wxString ixname(std2wxIdentifier(index, conv));
 
         if (fkp && fkp->getName_() == cname) // add column
             fkp->columnsM.push_back(fname);
@@ -353,13 +339,9 @@ void Table::loadForeignKeys()
 
             st2->Set(1, ref_constraint);
             st2->Execute();
-            std::string rtable;
-            while (st2->Fetch())
-            {
-                st2->Get(1, rtable);
-                st2->Get(2, s);
-                fkp->referencedColumnsM.push_back(std2wxIdentifier(s, conv));
-            }
+            std::string rtable, rfield;
+            while (st2->FetchAs(rtable, rfield))
+                fkp->referencedColumnsM.push_back(std2wxIdentifier(rfield, conv));
             fkp->referencedTableM = std2wxIdentifier(rtable, conv);
             fkp->columnsM.push_back(fname);
         }
@@ -399,33 +381,18 @@ void Table::loadIndices()
     st1->Set(1, wx2std(getName_(), conv));
     st1->Execute();
     Index* i = 0;
-    while (st1->Fetch())
+    std::string name, field;
+    // null unique flag = non-unique, null inactive = active,
+    // null type = ascending
+    int16_t unq, inactive, type;
+    IBPP::Nullable<double> stats;
+    IBPP::Nullable<std::string> constraint;
+    while (st1->FetchAs(name, unq, inactive, type, stats, field, constraint))
     {
-        std::string s;
-        st1->Get(1, s);
-        wxString ixname(std2wxIdentifier(s, conv));
-
-        short unq, inactive, type;
-        if (st1->IsNull(2))     // null = non-unique
-            unq = 0;
-        else
-            st1->Get(2, unq);
-        if (st1->IsNull(3))     // null = active
-            inactive = 0;
-        else
-            st1->Get(3, inactive);
-        if (st1->IsNull(4))     // null = ascending
-            type = 0;
-        else
-            st1->Get(4, type);
-        double statistics;
-        if (st1->IsNull(5))     // this can happen, see bug #1825725
-            statistics = -1;
-        else
-            st1->Get(5, statistics);
-
-        st1->Get(6, s);
-        wxString fname(std2wxIdentifier(s, conv));
+        wxString ixname(std2wxIdentifier(name, conv));
+        // this can be null, see bug #1825725
+        double statistics = stats.ValueOr(-1);
+        wxString fname(std2wxIdentifier(field, conv));
         wxString expression;
         readBlob(st1, 8, expression, conv);
 
@@ -438,7 +405,7 @@ void Table::loadIndices()
                 inactive == 0,
                 type == 0,
                 statistics,
-                !st1->IsNull(7),
+                !constraint.IsNull(),
                 expression
             );
             indicesM.push_back(x);
@@ -169,26 +169,13 @@ void Trigger::loadProperties()
 
     st1->Set(1, wx2std(getName_(), db->getCharsetConverter()));
     st1->Execute();
-    if (st1->Fetch())
+    // null relation = database trigger, null inactive = active
+    std::string objname;
+    int16_t inactive;
+    if (st1->FetchAs(objname, positionM, inactive, typeM))
     {
-        if (st1->IsNull(1))
-            relationNameM.clear();
-        else
-        {
-            std::string objname;
-            st1->Get(1, objname);
-            relationNameM = std2wxIdentifier(objname, db->getCharsetConverter());
-        }
-        st1->Get(2, &positionM);
-
-        short temp;
-        if (st1->IsNull(3))
-            temp = 0;
-        else
-            st1->Get(3, &temp);
-        activeM = (temp == 0);
-
-        st1->Get(4, &typeM);
+        relationNameM = std2wxIdentifier(objname, db->getCharsetConverter());
+        activeM = (inactive == 0);
 
         readBlob(st1, 5, sourceM, db->getCharsetConverter());
     }